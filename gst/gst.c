@@ -1111,6 +1111,11 @@ gst_deinit (void)
 
   _priv_gst_registry_cleanup ();
   _priv_gst_allocator_cleanup ();
+  _priv_gst_meta_cleanup ();
+
+  /* drop the caps that were cached or interned before the leaks tracer
+   * looks for leaked caps */
+  _priv_gst_caps_cache_cleanup ();
 
   /* We want to destroy tracers as late as possible for the leaks tracer
    * but still need to keep the caps system alive as it may have to use
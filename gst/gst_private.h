@@ -134,6 +134,14 @@ G_GNUC_INTERNAL  void  _priv_gst_date_time_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_allocator_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_caps_features_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_caps_cleanup (void);
+G_GNUC_INTERNAL  void  _priv_gst_caps_cache_cleanup (void);
+G_GNUC_INTERNAL  void  _priv_gst_meta_cleanup (void);
+
+/* memory accounting, called when memory is initialized. Accounted memory
+ * is flagged so that only that is subtracted when it is freed. */
+#define GST_MEMORY_FLAG_ACCOUNTED (GST_MINI_OBJECT_FLAG_LAST << 15)
+
+G_GNUC_INTERNAL  void  _priv_gst_allocator_account_memory (GstMemory * mem);
 
 /* called from gst_task_cleanup_all(). */
 G_GNUC_INTERNAL  void  _priv_gst_element_cleanup (void);
@@ -160,6 +168,20 @@ G_GNUC_INTERNAL gboolean _priv_gst_value_parse_simple_string (gchar * str, gchar
 G_GNUC_INTERNAL gboolean _priv_gst_value_parse_value (gchar * str, gchar ** after, GValue * value, GType default_type);
 G_GNUC_INTERNAL gchar * _priv_gst_value_serialize_any_list (const GValue * value, const gchar * begin, const gchar * end, gboolean print_type);
 
+/* hashes of values, structures and caps, used to look up caps */
+G_GNUC_INTERNAL guint _priv_gst_value_hash (const GValue * value);
+G_GNUC_INTERNAL guint _priv_gst_structure_hash (const GstStructure * structure);
+G_GNUC_INTERNAL guint _priv_gst_caps_hash (const GstCaps * caps);
+
+/* binary serialization of structures and caps, in gstvalue.c */
+G_GNUC_INTERNAL gboolean _priv_gst_binary_write_structure (GByteArray * array, const GstStructure * structure);
+G_GNUC_INTERNAL gboolean _priv_gst_binary_write_caps (GByteArray * array, const GstCaps * caps);
+G_GNUC_INTERNAL GstStructure * _priv_gst_binary_read_structure (const guint8 * data, gsize size, gsize * consumed);
+G_GNUC_INTERNAL GstCaps * _priv_gst_binary_read_caps (const guint8 * data, gsize size, gsize * consumed);
+
+/* checks feature names also when checks are disabled, for untrusted input */
+G_GNUC_INTERNAL gboolean _priv_gst_caps_feature_name_is_valid (const gchar * feature);
+
 /* Used in GstBin for manual state handling */
 G_GNUC_INTERNAL  void _priv_gst_element_state_changed (GstElement *element,
                       GstState oldstate, GstState newstate, GstState pending);
@@ -212,6 +234,10 @@ void      __gst_element_factory_add_interface           (GstElementFactory    *
     ((c) == '-') || ((c) == '+') || ((c) == '/') || ((c) == ':') || \
     ((c) == '.'))
 
+/* structure and caps strings shorter than this are copied on the stack
+ * to be parsed in place, used in gststructure.c and gstcaps.c */
+#define GST_PARSE_STACK_BUFFER_SIZE 1024
+
 /* This is only meant for internal uses */
 G_GNUC_INTERNAL
 gint __gst_date_time_compare (const GstDateTime * dt1, const GstDateTime * dt2);
@@ -501,6 +527,18 @@ struct _GstDynamicTypeFactoryClass {
   GstPluginFeatureClass      parent;
 };
 
+/* GstClockEntry as allocated by GstClock, with the private data the system
+ * clock needs to wake up the waiter of just this entry and to keep async
+ * entries in its timer heap */
+typedef struct {
+  GstClockEntry entry;
+
+  GMutex lock;
+  GCond cond;                   /* signalled to wake up the waiter */
+  gint heap_index;              /* position in the timer heap or -1 */
+  guint64 heap_seqnum;          /* orders entries with the same time */
+} GstClockEntryImpl;
+
 /* privat flag used by GstBus / GstMessage */
 #define GST_MESSAGE_FLAG_ASYNC_DELIVERY (GST_MINI_OBJECT_FLAG_LAST << 0)
 
@@ -36,6 +36,25 @@
  *
  * New memory can be created with gst_memory_new_wrapped() that wraps the memory
  * allocated elsewhere.
+ *
+ * On platforms that support it, an allocator that backs large memory blocks
+ * with huge pages is registered as #GST_ALLOCATOR_HUGE_PAGE. Instances bound
+ * to a NUMA node can be made with gst_huge_page_allocator_new().
+ *
+ * On Linux, memory allocated by the #GST_ALLOCATOR_MEMFD allocator is backed
+ * by a sealed memfd. The file descriptor can be retrieved with
+ * gst_memfd_memory_get_fd_info() and passed to another process, where
+ * gst_memfd_memory_import() wraps it in a #GstMemory again without copying.
+ *
+ * The GST_ALLOCATOR_DEFAULT environment variable can be set to the name of a
+ * registered allocator to make it the default allocator.
+ *
+ * Every allocator counts the bytes of the memory it has alive and the highest
+ * amount it ever had, gst_allocator_get_stats() returns those counters for one
+ * allocator or for the whole process. With gst_allocator_set_memory_budget()
+ * an application sets a limit for the memory of the whole process. Allocation
+ * does not fail when the budget is exceeded but buffer pools stop growing and
+ * elements that hold on to data, like queue, post a message on the bus.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -44,6 +63,28 @@
 
 #include "gst_private.h"
 #include "gstmemory.h"
+#include "gstslicecache.h"
+#include "gstmemcpy.h"
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_SYS_MMAN_H
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef HAVE_SYS_SYSCALL_H
+#include <sys/syscall.h>
+#endif
+#if defined(HAVE_MADVISE) && defined(MAP_ANONYMOUS)
+#define HAVE_HUGE_PAGE_ALLOCATOR
+#endif
+#if defined(HAVE_MEMFD_CREATE) || defined(__NR_memfd_create)
+#define HAVE_MEMFD_ALLOCATOR
+#endif
+#endif
 
 GST_DEBUG_CATEGORY_STATIC (gst_allocator_debug);
 #define GST_CAT_DEFAULT gst_allocator_debug
@@ -53,9 +94,21 @@ GST_DEBUG_CATEGORY_STATIC (gst_allocator_debug);
 
 struct _GstAllocatorPrivate
 {
-  gpointer dummy;
+  /* bytes of the memory alive and the highest amount there ever was */
+  gsize live_bytes;
+  gsize peak_bytes;
+  /* if we are in the accounted list */
+  gboolean accounted;
 };
 
+/* the allocators that accounted memory, the highest sum of their memory seen
+ * so far and the budget, 0 is unlimited. Memory is only accounted while there
+ * is a budget, the sum is only made when it is checked. */
+static GRWLock accounting_lock;
+static GList *accounted_allocators;
+static gsize total_peak_bytes;
+static gsize memory_budget;
+
 #if defined(MEMORY_ALIGNMENT_MALLOC)
 gsize gst_memory_alignment = 7;
 #elif defined(MEMORY_ALIGNMENT_PAGESIZE)
@@ -79,11 +132,17 @@ static GHashTable *allocators;
 
 G_DEFINE_ABSTRACT_TYPE (GstAllocator, gst_allocator, GST_TYPE_OBJECT);
 
+static void gst_allocator_finalize (GObject * object);
+
 static void
 gst_allocator_class_init (GstAllocatorClass * klass)
 {
+  GObjectClass *gobject_class = (GObjectClass *) klass;
+
   g_type_class_add_private (klass, sizeof (GstAllocatorPrivate));
 
+  gobject_class->finalize = gst_allocator_finalize;
+
   GST_DEBUG_CATEGORY_INIT (gst_allocator_debug, "allocator", 0,
       "allocator debug");
 }
@@ -117,7 +176,7 @@ _fallback_mem_copy (GstMemory * mem, gssize offset, gssize size)
 
   GST_CAT_DEBUG (GST_CAT_PERFORMANCE,
       "memcpy %" G_GSSIZE_FORMAT " memory %p -> %p", size, mem, copy);
-  memcpy (dinfo.data, sinfo.data + offset, size);
+  _priv_gst_memcpy (dinfo.data, sinfo.data + offset, size);
   gst_memory_unmap (copy, &dinfo);
   gst_memory_unmap (mem, &sinfo);
 
@@ -139,6 +198,20 @@ gst_allocator_init (GstAllocator * allocator)
   allocator->mem_is_span = _fallback_mem_is_span;
 }
 
+static void
+gst_allocator_finalize (GObject * object)
+{
+  GstAllocator *allocator = GST_ALLOCATOR_CAST (object);
+
+  if (allocator->priv->accounted) {
+    g_rw_lock_writer_lock (&accounting_lock);
+    accounted_allocators = g_list_remove (accounted_allocators, allocator);
+    g_rw_lock_writer_unlock (&accounting_lock);
+  }
+
+  G_OBJECT_CLASS (gst_allocator_parent_class)->finalize (object);
+}
+
 G_DEFINE_BOXED_TYPE (GstAllocationParams, gst_allocation_params,
     (GBoxedCopyFunc) gst_allocation_params_copy,
     (GBoxedFreeFunc) gst_allocation_params_free);
@@ -268,6 +341,181 @@ gst_allocator_set_default (GstAllocator * allocator)
     gst_object_unref (old);
 }
 
+static inline void
+update_peak (gsize * peak, gsize live)
+{
+  gsize old;
+
+  do {
+    old = GPOINTER_TO_SIZE (g_atomic_pointer_get (peak));
+    if (old >= live)
+      break;
+  } while (!g_atomic_pointer_compare_and_exchange ((gpointer *) peak,
+          GSIZE_TO_POINTER (old), GSIZE_TO_POINTER (live)));
+}
+
+/* Memory is accounted to its allocator when it is initialized without a
+ * parent while a budget is set, until it is freed. Shared memory doesn't own
+ * its data. Without a budget this is only a load of the budget. */
+void
+_priv_gst_allocator_account_memory (GstMemory * mem)
+{
+  GstAllocatorPrivate *priv;
+  gsize live;
+
+  if (G_LIKELY (g_atomic_pointer_get (&memory_budget) == NULL))
+    return;
+
+  priv = mem->allocator->priv;
+  if (G_UNLIKELY (!g_atomic_int_get (&priv->accounted))) {
+    g_rw_lock_writer_lock (&accounting_lock);
+    if (!priv->accounted) {
+      accounted_allocators =
+          g_list_prepend (accounted_allocators, mem->allocator);
+      g_atomic_int_set (&priv->accounted, TRUE);
+    }
+    g_rw_lock_writer_unlock (&accounting_lock);
+  }
+
+  GST_MINI_OBJECT_FLAG_SET (mem, GST_MEMORY_FLAG_ACCOUNTED);
+  live = g_atomic_pointer_add (&priv->live_bytes, mem->maxsize) + mem->maxsize;
+  update_peak (&priv->peak_bytes, live);
+}
+
+/* the memory of all accounted allocators together */
+static gsize
+total_live_bytes (void)
+{
+  GList *walk;
+  gsize live = 0;
+
+  g_rw_lock_reader_lock (&accounting_lock);
+  for (walk = accounted_allocators; walk; walk = walk->next) {
+    GstAllocator *allocator = walk->data;
+
+    live += GPOINTER_TO_SIZE (g_atomic_pointer_get
+        (&allocator->priv->live_bytes));
+  }
+  g_rw_lock_reader_unlock (&accounting_lock);
+
+  update_peak (&total_peak_bytes, live);
+
+  return live;
+}
+
+/**
+ * gst_allocator_get_stats:
+ * @allocator: (transfer none) (allow-none): a #GstAllocator
+ *
+ * Get the memory accounting of @allocator or, when @allocator is %NULL, of
+ * all allocators of the process. The structure is named
+ * "GstAllocatorStats" and contains the following fields:
+ *
+ * - "live-bytes" (#guint64): the size of all memory that is alive
+ * - "peak-bytes" (#guint64): the highest value "live-bytes" ever had
+ *
+ * For the process, the "budget" (#guint64) field contains the budget set
+ * with gst_allocator_set_memory_budget().
+ *
+ * Memory is counted with its complete size, including prefix and padding.
+ * Memory that shares the data of another memory is not counted. Memory is only
+ * counted while a budget is set with gst_allocator_set_memory_budget(), and
+ * the "peak-bytes" of the process is the highest total seen when the budget
+ * was checked.
+ *
+ * Returns: (transfer full): a new #GstStructure with the counters.
+ *
+ * Since: 1.14
+ */
+GstStructure *
+gst_allocator_get_stats (GstAllocator * allocator)
+{
+  gsize live, peak;
+  GstStructure *stats;
+
+  g_return_val_if_fail (allocator == NULL || GST_IS_ALLOCATOR (allocator),
+      NULL);
+
+  if (allocator) {
+    live = GPOINTER_TO_SIZE (g_atomic_pointer_get
+        (&allocator->priv->live_bytes));
+    peak = GPOINTER_TO_SIZE (g_atomic_pointer_get
+        (&allocator->priv->peak_bytes));
+  } else {
+    live = total_live_bytes ();
+    peak = GPOINTER_TO_SIZE (g_atomic_pointer_get (&total_peak_bytes));
+  }
+
+  stats = gst_structure_new ("GstAllocatorStats",
+      "live-bytes", G_TYPE_UINT64, (guint64) live,
+      "peak-bytes", G_TYPE_UINT64, (guint64) peak, NULL);
+
+  if (allocator == NULL)
+    gst_structure_set (stats, "budget", G_TYPE_UINT64,
+        (guint64) gst_allocator_get_memory_budget (), NULL);
+
+  return stats;
+}
+
+/**
+ * gst_allocator_set_memory_budget:
+ * @budget: the maximum number of bytes, or 0 for no limit
+ *
+ * Set the number of bytes that the memory of all allocators together should
+ * not exceed. Memory is only accounted while a budget is set, memory that was
+ * allocated before is not counted.
+ *
+ * The budget is not enforced by the allocators, allocation never fails
+ * because of it. Instead, buffer pools don't allocate more buffers while the
+ * budget is exceeded and wait for buffers to be released, which slows down
+ * the producer. Elements that hold on to data, like queue, post a
+ * "GstMemoryBudgetExceeded" element message with their current level on the
+ * bus so that the application can find out who holds the memory.
+ *
+ * Since: 1.14
+ */
+void
+gst_allocator_set_memory_budget (gsize budget)
+{
+  GST_CAT_INFO (GST_CAT_MEMORY, "memory budget set to %" G_GSIZE_FORMAT,
+      budget);
+  g_atomic_pointer_set (&memory_budget, GSIZE_TO_POINTER (budget));
+}
+
+/**
+ * gst_allocator_get_memory_budget:
+ *
+ * Get the budget set with gst_allocator_set_memory_budget().
+ *
+ * Returns: the memory budget in bytes, 0 when there is no limit.
+ *
+ * Since: 1.14
+ */
+gsize
+gst_allocator_get_memory_budget (void)
+{
+  return GPOINTER_TO_SIZE (g_atomic_pointer_get (&memory_budget));
+}
+
+/**
+ * gst_allocator_memory_budget_exceeded:
+ *
+ * Check if the memory of all allocators together is larger than the budget
+ * set with gst_allocator_set_memory_budget(). Without a budget this check is
+ * cheap, with a budget it sums the memory of all allocators.
+ *
+ * Returns: %TRUE when a budget is set and exceeded.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_allocator_memory_budget_exceeded (void)
+{
+  gsize budget = GPOINTER_TO_SIZE (g_atomic_pointer_get (&memory_budget));
+
+  return budget != 0 && total_live_bytes () > budget;
+}
+
 /**
  * gst_allocator_alloc:
  * @allocator: (transfer none) (allow-none): a #GstAllocator to use
@@ -334,6 +582,10 @@ gst_allocator_free (GstAllocator * allocator, GstMemory * memory)
   g_return_if_fail (memory != NULL);
   g_return_if_fail (memory->allocator == allocator);
 
+  if (GST_MEMORY_FLAG_IS_SET (memory, GST_MEMORY_FLAG_ACCOUNTED))
+    g_atomic_pointer_add (&allocator->priv->live_bytes,
+        -(gssize) memory->maxsize);
+
   aclass = GST_ALLOCATOR_GET_CLASS (allocator);
   if (aclass->free)
     aclass->free (allocator, memory);
@@ -391,7 +643,7 @@ _sysmem_new (GstMemoryFlags flags,
 
   slice_size = sizeof (GstMemorySystem);
 
-  mem = g_slice_alloc (slice_size);
+  mem = _priv_gst_slice_cache_alloc (slice_size);
   _sysmem_init (mem, flags, parent, slice_size,
       data, maxsize, align, offset, size, user_data, notify);
 
@@ -414,7 +666,7 @@ _sysmem_new_block (GstMemoryFlags flags,
   /* alloc header and data in one block */
   slice_size = sizeof (GstMemorySystem) + maxsize;
 
-  mem = g_slice_alloc (slice_size);
+  mem = _priv_gst_slice_cache_alloc (slice_size);
   if (mem == NULL)
     return NULL;
 
@@ -463,7 +715,7 @@ _sysmem_copy (GstMemorySystem * mem, gssize offset, gsize size)
   copy = _sysmem_new_block (0, size, mem->mem.align, 0, size);
   GST_CAT_DEBUG (GST_CAT_PERFORMANCE,
       "memcpy %" G_GSIZE_FORMAT " memory %p -> %p", size, mem, copy);
-  memcpy (copy->data, mem->data + mem->mem.offset + offset, size);
+  _priv_gst_memcpy (copy->data, mem->data + mem->mem.offset + offset, size);
 
   return copy;
 }
@@ -533,7 +785,7 @@ default_free (GstAllocator * allocator, GstMemory * mem)
   memset (mem, 0xff, sizeof (GstMemorySystem));
 #endif
 
-  g_slice_free1 (slice_size, mem);
+  _priv_gst_slice_cache_free (slice_size, mem);
 }
 
 static void
@@ -576,9 +828,810 @@ gst_allocator_sysmem_init (GstAllocatorSysmem * allocator)
   alloc->mem_is_span = (GstMemoryIsSpanFunction) _sysmem_is_span;
 }
 
+/* huge page memory implementation */
+#ifdef HAVE_HUGE_PAGE_ALLOCATOR
+
+#ifndef MPOL_BIND
+#define MPOL_BIND 2
+#endif
+
+/* the max NUMA node we can bind to */
+#define NUMA_MAX_NODES 1024
+
+/* default huge page size, updated from /proc/meminfo */
+static gsize huge_page_size = 2 * 1024 * 1024;
+/* the size of normal pages */
+static gsize system_page_size = 4096;
+
+typedef struct
+{
+  GstMemory mem;
+
+  guint8 *data;
+
+  /* the mmap()ed region, NULL for shared memory */
+  gpointer base;
+  gsize base_size;
+} GstMemoryHugePage;
+
+typedef struct
+{
+  GstAllocator parent;
+
+  gint numa_node;
+  GstHugePageAllocatorFlags flags;
+
+  /* set when the explicit huge page pool was exhausted once, accessed with
+   * atomic operations */
+  gint explicit_failed;
+} GstAllocatorHugePage;
+
+typedef struct
+{
+  GstAllocatorClass parent_class;
+} GstAllocatorHugePageClass;
+
+static GType gst_allocator_huge_page_get_type (void);
+G_DEFINE_TYPE (GstAllocatorHugePage, gst_allocator_huge_page,
+    GST_TYPE_ALLOCATOR);
+
+static void
+_huge_page_init_size (void)
+{
+  gchar *contents, *line;
+  glong page_size;
+
+  if ((page_size = sysconf (_SC_PAGESIZE)) > 0)
+    system_page_size = page_size;
+
+  if (!g_file_get_contents ("/proc/meminfo", &contents, NULL, NULL))
+    return;
+
+  if ((line = strstr (contents, "Hugepagesize:"))) {
+    guint64 kb = g_ascii_strtoull (line + strlen ("Hugepagesize:"), NULL, 10);
+
+    if (kb > 0)
+      huge_page_size = kb * 1024;
+  }
+  g_free (contents);
+
+  GST_CAT_DEBUG (GST_CAT_MEMORY, "huge page size %" G_GSIZE_FORMAT,
+      huge_page_size);
+}
+
+static gboolean
+_huge_page_bind (gpointer base, gsize size, gint node)
+{
+#ifdef __NR_mbind
+  unsigned long mask[NUMA_MAX_NODES / (8 * sizeof (unsigned long))] = { 0, };
+
+  mask[node / (8 * sizeof (unsigned long))] |=
+      1UL << (node % (8 * sizeof (unsigned long)));
+
+  /* the kernel wants the number of bits + 1 */
+  if (syscall (__NR_mbind, base, size, MPOL_BIND, mask, NUMA_MAX_NODES + 1,
+          0) == 0)
+    return TRUE;
+
+  GST_CAT_WARNING (GST_CAT_MEMORY, "failed to bind memory to node %d: %s",
+      node, g_strerror (errno));
+#endif
+  return FALSE;
+}
+
+/* @page_size is the size of the pages that back the memory, without explicit
+ * huge pages the kernel might not use transparent huge pages and then every
+ * normal page has to be touched */
+static void
+_huge_page_prefault (guint8 * data, gsize size, gsize page_size)
+{
+  gsize i;
+
+#ifdef MADV_POPULATE_WRITE
+  if (madvise (data, size, MADV_POPULATE_WRITE) == 0)
+    return;
+#endif
+  /* writing one byte per page is enough to fault it in, the memory is zeroed
+   * already so we don't change the contents */
+  for (i = 0; i < size; i += page_size)
+    ((volatile guint8 *) data)[i] = 0;
+}
+
+static GstMemoryHugePage *
+_huge_page_new_block (GstAllocatorHugePage * allocator, GstMemoryFlags flags,
+    gsize maxsize, gsize align, gsize offset, gsize size)
+{
+  GstMemoryHugePage *mem;
+  gpointer base = MAP_FAILED;
+  gsize base_size, aoffset, page_size = system_page_size;
+  guint8 *data;
+
+  align |= gst_memory_alignment;
+
+  /* reserve space for the alignment, this is almost always absorbed by
+   * rounding up to whole huge pages */
+  base_size = maxsize + align;
+  base_size = (base_size + huge_page_size - 1) & ~(huge_page_size - 1);
+
+#ifdef MAP_HUGETLB
+  if ((allocator->flags & GST_HUGE_PAGE_ALLOCATOR_FLAG_EXPLICIT)
+      && !g_atomic_int_get (&allocator->explicit_failed)) {
+    base = mmap (NULL, base_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (base == MAP_FAILED) {
+      GST_CAT_WARNING (GST_CAT_MEMORY, "no explicit huge pages available (%s), "
+          "falling back to transparent huge pages", g_strerror (errno));
+      g_atomic_int_set (&allocator->explicit_failed, TRUE);
+    } else {
+      page_size = huge_page_size;
+    }
+  }
+#endif
+
+  if (base == MAP_FAILED) {
+    gsize head, tail;
+
+    /* transparent huge pages are only used for huge page aligned ranges,
+     * map one more huge page and unmap what is before and after the aligned
+     * range */
+    base = mmap (NULL, base_size + huge_page_size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+      GST_CAT_ERROR (GST_CAT_MEMORY, "failed to mmap %" G_GSIZE_FORMAT
+          " bytes: %s", base_size + huge_page_size, g_strerror (errno));
+      return NULL;
+    }
+    head = (huge_page_size - ((guintptr) base & (huge_page_size - 1))) &
+        (huge_page_size - 1);
+    tail = huge_page_size - head;
+    if (head > 0)
+      munmap (base, head);
+    base = (guint8 *) base + head;
+    munmap ((guint8 *) base + base_size, tail);
+#ifdef MADV_HUGEPAGE
+    if (madvise (base, base_size, MADV_HUGEPAGE) < 0)
+      GST_CAT_DEBUG (GST_CAT_MEMORY, "transparent huge pages not available: %s",
+          g_strerror (errno));
+#endif
+  }
+
+  /* must happen before the pages are touched */
+  if (allocator->numa_node >= 0)
+    _huge_page_bind (base, base_size, allocator->numa_node);
+
+  if (allocator->flags & GST_HUGE_PAGE_ALLOCATOR_FLAG_PREFAULT)
+    _huge_page_prefault (base, base_size, page_size);
+
+  data = base;
+  if ((aoffset = ((guintptr) data & align))) {
+    aoffset = (align + 1) - aoffset;
+    data += aoffset;
+  }
+
+  /* anonymous memory is zeroed, no need to handle the ZERO_PREFIXED and
+   * ZERO_PADDED flags */
+  mem = g_slice_new (GstMemoryHugePage);
+  gst_memory_init (GST_MEMORY_CAST (mem), flags, GST_ALLOCATOR_CAST (allocator),
+      NULL, maxsize, align, offset, size);
+  mem->data = data;
+  mem->base = base;
+  mem->base_size = base_size;
+
+  return mem;
+}
+
+static gpointer
+_huge_page_map (GstMemoryHugePage * mem, gsize maxsize, GstMapFlags flags)
+{
+  return mem->data;
+}
+
+static gboolean
+_huge_page_unmap (GstMemoryHugePage * mem)
+{
+  return TRUE;
+}
+
+static GstMemoryHugePage *
+_huge_page_copy (GstMemoryHugePage * mem, gssize offset, gsize size)
+{
+  GstMemoryHugePage *copy;
+
+  if (size == -1)
+    size = mem->mem.size > offset ? mem->mem.size - offset : 0;
+
+  copy = _huge_page_new_block ((GstAllocatorHugePage *) mem->mem.allocator,
+      0, size, mem->mem.align, 0, size);
+  if (copy == NULL)
+    return NULL;
+
+  GST_CAT_DEBUG (GST_CAT_PERFORMANCE,
+      "memcpy %" G_GSIZE_FORMAT " memory %p -> %p", size, mem, copy);
+  _priv_gst_memcpy (copy->data, mem->data + mem->mem.offset + offset, size);
+
+  return copy;
+}
+
+static GstMemoryHugePage *
+_huge_page_share (GstMemoryHugePage * mem, gssize offset, gsize size)
+{
+  GstMemoryHugePage *sub;
+  GstMemory *parent;
+
+  if ((parent = mem->mem.parent) == NULL)
+    parent = (GstMemory *) mem;
+
+  if (size == -1)
+    size = mem->mem.size - offset;
+
+  sub = g_slice_new (GstMemoryHugePage);
+  gst_memory_init (GST_MEMORY_CAST (sub), GST_MINI_OBJECT_FLAGS (parent) |
+      GST_MINI_OBJECT_FLAG_LOCK_READONLY, mem->mem.allocator, parent,
+      mem->mem.maxsize, mem->mem.align, mem->mem.offset + offset, size);
+  sub->data = mem->data;
+  sub->base = NULL;
+  sub->base_size = 0;
+
+  return sub;
+}
+
+static gboolean
+_huge_page_is_span (GstMemoryHugePage * mem1, GstMemoryHugePage * mem2,
+    gsize * offset)
+{
+  if (offset) {
+    GstMemoryHugePage *parent;
+
+    parent = (GstMemoryHugePage *) mem1->mem.parent;
+
+    *offset = mem1->mem.offset - parent->mem.offset;
+  }
+
+  return mem1->data + mem1->mem.offset + mem1->mem.size ==
+      mem2->data + mem2->mem.offset;
+}
+
+static GstMemory *
+huge_page_alloc (GstAllocator * allocator, gsize size,
+    GstAllocationParams * params)
+{
+  gsize maxsize = size + params->prefix + params->padding;
+
+  /* small allocations would waste most of a huge page */
+  if (maxsize < huge_page_size / 2)
+    return gst_allocator_alloc (_sysmem_allocator, size, params);
+
+  return (GstMemory *) _huge_page_new_block ((GstAllocatorHugePage *)
+      allocator, params->flags, maxsize, params->align, params->prefix, size);
+}
+
+static void
+huge_page_free (GstAllocator * allocator, GstMemory * mem)
+{
+  GstMemoryHugePage *hmem = (GstMemoryHugePage *) mem;
+
+  if (hmem->base)
+    munmap (hmem->base, hmem->base_size);
+
+  g_slice_free (GstMemoryHugePage, hmem);
+}
+
+static void
+gst_allocator_huge_page_class_init (GstAllocatorHugePageClass * klass)
+{
+  GstAllocatorClass *allocator_class = (GstAllocatorClass *) klass;
+
+  allocator_class->alloc = huge_page_alloc;
+  allocator_class->free = huge_page_free;
+}
+
+static void
+gst_allocator_huge_page_init (GstAllocatorHugePage * allocator)
+{
+  GstAllocator *alloc = GST_ALLOCATOR_CAST (allocator);
+
+  GST_CAT_DEBUG (GST_CAT_MEMORY, "init allocator %p", allocator);
+
+  allocator->numa_node = -1;
+
+  alloc->mem_type = GST_ALLOCATOR_HUGE_PAGE;
+  alloc->mem_map = (GstMemoryMapFunction) _huge_page_map;
+  alloc->mem_unmap = (GstMemoryUnmapFunction) _huge_page_unmap;
+  alloc->mem_copy = (GstMemoryCopyFunction) _huge_page_copy;
+  alloc->mem_share = (GstMemoryShareFunction) _huge_page_share;
+  alloc->mem_is_span = (GstMemoryIsSpanFunction) _huge_page_is_span;
+}
+#endif /* HAVE_HUGE_PAGE_ALLOCATOR */
+
+/**
+ * gst_huge_page_allocator_new:
+ * @numa_node: the NUMA node to bind the memory to, or -1
+ * @flags: #GstHugePageAllocatorFlags
+ *
+ * Create a new allocator that backs memory with mmap()ed regions that use
+ * huge pages. This reduces the number of page faults and TLB misses when
+ * accessing large memory blocks such as raw video frames.
+ *
+ * When @numa_node is not -1, the memory is bound to the given NUMA node.
+ *
+ * Allocations that are smaller than half a huge page are served by the
+ * default system memory allocator.
+ *
+ * A shared instance of this allocator without NUMA binding is registered as
+ * #GST_ALLOCATOR_HUGE_PAGE.
+ *
+ * Returns: (transfer full) (nullable): a new huge page #GstAllocator or %NULL
+ *     when huge pages are not supported on this platform.
+ *
+ * Since: 1.14
+ */
+GstAllocator *
+gst_huge_page_allocator_new (gint numa_node, GstHugePageAllocatorFlags flags)
+{
+#ifdef HAVE_HUGE_PAGE_ALLOCATOR
+  GstAllocatorHugePage *allocator;
+
+  g_return_val_if_fail (numa_node >= -1 && numa_node < NUMA_MAX_NODES, NULL);
+
+  allocator = g_object_new (gst_allocator_huge_page_get_type (), NULL);
+  allocator->numa_node = numa_node;
+  allocator->flags = flags;
+
+  return GST_ALLOCATOR_CAST (gst_object_ref_sink (allocator));
+#else
+  return NULL;
+#endif
+}
+
+#ifdef HAVE_HUGE_PAGE_ALLOCATOR
+/* the registered huge page allocator can be configured with
+ * GST_HUGE_PAGE_NUMA_NODE and GST_HUGE_PAGE_FLAGS */
+static void
+_huge_page_register (void)
+{
+  GstHugePageAllocatorFlags flags = GST_HUGE_PAGE_ALLOCATOR_FLAG_NONE;
+  gint node = -1;
+  const gchar *env;
+
+  _huge_page_init_size ();
+
+  if ((env = g_getenv ("GST_HUGE_PAGE_NUMA_NODE")))
+    node = CLAMP (atoi (env), -1, NUMA_MAX_NODES - 1);
+
+  if ((env = g_getenv ("GST_HUGE_PAGE_FLAGS"))) {
+    gchar **names;
+    guint i;
+
+    names = g_strsplit (env, ",", -1);
+    for (i = 0; names[i]; i++) {
+      g_strstrip (names[i]);
+      if (g_ascii_strcasecmp (names[i], "explicit") == 0)
+        flags |= GST_HUGE_PAGE_ALLOCATOR_FLAG_EXPLICIT;
+      else if (g_ascii_strcasecmp (names[i], "prefault") == 0)
+        flags |= GST_HUGE_PAGE_ALLOCATOR_FLAG_PREFAULT;
+    }
+    g_strfreev (names);
+  }
+
+  gst_allocator_register (GST_ALLOCATOR_HUGE_PAGE,
+      gst_huge_page_allocator_new (node, flags));
+}
+#endif
+
+/* memfd memory implementation */
+#ifdef HAVE_MEMFD_ALLOCATOR
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS (1024 + 9)
+#define F_GET_SEALS (1024 + 10)
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#define F_SEAL_WRITE 0x0008
+#endif
+
+typedef struct
+{
+  GstMemory mem;
+
+  /* the fd and mapping, -1 and NULL for shared memory */
+  gint fd;
+  gpointer base;
+  gsize base_size;
+
+  /* start of the memory, at fd_offset in the file */
+  guint8 *data;
+  gsize fd_offset;
+} GstMemoryMemfd;
+
+typedef struct
+{
+  GstAllocator parent;
+} GstAllocatorMemfd;
+
+typedef struct
+{
+  GstAllocatorClass parent_class;
+} GstAllocatorMemfdClass;
+
+static GstAllocator *_memfd_allocator;
+
+static GType gst_allocator_memfd_get_type (void);
+G_DEFINE_TYPE (GstAllocatorMemfd, gst_allocator_memfd, GST_TYPE_ALLOCATOR);
+
+static gint
+_memfd_create (const gchar * name)
+{
+#ifdef HAVE_MEMFD_CREATE
+  return memfd_create (name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+  return syscall (__NR_memfd_create, name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#endif
+}
+
+static GstMemoryMemfd *
+_memfd_new (GstMemoryFlags flags, gint fd, gpointer base, gsize base_size,
+    gsize fd_offset, gsize maxsize, gsize align, gsize offset, gsize size)
+{
+  GstMemoryMemfd *mem;
+
+  mem = g_slice_new (GstMemoryMemfd);
+  gst_memory_init (GST_MEMORY_CAST (mem), flags, _memfd_allocator, NULL,
+      maxsize, align, offset, size);
+  mem->fd = fd;
+  mem->base = base;
+  mem->base_size = base_size;
+  mem->data = (guint8 *) base + fd_offset;
+  mem->fd_offset = fd_offset;
+
+  return mem;
+}
+
+static GstMemoryMemfd *
+_memfd_new_block (GstMemoryFlags flags, gsize maxsize, gsize align,
+    gsize offset, gsize size)
+{
+  gpointer base;
+  gsize base_size, aoffset;
+  gint fd;
+
+  align |= gst_memory_alignment;
+  base_size = maxsize + align;
+
+  if ((fd = _memfd_create ("gst-memfd")) < 0)
+    goto create_failed;
+
+  if (ftruncate (fd, base_size) < 0)
+    goto truncate_failed;
+
+  /* the receiver can't change the size of the file after this, which would
+   * make our mapping raise SIGBUS. F_SEAL_WRITE can't be added while our
+   * writable shared mapping exists, receivers that should not write import
+   * the fd read-only instead */
+  if (fcntl (fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) < 0)
+    goto seal_failed;
+
+  base = mmap (NULL, base_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED)
+    goto mmap_failed;
+
+  /* mmap() is page aligned, only bigger alignments need an offset */
+  if ((aoffset = ((guintptr) base & align)))
+    aoffset = (align + 1) - aoffset;
+
+  /* the file is zero filled, no need to handle the ZERO_PREFIXED and
+   * ZERO_PADDED flags */
+  return _memfd_new (flags, fd, base, base_size, aoffset, maxsize, align,
+      offset, size);
+
+  /* ERRORS */
+create_failed:
+  {
+    GST_CAT_ERROR (GST_CAT_MEMORY, "memfd_create failed: %s",
+        g_strerror (errno));
+    return NULL;
+  }
+truncate_failed:
+  {
+    GST_CAT_ERROR (GST_CAT_MEMORY, "failed to resize memfd to %"
+        G_GSIZE_FORMAT " bytes: %s", base_size, g_strerror (errno));
+    close (fd);
+    return NULL;
+  }
+seal_failed:
+  {
+    GST_CAT_ERROR (GST_CAT_MEMORY, "failed to seal memfd: %s",
+        g_strerror (errno));
+    close (fd);
+    return NULL;
+  }
+mmap_failed:
+  {
+    GST_CAT_ERROR (GST_CAT_MEMORY, "failed to mmap memfd: %s",
+        g_strerror (errno));
+    close (fd);
+    return NULL;
+  }
+}
+
+static gpointer
+_memfd_map (GstMemoryMemfd * mem, gsize maxsize, GstMapFlags flags)
+{
+  return mem->data;
+}
+
+static gboolean
+_memfd_unmap (GstMemoryMemfd * mem)
+{
+  return TRUE;
+}
+
+static GstMemoryMemfd *
+_memfd_copy (GstMemoryMemfd * mem, gssize offset, gsize size)
+{
+  GstMemoryMemfd *copy;
+
+  if (size == -1)
+    size = mem->mem.size > offset ? mem->mem.size - offset : 0;
+
+  copy = _memfd_new_block (0, size, mem->mem.align, 0, size);
+  if (copy == NULL)
+    return NULL;
+
+  GST_CAT_DEBUG (GST_CAT_PERFORMANCE,
+      "memcpy %" G_GSIZE_FORMAT " memory %p -> %p", size, mem, copy);
+  _priv_gst_memcpy (copy->data, mem->data + mem->mem.offset + offset, size);
+
+  return copy;
+}
+
+static GstMemoryMemfd *
+_memfd_share (GstMemoryMemfd * mem, gssize offset, gsize size)
+{
+  GstMemoryMemfd *sub;
+  GstMemory *parent;
+
+  if ((parent = mem->mem.parent) == NULL)
+    parent = (GstMemory *) mem;
+
+  if (size == -1)
+    size = mem->mem.size - offset;
+
+  sub = g_slice_new (GstMemoryMemfd);
+  gst_memory_init (GST_MEMORY_CAST (sub), GST_MINI_OBJECT_FLAGS (parent) |
+      GST_MINI_OBJECT_FLAG_LOCK_READONLY, mem->mem.allocator, parent,
+      mem->mem.maxsize, mem->mem.align, mem->mem.offset + offset, size);
+  sub->fd = -1;
+  sub->base = NULL;
+  sub->base_size = 0;
+  sub->data = mem->data;
+  sub->fd_offset = mem->fd_offset;
+
+  return sub;
+}
+
+static gboolean
+_memfd_is_span (GstMemoryMemfd * mem1, GstMemoryMemfd * mem2, gsize * offset)
+{
+  if (offset) {
+    GstMemoryMemfd *parent;
+
+    parent = (GstMemoryMemfd *) mem1->mem.parent;
+
+    *offset = mem1->mem.offset - parent->mem.offset;
+  }
+
+  return mem1->data + mem1->mem.offset + mem1->mem.size ==
+      mem2->data + mem2->mem.offset;
+}
+
+static GstMemory *
+memfd_alloc (GstAllocator * allocator, gsize size,
+    GstAllocationParams * params)
+{
+  gsize maxsize = size + params->prefix + params->padding;
+
+  return (GstMemory *) _memfd_new_block (params->flags, maxsize,
+      params->align, params->prefix, size);
+}
+
+static void
+memfd_free (GstAllocator * allocator, GstMemory * mem)
+{
+  GstMemoryMemfd *fmem = (GstMemoryMemfd *) mem;
+
+  if (fmem->base) {
+    munmap (fmem->base, fmem->base_size);
+    close (fmem->fd);
+  }
+  g_slice_free (GstMemoryMemfd, fmem);
+}
+
+static void
+gst_allocator_memfd_class_init (GstAllocatorMemfdClass * klass)
+{
+  GstAllocatorClass *allocator_class = (GstAllocatorClass *) klass;
+
+  allocator_class->alloc = memfd_alloc;
+  allocator_class->free = memfd_free;
+}
+
+static void
+gst_allocator_memfd_init (GstAllocatorMemfd * allocator)
+{
+  GstAllocator *alloc = GST_ALLOCATOR_CAST (allocator);
+
+  GST_CAT_DEBUG (GST_CAT_MEMORY, "init allocator %p", allocator);
+
+  alloc->mem_type = GST_ALLOCATOR_MEMFD;
+  alloc->mem_map = (GstMemoryMapFunction) _memfd_map;
+  alloc->mem_unmap = (GstMemoryUnmapFunction) _memfd_unmap;
+  alloc->mem_copy = (GstMemoryCopyFunction) _memfd_copy;
+  alloc->mem_share = (GstMemoryShareFunction) _memfd_share;
+  alloc->mem_is_span = (GstMemoryIsSpanFunction) _memfd_is_span;
+}
+#endif /* HAVE_MEMFD_ALLOCATOR */
+
+/**
+ * gst_is_memfd_memory:
+ * @mem: a #GstMemory
+ *
+ * Check if @mem was allocated by the #GST_ALLOCATOR_MEMFD allocator or
+ * imported with gst_memfd_memory_import().
+ *
+ * Returns: %TRUE when @mem is memfd memory.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_is_memfd_memory (GstMemory * mem)
+{
+  g_return_val_if_fail (mem != NULL, FALSE);
+
+  return gst_memory_is_type (mem, GST_ALLOCATOR_MEMFD);
+}
+
+/**
+ * gst_memfd_memory_get_fd_info:
+ * @mem: a #GstMemory
+ * @fd: (out) (allow-none): the file descriptor
+ * @offset: (out) (allow-none): the offset of the memory in @fd
+ * @size: (out) (allow-none): the size of the memory
+ *
+ * Get the file descriptor that backs the memfd memory @mem and the region of
+ * the file that contains the memory.
+ *
+ * The file descriptor remains owned by @mem and is only valid as long as @mem
+ * is alive. It can be passed to another process, for example over a Unix
+ * socket, where gst_memfd_memory_import() turns it into a #GstMemory again
+ * without copying the data.
+ *
+ * Returns: %TRUE when @mem is memfd memory.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_memfd_memory_get_fd_info (GstMemory * mem, gint * fd, gsize * offset,
+    gsize * size)
+{
+#ifdef HAVE_MEMFD_ALLOCATOR
+  GstMemoryMemfd *fmem;
+
+  g_return_val_if_fail (mem != NULL, FALSE);
+
+  if (!gst_is_memfd_memory (mem))
+    return FALSE;
+
+  /* shared memory uses the fd of the parent */
+  fmem = (GstMemoryMemfd *) (mem->parent ? mem->parent : mem);
+
+  if (fd)
+    *fd = fmem->fd;
+  if (offset)
+    *offset = fmem->fd_offset + mem->offset;
+  if (size)
+    *size = mem->size;
+
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+/**
+ * gst_memfd_memory_import:
+ * @fd: a file descriptor
+ * @offset: offset of the memory in @fd
+ * @size: size of the memory
+ * @flags: #GST_MAP_WRITE to import the memory writable
+ *
+ * Create a #GstMemory from the memfd @fd, usually received from another
+ * process. The memory is mapped without copying and @fd will be closed when
+ * the memory is freed.
+ *
+ * @fd must have been sealed against shrinking, like the file descriptors of
+ * the #GST_ALLOCATOR_MEMFD allocator are. Without #GST_MAP_WRITE in @flags
+ * the file is mapped read-only and the memory is read-only. Writable memory
+ * changes the data for everybody who mapped @fd and can't be imported when
+ * @fd is sealed against writing.
+ *
+ * On success the memory takes ownership of @fd. On failure @fd is not closed
+ * and stays owned by the caller.
+ *
+ * Returns: (transfer full) (nullable): a new #GstMemory or %NULL when @fd
+ * could not be imported.
+ *
+ * Since: 1.14
+ */
+GstMemory *
+gst_memfd_memory_import (gint fd, gsize offset, gsize size,
+    GstMapFlags flags)
+{
+#ifdef HAVE_MEMFD_ALLOCATOR
+  GstMemoryFlags mem_flags = 0;
+  struct stat st;
+  gpointer base;
+  gint seals, prot = PROT_READ;
+
+  g_return_val_if_fail (fd >= 0, NULL);
+
+  if (fstat (fd, &st) < 0) {
+    GST_CAT_WARNING (GST_CAT_MEMORY, "failed to stat fd %d: %s", fd,
+        g_strerror (errno));
+    return NULL;
+  }
+
+  if (st.st_size < 0 || (guint64) st.st_size > G_MAXSIZE
+      || offset > (gsize) st.st_size || size > (gsize) st.st_size - offset) {
+    GST_CAT_WARNING (GST_CAT_MEMORY, "fd %d too small for %" G_GSIZE_FORMAT
+        " bytes at offset %" G_GSIZE_FORMAT, fd, size, offset);
+    return NULL;
+  }
+
+  /* if the sender could shrink the file, we could crash accessing it */
+  seals = fcntl (fd, F_GET_SEALS);
+  if (seals < 0 || !(seals & F_SEAL_SHRINK)) {
+    GST_CAT_WARNING (GST_CAT_MEMORY, "fd %d is not sealed against shrinking",
+        fd);
+    return NULL;
+  }
+
+  if (!(flags & GST_MAP_WRITE)) {
+    mem_flags |= GST_MEMORY_FLAG_READONLY;
+  } else if (seals & F_SEAL_WRITE) {
+    GST_CAT_WARNING (GST_CAT_MEMORY, "fd %d is sealed against writing", fd);
+    return NULL;
+  } else {
+    prot |= PROT_WRITE;
+  }
+
+  base = mmap (NULL, st.st_size, prot, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    GST_CAT_WARNING (GST_CAT_MEMORY, "failed to mmap fd %d: %s", fd,
+        g_strerror (errno));
+    return NULL;
+  }
+
+  return (GstMemory *) _memfd_new (mem_flags, fd, base, st.st_size, 0,
+      st.st_size, 0, offset, size);
+#else
+  return NULL;
+#endif
+}
+
 void
 _priv_gst_allocator_initialize (void)
 {
+  const gchar *env;
+
+  _priv_gst_slice_cache_initialize ();
+
   g_rw_lock_init (&lock);
   allocators = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
       gst_object_unref);
@@ -601,6 +1654,29 @@ _priv_gst_allocator_initialize (void)
       gst_object_ref (_sysmem_allocator));
 
   _default_allocator = gst_object_ref (_sysmem_allocator);
+
+#ifdef HAVE_HUGE_PAGE_ALLOCATOR
+  _huge_page_register ();
+#endif
+
+#ifdef HAVE_MEMFD_ALLOCATOR
+  _memfd_allocator = g_object_new (gst_allocator_memfd_get_type (), NULL);
+  gst_object_ref_sink (_memfd_allocator);
+  gst_allocator_register (GST_ALLOCATOR_MEMFD,
+      gst_object_ref (_memfd_allocator));
+#endif
+
+  /* allow selecting another registered allocator as the default */
+  if ((env = g_getenv ("GST_ALLOCATOR_DEFAULT"))) {
+    GstAllocator *allocator = gst_allocator_find (env);
+
+    if (allocator) {
+      GST_CAT_INFO (GST_CAT_MEMORY, "using %s as default allocator", env);
+      gst_allocator_set_default (allocator);
+    } else {
+      GST_CAT_WARNING (GST_CAT_MEMORY, "unknown allocator %s", env);
+    }
+  }
 }
 
 void
@@ -612,7 +1688,14 @@ _priv_gst_allocator_cleanup (void)
   gst_object_unref (_default_allocator);
   _default_allocator = NULL;
 
+#ifdef HAVE_MEMFD_ALLOCATOR
+  gst_object_unref (_memfd_allocator);
+  _memfd_allocator = NULL;
+#endif
+
   g_clear_pointer (&allocators, g_hash_table_unref);
+
+  _priv_gst_slice_cache_cleanup ();
 }
 
 /**
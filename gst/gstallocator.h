@@ -25,6 +25,7 @@
 
 #include <gst/gstmemory.h>
 #include <gst/gstobject.h>
+#include <gst/gststructure.h>
 
 G_BEGIN_DECLS
 
@@ -62,6 +63,27 @@ GST_EXPORT gsize gst_memory_alignment;
  */
 #define GST_ALLOCATOR_SYSMEM   "SystemMemory"
 
+/**
+ * GST_ALLOCATOR_HUGE_PAGE:
+ *
+ * The allocator name for the huge page system memory allocator. This
+ * allocator is only registered on platforms that support it.
+ *
+ * Since: 1.14
+ */
+#define GST_ALLOCATOR_HUGE_PAGE "HugePageMemory"
+
+/**
+ * GST_ALLOCATOR_MEMFD:
+ *
+ * The allocator name for the memfd allocator. Memory of this allocator is
+ * backed by a sealed memfd that can be passed to other processes. This
+ * allocator is only registered on platforms that support it.
+ *
+ * Since: 1.14
+ */
+#define GST_ALLOCATOR_MEMFD     "MemfdMemory"
+
 /**
  * GstAllocationParams:
  * @flags: flags to control allocation
@@ -94,6 +116,25 @@ typedef enum {
   GST_ALLOCATOR_FLAG_LAST          = (GST_OBJECT_FLAG_LAST << 16)
 } GstAllocatorFlags;
 
+/**
+ * GstHugePageAllocatorFlags:
+ * @GST_HUGE_PAGE_ALLOCATOR_FLAG_NONE: use transparent huge pages
+ * @GST_HUGE_PAGE_ALLOCATOR_FLAG_EXPLICIT: take pages from the reserved
+ *     huge page pool of the system. Falls back to transparent huge pages
+ *     when the pool is exhausted.
+ * @GST_HUGE_PAGE_ALLOCATOR_FLAG_PREFAULT: fault in all pages when the memory
+ *     is allocated instead of on first access.
+ *
+ * Flags for the huge page allocator.
+ *
+ * Since: 1.14
+ */
+typedef enum {
+  GST_HUGE_PAGE_ALLOCATOR_FLAG_NONE      = 0,
+  GST_HUGE_PAGE_ALLOCATOR_FLAG_EXPLICIT  = (1 << 0),
+  GST_HUGE_PAGE_ALLOCATOR_FLAG_PREFAULT  = (1 << 1)
+} GstHugePageAllocatorFlags;
+
 /**
  * GstAllocator:
  * @mem_map: the implementation of the GstMemoryMapFunction
@@ -165,6 +206,24 @@ GstAllocator * gst_allocator_find            (const gchar *name);
 GST_EXPORT
 void           gst_allocator_set_default     (GstAllocator * allocator);
 
+GST_EXPORT
+GstAllocator * gst_huge_page_allocator_new   (gint numa_node,
+                                              GstHugePageAllocatorFlags flags);
+
+/* memory accounting */
+
+GST_EXPORT
+GstStructure * gst_allocator_get_stats       (GstAllocator * allocator);
+
+GST_EXPORT
+void           gst_allocator_set_memory_budget (gsize budget);
+
+GST_EXPORT
+gsize          gst_allocator_get_memory_budget (void);
+
+GST_EXPORT
+gboolean       gst_allocator_memory_budget_exceeded (void);
+
 /* allocation parameters */
 
 GST_EXPORT
@@ -191,6 +250,19 @@ GstMemory *    gst_memory_new_wrapped  (GstMemoryFlags flags, gpointer data, gsi
                                         gsize offset, gsize size, gpointer user_data,
                                         GDestroyNotify notify);
 
+/* memfd memory */
+
+GST_EXPORT
+gboolean       gst_is_memfd_memory          (GstMemory *mem);
+
+GST_EXPORT
+gboolean       gst_memfd_memory_get_fd_info (GstMemory *mem, gint *fd,
+                                             gsize *offset, gsize *size);
+
+GST_EXPORT
+GstMemory *    gst_memfd_memory_import      (gint fd, gsize offset, gsize size,
+                                             GstMapFlags flags);
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstAllocationParams, gst_allocation_params_free)
 #endif
@@ -128,6 +128,8 @@
 #include "gstbuffer.h"
 #include "gstbufferpool.h"
 #include "gstinfo.h"
+#include "gstslicecache.h"
+#include "gstmemcpy.h"
 #include "gstutils.h"
 #include "gstversion.h"
 
@@ -142,14 +144,23 @@ struct _GstMetaItem
 };
 #define ITEM_SIZE(info) ((info)->size + sizeof (GstMetaItem))
 
-#define GST_BUFFER_MEM_MAX         16
+/* memory blocks stored in the buffer itself, more blocks are stored in an
+ * overflow array that grows as needed */
+#define GST_BUFFER_MEM_INLINE      16
+#define GST_BUFFER_MEM_MAX         G_MAXINT
 
 #define GST_BUFFER_SLICE_SIZE(b)   (((GstBufferImpl *)(b))->slice_size)
 #define GST_BUFFER_MEM_LEN(b)      (((GstBufferImpl *)(b))->len)
+#define GST_BUFFER_MEM_ALLOC(b)    (((GstBufferImpl *)(b))->alloc)
 #define GST_BUFFER_MEM_ARRAY(b)    (((GstBufferImpl *)(b))->mem)
 #define GST_BUFFER_MEM_PTR(b,i)    (((GstBufferImpl *)(b))->mem[i])
 #define GST_BUFFER_BUFMEM(b)       (((GstBufferImpl *)(b))->bufmem)
 #define GST_BUFFER_META(b)         (((GstBufferImpl *)(b))->item)
+#define GST_BUFFER_N_META(b)       (((GstBufferImpl *)(b))->n_meta)
+
+/* the number of metas that are indexed by API type in the buffer and the
+ * number of removed meta items that are kept for reuse */
+#define GST_BUFFER_META_INDEX      8
 
 typedef struct
 {
@@ -157,16 +168,31 @@ typedef struct
 
   gsize slice_size;
 
-  /* the memory blocks */
+  /* the memory blocks, @mem points to @mem_inline or to an overflow array
+   * of @alloc entries */
   guint len;
-  GstMemory *mem[GST_BUFFER_MEM_MAX];
+  guint alloc;
+  GstMemory **mem;
+  GstMemory *mem_inline[GST_BUFFER_MEM_INLINE];
 
   /* memory of the buffer when allocated from 1 chunk */
   GstMemory *bufmem;
 
-  /* FIXME, make metadata allocation more efficient by using part of the
-   * GstBufferImpl */
+  /* the metadata, most recently added first */
   GstMetaItem *item;
+  guint n_meta;
+
+  /* the API types of the first @n_index items, scanning this array is a lot
+   * cheaper than following the list */
+  guint n_index;
+  GType index_api[GST_BUFFER_META_INDEX];
+  GstMetaItem *index_item[GST_BUFFER_META_INDEX];
+
+  /* items of removed metadata, reused by the next metadata of the same size.
+   * Buffers that return to a pool lose their metadata and get the same
+   * metadata again in the next round. */
+  GstMetaItem *free_item;
+  guint n_free_item;
 } GstBufferImpl;
 
 
@@ -260,7 +286,7 @@ _get_merged_memory (GstBuffer * buffer, guint idx, guint length)
         GST_CAT_DEBUG (GST_CAT_PERFORMANCE,
             "memcpy %" G_GSIZE_FORMAT " bytes for merge %p from memory %p",
             tocopy, result, mem[i]);
-        memcpy (ptr, (guint8 *) sinfo.data, tocopy);
+        _priv_gst_memcpy (ptr, (guint8 *) sinfo.data, tocopy);
         left -= tocopy;
         ptr += tocopy;
         gst_memory_unmap (mem[i], &sinfo);
@@ -406,6 +432,29 @@ _memory_get_exclusive_reference (GstMemory * mem)
   return ret;
 }
 
+/* make room for more memory blocks by moving them to a bigger overflow
+ * array, the array is kept until the buffer is freed so that pooled buffers
+ * only grow it once */
+static void
+_memory_grow (GstBuffer * buffer)
+{
+  guint alloc = GST_BUFFER_MEM_ALLOC (buffer);
+  GstMemory **mem = GST_BUFFER_MEM_ARRAY (buffer);
+
+  GST_CAT_DEBUG (GST_CAT_PERFORMANCE, "growing memory array of buffer %p "
+      "to %u blocks", buffer, alloc * 2);
+
+  if (mem == ((GstBufferImpl *) buffer)->mem_inline) {
+    mem = g_new (GstMemory *, alloc * 2);
+    memcpy (mem, GST_BUFFER_MEM_ARRAY (buffer), alloc * sizeof (GstMemory *));
+  } else {
+    mem = g_renew (GstMemory *, mem, alloc * 2);
+  }
+
+  GST_BUFFER_MEM_ARRAY (buffer) = mem;
+  GST_BUFFER_MEM_ALLOC (buffer) = alloc * 2;
+}
+
 static inline void
 _memory_add (GstBuffer * buffer, gint idx, GstMemory * mem)
 {
@@ -413,23 +462,14 @@ _memory_add (GstBuffer * buffer, gint idx, GstMemory * mem)
 
   GST_CAT_LOG (GST_CAT_BUFFER, "buffer %p, idx %d, mem %p", buffer, idx, mem);
 
-  if (G_UNLIKELY (len >= GST_BUFFER_MEM_MAX)) {
-    /* too many buffer, span them. */
-    /* FIXME, there is room for improvement here: We could only try to merge
-     * 2 buffers to make some room. If we can't efficiently merge 2 buffers we
-     * could try to only merge the two smallest buffers to avoid memcpy, etc. */
-    GST_CAT_DEBUG (GST_CAT_PERFORMANCE, "memory array overflow in buffer %p",
-        buffer);
-    _replace_memory (buffer, len, 0, len, _get_merged_memory (buffer, 0, len));
-    /* we now have 1 single spanned buffer */
-    len = 1;
-  }
+  if (G_UNLIKELY (len >= GST_BUFFER_MEM_ALLOC (buffer)))
+    _memory_grow (buffer);
 
   if (idx == -1)
     idx = len;
 
   for (i = len; i > idx; i--) {
-    /* move buffers to insert, FIXME, we need to insert first and then merge */
+    /* move buffers to insert */
     GST_BUFFER_MEM_PTR (buffer, i) = GST_BUFFER_MEM_PTR (buffer, i - 1);
   }
   /* and insert the new buffer */
@@ -450,11 +490,12 @@ _priv_gst_buffer_initialize (void)
 /**
  * gst_buffer_get_max_memory:
  *
- * Get the maximum amount of memory blocks that a buffer can hold. This is a
- * compile time constant that can be queried with the function.
+ * Get the maximum amount of memory blocks that a buffer can hold.
  *
- * When more memory blocks are added, existing memory blocks will be merged
- * together to make room for the new block.
+ * Since 1.14 buffers grow their memory array as needed and memory blocks are
+ * never merged when adding more blocks. The returned value is no longer a
+ * small compile time constant but the limit of the memory indices, in
+ * practice the number of blocks is only limited by the available memory.
  *
  * Returns: the maximum amount of memory blocks that a buffer can hold.
  *
@@ -466,6 +507,51 @@ gst_buffer_get_max_memory (void)
   return GST_BUFFER_MEM_MAX;
 }
 
+/**
+ * gst_buffer_cache_get_stats:
+ *
+ * Get statistics about the per-thread cache that is used to allocate
+ * #GstBuffer and #GstMemory structures and small system memory blocks.
+ *
+ * The returned structure contains the number of allocations served from the
+ * cache ("hits") and from the slice allocator ("misses"), the number of
+ * blocks that were given back to the slice allocator by the trim policy
+ * ("released"), the number of blocks currently kept in the shared depot
+ * ("cached") and the number of threads with a cache ("threads").
+ *
+ * The counters are updated without locking and are only approximate while
+ * other threads are allocating.
+ *
+ * Returns: (transfer full): a #GstStructure with the statistics. Free with
+ * gst_structure_free() after usage.
+ *
+ * Since: 1.14
+ */
+GstStructure *
+gst_buffer_cache_get_stats (void)
+{
+  return _priv_gst_slice_cache_get_stats ();
+}
+
+/**
+ * gst_buffer_cache_trim:
+ *
+ * Release all blocks that are kept in the shared depot of the buffer
+ * allocation cache back to the system. Blocks cached by a thread are given
+ * back to the depot when the thread exits.
+ *
+ * Unused blocks are also released periodically, this function is only needed
+ * when memory should be returned right away, for example after a pipeline
+ * was shut down.
+ *
+ * Since: 1.14
+ */
+void
+gst_buffer_cache_trim (void)
+{
+  _priv_gst_slice_cache_trim (TRUE);
+}
+
 /**
  * gst_buffer_copy_into:
  * @dest: a destination #GstBuffer
@@ -735,7 +821,11 @@ _gst_buffer_free (GstBuffer * buffer)
 
     next = walk->next;
     /* and free the slice */
-    g_slice_free1 (ITEM_SIZE (info), walk);
+    _priv_gst_slice_cache_free (ITEM_SIZE (info), walk);
+  }
+  for (walk = ((GstBufferImpl *) buffer)->free_item; walk; walk = next) {
+    next = walk->next;
+    _priv_gst_slice_cache_free (ITEM_SIZE (walk->meta.info), walk);
   }
 
   /* get the size, when unreffing the memory, we could also unref the buffer
@@ -748,13 +838,15 @@ _gst_buffer_free (GstBuffer * buffer)
     gst_memory_unlock (GST_BUFFER_MEM_PTR (buffer, i), GST_LOCK_FLAG_EXCLUSIVE);
     gst_memory_unref (GST_BUFFER_MEM_PTR (buffer, i));
   }
+  if (GST_BUFFER_MEM_ARRAY (buffer) != ((GstBufferImpl *) buffer)->mem_inline)
+    g_free (GST_BUFFER_MEM_ARRAY (buffer));
 
   /* we set msize to 0 when the buffer is part of the memory block */
   if (msize) {
 #ifdef USE_POISONING
     memset (buffer, 0xff, msize);
 #endif
-    g_slice_free1 (msize, buffer);
+    _priv_gst_slice_cache_free (msize, buffer);
   } else {
     gst_memory_unref (GST_BUFFER_BUFMEM (buffer));
   }
@@ -778,7 +870,13 @@ gst_buffer_init (GstBufferImpl * buffer, gsize size)
   GST_BUFFER_OFFSET_END (buffer) = GST_BUFFER_OFFSET_NONE;
 
   GST_BUFFER_MEM_LEN (buffer) = 0;
+  GST_BUFFER_MEM_ALLOC (buffer) = GST_BUFFER_MEM_INLINE;
+  GST_BUFFER_MEM_ARRAY (buffer) = buffer->mem_inline;
   GST_BUFFER_META (buffer) = NULL;
+  GST_BUFFER_N_META (buffer) = 0;
+  buffer->n_index = 0;
+  buffer->free_item = NULL;
+  buffer->n_free_item = 0;
 }
 
 /**
@@ -795,7 +893,7 @@ gst_buffer_new (void)
 {
   GstBufferImpl *newbuf;
 
-  newbuf = g_slice_new (GstBufferImpl);
+  newbuf = _priv_gst_slice_cache_alloc (sizeof (GstBufferImpl));
   GST_CAT_LOG (GST_CAT_BUFFER, "new %p", newbuf);
 
   gst_buffer_init (newbuf, sizeof (GstBufferImpl));
@@ -971,8 +1069,9 @@ gst_buffer_new_wrapped (gpointer data, gsize size)
  * gst_buffer_n_memory:
  * @buffer: a #GstBuffer.
  *
- * Get the amount of memory blocks that this buffer has. This amount is never
- * larger than what gst_buffer_get_max_memory() returns.
+ * Get the amount of memory blocks that this buffer has. The memory array
+ * grows as needed, so there is no fixed limit besides the range of the
+ * memory indices.
  *
  * Returns: the number of memory blocks this buffer is made of.
  */
@@ -1027,9 +1126,8 @@ gst_buffer_append_memory (GstBuffer * buffer, GstMemory * mem)
  * Insert the memory block @mem to @buffer at @idx. This function takes ownership
  * of @mem and thus doesn't increase its refcount.
  *
- * Only gst_buffer_get_max_memory() can be added to a buffer. If more memory is
- * added, existing memory blocks will automatically be merged to make room for
- * the new memory.
+ * The memory array of @buffer grows as needed, adding memory never merges or
+ * copies the existing memory blocks.
  */
 void
 gst_buffer_insert_memory (GstBuffer * buffer, gint idx, GstMemory * mem)
@@ -1798,6 +1896,122 @@ gst_buffer_unmap (GstBuffer * buffer, GstMapInfo * info)
   }
 }
 
+/**
+ * gst_buffer_map_memories:
+ * @buffer: a #GstBuffer.
+ * @idx: an index
+ * @length: a length
+ * @infos: (out caller-allocates) (array): an array of @length #GstMapInfo
+ * @flags: flags for the mapping
+ *
+ * This function maps each of the @length memory blocks starting at @idx in
+ * @buffer separately and fills @infos with their #GstMapInfo. When @length
+ * is -1, all memory blocks starting from @idx are mapped and @infos should
+ * have room for gst_buffer_n_memory() - @idx entries.
+ *
+ * Contrary to gst_buffer_map_range(), the memory blocks are never merged. This
+ * makes it possible to process the data of a buffer that consists of several
+ * memory blocks, for example with writev(), without copying it.
+ *
+ * @flags describe the desired access of the memory. When @flags is
+ * #GST_MAP_WRITE, @buffer should be writable (as returned from
+ * gst_buffer_is_writable()). Memory blocks that are not writable are then
+ * replaced with a writable copy.
+ *
+ * The memory in @infos should be unmapped with gst_buffer_unmap_memories()
+ * after usage.
+ *
+ * Returns: %TRUE if all memory blocks could be mapped. When %FALSE is
+ * returned, no memory block is mapped.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_buffer_map_memories (GstBuffer * buffer, guint idx, gint length,
+    GstMapInfo * infos, GstMapFlags flags)
+{
+  GstMemory *mem, *nmem;
+  gboolean write, writable;
+  gsize len;
+  gint i;
+
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), FALSE);
+  g_return_val_if_fail (infos != NULL, FALSE);
+  len = GST_BUFFER_MEM_LEN (buffer);
+  g_return_val_if_fail ((len == 0 && idx == 0 && length == -1) ||
+      (length == -1 && idx < len) || (length > 0
+          && length + idx <= len), FALSE);
+
+  GST_CAT_LOG (GST_CAT_BUFFER, "buffer %p, idx %u, length %d, flags %04x",
+      buffer, idx, length, flags);
+
+  write = (flags & GST_MAP_WRITE) != 0;
+  writable = gst_buffer_is_writable (buffer);
+
+  /* check if we can write when asked for write access */
+  if (G_UNLIKELY (write && !writable))
+    goto not_writable;
+
+  if (length == -1)
+    length = len - idx;
+
+  for (i = 0; i < length; i++) {
+    mem = gst_memory_ref (GST_BUFFER_MEM_PTR (buffer, idx + i));
+
+    nmem = gst_memory_make_mapped (mem, &infos[i], flags);
+    if (G_UNLIKELY (nmem == NULL))
+      goto cannot_map;
+
+    /* the map returned a copy, replace the memory in the buffer when we can */
+    if (G_UNLIKELY (nmem != mem)) {
+      if (writable) {
+        _replace_memory (buffer, len, idx + i, 1, gst_memory_ref (nmem));
+      } else {
+        GST_CAT_DEBUG (GST_CAT_PERFORMANCE,
+            "temporary mapping for memory %p in buffer %p", nmem, buffer);
+      }
+    }
+  }
+  return TRUE;
+
+  /* ERROR */
+not_writable:
+  {
+    GST_WARNING_OBJECT (buffer, "write map requested on non-writable buffer");
+    g_critical ("write map requested on non-writable buffer");
+    return FALSE;
+  }
+cannot_map:
+  {
+    GST_DEBUG_OBJECT (buffer, "cannot map memory %d", idx + i);
+    gst_buffer_unmap_memories (buffer, infos, i);
+    return FALSE;
+  }
+}
+
+/**
+ * gst_buffer_unmap_memories:
+ * @buffer: a #GstBuffer.
+ * @infos: (array length=n_infos): an array of #GstMapInfo
+ * @n_infos: the number of entries in @infos
+ *
+ * Release the memory previously mapped with gst_buffer_map_memories().
+ *
+ * Since: 1.14
+ */
+void
+gst_buffer_unmap_memories (GstBuffer * buffer, GstMapInfo * infos,
+    guint n_infos)
+{
+  guint i;
+
+  g_return_if_fail (GST_IS_BUFFER (buffer));
+  g_return_if_fail (n_infos == 0 || infos != NULL);
+
+  for (i = 0; i < n_infos; i++)
+    gst_buffer_unmap (buffer, &infos[i]);
+}
+
 /**
  * gst_buffer_fill:
  * @buffer: a #GstBuffer.
@@ -1837,7 +2051,7 @@ gst_buffer_fill (GstBuffer * buffer, gsize offset, gconstpointer src,
     if (info.size > offset) {
       /* we have enough */
       tocopy = MIN (info.size - offset, left);
-      memcpy ((guint8 *) info.data + offset, ptr, tocopy);
+      _priv_gst_memcpy ((guint8 *) info.data + offset, ptr, tocopy);
       left -= tocopy;
       ptr += tocopy;
       offset = 0;
@@ -1887,7 +2101,7 @@ gst_buffer_extract (GstBuffer * buffer, gsize offset, gpointer dest, gsize size)
     if (info.size > offset) {
       /* we have enough */
       tocopy = MIN (info.size - offset, left);
-      memcpy (ptr, (guint8 *) info.data + offset, tocopy);
+      _priv_gst_memcpy (ptr, (guint8 *) info.data + offset, tocopy);
       left -= tocopy;
       ptr += tocopy;
       offset = 0;
@@ -2105,6 +2319,85 @@ gst_buffer_append_region (GstBuffer * buf1, GstBuffer * buf2, gssize offset,
   return buf1;
 }
 
+static GstMetaItem *
+_meta_item_alloc (GstBuffer * buffer, gsize size)
+{
+  GstBufferImpl *impl = (GstBufferImpl *) buffer;
+  GstMetaItem *item, **prev;
+
+  for (prev = &impl->free_item; (item = *prev); prev = &item->next) {
+    if (ITEM_SIZE (item->meta.info) == size) {
+      *prev = item->next;
+      impl->n_free_item--;
+      return item;
+    }
+  }
+  return _priv_gst_slice_cache_alloc (size);
+}
+
+static void
+_meta_item_free (GstBuffer * buffer, GstMetaItem * item)
+{
+  GstBufferImpl *impl = (GstBufferImpl *) buffer;
+
+  if (impl->n_free_item < GST_BUFFER_META_INDEX) {
+    /* keep it around, the info stays valid to find the size of the item */
+    item->next = impl->free_item;
+    impl->free_item = item;
+    impl->n_free_item++;
+  } else {
+    _priv_gst_slice_cache_free (ITEM_SIZE (item->meta.info), item);
+  }
+}
+
+/* prepend @item to the list of metadata, the index keeps covering the first
+ * items of the list */
+static void
+_meta_item_link (GstBuffer * buffer, GstMetaItem * item)
+{
+  GstBufferImpl *impl = (GstBufferImpl *) buffer;
+  guint n_index = MIN (impl->n_index, GST_BUFFER_META_INDEX - 1);
+
+  item->next = GST_BUFFER_META (buffer);
+  GST_BUFFER_META (buffer) = item;
+  impl->n_meta++;
+
+  memmove (&impl->index_api[1], &impl->index_api[0],
+      n_index * sizeof (GType));
+  memmove (&impl->index_item[1], &impl->index_item[0],
+      n_index * sizeof (GstMetaItem *));
+  impl->index_api[0] = item->meta.info->api;
+  impl->index_item[0] = item;
+  impl->n_index = n_index + 1;
+}
+
+/* remove @item from the list of metadata, @prev is the item before @item or
+ * @item itself when it is the first item */
+static void
+_meta_item_unlink (GstBuffer * buffer, GstMetaItem * prev,
+    GstMetaItem * item)
+{
+  GstBufferImpl *impl = (GstBufferImpl *) buffer;
+  guint i;
+
+  if (GST_BUFFER_META (buffer) == item)
+    GST_BUFFER_META (buffer) = item->next;
+  else
+    prev->next = item->next;
+  impl->n_meta--;
+
+  for (i = 0; i < impl->n_index; i++) {
+    if (impl->index_item[i] == item) {
+      impl->n_index--;
+      memmove (&impl->index_api[i], &impl->index_api[i + 1],
+          (impl->n_index - i) * sizeof (GType));
+      memmove (&impl->index_item[i], &impl->index_item[i + 1],
+          (impl->n_index - i) * sizeof (GstMetaItem *));
+      break;
+    }
+  }
+}
+
 /**
  * gst_buffer_get_meta:
  * @buffer: a #GstBuffer
@@ -2122,14 +2415,30 @@ gst_buffer_append_region (GstBuffer * buf1, GstBuffer * buf2, gssize offset,
 GstMeta *
 gst_buffer_get_meta (GstBuffer * buffer, GType api)
 {
+  GstBufferImpl *impl = (GstBufferImpl *) buffer;
   GstMetaItem *item;
   GstMeta *result = NULL;
+  guint i;
 
   g_return_val_if_fail (buffer != NULL, NULL);
   g_return_val_if_fail (api != 0, NULL);
 
-  /* find GstMeta of the requested API */
-  for (item = GST_BUFFER_META (buffer); item; item = item->next) {
+  /* find GstMeta of the requested API, first in the index */
+  for (i = 0; i < impl->n_index; i++) {
+    if (impl->index_api[i] == api)
+      return &impl->index_item[i]->meta;
+  }
+
+  if (G_LIKELY (impl->n_meta == impl->n_index))
+    return NULL;
+
+  /* and then in the items that are not indexed */
+  if (impl->n_index > 0)
+    item = impl->index_item[impl->n_index - 1]->next;
+  else
+    item = GST_BUFFER_META (buffer);
+
+  for (; item; item = item->next) {
     GstMeta *meta = &item->meta;
     if (meta->info->api == api) {
       result = meta;
@@ -2163,14 +2472,13 @@ gst_buffer_add_meta (GstBuffer * buffer, const GstMetaInfo * info,
 
   /* create a new slice */
   size = ITEM_SIZE (info);
+  item = _meta_item_alloc (buffer, size);
   /* We warn in gst_meta_register() about metas without
    * init function but let's play safe here and prevent
    * uninitialized memory
    */
   if (!info->init_func)
-    item = g_slice_alloc0 (size);
-  else
-    item = g_slice_alloc (size);
+    memset (item, 0, size);
   result = &item->meta;
   result->info = info;
   result->flags = GST_META_FLAG_NONE;
@@ -2184,14 +2492,13 @@ gst_buffer_add_meta (GstBuffer * buffer, const GstMetaInfo * info,
       goto init_failed;
 
   /* and add to the list of metadata */
-  item->next = GST_BUFFER_META (buffer);
-  GST_BUFFER_META (buffer) = item;
+  _meta_item_link (buffer, item);
 
   return result;
 
 init_failed:
   {
-    g_slice_free1 (size, item);
+    _meta_item_free (buffer, item);
     return NULL;
   }
 }
@@ -2225,16 +2532,13 @@ gst_buffer_remove_meta (GstBuffer * buffer, GstMeta * meta)
       const GstMetaInfo *info = meta->info;
 
       /* remove from list */
-      if (GST_BUFFER_META (buffer) == walk)
-        GST_BUFFER_META (buffer) = walk->next;
-      else
-        prev->next = walk->next;
+      _meta_item_unlink (buffer, prev, walk);
       /* call free_func if any */
       if (info->free_func)
         info->free_func (m, buffer);
 
       /* and free the slice */
-      g_slice_free1 (ITEM_SIZE (info), walk);
+      _meta_item_free (buffer, walk);
       break;
     }
     prev = walk;
@@ -2364,20 +2668,15 @@ gst_buffer_foreach_meta (GstBuffer * buffer, GstBufferForeachMetaFunc func,
       g_return_val_if_fail (!GST_META_FLAG_IS_SET (m, GST_META_FLAG_LOCKED),
           FALSE);
 
-      /* remove from list */
-      if (GST_BUFFER_META (buffer) == walk)
-        GST_BUFFER_META (buffer) = next;
-      else
-        prev->next = next;
-
-      prev = next;
+      /* remove from list, @prev stays the item before @next */
+      _meta_item_unlink (buffer, prev, walk);
 
       /* call free_func if any */
       if (info->free_func)
         info->free_func (m, buffer);
 
       /* and free the slice */
-      g_slice_free1 (ITEM_SIZE (info), walk);
+      _meta_item_free (buffer, walk);
     } else {
       prev = walk;
     }
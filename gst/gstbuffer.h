@@ -277,6 +277,12 @@ GType       gst_buffer_get_type            (void);
 GST_EXPORT
 guint       gst_buffer_get_max_memory      (void);
 
+GST_EXPORT
+GstStructure * gst_buffer_cache_get_stats  (void);
+
+GST_EXPORT
+void        gst_buffer_cache_trim          (void);
+
 /* allocation */
 
 GST_EXPORT
@@ -384,6 +390,13 @@ gboolean    gst_buffer_map                 (GstBuffer *buffer, GstMapInfo *info,
 GST_EXPORT
 void        gst_buffer_unmap               (GstBuffer *buffer, GstMapInfo *info);
 
+GST_EXPORT
+gboolean    gst_buffer_map_memories        (GstBuffer *buffer, guint idx, gint length,
+                                            GstMapInfo *infos, GstMapFlags flags);
+GST_EXPORT
+void        gst_buffer_unmap_memories      (GstBuffer *buffer, GstMapInfo *infos,
+                                            guint n_infos);
+
 GST_EXPORT
 void        gst_buffer_extract_dup         (GstBuffer *buffer, gsize offset,
                                             gsize size, gpointer *dest,
@@ -67,26 +67,18 @@
 #include "gst_private.h"
 #include "glib-compat-private.h"
 
-#include <errno.h>
 #ifdef HAVE_UNISTD_H
 #  include <unistd.h>
 #endif
 #include <sys/types.h>
 
 #include "gstatomicqueue.h"
-#include "gstpoll.h"
 #include "gstinfo.h"
 #include "gstquark.h"
 #include "gstvalue.h"
 
 #include "gstbufferpool.h"
 
-#ifdef G_OS_WIN32
-#  ifndef EWOULDBLOCK
-#  define EWOULDBLOCK EAGAIN    /* This is just to placate gcc */
-#  endif
-#endif /* G_OS_WIN32 */
-
 GST_DEBUG_CATEGORY_STATIC (gst_buffer_pool_debug);
 #define GST_CAT_DEFAULT gst_buffer_pool_debug
 
@@ -99,7 +91,14 @@ GST_DEBUG_CATEGORY_STATIC (gst_buffer_pool_debug);
 struct _GstBufferPoolPrivate
 {
   GstAtomicQueue *queue;
-  GstPoll *poll;
+
+  /* acquire and release only touch the queue and waiters with atomic
+   * operations, the lock and cond are only used when a thread actually has
+   * to wait for a free buffer */
+  gint waiters;
+  guint wake_seq;               /* protected by wait_lock */
+  GMutex wait_lock;
+  GCond wait_cond;
 
   GRecMutex rec_lock;
 
@@ -116,12 +115,46 @@ struct _GstBufferPoolPrivate
   guint cur_buffers;
   GstAllocator *allocator;
   GstAllocationParams params;
+
+  /* adaptive sizing, buffers that stayed unused in the queue for a whole
+   * idle_timeout period are freed */
+  GstClockTime idle_timeout;
+  gint idle_min;                /* lowest queue level in this period */
+  gint64 next_trim;             /* monotonic time, racy reads are a hint */
+  GMutex trim_lock;
+
+  /* statistics, the counters are updated with stats_inc() */
+  gsize allocations;
+  gsize reuses;
+  gsize trimmed;
+  gint peak_outstanding;
+  gsize live_bytes;
+  gsize peak_bytes;
+  guint64 waits;                /* protected by wait_lock */
+  GstClockTime blocked_time;    /* protected by wait_lock */
 };
 
 static void gst_buffer_pool_finalize (GObject * object);
 
+/* the size that a buffer accounted for in live_bytes when it was allocated */
+static GQuark buffer_bytes_quark;
+
 G_DEFINE_TYPE (GstBufferPool, gst_buffer_pool, GST_TYPE_OBJECT);
 
+/* pointer sized statistics counters, updated without locking. Where a
+ * pointer has 32 bits they wrap around after 4G events */
+static inline void
+stats_inc (gsize * counter)
+{
+  g_atomic_pointer_add (counter, 1);
+}
+
+static inline guint64
+stats_get (gsize * counter)
+{
+  return GPOINTER_TO_SIZE (g_atomic_pointer_get (counter));
+}
+
 static gboolean default_start (GstBufferPool * pool);
 static gboolean default_stop (GstBufferPool * pool);
 static gboolean default_set_config (GstBufferPool * pool,
@@ -152,6 +185,8 @@ gst_buffer_pool_class_init (GstBufferPoolClass * klass)
   klass->release_buffer = default_release_buffer;
   klass->free_buffer = default_free_buffer;
 
+  buffer_bytes_quark = g_quark_from_static_string ("GstBufferPoolBytes");
+
   GST_DEBUG_CATEGORY_INIT (gst_buffer_pool_debug, "bufferpool", 0,
       "bufferpool debug");
 }
@@ -165,8 +200,11 @@ gst_buffer_pool_init (GstBufferPool * pool)
 
   g_rec_mutex_init (&priv->rec_lock);
 
-  priv->poll = gst_poll_new_timer ();
   priv->queue = gst_atomic_queue_new (16);
+  g_mutex_init (&priv->wait_lock);
+  g_cond_init (&priv->wait_cond);
+  g_mutex_init (&priv->trim_lock);
+  priv->idle_timeout = GST_CLOCK_TIME_NONE;
   pool->flushing = 1;
   priv->active = FALSE;
   priv->configured = FALSE;
@@ -177,10 +215,6 @@ gst_buffer_pool_init (GstBufferPool * pool)
   gst_allocation_params_init (&priv->params);
   gst_buffer_pool_config_set_allocator (priv->config, priv->allocator,
       &priv->params);
-  /* 1 control write for flushing - the flush token */
-  gst_poll_write_control (priv->poll);
-  /* 1 control write for marking that we are not waiting for poll - the wait token */
-  gst_poll_write_control (priv->poll);
 
   GST_DEBUG_OBJECT (pool, "created");
 }
@@ -198,7 +232,9 @@ gst_buffer_pool_finalize (GObject * object)
 
   gst_buffer_pool_set_active (pool, FALSE);
   gst_atomic_queue_unref (priv->queue);
-  gst_poll_free (priv->poll);
+  g_mutex_clear (&priv->wait_lock);
+  g_cond_clear (&priv->wait_cond);
+  g_mutex_clear (&priv->trim_lock);
   gst_structure_free (priv->config);
   g_rec_mutex_clear (&priv->rec_lock);
   if (priv->allocator)
@@ -262,6 +298,7 @@ do_alloc_buffer (GstBufferPool * pool, GstBuffer ** buffer,
   GstFlowReturn result;
   gint cur_buffers, max_buffers;
   GstBufferPoolClass *pclass;
+  gsize maxsize, live, peak;
 
   pclass = GST_BUFFER_POOL_GET_CLASS (pool);
 
@@ -288,6 +325,22 @@ do_alloc_buffer (GstBufferPool * pool, GstBuffer ** buffer,
    * released again */
   GST_BUFFER_FLAG_UNSET (*buffer, GST_BUFFER_FLAG_TAG_MEMORY);
 
+  stats_inc (&priv->allocations);
+
+  /* remember what we accounted for, the buffer can be resized while it is
+   * used */
+  gst_buffer_get_sizes (*buffer, NULL, &maxsize);
+  gst_mini_object_set_qdata (GST_MINI_OBJECT_CAST (*buffer),
+      buffer_bytes_quark, GSIZE_TO_POINTER (maxsize), NULL);
+  live = g_atomic_pointer_add (&priv->live_bytes, maxsize) + maxsize;
+  peak = GPOINTER_TO_SIZE (g_atomic_pointer_get (&priv->peak_bytes));
+  while (G_UNLIKELY (live > peak)) {
+    if (g_atomic_pointer_compare_and_exchange ((gpointer *) &priv->peak_bytes,
+            GSIZE_TO_POINTER (peak), GSIZE_TO_POINTER (live)))
+      break;
+    peak = GPOINTER_TO_SIZE (g_atomic_pointer_get (&priv->peak_bytes));
+  }
+
   GST_LOG_OBJECT (pool, "allocated buffer %d/%d, %p", cur_buffers,
       max_buffers, *buffer);
 
@@ -357,6 +410,10 @@ do_start (GstBufferPool * pool)
     pclass = GST_BUFFER_POOL_GET_CLASS (pool);
 
     GST_LOG_OBJECT (pool, "starting");
+    /* the first release starts a new idle period */
+    priv->next_trim = 0;
+    priv->idle_min = 0;
+
     /* start the pool, subclasses should allocate buffers and put them
      * in the queue */
     if (G_LIKELY (pclass->start)) {
@@ -374,21 +431,48 @@ default_free_buffer (GstBufferPool * pool, GstBuffer * buffer)
   gst_buffer_unref (buffer);
 }
 
+/* wake up threads waiting in acquire. This is a no-op without waiters so
+ * that releasing a buffer stays free of locks and syscalls. */
+static inline void
+wake_waiters (GstBufferPool * pool, gboolean all)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+
+  if (G_LIKELY (g_atomic_int_get (&priv->waiters) == 0))
+    return;
+
+  g_mutex_lock (&priv->wait_lock);
+  priv->wake_seq++;
+  if (all)
+    g_cond_broadcast (&priv->wait_cond);
+  else
+    g_cond_signal (&priv->wait_cond);
+  g_mutex_unlock (&priv->wait_lock);
+}
+
 static void
 do_free_buffer (GstBufferPool * pool, GstBuffer * buffer)
 {
   GstBufferPoolPrivate *priv;
   GstBufferPoolClass *pclass;
+  gsize maxsize;
 
   priv = pool->priv;
   pclass = GST_BUFFER_POOL_GET_CLASS (pool);
 
+  maxsize = GPOINTER_TO_SIZE (gst_mini_object_get_qdata (GST_MINI_OBJECT_CAST
+          (buffer), buffer_bytes_quark));
+  g_atomic_pointer_add (&priv->live_bytes, -(gssize) maxsize);
+
   g_atomic_int_add (&priv->cur_buffers, -1);
   GST_LOG_OBJECT (pool, "freeing buffer %p (%u left)", buffer,
       priv->cur_buffers);
 
   if (G_LIKELY (pclass->free_buffer))
     pclass->free_buffer (pool, buffer);
+
+  /* a waiter can allocate a new buffer now */
+  wake_waiters (pool, FALSE);
 }
 
 /* must be called with the lock */
@@ -399,20 +483,8 @@ default_stop (GstBufferPool * pool)
   GstBuffer *buffer;
 
   /* clear the pool */
-  while ((buffer = gst_atomic_queue_pop (priv->queue))) {
-    while (!gst_poll_read_control (priv->poll)) {
-      if (errno == EWOULDBLOCK) {
-        /* We put the buffer into the queue but did not finish writing control
-         * yet, let's wait a bit and retry */
-        g_thread_yield ();
-        continue;
-      } else {
-        /* Critical error but GstPoll already complained */
-        break;
-      }
-    }
+  while ((buffer = gst_atomic_queue_pop (priv->queue)))
     do_free_buffer (pool, buffer);
-  }
   return priv->cur_buffers == 0;
 }
 
@@ -437,6 +509,63 @@ do_stop (GstBufferPool * pool)
   return TRUE;
 }
 
+/* free the buffers that were not needed for a whole idle period, called
+ * after an acquire from the queue or a release in adaptive mode */
+static void
+maybe_trim (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBuffer *buffer;
+  gint64 now;
+  guint len, n_free, cur_buffers;
+
+  now = g_get_monotonic_time ();
+  if (G_LIKELY (now < priv->next_trim))
+    return;
+
+  if (!g_mutex_trylock (&priv->trim_lock))
+    return;
+
+  if (now < priv->next_trim || GST_BUFFER_POOL_IS_FLUSHING (pool))
+    goto done;
+
+  /* never go below the configured minimum */
+  len = gst_atomic_queue_length (priv->queue);
+  n_free = MIN ((guint) g_atomic_int_get (&priv->idle_min), len);
+  cur_buffers = g_atomic_int_get (&priv->cur_buffers);
+  if (cur_buffers < priv->min_buffers + n_free)
+    n_free = cur_buffers > priv->min_buffers ?
+        cur_buffers - priv->min_buffers : 0;
+
+  if (n_free > 0)
+    GST_DEBUG_OBJECT (pool, "freeing %u of %u idle buffers", n_free, len);
+
+  for (; n_free > 0; n_free--) {
+    if (!(buffer = gst_atomic_queue_pop (priv->queue)))
+      break;
+    do_free_buffer (pool, buffer);
+    stats_inc (&priv->trimmed);
+  }
+
+  g_atomic_int_set (&priv->idle_min, gst_atomic_queue_length (priv->queue));
+  priv->next_trim = now + priv->idle_timeout / GST_USECOND;
+
+done:
+  g_mutex_unlock (&priv->trim_lock);
+}
+
+/* remember the lowest queue level of the idle period */
+static inline void
+update_idle_min (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  gint len;
+
+  len = gst_atomic_queue_length (priv->queue);
+  if (len < g_atomic_int_get (&priv->idle_min))
+    g_atomic_int_set (&priv->idle_min, len);
+}
+
 /* must be called with the lock */
 static void
 do_set_flushing (GstBufferPool * pool, gboolean flushing)
@@ -451,8 +580,8 @@ do_set_flushing (GstBufferPool * pool, gboolean flushing)
 
   if (flushing) {
     g_atomic_int_set (&pool->flushing, 1);
-    /* Write the flush token to wake up any waiters */
-    gst_poll_write_control (priv->poll);
+    /* wake up all waiters so that they see the flushing flag */
+    wake_waiters (pool, TRUE);
 
     if (pclass->flush_start)
       pclass->flush_start (pool);
@@ -460,19 +589,6 @@ do_set_flushing (GstBufferPool * pool, gboolean flushing)
     if (pclass->flush_stop)
       pclass->flush_stop (pool);
 
-    while (!gst_poll_read_control (priv->poll)) {
-      if (errno == EWOULDBLOCK) {
-        /* This should not really happen unless flushing and unflushing
-         * happens on different threads. Let's wait a bit to get back flush
-         * token from the thread that was setting it to flushing */
-        g_thread_yield ();
-        continue;
-      } else {
-        /* Critical error but GstPoll already complained */
-        break;
-      }
-    }
-
     g_atomic_int_set (&pool->flushing, 0);
   }
 }
@@ -602,6 +718,7 @@ default_set_config (GstBufferPool * pool, GstStructure * config)
   guint size, min_buffers, max_buffers;
   GstAllocator *allocator;
   GstAllocationParams params;
+  GstClockTime idle_timeout;
 
   /* parse the config and keep around */
   if (!gst_buffer_pool_config_get_params (config, &caps, &size, &min_buffers,
@@ -611,12 +728,15 @@ default_set_config (GstBufferPool * pool, GstStructure * config)
   if (!gst_buffer_pool_config_get_allocator (config, &allocator, &params))
     goto wrong_config;
 
+  gst_buffer_pool_config_get_idle_timeout (config, &idle_timeout);
+
   GST_DEBUG_OBJECT (pool, "config %" GST_PTR_FORMAT, config);
 
   priv->size = size;
   priv->min_buffers = min_buffers;
   priv->max_buffers = max_buffers;
   priv->cur_buffers = 0;
+  priv->idle_timeout = idle_timeout;
 
   if (priv->allocator)
     gst_object_unref (priv->allocator);
@@ -1059,6 +1179,65 @@ gst_buffer_pool_config_get_allocator (GstStructure * config,
   return TRUE;
 }
 
+/**
+ * gst_buffer_pool_config_set_idle_timeout:
+ * @config: a #GstBufferPool configuration
+ * @timeout: the idle timeout or %GST_CLOCK_TIME_NONE
+ *
+ * Make the pool adapt its size to the actual demand. The pool preallocates
+ * the minimum amount of buffers of gst_buffer_pool_config_set_params() and
+ * grows on demand up to the maximum, like without an idle timeout. In
+ * addition, buffers that stayed unused in the pool for @timeout are freed
+ * again until the pool shrinks back to its minimum size.
+ *
+ * Idle buffers are freed while buffers are released to the pool, a pool that
+ * is not used at all keeps its buffers.
+ *
+ * Use %GST_CLOCK_TIME_NONE to disable adaptive sizing, which is the default.
+ *
+ * Since: 1.14
+ */
+void
+gst_buffer_pool_config_set_idle_timeout (GstStructure * config,
+    GstClockTime timeout)
+{
+  g_return_if_fail (config != NULL);
+
+  gst_structure_id_set (config,
+      GST_QUARK (IDLE_TIMEOUT), G_TYPE_UINT64, timeout, NULL);
+}
+
+/**
+ * gst_buffer_pool_config_get_idle_timeout:
+ * @config: (transfer none): a #GstBufferPool configuration
+ * @timeout: (out) (allow-none): the idle timeout, or %NULL
+ *
+ * Get the idle timeout of gst_buffer_pool_config_set_idle_timeout() from
+ * @config. @timeout is set to %GST_CLOCK_TIME_NONE when no idle timeout is
+ * configured.
+ *
+ * Returns: %TRUE when @config enables adaptive sizing.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_buffer_pool_config_get_idle_timeout (GstStructure * config,
+    GstClockTime * timeout)
+{
+  guint64 value;
+
+  g_return_val_if_fail (config != NULL, FALSE);
+
+  if (!gst_structure_id_get (config,
+          GST_QUARK (IDLE_TIMEOUT), G_TYPE_UINT64, &value, NULL))
+    value = GST_CLOCK_TIME_NONE;
+
+  if (timeout)
+    *timeout = value;
+
+  return value != GST_CLOCK_TIME_NONE;
+}
+
 /**
  * gst_buffer_pool_config_validate_params:
  * @config: (transfer none): a #GstBufferPool configuration
@@ -1099,12 +1278,66 @@ gst_buffer_pool_config_validate_params (GstStructure * config, GstCaps * caps,
   return ret;
 }
 
+/* how long an acquire waits for a released buffer before it allocates a new
+ * one when the memory budget is exceeded, and how often it checks if the
+ * budget was freed up elsewhere meanwhile, in microseconds */
+#define BUDGET_WAIT (100 * G_TIME_SPAN_MILLISECOND)
+#define BUDGET_POLL (10 * G_TIME_SPAN_MILLISECOND)
+
+/* wait for a buffer release or free, or flushing. We announce ourselves as a
+ * waiter before checking the queue again, a concurrent release either sees us
+ * waiting or we see its buffer. We only wait when the pool can't allocate more
+ * buffers or, with @for_budget, while the memory budget is exceeded. Nothing
+ * tells us when memory of other allocators is freed or when the budget
+ * changes, so then we check the budget every BUDGET_POLL and wait at most
+ * BUDGET_WAIT: the buffers we wait for might be held by a downstream element
+ * that waits for more data. */
+static void
+wait_for_release (GstBufferPool * pool, gboolean for_budget)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+
+  g_mutex_lock (&priv->wait_lock);
+  g_atomic_int_inc (&priv->waiters);
+  if (!GST_BUFFER_POOL_IS_FLUSHING (pool)
+      && gst_atomic_queue_length (priv->queue) == 0
+      && (for_budget ? gst_allocator_memory_budget_exceeded ()
+          : (guint) g_atomic_int_get (&priv->cur_buffers) >=
+          priv->max_buffers)) {
+    guint seq = priv->wake_seq;
+    gint64 start, now, end;
+
+    GST_LOG_OBJECT (pool, "waiting for free buffers or flushing");
+    now = start = g_get_monotonic_time ();
+    end = start + BUDGET_WAIT;
+    do {
+      if (!for_budget)
+        g_cond_wait (&priv->wait_cond, &priv->wait_lock);
+      else if (!g_cond_wait_until (&priv->wait_cond, &priv->wait_lock,
+              MIN (now + BUDGET_POLL, end))) {
+        now = g_get_monotonic_time ();
+        if (now >= end || !gst_allocator_memory_budget_exceeded ())
+          break;
+      }
+    } while (seq == priv->wake_seq);
+
+    priv->waits++;
+    priv->blocked_time += (g_get_monotonic_time () - start) * GST_USECOND;
+  }
+  g_atomic_int_add (&priv->waiters, -1);
+  g_mutex_unlock (&priv->wait_lock);
+}
+
 static GstFlowReturn
 default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     GstBufferPoolAcquireParams * params)
 {
   GstFlowReturn result;
   GstBufferPoolPrivate *priv = pool->priv;
+  gboolean dontwait, budget_waited = FALSE;
+
+  dontwait = params
+      && (params->flags & GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT);
 
   while (TRUE) {
     if (G_UNLIKELY (GST_BUFFER_POOL_IS_FLUSHING (pool)))
@@ -1113,16 +1346,10 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     /* try to get a buffer from the queue */
     *buffer = gst_atomic_queue_pop (priv->queue);
     if (G_LIKELY (*buffer)) {
-      while (!gst_poll_read_control (priv->poll)) {
-        if (errno == EWOULDBLOCK) {
-          /* We put the buffer into the queue but did not finish writing control
-           * yet, let's wait a bit and retry */
-          g_thread_yield ();
-          continue;
-        } else {
-          /* Critical error but GstPoll already complained */
-          break;
-        }
+      stats_inc (&priv->reuses);
+      if (priv->idle_timeout != GST_CLOCK_TIME_NONE) {
+        update_idle_min (pool);
+        maybe_trim (pool);
       }
       result = GST_FLOW_OK;
       GST_LOG_OBJECT (pool, "acquired buffer %p", *buffer);
@@ -1131,6 +1358,26 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
 
     /* no buffer, try to allocate some more */
     GST_LOG_OBJECT (pool, "no buffer, trying to allocate");
+    if (priv->idle_timeout != GST_CLOCK_TIME_NONE)
+      g_atomic_int_set (&priv->idle_min, 0);
+
+    /* over the memory budget, prefer to wait a little for one of our own
+     * buffers to come back before we grow. This only throttles, we never fail
+     * because of the budget and an empty pool always allocates. */
+    if (G_UNLIKELY (!budget_waited
+            && g_atomic_int_get (&priv->cur_buffers) > 0
+            && gst_allocator_memory_budget_exceeded ())) {
+      if (dontwait) {
+        GST_LOG_OBJECT (pool, "memory budget exceeded");
+        result = GST_FLOW_EOS;
+        break;
+      }
+      GST_DEBUG_OBJECT (pool, "memory budget exceeded, waiting for a buffer");
+      budget_waited = TRUE;
+      wait_for_release (pool, TRUE);
+      continue;
+    }
+
     result = do_alloc_buffer (pool, buffer, params);
     if (G_LIKELY (result == GST_FLOW_OK))
       /* we have a buffer, return it */
@@ -1141,40 +1388,12 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
       break;
 
     /* check if we need to wait */
-    if (params && (params->flags & GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT)) {
+    if (dontwait) {
       GST_LOG_OBJECT (pool, "no more buffers");
       break;
     }
 
-    /* now we release the control socket, we wait for a buffer release or
-     * flushing */
-    if (!gst_poll_read_control (pool->priv->poll)) {
-      if (errno == EWOULDBLOCK) {
-        /* This means that we have two threads trying to allocate buffers
-         * already, and the other one already got the wait token. This
-         * means that we only have to wait for the poll now and not write the
-         * token afterwards: we will be woken up once the other thread is
-         * woken up and that one will write the wait token it removed */
-        GST_LOG_OBJECT (pool, "waiting for free buffers or flushing");
-        gst_poll_wait (priv->poll, GST_CLOCK_TIME_NONE);
-      } else {
-        /* This is a critical error, GstPoll already gave a warning */
-        result = GST_FLOW_ERROR;
-        break;
-      }
-    } else {
-      /* We're the first thread waiting, we got the wait token and have to
-       * write it again later
-       * OR
-       * We're a second thread and just consumed the flush token and block all
-       * other threads, in which case we must not wait and give it back
-       * immediately */
-      if (!GST_BUFFER_POOL_IS_FLUSHING (pool)) {
-        GST_LOG_OBJECT (pool, "waiting for free buffers or flushing");
-        gst_poll_wait (priv->poll, GST_CLOCK_TIME_NONE);
-      }
-      gst_poll_write_control (pool->priv->poll);
-    }
+    wait_for_release (pool, FALSE);
   }
 
   return result;
@@ -1251,6 +1470,7 @@ gst_buffer_pool_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
 {
   GstBufferPoolClass *pclass;
   GstFlowReturn result;
+  gint outstanding, peak;
 
   g_return_val_if_fail (GST_IS_BUFFER_POOL (pool), GST_FLOW_ERROR);
   g_return_val_if_fail (buffer != NULL, GST_FLOW_ERROR);
@@ -1259,7 +1479,7 @@ gst_buffer_pool_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
 
   /* assume we'll have one more outstanding buffer we need to do that so
    * that concurrent set_active doesn't clear the buffers */
-  g_atomic_int_inc (&pool->priv->outstanding);
+  outstanding = g_atomic_int_add (&pool->priv->outstanding, 1) + 1;
 
   if (G_LIKELY (pclass->acquire_buffer))
     result = pclass->acquire_buffer (pool, buffer, params);
@@ -1270,6 +1490,14 @@ gst_buffer_pool_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     /* all buffers from the pool point to the pool and have the refcount of the
      * pool incremented */
     (*buffer)->pool = gst_object_ref (pool);
+
+    peak = g_atomic_int_get (&pool->priv->peak_outstanding);
+    while (G_UNLIKELY (outstanding > peak)) {
+      if (g_atomic_int_compare_and_exchange (&pool->priv->peak_outstanding,
+              peak, outstanding))
+        break;
+      peak = g_atomic_int_get (&pool->priv->peak_outstanding);
+    }
   } else {
     dec_outstanding (pool);
   }
@@ -1298,7 +1526,10 @@ default_release_buffer (GstBufferPool * pool, GstBuffer * buffer)
 
   /* keep it around in our queue */
   gst_atomic_queue_push (pool->priv->queue, buffer);
-  gst_poll_write_control (pool->priv->poll);
+  wake_waiters (pool, FALSE);
+
+  if (pool->priv->idle_timeout != GST_CLOCK_TIME_NONE)
+    maybe_trim (pool);
 
   return;
 
@@ -1400,3 +1631,64 @@ gst_buffer_pool_set_flushing (GstBufferPool * pool, gboolean flushing)
 done:
   GST_BUFFER_POOL_UNLOCK (pool);
 }
+
+/**
+ * gst_buffer_pool_get_stats:
+ * @pool: a #GstBufferPool
+ *
+ * Get the usage statistics of @pool. The returned structure is named
+ * "GstBufferPoolStats" and contains the following fields:
+ *
+ * - "allocations" (#guint64): buffers allocated by the pool
+ * - "reuses" (#guint64): acquired buffers that were reused from the pool
+ * - "trimmed" (#guint64): idle buffers freed by adaptive sizing
+ * - "waits" (#guint64): times an acquire had to wait for a free buffer
+ * - "blocked-time" (#guint64): total time in nanoseconds spent waiting
+ * - "buffers" (#guint): buffers currently allocated by the pool
+ * - "outstanding" (#guint): buffers currently acquired from the pool
+ * - "peak-outstanding" (#guint): the highest number of acquired buffers
+ * - "waiters" (#guint): threads currently waiting in an acquire
+ * - "live-bytes" (#guint64): memory size of the buffers allocated by the pool
+ * - "peak-bytes" (#guint64): the highest value of "live-bytes"
+ *
+ * Allocations, reuses and trimmed buffers are only counted by the default
+ * acquire and release implementation. Where pointers have 32 bits, their
+ * counters wrap around after 2^32 events.
+ *
+ * Returns: (transfer full): a new #GstStructure with the statistics.
+ *
+ * Since: 1.14
+ */
+GstStructure *
+gst_buffer_pool_get_stats (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv;
+  guint64 waits;
+  GstClockTime blocked_time;
+
+  g_return_val_if_fail (GST_IS_BUFFER_POOL (pool), NULL);
+
+  priv = pool->priv;
+
+  g_mutex_lock (&priv->wait_lock);
+  waits = priv->waits;
+  blocked_time = priv->blocked_time;
+  g_mutex_unlock (&priv->wait_lock);
+
+  return gst_structure_new ("GstBufferPoolStats",
+      "allocations", G_TYPE_UINT64, stats_get (&priv->allocations),
+      "reuses", G_TYPE_UINT64, stats_get (&priv->reuses),
+      "trimmed", G_TYPE_UINT64, stats_get (&priv->trimmed),
+      "waits", G_TYPE_UINT64, waits,
+      "blocked-time", G_TYPE_UINT64, blocked_time,
+      "buffers", G_TYPE_UINT, g_atomic_int_get (&priv->cur_buffers),
+      "outstanding", G_TYPE_UINT, g_atomic_int_get (&priv->outstanding),
+      "peak-outstanding", G_TYPE_UINT,
+      g_atomic_int_get (&priv->peak_outstanding),
+      "waiters", G_TYPE_UINT, g_atomic_int_get (&priv->waiters),
+      "live-bytes", G_TYPE_UINT64,
+      (guint64) GPOINTER_TO_SIZE (g_atomic_pointer_get (&priv->live_bytes)),
+      "peak-bytes", G_TYPE_UINT64,
+      (guint64) GPOINTER_TO_SIZE (g_atomic_pointer_get (&priv->peak_bytes)),
+      NULL);
+}
@@ -224,6 +224,12 @@ GST_EXPORT
 gboolean         gst_buffer_pool_config_get_allocator (GstStructure *config, GstAllocator **allocator,
                                                        GstAllocationParams *params);
 
+GST_EXPORT
+void             gst_buffer_pool_config_set_idle_timeout (GstStructure *config, GstClockTime timeout);
+
+GST_EXPORT
+gboolean         gst_buffer_pool_config_get_idle_timeout (GstStructure *config, GstClockTime *timeout);
+
 /* options */
 
 GST_EXPORT
@@ -251,6 +257,11 @@ GstFlowReturn    gst_buffer_pool_acquire_buffer  (GstBufferPool *pool, GstBuffer
 GST_EXPORT
 void             gst_buffer_pool_release_buffer  (GstBufferPool *pool, GstBuffer *buffer);
 
+/* statistics */
+
+GST_EXPORT
+GstStructure *   gst_buffer_pool_get_stats       (GstBufferPool *pool);
+
 G_END_DECLS
 
 #endif /* __GST_BUFFER_POOL_H__ */
@@ -134,6 +134,302 @@ GstCaps *_gst_caps_none;
 
 GST_DEFINE_MINI_OBJECT_TYPE (GstCaps, gst_caps);
 
+/* Results of intersections and subset checks are kept in a small cache per
+ * thread because negotiation and autoplugging compare the same template caps
+ * over and over again. The cache keeps copies of the compared caps, so the
+ * caps of the caller stay writable, and a ref to the intersection, which is
+ * handed out again like the intersections of equal or ANY caps are. */
+typedef enum
+{
+  CAPS_CACHE_OP_INTERSECT_ZIG_ZAG,
+  CAPS_CACHE_OP_INTERSECT_FIRST,
+  CAPS_CACHE_OP_IS_SUBSET,
+  CAPS_CACHE_OP_CAN_INTERSECT
+} CapsCacheOp;
+
+typedef struct
+{
+  GstCaps *caps1;
+  GstCaps *caps2;
+  guint hash1;
+  guint hash2;
+  CapsCacheOp op;
+  /* for the intersections */
+  GstCaps *result;
+  /* for the checks */
+  gboolean res;
+  guint64 last_used;
+} CapsCacheEntry;
+
+#define CAPS_CACHE_SIZE 32
+
+typedef struct
+{
+  CapsCacheEntry entries[CAPS_CACHE_SIZE];
+  guint64 tick;
+} CapsCache;
+
+/* the caps to look up */
+typedef struct
+{
+  CapsCacheOp op;
+  GstCaps *caps1;
+  GstCaps *caps2;
+  guint hash1;
+  guint hash2;
+} CapsCacheKey;
+
+/* comparing fewer pairs of structures is faster than hashing the caps */
+#define CAPS_CACHE_MIN_PAIRS 8
+
+static void caps_cache_free (gpointer data);
+
+static GPrivate caps_cache = G_PRIVATE_INIT (caps_cache_free);
+
+/* caps kept alive by gst_caps_intern() */
+static GMutex caps_intern_lock;
+static GHashTable *caps_intern_table;
+
+/* The same caps strings from templates, configuration and signalling are
+ * parsed over and over again, so the caps of the last ones that were parsed
+ * are kept around. gst_caps_from_string() returns copies of them, which are
+ * writable like newly parsed caps. */
+typedef struct
+{
+  gchar *string;
+  guint hash;
+  GstCaps *caps;
+  guint64 last_used;
+} CapsParseCacheEntry;
+
+#define CAPS_PARSE_CACHE_SIZE 32
+/* longer strings are rarely repeated and would only make the cache big */
+#define CAPS_PARSE_CACHE_MAX_LEN 1024
+
+static GMutex caps_parse_cache_lock;
+static CapsParseCacheEntry caps_parse_cache[CAPS_PARSE_CACHE_SIZE];
+static guint64 caps_parse_cache_tick;
+
+static void
+caps_cache_entry_clear (CapsCacheEntry * entry)
+{
+  if (entry->caps1) {
+    gst_caps_unref (entry->caps1);
+    gst_caps_unref (entry->caps2);
+    if (entry->result)
+      gst_caps_unref (entry->result);
+  }
+  memset (entry, 0, sizeof (CapsCacheEntry));
+}
+
+static void
+caps_cache_free (gpointer data)
+{
+  CapsCache *cache = data;
+  guint i;
+
+  for (i = 0; i < CAPS_CACHE_SIZE; i++)
+    caps_cache_entry_clear (&cache->entries[i]);
+  g_slice_free (CapsCache, cache);
+}
+
+static CapsCache *
+caps_cache_get (void)
+{
+  CapsCache *cache = g_private_get (&caps_cache);
+
+  if (G_UNLIKELY (cache == NULL)) {
+    cache = g_slice_new0 (CapsCache);
+    g_private_set (&caps_cache, cache);
+  }
+  return cache;
+}
+
+static gboolean
+caps_cache_usable (const GstCaps * caps1, const GstCaps * caps2)
+{
+  /* ANY and empty caps have no structures and are never cached */
+  return caps1 != caps2 &&
+      GST_CAPS_LEN (caps1) * GST_CAPS_LEN (caps2) >= CAPS_CACHE_MIN_PAIRS;
+}
+
+static void
+caps_cache_key_init (CapsCacheKey * key, CapsCacheOp op,
+    const GstCaps * caps1, const GstCaps * caps2)
+{
+  key->op = op;
+  key->caps1 = (GstCaps *) caps1;
+  key->caps2 = (GstCaps *) caps2;
+  key->hash1 = _priv_gst_caps_hash (caps1);
+  key->hash2 = _priv_gst_caps_hash (caps2);
+}
+
+static CapsCacheEntry *
+caps_cache_find (CapsCache * cache, CapsCacheKey * key)
+{
+  CapsCacheEntry *entry;
+  guint i;
+
+  for (i = 0; i < CAPS_CACHE_SIZE; i++) {
+    entry = &cache->entries[i];
+    if (entry->caps1 != NULL && entry->op == key->op
+        && entry->hash1 == key->hash1 && entry->hash2 == key->hash2
+        && gst_caps_is_strictly_equal (entry->caps1, key->caps1)
+        && gst_caps_is_strictly_equal (entry->caps2, key->caps2))
+      return entry;
+  }
+
+  return NULL;
+}
+
+/* @result is set to a ref to the cached result */
+static gboolean
+caps_cache_lookup (CapsCacheKey * key, GstCaps ** result, gboolean * res)
+{
+  CapsCache *cache = caps_cache_get ();
+  CapsCacheEntry *entry;
+
+  entry = caps_cache_find (cache, key);
+  if (entry == NULL)
+    return FALSE;
+
+  entry->last_used = ++cache->tick;
+  if (result)
+    *result = gst_caps_ref (entry->result);
+  if (res)
+    *res = entry->res;
+
+  return TRUE;
+}
+
+/* a ref to @result is kept, the compared caps are copied */
+static void
+caps_cache_store (CapsCacheKey * key, GstCaps * result, gboolean res)
+{
+  CapsCache *cache = caps_cache_get ();
+  CapsCacheEntry *entry;
+  guint i;
+
+  /* replace the least recently used entry, unused ones come first */
+  entry = &cache->entries[0];
+  for (i = 1; i < CAPS_CACHE_SIZE && entry->caps1 != NULL; i++) {
+    if (cache->entries[i].last_used < entry->last_used)
+      entry = &cache->entries[i];
+  }
+  caps_cache_entry_clear (entry);
+
+  entry->caps1 = gst_caps_copy (key->caps1);
+  entry->caps2 = gst_caps_copy (key->caps2);
+  entry->hash1 = key->hash1;
+  entry->hash2 = key->hash2;
+  entry->op = key->op;
+  entry->result = result ? gst_caps_ref (result) : NULL;
+  entry->res = res;
+  entry->last_used = ++cache->tick;
+}
+
+/* returns a copy of the cached caps for @string, or %NULL */
+static GstCaps *
+caps_parse_cache_lookup (const gchar * string, guint hash)
+{
+  GstCaps *caps = NULL;
+  guint i;
+
+  g_mutex_lock (&caps_parse_cache_lock);
+  for (i = 0; i < CAPS_PARSE_CACHE_SIZE; i++) {
+    CapsParseCacheEntry *entry = &caps_parse_cache[i];
+
+    if (entry->string && entry->hash == hash
+        && strcmp (entry->string, string) == 0) {
+      entry->last_used = ++caps_parse_cache_tick;
+      caps = gst_caps_ref (entry->caps);
+      break;
+    }
+  }
+  g_mutex_unlock (&caps_parse_cache_lock);
+
+  if (caps) {
+    GstCaps *copy = gst_caps_copy (caps);
+
+    gst_caps_unref (caps);
+    caps = copy;
+  }
+
+  return caps;
+}
+
+/* @caps are not taken, the cache keeps its own copy */
+static void
+caps_parse_cache_store (const gchar * string, guint hash, GstCaps * caps)
+{
+  CapsParseCacheEntry *entry, old = { NULL, };
+  GstCaps *copy;
+  guint i;
+
+  copy = gst_caps_copy (caps);
+
+  g_mutex_lock (&caps_parse_cache_lock);
+  /* replace the least recently used entry, unused ones come first, unless
+   * another thread stored the same string in the meantime */
+  entry = &caps_parse_cache[0];
+  for (i = 0; i < CAPS_PARSE_CACHE_SIZE; i++) {
+    CapsParseCacheEntry *e = &caps_parse_cache[i];
+
+    if (e->string && e->hash == hash && strcmp (e->string, string) == 0) {
+      entry = NULL;
+      break;
+    }
+    if (entry->string && (e->string == NULL
+            || e->last_used < entry->last_used))
+      entry = e;
+  }
+  if (entry) {
+    old = *entry;
+    entry->string = g_strdup (string);
+    entry->hash = hash;
+    entry->caps = copy;
+    entry->last_used = ++caps_parse_cache_tick;
+    copy = NULL;
+  }
+  g_mutex_unlock (&caps_parse_cache_lock);
+
+  if (copy)
+    gst_caps_unref (copy);
+  if (old.string) {
+    g_free (old.string);
+    gst_caps_unref (old.caps);
+  }
+}
+
+void
+_priv_gst_caps_cache_cleanup (void)
+{
+  guint i;
+
+  /* the caches of other threads go away with them */
+  g_private_replace (&caps_cache, NULL);
+
+  g_mutex_lock (&caps_intern_lock);
+  if (caps_intern_table) {
+    g_hash_table_destroy (caps_intern_table);
+    caps_intern_table = NULL;
+  }
+  g_mutex_unlock (&caps_intern_lock);
+
+  g_mutex_lock (&caps_parse_cache_lock);
+  for (i = 0; i < CAPS_PARSE_CACHE_SIZE; i++) {
+    CapsParseCacheEntry *entry = &caps_parse_cache[i];
+
+    if (entry->string) {
+      g_free (entry->string);
+      gst_caps_unref (entry->caps);
+    }
+    memset (entry, 0, sizeof (CapsParseCacheEntry));
+  }
+  caps_parse_cache_tick = 0;
+  g_mutex_unlock (&caps_parse_cache_lock);
+}
+
 void
 _priv_gst_caps_initialize (void)
 {
@@ -1216,6 +1512,8 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
 {
   GstStructure *s1, *s2;
   GstCapsFeatures *f1, *f2;
+  CapsCacheKey key = { 0, };
+  gboolean cache;
   gboolean ret = TRUE;
   gint i, j;
 
@@ -1227,6 +1525,13 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
   if (CAPS_IS_ANY (subset) || CAPS_IS_EMPTY (superset))
     return FALSE;
 
+  cache = caps_cache_usable (subset, superset);
+  if (cache) {
+    caps_cache_key_init (&key, CAPS_CACHE_OP_IS_SUBSET, subset, superset);
+    if (caps_cache_lookup (&key, NULL, &ret))
+      return ret;
+  }
+
   for (i = GST_CAPS_LEN (subset) - 1; i >= 0; i--) {
     for (j = GST_CAPS_LEN (superset) - 1; j >= 0; j--) {
       s1 = gst_caps_get_structure_unchecked (subset, i);
@@ -1253,6 +1558,9 @@ gst_caps_is_subset (const GstCaps * subset, const GstCaps * superset)
     }
   }
 
+  if (cache)
+    caps_cache_store (&key, NULL, ret);
+
   return ret;
 }
 
@@ -1408,6 +1716,91 @@ gst_caps_is_strictly_equal (const GstCaps * caps1, const GstCaps * caps2)
   return TRUE;
 }
 
+/* hashes the structures and their features in order, caps that are only
+ * equal after reordering hash differently */
+guint
+_priv_gst_caps_hash (const GstCaps * caps)
+{
+  GstCapsFeatures *features;
+  guint i, j, n, len, h;
+
+  h = GST_CAPS_FLAGS (caps) & GST_CAPS_FLAG_ANY;
+  len = GST_CAPS_LEN (caps);
+  for (i = 0; i < len; i++) {
+    h = (h << 5) - h +
+        _priv_gst_structure_hash (gst_caps_get_structure_unchecked (caps, i));
+
+    features = gst_caps_get_features_unchecked (caps, i);
+    if (features == NULL) {
+      h = (h << 5) - h;
+    } else if (gst_caps_features_is_any (features)) {
+      h = (h << 5) - h + 1;
+    } else {
+      n = gst_caps_features_get_size (features);
+      for (j = 0; j < n; j++)
+        h = (h << 5) - h + gst_caps_features_get_nth_id (features, j);
+    }
+  }
+
+  return h;
+}
+
+static guint
+gst_caps_intern_hash (gconstpointer caps)
+{
+  return _priv_gst_caps_hash (caps);
+}
+
+static gboolean
+gst_caps_intern_equal (gconstpointer caps1, gconstpointer caps2)
+{
+  return gst_caps_is_strictly_equal (caps1, caps2);
+}
+
+/**
+ * gst_caps_intern:
+ * @caps: (transfer full): a #GstCaps
+ *
+ * Looks up caps that are strictly equal to @caps in a process wide table
+ * and returns those, or adds @caps to the table when there are none yet.
+ *
+ * The caps in the table are never writable and stay alive until
+ * gst_deinit(). Elements that share interned caps, for example for their pad
+ * templates, can be compared by pointer and their intersections are found in
+ * the intersection cache without hashing the caps.
+ *
+ * This is meant for caps that are used for the lifetime of the process, not
+ * for caps that are created per stream.
+ *
+ * Returns: (transfer full): the interned caps, equal to @caps
+ *
+ * Since: 1.14
+ */
+GstCaps *
+gst_caps_intern (GstCaps * caps)
+{
+  GstCaps *interned;
+
+  g_return_val_if_fail (GST_IS_CAPS (caps), NULL);
+
+  g_mutex_lock (&caps_intern_lock);
+  if (G_UNLIKELY (caps_intern_table == NULL))
+    caps_intern_table = g_hash_table_new_full (gst_caps_intern_hash,
+        gst_caps_intern_equal, (GDestroyNotify) gst_mini_object_unref, NULL);
+
+  interned = g_hash_table_lookup (caps_intern_table, caps);
+  if (interned == NULL) {
+    interned = caps;
+    g_hash_table_add (caps_intern_table, gst_caps_ref (interned));
+  }
+  gst_caps_ref (interned);
+  g_mutex_unlock (&caps_intern_lock);
+
+  gst_caps_unref (caps);
+
+  return interned;
+}
+
 /* intersect operation */
 
 /**
@@ -1429,6 +1822,9 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
   GstStructure *struct2;
   GstCapsFeatures *features1;
   GstCapsFeatures *features2;
+  CapsCacheKey key = { 0, };
+  gboolean cache;
+  gboolean ret = FALSE;
 
   g_return_val_if_fail (GST_IS_CAPS (caps1), FALSE);
   g_return_val_if_fail (GST_IS_CAPS (caps2), FALSE);
@@ -1445,6 +1841,13 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
   if (G_UNLIKELY (CAPS_IS_ANY (caps1) || CAPS_IS_ANY (caps2)))
     return TRUE;
 
+  cache = caps_cache_usable (caps1, caps2);
+  if (cache) {
+    caps_cache_key_init (&key, CAPS_CACHE_OP_CAN_INTERSECT, caps1, caps2);
+    if (caps_cache_lookup (&key, NULL, &ret))
+      return ret;
+  }
+
   /* run zigzag on top line then right line, this preserves the caps order
    * much better than a simple loop.
    *
@@ -1483,7 +1886,8 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
         features2 = GST_CAPS_FEATURES_MEMORY_SYSTEM_MEMORY;
       if (gst_caps_features_is_equal (features1, features2) &&
           gst_structure_can_intersect (struct1, struct2)) {
-        return TRUE;
+        ret = TRUE;
+        goto done;
       }
       /* move down left */
       k++;
@@ -1493,7 +1897,11 @@ gst_caps_can_intersect (const GstCaps * caps1, const GstCaps * caps2)
     }
   }
 
-  return FALSE;
+done:
+  if (cache)
+    caps_cache_store (&key, NULL, ret);
+
+  return ret;
 }
 
 static GstCaps *
@@ -1670,18 +2078,36 @@ GstCaps *
 gst_caps_intersect_full (GstCaps * caps1, GstCaps * caps2,
     GstCapsIntersectMode mode)
 {
+  CapsCacheKey key = { 0, };
+  gboolean cache;
+  GstCaps *result;
+
   g_return_val_if_fail (GST_IS_CAPS (caps1), NULL);
   g_return_val_if_fail (GST_IS_CAPS (caps2), NULL);
 
-  switch (mode) {
-    case GST_CAPS_INTERSECT_FIRST:
-      return gst_caps_intersect_first (caps1, caps2);
-    default:
-      g_warning ("Unknown caps intersect mode: %d", mode);
-      /* fallthrough */
-    case GST_CAPS_INTERSECT_ZIG_ZAG:
-      return gst_caps_intersect_zig_zag (caps1, caps2);
+  if (mode != GST_CAPS_INTERSECT_FIRST && mode != GST_CAPS_INTERSECT_ZIG_ZAG) {
+    g_warning ("Unknown caps intersect mode: %d", mode);
+    mode = GST_CAPS_INTERSECT_ZIG_ZAG;
   }
+
+  cache = caps_cache_usable (caps1, caps2);
+  if (cache) {
+    caps_cache_key_init (&key, mode == GST_CAPS_INTERSECT_FIRST ?
+        CAPS_CACHE_OP_INTERSECT_FIRST : CAPS_CACHE_OP_INTERSECT_ZIG_ZAG,
+        caps1, caps2);
+    if (caps_cache_lookup (&key, &result, NULL))
+      return result;
+  }
+
+  if (mode == GST_CAPS_INTERSECT_FIRST)
+    result = gst_caps_intersect_first (caps1, caps2);
+  else
+    result = gst_caps_intersect_zig_zag (caps1, caps2);
+
+  if (cache)
+    caps_cache_store (&key, result, FALSE);
+
+  return result;
 }
 
 /**
@@ -2259,6 +2685,8 @@ gst_caps_from_string_inplace (GstCaps * caps, const gchar * string)
 {
   GstStructure *structure;
   gchar *s, *copy, *end, *next, save;
+  gchar buf[GST_PARSE_STACK_BUFFER_SIZE];
+  gsize len;
 
   if (strcmp ("ANY", string) == 0) {
     GST_CAPS_FLAGS (caps) = GST_CAPS_FLAG_ANY;
@@ -2269,7 +2697,13 @@ gst_caps_from_string_inplace (GstCaps * caps, const gchar * string)
     return TRUE;
   }
 
-  copy = s = g_strdup (string);
+  /* the string is parsed in place, short ones are copied on the stack */
+  len = strlen (string);
+  if (len < sizeof (buf))
+    copy = memcpy (buf, string, len + 1);
+  else
+    copy = g_strdup (string);
+  s = copy;
   do {
     GstCapsFeatures *features = NULL;
 
@@ -2280,7 +2714,8 @@ gst_caps_from_string_inplace (GstCaps * caps, const gchar * string)
     }
 
     if (!priv_gst_structure_parse_name (s, &s, &end, &next)) {
-      g_free (copy);
+      if (copy != buf)
+        g_free (copy);
       return FALSE;
     }
 
@@ -2290,7 +2725,8 @@ gst_caps_from_string_inplace (GstCaps * caps, const gchar * string)
     *end = save;
 
     if (structure == NULL) {
-      g_free (copy);
+      if (copy != buf)
+        g_free (copy);
       return FALSE;
     }
 
@@ -2319,7 +2755,8 @@ gst_caps_from_string_inplace (GstCaps * caps, const gchar * string)
       features = gst_caps_features_from_string (s);
       if (!features) {
         gst_structure_free (structure);
-        g_free (copy);
+        if (copy != buf)
+          g_free (copy);
         return FALSE;
       }
       *end = save;
@@ -2336,7 +2773,8 @@ gst_caps_from_string_inplace (GstCaps * caps, const gchar * string)
       gst_structure_free (structure);
       if (features)
         gst_caps_features_free (features);
-      g_free (copy);
+      if (copy != buf)
+        g_free (copy);
       return FALSE;
     }
 
@@ -2347,7 +2785,8 @@ gst_caps_from_string_inplace (GstCaps * caps, const gchar * string)
       break;
   } while (TRUE);
 
-  g_free (copy);
+  if (copy != buf)
+    g_free (copy);
 
   return TRUE;
 }
@@ -2361,17 +2800,32 @@ gst_caps_from_string_inplace (GstCaps * caps, const gchar * string)
  * The current implementation of serialization will lead to unexpected results
  * when there are nested #GstCaps / #GstStructure deeper than one level.
  *
+ * The caps of recently converted strings are cached, converting the same
+ * string again only makes a copy of them.
+ *
  * Returns: (transfer full): a newly allocated #GstCaps
  */
 GstCaps *
 gst_caps_from_string (const gchar * string)
 {
   GstCaps *caps;
+  gboolean cache;
+  guint hash = 0;
 
   g_return_val_if_fail (string, FALSE);
 
+  cache = strlen (string) <= CAPS_PARSE_CACHE_MAX_LEN;
+  if (cache) {
+    hash = g_str_hash (string);
+    caps = caps_parse_cache_lookup (string, hash);
+    if (caps)
+      return caps;
+  }
+
   caps = gst_caps_new_empty ();
   if (gst_caps_from_string_inplace (caps, string)) {
+    if (cache)
+      caps_parse_cache_store (string, hash, caps);
     return caps;
   } else {
     gst_caps_unref (caps);
@@ -2379,6 +2833,51 @@ gst_caps_from_string (const gchar * string)
   }
 }
 
+/**
+ * gst_caps_to_binary:
+ * @caps: a #GstCaps
+ * @array: a #GByteArray to append to
+ *
+ * Appends a compact binary representation of @caps to @array, which can be
+ * turned back into caps with gst_caps_from_binary(). This is a lot faster
+ * to write and to read than gst_caps_to_string(), and it keeps nested
+ * caps and structures intact.
+ *
+ * Returns: %TRUE if @caps were written, %FALSE if they hold a value that
+ *     can't be serialized, @array is left unchanged then.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_caps_to_binary (const GstCaps * caps, GByteArray * array)
+{
+  g_return_val_if_fail (GST_IS_CAPS (caps), FALSE);
+  g_return_val_if_fail (array != NULL, FALSE);
+
+  return _priv_gst_binary_write_caps (array, caps);
+}
+
+/**
+ * gst_caps_from_binary:
+ * @data: (array length=size): data written by gst_caps_to_binary()
+ * @size: the size of @data
+ * @consumed: (out) (allow-none): the number of bytes that were read
+ *
+ * Reads caps that were written with gst_caps_to_binary().
+ *
+ * Returns: (transfer full) (nullable): new #GstCaps or %NULL when @data
+ *     does not hold valid caps.
+ *
+ * Since: 1.14
+ */
+GstCaps *
+gst_caps_from_binary (const guint8 * data, gsize size, gsize * consumed)
+{
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  return _priv_gst_binary_read_caps (data, size, consumed);
+}
+
 static void
 gst_caps_transform_to_string (const GValue * src_value, GValue * dest_value)
 {
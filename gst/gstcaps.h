@@ -558,6 +558,9 @@ GstCaps *         gst_caps_simplify                (GstCaps *caps) G_GNUC_WARN_U
 GST_EXPORT
 GstCaps *         gst_caps_fixate                  (GstCaps *caps) G_GNUC_WARN_UNUSED_RESULT;
 
+GST_EXPORT
+GstCaps *         gst_caps_intern                  (GstCaps *caps) G_GNUC_WARN_UNUSED_RESULT;
+
 /* utility */
 
 GST_EXPORT
@@ -566,6 +569,14 @@ gchar *           gst_caps_to_string               (const GstCaps *caps) G_GNUC_
 GST_EXPORT
 GstCaps *         gst_caps_from_string             (const gchar   *string) G_GNUC_WARN_UNUSED_RESULT;
 
+GST_EXPORT
+gboolean          gst_caps_to_binary               (const GstCaps *caps,
+                                                    GByteArray    *array);
+GST_EXPORT
+GstCaps *         gst_caps_from_binary             (const guint8  *data,
+                                                    gsize          size,
+                                                    gsize         *consumed) G_GNUC_WARN_UNUSED_RESULT;
+
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GstCaps, gst_caps_unref)
 #endif
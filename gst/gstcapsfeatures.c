@@ -126,10 +126,9 @@ gst_is_caps_features (gconstpointer obj)
   return (obj != NULL && features->type == _gst_caps_features_type);
 }
 
-static gboolean
-gst_caps_feature_name_is_valid (const gchar * feature)
+gboolean
+_priv_gst_caps_feature_name_is_valid (const gchar * feature)
 {
-#ifndef G_DISABLE_CHECKS
   while (TRUE) {
     if (g_ascii_isalpha (*feature))
       feature++;
@@ -154,11 +153,20 @@ gst_caps_feature_name_is_valid (const gchar * feature)
     else
       return FALSE;
   }
-#endif
 
   return TRUE;
 }
 
+static gboolean
+gst_caps_feature_name_is_valid (const gchar * feature)
+{
+#ifndef G_DISABLE_CHECKS
+  return _priv_gst_caps_feature_name_is_valid (feature);
+#else
+  return TRUE;
+#endif
+}
+
 /**
  * gst_caps_features_new_empty:
  *
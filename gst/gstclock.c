@@ -239,9 +239,11 @@ static GstClockID
 gst_clock_entry_new (GstClock * clock, GstClockTime time,
     GstClockTime interval, GstClockEntryType type)
 {
+  GstClockEntryImpl *impl;
   GstClockEntry *entry;
 
-  entry = g_slice_new (GstClockEntry);
+  impl = g_slice_new (GstClockEntryImpl);
+  entry = (GstClockEntry *) impl;
 
   /* FIXME: add tracer hook for struct allocations such as clock entries */
 
@@ -260,6 +262,11 @@ gst_clock_entry_new (GstClock * clock, GstClockTime time,
   entry->unscheduled = FALSE;
   entry->woken_up = FALSE;
 
+  g_mutex_init (&impl->lock);
+  g_cond_init (&impl->cond);
+  impl->heap_index = -1;
+  impl->heap_seqnum = 0;
+
   return (GstClockID) entry;
 }
 
@@ -346,6 +353,7 @@ gst_clock_id_ref (GstClockID id)
 static void
 _gst_clock_id_free (GstClockID id)
 {
+  GstClockEntryImpl *impl;
   GstClockEntry *entry;
   g_return_if_fail (id != NULL);
 
@@ -356,7 +364,10 @@ _gst_clock_id_free (GstClockID id)
 
   /* FIXME: add tracer hook for struct allocations such as clock entries */
 
-  g_slice_free (GstClockEntry, id);
+  impl = (GstClockEntryImpl *) entry;
+  g_mutex_clear (&impl->lock);
+  g_cond_clear (&impl->cond);
+  g_slice_free (GstClockEntryImpl, impl);
 }
 
 /**
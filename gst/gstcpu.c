@@ -0,0 +1,209 @@
+/* GStreamer
+ * gstcpu.c: CPU feature detection and kernel selection
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Optimized kernels are compiled for several instruction sets and the best
+ * one that the CPU supports is selected at runtime with _gst_cpu_select().
+ *
+ * The features are detected once, with cpuid on x86. NEON is always there on
+ * aarch64 and on arm when the code is compiled for it.
+ *
+ * The GST_CPU_DISABLE environment variable contains a comma separated list
+ * of features that should not be used, like "avx2,avx512", or "all" to
+ * always use the generic kernels.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "gst_private.h"
+#include "gstcpu.h"
+
+#if defined(HAVE_CPU_I386) || defined(HAVE_CPU_X86_64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define HAVE_CPUID 1
+#elif defined(__GNUC__)
+#include <cpuid.h>
+#define HAVE_CPUID 1
+#endif
+#endif
+
+static const struct
+{
+  const gchar *name;
+  GstCpuFlags flag;
+} flag_names[] = {
+  {"sse2", GST_CPU_FLAG_SSE2},
+  {"sse4.2", GST_CPU_FLAG_SSE4_2},
+  {"avx", GST_CPU_FLAG_AVX},
+  {"avx2", GST_CPU_FLAG_AVX2},
+  {"avx512", GST_CPU_FLAG_AVX512},
+  {"neon", GST_CPU_FLAG_NEON}
+};
+
+#ifdef HAVE_CPUID
+static void
+cpuid (guint32 leaf, guint32 subleaf, guint32 regs[4])
+{
+#if defined(_MSC_VER)
+  int r[4];
+
+  __cpuidex (r, leaf, subleaf);
+  memcpy (regs, r, sizeof (r));
+#else
+  __cpuid_count (leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+/* the state components that the OS saves on context switches */
+static guint64
+xgetbv (void)
+{
+#if defined(_MSC_VER)
+  return _xgetbv (0);
+#else
+  guint32 eax, edx;
+
+  __asm__ __volatile__ ("xgetbv":"=a" (eax), "=d" (edx):"c" (0));
+  return ((guint64) edx << 32) | eax;
+#endif
+}
+
+static GstCpuFlags
+detect_flags (void)
+{
+  GstCpuFlags flags = 0;
+  guint32 regs[4], max_leaf;
+  guint64 xcr0 = 0;
+
+  cpuid (0, 0, regs);
+  max_leaf = regs[0];
+  if (max_leaf < 1)
+    return 0;
+
+  cpuid (1, 0, regs);
+  if (regs[3] & (1 << 26))
+    flags |= GST_CPU_FLAG_SSE2;
+  if (regs[2] & (1 << 20))
+    flags |= GST_CPU_FLAG_SSE4_2;
+
+  /* AVX needs the OS to save the YMM registers */
+  if (regs[2] & (1 << 27))
+    xcr0 = xgetbv ();
+  if ((regs[2] & (1 << 28)) && (xcr0 & 0x6) == 0x6)
+    flags |= GST_CPU_FLAG_AVX;
+
+  if (max_leaf >= 7 && (flags & GST_CPU_FLAG_AVX)) {
+    cpuid (7, 0, regs);
+    if (regs[1] & (1 << 5))
+      flags |= GST_CPU_FLAG_AVX2;
+    /* AVX-512 also needs the opmask and ZMM state */
+    if ((regs[1] & (1 << 16)) && (regs[1] & (1u << 30))
+        && (xcr0 & 0xe6) == 0xe6)
+      flags |= GST_CPU_FLAG_AVX512;
+  }
+
+  return flags;
+}
+#elif defined(HAVE_CPU_AARCH64) || defined(__ARM_NEON__)
+static GstCpuFlags
+detect_flags (void)
+{
+  return GST_CPU_FLAG_NEON;
+}
+#else
+static GstCpuFlags
+detect_flags (void)
+{
+  return 0;
+}
+#endif
+
+static GstCpuFlags
+parse_disabled (const gchar * env)
+{
+  GstCpuFlags disabled = 0;
+  gchar **names;
+  guint i, j;
+
+  names = g_strsplit (env, ",", -1);
+  for (i = 0; names[i]; i++) {
+    g_strstrip (names[i]);
+    if (g_ascii_strcasecmp (names[i], "all") == 0) {
+      disabled = ~0;
+      break;
+    }
+    for (j = 0; j < G_N_ELEMENTS (flag_names); j++) {
+      if (g_ascii_strcasecmp (names[i], flag_names[j].name) == 0)
+        disabled |= flag_names[j].flag;
+    }
+  }
+  g_strfreev (names);
+
+  return disabled;
+}
+
+/* Returns: the CPU features that kernels may use, without the ones disabled
+ * with GST_CPU_DISABLE */
+GstCpuFlags
+_gst_cpu_get_flags (void)
+{
+  static gsize flags = 0;
+
+  /* can be called before gst_init() by the other libraries */
+  if (g_once_init_enter (&flags)) {
+    GstCpuFlags detected;
+    const gchar *env;
+
+    detected = detect_flags ();
+    if ((env = g_getenv ("GST_CPU_DISABLE")))
+      detected &= ~parse_disabled (env);
+
+    /* 0 is the unset value */
+    g_once_init_leave (&flags, detected | (1u << 31));
+  }
+
+  return flags & ~(1u << 31);
+}
+
+/* @impls is ordered from the most to the least specialized implementation,
+ * the last one must be the generic one without flags.
+ *
+ * Returns: the function of the first implementation whose flags are all
+ * supported by the CPU */
+gpointer
+_gst_cpu_select (const gchar * kernel, const GstCpuImpl * impls,
+    guint n_impls)
+{
+  GstCpuFlags flags = _gst_cpu_get_flags ();
+  guint i;
+
+  g_return_val_if_fail (n_impls > 0, NULL);
+
+  for (i = 0; i < n_impls - 1; i++) {
+    if ((impls[i].flags & flags) == impls[i].flags)
+      break;
+  }
+
+  /* no logging, the debug system might not be initialized yet */
+  return impls[i].func;
+}
@@ -0,0 +1,91 @@
+/* GStreamer
+ * gstcpu.h: Private header for CPU feature detection and kernel selection
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_CPU_H__
+#define __GST_CPU_H__
+
+#include <glib.h>
+#include <gst/gstconfig.h>
+
+G_BEGIN_DECLS
+
+/* The functions are exported for the libraries in this tree but are not part
+ * of the API, their use outside of it is not supported. */
+
+typedef enum {
+  GST_CPU_FLAG_NONE   = 0,
+  GST_CPU_FLAG_SSE2   = (1 << 0),
+  GST_CPU_FLAG_SSE4_2 = (1 << 1),
+  GST_CPU_FLAG_AVX    = (1 << 2),
+  GST_CPU_FLAG_AVX2   = (1 << 3),
+  /* AVX-512 foundation and byte/word instructions */
+  GST_CPU_FLAG_AVX512 = (1 << 4),
+  GST_CPU_FLAG_NEON   = (1 << 5)
+} GstCpuFlags;
+
+/* the kernels the compiler can build, independent of the CPU we run on. AVX
+ * and AVX2 kernels are built with GST_CPU_TARGET() so that the rest of the
+ * code doesn't need the instructions. */
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GST_CPU_HAVE_SSE2 1
+#endif
+
+#if defined(GST_CPU_HAVE_SSE2) && (defined(__clang__) || \
+    (defined(__GNUC__) && \
+     (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define GST_CPU_HAVE_AVX 1
+#define GST_CPU_TARGET(isa) __attribute__ ((target (isa)))
+#endif
+
+#if defined(__aarch64__) && defined(__GNUC__)
+#define GST_CPU_HAVE_NEON64 1
+#endif
+
+/* one implementation of a kernel, @func is used when the CPU supports all
+ * of @flags */
+typedef struct {
+  const gchar *name;
+  GstCpuFlags  flags;
+  gpointer     func;
+} GstCpuImpl;
+
+GST_EXPORT
+GstCpuFlags  _gst_cpu_get_flags (void);
+
+GST_EXPORT
+gpointer     _gst_cpu_select    (const gchar * kernel,
+                                 const GstCpuImpl * impls, guint n_impls);
+
+/* declares a function pointer @name that selects the implementation from the
+ * GstCpuImpl array @impls the first time it is called */
+#define GST_CPU_DISPATCH(ret, name, impls, params, args)                \
+static ret name##_resolve params;                                       \
+static ret (*name) params = name##_resolve;                             \
+static ret                                                              \
+name##_resolve params                                                   \
+{                                                                       \
+  gpointer func = _gst_cpu_select (#name, impls, G_N_ELEMENTS (impls)); \
+  g_atomic_pointer_set (&name, func);                                   \
+  return ((ret (*) params) func) args;                                  \
+}
+
+G_END_DECLS
+
+#endif /* __GST_CPU_H__ */
@@ -0,0 +1,201 @@
+/* GStreamer
+ * gstmemcpy.c: copy kernels for large memory copies
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Copying a whole video frame with memcpy pulls the destination into the
+ * cache, evicting everything the other threads of the pipeline were working
+ * on, while the copy itself is rarely read back before it is evicted again.
+ * Above a threshold the copies of buffer and memory data use non-temporal
+ * stores that write around the cache.
+ *
+ * The kernel is selected once at init time with _gst_cpu_select(): AVX or
+ * SSE2 on x86, NEON on aarch64 and plain memcpy elsewhere. The threshold
+ * defaults to GST_MEMCPY_DEFAULT_STREAM_THRESHOLD and can be changed with
+ * the GST_MEMCPY_STREAM_THRESHOLD environment variable, 0 disables the
+ * non-temporal copies.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gst_private.h"
+#include "gstcpu.h"
+#include "gstmemcpy.h"
+
+#ifdef GST_CPU_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef GST_CPU_HAVE_AVX
+#include <immintrin.h>
+#endif
+
+typedef void (*CopyFunc) (guint8 * dest, const guint8 * src, gsize size);
+
+/* G_MAXSIZE until initialized, all copies use memcpy then */
+gsize _priv_gst_memcpy_stream_threshold = G_MAXSIZE;
+
+static void
+copy_generic (guint8 * dest, const guint8 * src, gsize size)
+{
+  memcpy (dest, src, size);
+}
+
+static CopyFunc stream_copy = copy_generic;
+
+/* the kernels copy the unaligned head and the tail with memcpy and the aligned
+ * middle part in blocks of 64 bytes, one cache line */
+#define BLOCK_SIZE      64
+
+/* how far ahead of the loads the source is prefetched */
+#define PREFETCH_AHEAD  (8 * BLOCK_SIZE)
+
+#ifdef GST_CPU_HAVE_SSE2
+static void
+copy_sse2 (guint8 * dest, const guint8 * src, gsize size)
+{
+  gsize head = MIN ((-(guintptr) dest) & 15, size);
+
+  memcpy (dest, src, head);
+  dest += head;
+  src += head;
+  size -= head;
+
+  while (size >= BLOCK_SIZE) {
+    __m128i a, b, c, d;
+
+    _mm_prefetch ((const char *) src + PREFETCH_AHEAD, _MM_HINT_NTA);
+    a = _mm_loadu_si128 ((const __m128i *) src);
+    b = _mm_loadu_si128 ((const __m128i *) (src + 16));
+    c = _mm_loadu_si128 ((const __m128i *) (src + 32));
+    d = _mm_loadu_si128 ((const __m128i *) (src + 48));
+    _mm_stream_si128 ((__m128i *) dest, a);
+    _mm_stream_si128 ((__m128i *) (dest + 16), b);
+    _mm_stream_si128 ((__m128i *) (dest + 32), c);
+    _mm_stream_si128 ((__m128i *) (dest + 48), d);
+    dest += BLOCK_SIZE;
+    src += BLOCK_SIZE;
+    size -= BLOCK_SIZE;
+  }
+  /* make the non-temporal stores visible before anyone else reads them */
+  _mm_sfence ();
+
+  memcpy (dest, src, size);
+}
+#endif
+
+#ifdef GST_CPU_HAVE_AVX
+GST_CPU_TARGET ("avx")
+static void
+copy_avx (guint8 * dest, const guint8 * src, gsize size)
+{
+  gsize head = MIN ((-(guintptr) dest) & 31, size);
+
+  memcpy (dest, src, head);
+  dest += head;
+  src += head;
+  size -= head;
+
+  while (size >= BLOCK_SIZE) {
+    __m256i a, b;
+
+    _mm_prefetch ((const char *) src + PREFETCH_AHEAD, _MM_HINT_NTA);
+    a = _mm256_loadu_si256 ((const __m256i *) src);
+    b = _mm256_loadu_si256 ((const __m256i *) (src + 32));
+    _mm256_stream_si256 ((__m256i *) dest, a);
+    _mm256_stream_si256 ((__m256i *) (dest + 32), b);
+    dest += BLOCK_SIZE;
+    src += BLOCK_SIZE;
+    size -= BLOCK_SIZE;
+  }
+  _mm_sfence ();
+  /* avoid the penalty of mixing AVX and SSE code in memcpy */
+  _mm256_zeroupper ();
+
+  memcpy (dest, src, size);
+}
+#endif
+
+#ifdef GST_CPU_HAVE_NEON64
+static void
+copy_neon (guint8 * dest, const guint8 * src, gsize size)
+{
+  gsize head = MIN ((-(guintptr) dest) & 15, size);
+
+  memcpy (dest, src, head);
+  dest += head;
+  src += head;
+  size -= head;
+
+  /* stnp is a store pair with a non-temporal hint */
+  while (size >= BLOCK_SIZE) {
+    __asm__ __volatile__ ("prfm pldl1strm, [%1, #%c2]\n\t"
+        "ldp q0, q1, [%1]\n\t"
+        "ldp q2, q3, [%1, #32]\n\t"
+        "stnp q0, q1, [%0]\n\t"
+        "stnp q2, q3, [%0, #32]\n\t"
+        ::"r" (dest), "r" (src), "i" (PREFETCH_AHEAD)
+        :"v0", "v1", "v2", "v3", "memory");
+    dest += BLOCK_SIZE;
+    src += BLOCK_SIZE;
+    size -= BLOCK_SIZE;
+  }
+  __asm__ __volatile__ ("dmb ishst":::"memory");
+
+  memcpy (dest, src, size);
+}
+#endif
+
+static const GstCpuImpl copy_impls[] = {
+#ifdef GST_CPU_HAVE_AVX
+  {"avx", GST_CPU_FLAG_AVX, (gpointer) copy_avx},
+#endif
+#ifdef GST_CPU_HAVE_SSE2
+  {"sse2", GST_CPU_FLAG_SSE2, (gpointer) copy_sse2},
+#endif
+#ifdef GST_CPU_HAVE_NEON64
+  {"neon", GST_CPU_FLAG_NEON, (gpointer) copy_neon},
+#endif
+  {"generic", GST_CPU_FLAG_NONE, (gpointer) copy_generic}
+};
+
+void
+_priv_gst_memcpy_initialize (void)
+{
+  const gchar *env;
+  gsize threshold = GST_MEMCPY_DEFAULT_STREAM_THRESHOLD;
+
+  if ((env = g_getenv ("GST_MEMCPY_STREAM_THRESHOLD")))
+    threshold = g_ascii_strtoull (env, NULL, 10);
+
+  stream_copy = _gst_cpu_select ("stream copy", copy_impls,
+      G_N_ELEMENTS (copy_impls));
+
+  if (threshold == 0 || stream_copy == copy_generic)
+    threshold = G_MAXSIZE;
+  _priv_gst_memcpy_stream_threshold = threshold;
+
+  GST_CAT_DEBUG (GST_CAT_MEMORY, "stream copy for %" G_GSIZE_FORMAT
+      " bytes and more", threshold);
+}
+
+void
+_priv_gst_memcpy_stream (gpointer dest, gconstpointer src, gsize size)
+{
+  stream_copy (dest, src, size);
+}
@@ -0,0 +1,52 @@
+/* GStreamer
+ * gstmemcpy.h: Private header for the large memory copy kernels
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_MEMCPY_H__
+#define __GST_MEMCPY_H__
+
+#include <string.h>
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* copies of at least this many bytes bypass the cache by default */
+#define GST_MEMCPY_DEFAULT_STREAM_THRESHOLD  (4 * 1024 * 1024)
+
+G_GNUC_INTERNAL void      _priv_gst_memcpy_initialize  (void);
+
+G_GNUC_INTERNAL void      _priv_gst_memcpy_stream      (gpointer dest,
+                                                        gconstpointer src,
+                                                        gsize size);
+
+/* a copy with non-temporal stores is only worth it when the destination
+ * doesn't fit in the cache anyway, smaller copies use plain memcpy */
+G_GNUC_INTERNAL extern gsize _priv_gst_memcpy_stream_threshold;
+
+static inline void
+_priv_gst_memcpy (gpointer dest, gconstpointer src, gsize size)
+{
+  if (G_UNLIKELY (size >= _priv_gst_memcpy_stream_threshold))
+    _priv_gst_memcpy_stream (dest, src, size);
+  else
+    memcpy (dest, src, size);
+}
+
+G_END_DECLS
+
+#endif /* __GST_MEMCPY_H__ */
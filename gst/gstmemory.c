@@ -69,6 +69,7 @@
 
 #include "gst_private.h"
 #include "gstmemory.h"
+#include "gstmemcpy.h"
 
 GType _gst_memory_type = 0;
 GST_DEFINE_MINI_OBJECT_TYPE (GstMemory, gst_memory);
@@ -117,6 +118,9 @@ gst_memory_init (GstMemory * mem, GstMemoryFlags flags,
     GstAllocator * allocator, GstMemory * parent, gsize maxsize, gsize align,
     gsize offset, gsize size)
 {
+  /* shares copy the flags of their parent, they are never accounted */
+  flags &= ~GST_MEMORY_FLAG_ACCOUNTED;
+
   gst_mini_object_init (GST_MINI_OBJECT_CAST (mem),
       flags | GST_MINI_OBJECT_FLAG_LOCKABLE, GST_TYPE_MEMORY,
       (GstMiniObjectCopyFunction) _gst_memory_copy, NULL,
@@ -134,6 +138,9 @@ gst_memory_init (GstMemory * mem, GstMemoryFlags flags,
   mem->offset = offset;
   mem->size = size;
 
+  if (parent == NULL)
+    _priv_gst_allocator_account_memory (mem);
+
   GST_CAT_DEBUG (GST_CAT_MEMORY, "new memory %p, maxsize:%" G_GSIZE_FORMAT
       " offset:%" G_GSIZE_FORMAT " size:%" G_GSIZE_FORMAT, mem, maxsize,
       offset, size);
@@ -462,4 +469,6 @@ void
 _priv_gst_memory_initialize (void)
 {
   _gst_memory_type = gst_memory_get_type ();
+
+  _priv_gst_memcpy_initialize ();
 }
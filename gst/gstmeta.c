@@ -51,22 +51,59 @@
 #include "gstinfo.h"
 #include "gstutils.h"
 
-static GHashTable *metainfo = NULL;
-static GRWLock lock;
+/* The registered implementations and the tags of the registered APIs are
+ * kept in hash tables that are never modified once they are published.
+ * Registering copies the table, adds the new entry and publishes the copy so
+ * that lookups only need an atomic load. Replaced tables are kept around
+ * because readers might still be using them, registrations are rare, and are
+ * freed in gst_deinit(). */
+static GMutex lock;
+static GHashTable *metainfo = NULL;     /* impl name -> GstMetaInfo */
+static GHashTable *apitags = NULL;      /* API GType -> 0 terminated GQuarks */
+static GSList *retired = NULL;
 
 GQuark _gst_meta_transform_copy;
 GQuark _gst_meta_tag_memory;
 
+/* call with the lock */
+static void
+publish_with_entry (GHashTable ** table, GHashFunc hash_func,
+    GEqualFunc equal_func, gpointer key, gpointer value)
+{
+  GHashTable *old = *table, *copy;
+  GHashTableIter iter;
+  gpointer k, v;
+
+  copy = g_hash_table_new (hash_func, equal_func);
+  g_hash_table_iter_init (&iter, old);
+  while (g_hash_table_iter_next (&iter, &k, &v))
+    g_hash_table_insert (copy, k, v);
+  g_hash_table_insert (copy, key, value);
+
+  g_atomic_pointer_set (table, copy);
+  retired = g_slist_prepend (retired, old);
+}
+
 void
 _priv_gst_meta_initialize (void)
 {
-  g_rw_lock_init (&lock);
+  g_mutex_init (&lock);
   metainfo = g_hash_table_new (g_str_hash, g_str_equal);
+  apitags = g_hash_table_new (g_direct_hash, g_direct_equal);
 
   _gst_meta_transform_copy = g_quark_from_static_string ("gst-copy");
   _gst_meta_tag_memory = g_quark_from_static_string ("memory");
 }
 
+void
+_priv_gst_meta_cleanup (void)
+{
+  g_mutex_lock (&lock);
+  g_slist_free_full (retired, (GDestroyNotify) g_hash_table_unref);
+  retired = NULL;
+  g_mutex_unlock (&lock);
+}
+
 /**
  * gst_meta_api_type_register:
  * @api: an API to register
@@ -89,13 +126,20 @@ gst_meta_api_type_register (const gchar * api, const gchar ** tags)
   type = g_pointer_type_register_static (api);
 
   if (type != 0) {
+    GQuark *quarks;
     gint i;
 
+    quarks = g_new0 (GQuark, g_strv_length ((gchar **) tags) + 1);
     for (i = 0; tags[i]; i++) {
       GST_CAT_DEBUG (GST_CAT_META, "  adding tag \"%s\"", tags[i]);
-      g_type_set_qdata (type, g_quark_from_string (tags[i]),
-          GINT_TO_POINTER (TRUE));
+      quarks[i] = g_quark_from_string (tags[i]);
+      g_type_set_qdata (type, quarks[i], GINT_TO_POINTER (TRUE));
     }
+
+    g_mutex_lock (&lock);
+    publish_with_entry (&apitags, g_direct_hash, g_direct_equal,
+        GSIZE_TO_POINTER (type), quarks);
+    g_mutex_unlock (&lock);
   }
 
   g_type_set_qdata (type, g_quark_from_string ("tags"),
@@ -116,10 +160,22 @@ gst_meta_api_type_register (const gchar * api, const gchar ** tags)
 gboolean
 gst_meta_api_type_has_tag (GType api, GQuark tag)
 {
+  const GQuark *quarks;
+
   g_return_val_if_fail (api != 0, FALSE);
   g_return_val_if_fail (tag != 0, FALSE);
 
-  return g_type_get_qdata (api, tag) != NULL;
+  /* this avoids the type system lock of g_type_get_qdata() */
+  quarks = g_hash_table_lookup (g_atomic_pointer_get (&apitags),
+      GSIZE_TO_POINTER (api));
+  if (G_UNLIKELY (quarks == NULL))
+    return g_type_get_qdata (api, tag) != NULL;
+
+  for (; *quarks; quarks++) {
+    if (*quarks == tag)
+      return TRUE;
+  }
+  return FALSE;
 }
 
 /**
@@ -196,9 +252,10 @@ gst_meta_register (GType api, const gchar * impl, gsize size,
       "register \"%s\" implementing \"%s\" of size %" G_GSIZE_FORMAT, impl,
       g_type_name (api), size);
 
-  g_rw_lock_writer_lock (&lock);
-  g_hash_table_insert (metainfo, (gpointer) impl, (gpointer) info);
-  g_rw_lock_writer_unlock (&lock);
+  g_mutex_lock (&lock);
+  publish_with_entry (&metainfo, g_str_hash, g_str_equal, (gpointer) impl,
+      (gpointer) info);
+  g_mutex_unlock (&lock);
 
   return info;
 }
@@ -220,9 +277,7 @@ gst_meta_get_info (const gchar * impl)
 
   g_return_val_if_fail (impl != NULL, NULL);
 
-  g_rw_lock_reader_lock (&lock);
-  info = g_hash_table_lookup (metainfo, impl);
-  g_rw_lock_reader_unlock (&lock);
+  info = g_hash_table_lookup (g_atomic_pointer_get (&metainfo), impl);
 
   return info;
 }
@@ -69,7 +69,8 @@
  * functions to query the current sticky CAPS event on a pad.
  *
  * GstElements will use gst_pad_push() and gst_pad_pull_range() to push out
- * or pull in a buffer.
+ * or pull in a buffer. With gst_pad_set_batching() the buffers pushed on a
+ * source pad are collected and pushed downstream in a #GstBufferList.
  *
  * The dataflow, events and queries that happen on a pad can be monitored with
  * probes that can be installed with gst_pad_add_probe(). gst_pad_is_blocked()
@@ -135,15 +136,74 @@ typedef struct
   GstEvent *event;
 } PadEvent;
 
+/* The sticky events that exist only once per pad have a fixed slot, in the
+ * order they are pushed. The STICKY_MULTI events, and sticky events we don't
+ * know about, are kept in a list sorted by type. EOS always goes last. */
+typedef enum
+{
+  STICKY_SLOT_STREAM_START,
+  STICKY_SLOT_CAPS,
+  STICKY_SLOT_SEGMENT,
+  STICKY_SLOT_BUFFERSIZE,
+  STICKY_SLOT_STREAM_GROUP_DONE,
+  STICKY_SLOT_EOS,
+  N_STICKY_SLOTS
+} StickySlot;
+
+/* bit in the pending mask for the events in the list */
+#define PENDING_LIST (1 << N_STICKY_SLOTS)
+
+/* the valid probes that can match a probe type, in the order in which they
+ * are called. Protected by the object lock, a dispatch keeps a ref while it
+ * calls the probes without the lock. */
+typedef struct
+{
+  gint refcount;
+  GstPadProbeType type;
+  guint n_hooks;
+  GHook *hooks[1];
+} ProbeTable;
+
+/* a pad sees a handful of different probe types, when more are used the
+ * tables are rebuilt */
+#define N_PROBE_TABLES 16
+
+/* the state of the caps cookies of a pad, see caps_cache_stamp() */
+typedef struct
+{
+  gpointer scope;
+  guint cookie;
+  guint global;
+} CapsCacheStamp;
+
+/* a caps query result of a pad with GST_PAD_FLAG_CACHE_CAPS, valid as long as
+ * @stamp matches the current one of the pad */
+typedef struct
+{
+  GstCaps *filter;
+  GstCaps *result;
+  CapsCacheStamp stamp;
+} CapsCacheEntry;
+
+#define N_CAPS_CACHE_ENTRIES 4
+
 struct _GstPadPrivate
 {
   guint events_cookie;
+  PadEvent sticky[N_STICKY_SLOTS];
   GArray *events;
+  /* the slots with events that were not received yet, plus PENDING_LIST when
+   * there are such events in the list */
+  guint pending;
   guint last_cookie;
 
-  gint using;
+  gint using;                   /* atomic, the fast path doesn't lock */
   guint probe_list_cookie;
   guint probe_cookie;
+  /* the probes that match a probe type, built when a type is dispatched and
+   * dropped when probes are added or removed */
+  ProbeTable *probe_tables[N_PROBE_TABLES];
+  guint n_probe_tables;
 
   /* counter of how many idle probes are running directly from the add_probe
    * call. Used to block any data flowing in the pad while the idle callback
@@ -154,6 +214,25 @@ struct _GstPadPrivate
    * by a single thread at a time. Protected by the object lock */
   GCond activation_cond;
   gboolean in_activation;
+
+  /* the peer of a source pad in push mode without probes, published for the
+   * push fast path. Changed with the object lock, fast_readers counts the
+   * threads that are about to take a ref on it. */
+  GstPad *fast_peer;
+  gint fast_readers;
+
+  /* caps query results, protected by the LOCK */
+  CapsCacheEntry caps_cache[N_CAPS_CACHE_ENTRIES];
+  guint caps_cache_next;
+
+  /* buffers collected by gst_pad_push() for a batch, protected by the LOCK.
+   * batch_pending is set atomically together with batch so that the push
+   * functions can check it without the LOCK */
+  GstBufferList *batch;
+  gint batch_pending;
+  GstClockTime batch_start;
+  guint batch_max;
+  GstClockTime batch_latency;
 };
 
 typedef struct
@@ -177,6 +256,21 @@ typedef struct
   guint cookie;
 } ProbeMarshall;
 
+/* changed when anything that can change the result of a caps query happens:
+ * links, reconfigure events and marks, caps events and pad templates. The
+ * changes are counted per topmost bin of the pad, in a cookie attached to the
+ * bin with caps_cookie_quark, so that one pipeline doesn't drop the cached
+ * results of all others. Changes on pads outside of a bin change
+ * caps_cache_global, which makes all cached results stale. New bin cookies
+ * start at caps_cache_next so that a bin at the address of a freed one
+ * doesn't match its stamps. */
+static GQuark caps_cookie_quark;
+static gint caps_cache_global = 0;
+static gint caps_cache_next = 0;
+
+static void caps_cache_clear (GstPad * pad);
+static void caps_cache_invalidate (GstPad * pad);
+
 static void gst_pad_dispose (GObject * object);
 static void gst_pad_finalize (GObject * object);
 static void gst_pad_set_property (GObject * object, guint prop_id,
@@ -309,6 +403,7 @@ gst_pad_link_get_name (GstPadLinkReturn ret)
   buffer_quark = g_quark_from_static_string ("buffer"); \
   buffer_list_quark = g_quark_from_static_string ("bufferlist"); \
   event_quark = g_quark_from_static_string ("event"); \
+  caps_cookie_quark = g_quark_from_static_string ("GstPadCapsCookie"); \
   \
   for (i = 0; i < G_N_ELEMENTS (flow_quarks); i++) {			\
     flow_quarks[i].quark = g_quark_from_static_string (flow_quarks[i].name); \
@@ -419,40 +514,198 @@ gst_pad_init (GstPad * pad)
 
   g_hook_list_init (&pad->probes, sizeof (GstProbe));
 
-  pad->priv->events = g_array_sized_new (FALSE, TRUE, sizeof (PadEvent), 16);
+  pad->priv->events = g_array_sized_new (FALSE, TRUE, sizeof (PadEvent), 4);
   pad->priv->events_cookie = 0;
   pad->priv->last_cookie = -1;
   g_cond_init (&pad->priv->activation_cond);
 
+  pad->priv->batch_latency = GST_CLOCK_TIME_NONE;
+
   pad->ABI.abi.last_flowret = GST_FLOW_FLUSHING;
 }
 
+static inline gint
+sticky_slot (GstEventType type)
+{
+  switch (type) {
+    case GST_EVENT_STREAM_START:
+      return STICKY_SLOT_STREAM_START;
+    case GST_EVENT_CAPS:
+      return STICKY_SLOT_CAPS;
+    case GST_EVENT_SEGMENT:
+      return STICKY_SLOT_SEGMENT;
+    case GST_EVENT_BUFFERSIZE:
+      return STICKY_SLOT_BUFFERSIZE;
+    case GST_EVENT_STREAM_GROUP_DONE:
+      return STICKY_SLOT_STREAM_GROUP_DONE;
+    case GST_EVENT_EOS:
+      return STICKY_SLOT_EOS;
+    default:
+      return -1;
+  }
+}
+
+/* the key sticky events are ordered by */
+static inline guint
+sticky_order (GstEventType type)
+{
+  return type == GST_EVENT_EOS ? G_MAXUINT : (guint) type;
+}
+
+static inline gboolean
+is_slot_event (GstPad * pad, PadEvent * ev)
+{
+  return ev >= pad->priv->sticky && ev < pad->priv->sticky + N_STICKY_SLOTS;
+}
+
+/* position of an iteration over the sticky events of a pad */
+typedef struct
+{
+  guint slot;
+  guint idx;
+} EventCursor;
+
+#define EVENT_CURSOR_INIT { 0, 0 }
+
+/* Returns the next event after @cursor in the order they are pushed, only
+ * the ones that were not received yet when @pending_only is set. Should be
+ * called with LOCK */
+static PadEvent *
+next_event (GstPad * pad, EventCursor * cursor, gboolean pending_only)
+{
+  GstPadPrivate *priv = pad->priv;
+  PadEvent *ev = NULL, *lev = NULL;
+  GArray *events = priv->events;
+  guint slot = cursor->slot, idx = cursor->idx;
+
+  if (pending_only) {
+    guint bits = priv->pending & (PENDING_LIST - 1) & ~((1u << slot) - 1);
+
+    slot = bits ? g_bit_nth_lsf (bits, -1) : N_STICKY_SLOTS;
+  } else {
+    while (slot < N_STICKY_SLOTS && priv->sticky[slot].event == NULL)
+      slot++;
+  }
+  if (slot < N_STICKY_SLOTS)
+    ev = &priv->sticky[slot];
+
+  if (!pending_only || (priv->pending & PENDING_LIST)) {
+    for (; idx < events->len; idx++) {
+      lev = &g_array_index (events, PadEvent, idx);
+      if (lev->event != NULL && (!pending_only || !lev->received))
+        break;
+    }
+    if (idx == events->len)
+      lev = NULL;
+  }
+
+  if (lev && (ev == NULL || sticky_order (GST_EVENT_TYPE (lev->event)) <
+          sticky_order (GST_EVENT_TYPE (ev->event)))) {
+    cursor->slot = slot;
+    cursor->idx = idx + 1;
+    return lev;
+  }
+  cursor->slot = slot + 1;
+  cursor->idx = idx;
+
+  return ev;
+}
+
+/* should be called with LOCK */
+static void
+update_list_pending (GstPad * pad)
+{
+  GArray *events = pad->priv->events;
+  guint i;
+
+  pad->priv->pending &= ~PENDING_LIST;
+  for (i = 0; i < events->len; i++) {
+    PadEvent *ev = &g_array_index (events, PadEvent, i);
+
+    if (ev->event != NULL && !ev->received) {
+      pad->priv->pending |= PENDING_LIST;
+      break;
+    }
+  }
+}
+
+/* should be called with LOCK */
+static void
+set_received (GstPad * pad, PadEvent * ev, gboolean received)
+{
+  ev->received = received;
+
+  if (is_slot_event (pad, ev)) {
+    guint bit = 1 << (ev - pad->priv->sticky);
+
+    if (ev->event != NULL && !received)
+      pad->priv->pending |= bit;
+    else
+      pad->priv->pending &= ~bit;
+  } else if (ev->event != NULL && !received) {
+    pad->priv->pending |= PENDING_LIST;
+  } else {
+    update_list_pending (pad);
+  }
+}
+
+/* unrefs and removes @ev, an iteration at @cursor continues with the event
+ * after @ev. Should be called with LOCK */
+static void
+remove_event (GstPad * pad, PadEvent * ev, EventCursor * cursor)
+{
+  gst_event_unref (ev->event);
+
+  if (is_slot_event (pad, ev)) {
+    ev->event = NULL;
+    set_received (pad, ev, FALSE);
+  } else {
+    GArray *events = pad->priv->events;
+    guint idx = ev - &g_array_index (events, PadEvent, 0);
+
+    g_array_remove_index (events, idx);
+    if (cursor && cursor->idx > idx)
+      cursor->idx--;
+    update_list_pending (pad);
+  }
+  pad->priv->events_cookie++;
+}
+
 /* called when setting the pad inactive. It removes all sticky events from
  * the pad. must be called with object lock */
 static void
 remove_events (GstPad * pad)
 {
-  guint i, len;
+  guint i;
   GArray *events;
   gboolean notify = FALSE;
 
-  events = pad->priv->events;
+  for (i = 0; i < N_STICKY_SLOTS; i++) {
+    PadEvent *ev = &pad->priv->sticky[i];
 
-  len = events->len;
-  for (i = 0; i < len; i++) {
-    PadEvent *ev = &g_array_index (events, PadEvent, i);
-    GstEvent *event = ev->event;
+    if (ev->event == NULL)
+      continue;
+    if (i == STICKY_SLOT_CAPS)
+      notify = TRUE;
 
+    gst_event_unref (ev->event);
     ev->event = NULL;
+    ev->received = FALSE;
+  }
 
-    if (event && GST_EVENT_TYPE (event) == GST_EVENT_CAPS)
-      notify = TRUE;
+  events = pad->priv->events;
+  for (i = 0; i < events->len; i++) {
+    PadEvent *ev = &g_array_index (events, PadEvent, i);
+    GstEvent *event = ev->event;
 
-    gst_event_unref (event);
+    ev->event = NULL;
+    if (event)
+      gst_event_unref (event);
   }
 
   GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_PENDING_EVENTS);
   g_array_set_size (events, 0);
+  pad->priv->pending = 0;
   pad->priv->events_cookie++;
 
   if (notify) {
@@ -472,6 +725,12 @@ find_event_by_type (GstPad * pad, GstEventType type, guint idx)
   guint i, len;
   GArray *events;
   PadEvent *ev;
+  gint slot;
+
+  if ((slot = sticky_slot (type)) >= 0) {
+    ev = &pad->priv->sticky[slot];
+    return (idx == 0 && ev->event != NULL) ? ev : NULL;
+  }
 
   events = pad->priv->events;
   len = events->len;
@@ -501,6 +760,12 @@ find_event (GstPad * pad, GstEvent * event)
   guint i, len;
   GArray *events;
   PadEvent *ev;
+  gint slot;
+
+  if ((slot = sticky_slot (GST_EVENT_TYPE (event))) >= 0) {
+    ev = &pad->priv->sticky[slot];
+    return ev->event == event ? ev : NULL;
+  }
 
   events = pad->priv->events;
   len = events->len;
@@ -521,32 +786,23 @@ found:
 static void
 remove_event_by_type (GstPad * pad, GstEventType type)
 {
-  guint i, len;
-  GArray *events;
+  EventCursor cursor = EVENT_CURSOR_INIT;
   PadEvent *ev;
+  gint slot;
 
-  events = pad->priv->events;
-  len = events->len;
-
-  i = 0;
-  while (i < len) {
-    ev = &g_array_index (events, PadEvent, i);
-    if (ev->event == NULL)
-      goto next;
+  if ((slot = sticky_slot (type)) >= 0) {
+    ev = &pad->priv->sticky[slot];
+    if (ev->event != NULL)
+      remove_event (pad, ev, NULL);
+    return;
+  }
 
+  cursor.slot = N_STICKY_SLOTS;
+  while ((ev = next_event (pad, &cursor, FALSE))) {
     if (GST_EVENT_TYPE (ev->event) > type)
       break;
-    else if (GST_EVENT_TYPE (ev->event) != type)
-      goto next;
-
-    gst_event_unref (ev->event);
-    g_array_remove_index (events, i);
-    len--;
-    pad->priv->events_cookie++;
-    continue;
-
-  next:
-    i++;
+    if (GST_EVENT_TYPE (ev->event) == type)
+      remove_event (pad, ev, &cursor);
   }
 }
 
@@ -557,21 +813,13 @@ remove_event_by_type (GstPad * pad, GstEventType type)
 static void
 schedule_events (GstPad * srcpad, GstPad * sinkpad)
 {
-  gint i, len;
-  GArray *events;
+  EventCursor cursor = EVENT_CURSOR_INIT;
   PadEvent *ev;
   gboolean pending = FALSE;
 
-  events = srcpad->priv->events;
-  len = events->len;
-
-  for (i = 0; i < len; i++) {
-    ev = &g_array_index (events, PadEvent, i);
-    if (ev->event == NULL)
-      continue;
-
+  while ((ev = next_event (srcpad, &cursor, FALSE))) {
     if (sinkpad == NULL || !find_event (sinkpad, ev->event)) {
-      ev->received = FALSE;
+      set_received (srcpad, ev, FALSE);
       pending = TRUE;
     }
   }
@@ -582,27 +830,22 @@ schedule_events (GstPad * srcpad, GstPad * sinkpad)
 typedef gboolean (*PadEventFunction) (GstPad * pad, PadEvent * ev,
     gpointer user_data);
 
-/* should be called with pad LOCK */
+/* should be called with pad LOCK. With @pending_only, @func is only called for
+ * the events that were not received yet */
 static void
-events_foreach (GstPad * pad, PadEventFunction func, gpointer user_data)
+events_foreach (GstPad * pad, gboolean pending_only, PadEventFunction func,
+    gpointer user_data)
 {
-  guint i, len;
-  GArray *events;
+  EventCursor cursor;
   gboolean ret;
   guint cookie;
-
-  events = pad->priv->events;
+  PadEvent *ev;
 
 restart:
   cookie = pad->priv->events_cookie;
-  i = 0;
-  len = events->len;
-  while (i < len) {
-    PadEvent *ev, ev_ret;
-
-    ev = &g_array_index (events, PadEvent, i);
-    if (G_UNLIKELY (ev->event == NULL))
-      goto next;
+  cursor.slot = cursor.idx = 0;
+  while ((ev = next_event (pad, &cursor, pending_only))) {
+    PadEvent ev_ret;
 
     /* take aditional ref, func might release the lock */
     ev_ret.event = gst_event_ref (ev->event);
@@ -619,16 +862,15 @@ restart:
     }
 
     /* store the received state */
-    ev->received = ev_ret.received;
+    if (ev->received != ev_ret.received)
+      set_received (pad, ev, ev_ret.received);
 
     /* if the event changed, we need to do something */
     if (G_UNLIKELY (ev->event != ev_ret.event)) {
       if (G_UNLIKELY (ev_ret.event == NULL)) {
         /* function unreffed and set the event to NULL, remove it */
-        gst_event_unref (ev->event);
-        g_array_remove_index (events, i);
-        len--;
-        cookie = ++pad->priv->events_cookie;
+        remove_event (pad, ev, &cursor);
+        cookie = pad->priv->events_cookie;
         continue;
       } else {
         /* function gave a new event for us */
@@ -640,8 +882,6 @@ restart:
     }
     if (!ret)
       break;
-  next:
-    i++;
   }
 }
 
@@ -726,6 +966,8 @@ gst_pad_dispose (GObject * object)
 
   GST_OBJECT_LOCK (pad);
   remove_events (pad);
+  probe_tables_clear (pad);
+  caps_cache_clear (pad);
   GST_OBJECT_UNLOCK (pad);
 
   g_hook_list_clear (&pad->probes);
@@ -771,6 +1013,8 @@ gst_pad_finalize (GObject * object)
   g_cond_clear (&pad->block_cond);
   g_cond_clear (&pad->priv->activation_cond);
   g_array_free (pad->priv->events, TRUE);
+  if (pad->priv->batch)
+    gst_buffer_list_unref (pad->priv->batch);
 
   G_OBJECT_CLASS (parent_class)->finalize (object);
 }
@@ -967,6 +1211,47 @@ gst_pad_mode_get_name (GstPadMode mode)
   return "unknown";
 }
 
+/* drops the buffers collected for a batch. Should be called with LOCK */
+static void
+drop_batch (GstPad * pad)
+{
+  if (pad->priv->batch) {
+    GST_DEBUG_OBJECT (pad, "dropping batch of %u buffers",
+        gst_buffer_list_length (pad->priv->batch));
+    gst_buffer_list_unref (pad->priv->batch);
+    pad->priv->batch = NULL;
+    g_atomic_int_set (&pad->priv->batch_pending, FALSE);
+  }
+}
+
+/* Publishes the peer of @pad for the push fast path when pushing to it needs
+ * nothing but a call of the chain function: a source pad in push mode
+ * without probes. Call this with the LOCK of @pad after changing its
+ * peer, mode or probes.
+ *
+ * When the peer is retracted we wait for the threads that read the old value
+ * to take their ref, after that the peer can go away. */
+static void
+update_fast_peer (GstPad * pad)
+{
+  GstPad *peer = NULL, *old;
+
+  if (GST_PAD_IS_SRC (pad) && GST_PAD_MODE (pad) == GST_PAD_MODE_PUSH
+      && pad->num_probes == 0)
+    peer = GST_PAD_PEER (pad);
+
+  old = g_atomic_pointer_get (&pad->priv->fast_peer);
+  if (old == peer)
+    return;
+
+  g_atomic_pointer_set (&pad->priv->fast_peer, peer);
+
+  if (old != NULL) {
+    while (g_atomic_int_get (&pad->priv->fast_readers) > 0)
+      g_thread_yield ();
+  }
+}
+
 /* Returns TRUE if pad wasn't already in the new_mode */
 static gboolean
 pre_activate (GstPad * pad, GstPadMode new_mode)
@@ -986,7 +1271,10 @@ pre_activate (GstPad * pad, GstPadMode new_mode)
       GST_DEBUG_OBJECT (pad, "setting PAD_MODE NONE, set flushing");
       GST_PAD_SET_FLUSHING (pad);
       pad->ABI.abi.last_flowret = GST_FLOW_FLUSHING;
+      drop_batch (pad);
+      caps_cache_clear (pad);
       GST_PAD_MODE (pad) = new_mode;
+      update_fast_peer (pad);
       /* unlock blocked pads so element can resume and stop */
       GST_PAD_BLOCK_BROADCAST (pad);
       GST_OBJECT_UNLOCK (pad);
@@ -1008,6 +1296,7 @@ pre_activate (GstPad * pad, GstPadMode new_mode)
       GST_PAD_UNSET_FLUSHING (pad);
       pad->ABI.abi.last_flowret = GST_FLOW_OK;
       GST_PAD_MODE (pad) = new_mode;
+      update_fast_peer (pad);
       if (GST_PAD_IS_SINK (pad)) {
         GstPad *peer;
         /* make sure the peer src pad sends us all events */
@@ -1276,6 +1565,7 @@ failure:
         active ? "activate" : "deactivate", gst_pad_mode_get_name (mode));
     GST_PAD_SET_FLUSHING (pad);
     GST_PAD_MODE (pad) = old;
+    update_fast_peer (pad);
     pad->priv->in_activation = FALSE;
     g_cond_broadcast (&pad->priv->activation_cond);
     GST_OBJECT_UNLOCK (pad);
@@ -1348,6 +1638,115 @@ gst_pad_is_active (GstPad * pad)
   return result;
 }
 
+/* checks if a probe with @flags is called for items of @type */
+static gboolean
+probe_type_matches (GstPadProbeType flags, GstPadProbeType type)
+{
+  /* one of the scheduling types */
+  if ((flags & GST_PAD_PROBE_TYPE_SCHEDULING & type) == 0)
+    return FALSE;
+
+  if (type & GST_PAD_PROBE_TYPE_PUSH) {
+    /* one of the data types for non-idle probes */
+    if ((type & GST_PAD_PROBE_TYPE_IDLE) == 0
+        && (flags & _PAD_PROBE_TYPE_ALL_BOTH_AND_FLUSH & type) == 0)
+      return FALSE;
+  } else if (type & GST_PAD_PROBE_TYPE_PULL) {
+    /* one of the data types for non-idle probes */
+    if ((type & GST_PAD_PROBE_TYPE_BLOCKING) == 0
+        && (flags & _PAD_PROBE_TYPE_ALL_BOTH_AND_FLUSH & type) == 0)
+      return FALSE;
+  } else {
+    /* Type must have PULL or PUSH probe types */
+    g_assert_not_reached ();
+  }
+
+  /* one of the blocking types must match */
+  if ((type & GST_PAD_PROBE_TYPE_BLOCKING) &&
+      (flags & GST_PAD_PROBE_TYPE_BLOCKING & type) == 0)
+    return FALSE;
+  if ((type & GST_PAD_PROBE_TYPE_BLOCKING) == 0 &&
+      (flags & GST_PAD_PROBE_TYPE_BLOCKING))
+    return FALSE;
+  /* only probes that have GST_PAD_PROBE_TYPE_EVENT_FLUSH set */
+  if ((type & GST_PAD_PROBE_TYPE_EVENT_FLUSH) &&
+      (flags & GST_PAD_PROBE_TYPE_EVENT_FLUSH & type) == 0)
+    return FALSE;
+
+  return TRUE;
+}
+
+/* call with LOCK */
+static void
+probe_table_unref (GstPad * pad, ProbeTable * table)
+{
+  guint i;
+
+  if (--table->refcount > 0)
+    return;
+
+  for (i = 0; i < table->n_hooks; i++)
+    g_hook_unref (&pad->probes, table->hooks[i]);
+  g_free (table);
+}
+
+/* drops the tables after the probes changed, call with LOCK */
+static void
+probe_tables_clear (GstPad * pad)
+{
+  GstPadPrivate *priv = pad->priv;
+  guint i;
+
+  for (i = 0; i < priv->n_probe_tables; i++)
+    probe_table_unref (pad, priv->probe_tables[i]);
+  priv->n_probe_tables = 0;
+}
+
+/* get a ref to the table of the probes that match @type, call with LOCK */
+static ProbeTable *
+probe_table_get (GstPad * pad, GstPadProbeType type)
+{
+  GstPadPrivate *priv = pad->priv;
+  ProbeTable *table;
+  GHook *hook;
+  guint i;
+
+  for (i = 0; i < priv->n_probe_tables; i++) {
+    table = priv->probe_tables[i];
+    if (table->type == type)
+      goto done;
+  }
+
+  if (priv->n_probe_tables == N_PROBE_TABLES)
+    probe_tables_clear (pad);
+
+  /* num_probes counts the valid hooks */
+  table = g_malloc (sizeof (ProbeTable) +
+      MAX (pad->num_probes, 1) * sizeof (GHook *));
+  table->refcount = 1;
+  table->type = type;
+  table->n_hooks = 0;
+
+  for (hook = pad->probes.hooks; hook; hook = hook->next) {
+    if (!G_HOOK_IS_VALID (hook))
+      continue;
+    if (!probe_type_matches (hook->flags >> G_HOOK_FLAG_USER_SHIFT, type))
+      continue;
+    g_hook_ref (&pad->probes, hook);
+    table->hooks[table->n_hooks++] = hook;
+  }
+
+  GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
+      "built table with %u of %u probes for type 0x%08x", table->n_hooks,
+      pad->num_probes, type);
+
+  priv->probe_tables[priv->n_probe_tables++] = table;
+
+done:
+  table->refcount++;
+  return table;
+}
+
 static void
 cleanup_hook (GstPad * pad, GHook * hook)
 {
@@ -1374,6 +1773,8 @@ cleanup_hook (GstPad * pad, GHook * hook)
   }
   g_hook_destroy_link (&pad->probes, hook);
   pad->num_probes--;
+  probe_tables_clear (pad);
+  update_fast_peer (pad);
 }
 
 /**
@@ -1438,6 +1839,8 @@ gst_pad_add_probe (GstPad * pad, GstPadProbeType mask,
   /* add the probe */
   g_hook_append (&pad->probes, hook);
   pad->num_probes++;
+  probe_tables_clear (pad);
+  update_fast_peer (pad);
   /* incremenent cookie so that the new hook get's called */
   pad->priv->probe_list_cookie++;
 
@@ -1460,7 +1863,7 @@ gst_pad_add_probe (GstPad * pad, GstPadProbeType mask,
 
   /* call the callback if we need to be called for idle callbacks */
   if ((mask & GST_PAD_PROBE_TYPE_IDLE) && (callback != NULL)) {
-    if (pad->priv->using > 0) {
+    if (g_atomic_int_get (&pad->priv->using) > 0) {
       /* the pad is in use, we can't signal the idle callback yet. Since we set the
        * flag above, the last thread to leave the push will do the callback. New
        * threads going into the push will block. */
@@ -1675,6 +2078,8 @@ gst_pad_mark_reconfigure (GstPad * pad)
   GST_OBJECT_LOCK (pad);
   GST_OBJECT_FLAG_SET (pad, GST_PAD_FLAG_NEED_RECONFIGURE);
   GST_OBJECT_UNLOCK (pad);
+
+  caps_cache_invalidate (pad);
 }
 
 /**
@@ -2153,10 +2558,14 @@ no_sink_parent:
   /* first clear peers */
   GST_PAD_PEER (srcpad) = NULL;
   GST_PAD_PEER (sinkpad) = NULL;
+  update_fast_peer (srcpad);
 
   GST_OBJECT_UNLOCK (sinkpad);
   GST_OBJECT_UNLOCK (srcpad);
 
+  caps_cache_invalidate (srcpad);
+  caps_cache_invalidate (sinkpad);
+
   /* fire off a signal to each of the pads telling them
    * that they've been unlinked */
   g_signal_emit (srcpad, gst_pad_signals[PAD_UNLINKED], 0, sinkpad);
@@ -2511,6 +2920,7 @@ gst_pad_link_full (GstPad * srcpad, GstPad * sinkpad, GstPadLinkCheck flags)
   /* must set peers before calling the link function */
   GST_PAD_PEER (srcpad) = sinkpad;
   GST_PAD_PEER (sinkpad) = srcpad;
+  update_fast_peer (srcpad);
 
   /* check events, when something is different, mark pending */
   schedule_events (srcpad, sinkpad);
@@ -2563,6 +2973,9 @@ gst_pad_link_full (GstPad * srcpad, GstPad * sinkpad, GstPadLinkCheck flags)
   GST_CAT_INFO (GST_CAT_PADS, "linked %s:%s and %s:%s, successful",
       GST_DEBUG_PAD_NAME (srcpad), GST_DEBUG_PAD_NAME (sinkpad));
 
+  caps_cache_invalidate (srcpad);
+  caps_cache_invalidate (sinkpad);
+
   if (!(flags & GST_PAD_LINK_CHECK_NO_RECONFIGURE))
     gst_pad_send_event (srcpad, gst_event_new_reconfigure ());
 
@@ -2597,6 +3010,7 @@ link_failed:
 
     GST_PAD_PEER (srcpad) = NULL;
     GST_PAD_PEER (sinkpad) = NULL;
+    update_fast_peer (srcpad);
 
     GST_OBJECT_UNLOCK (sinkpad);
     GST_OBJECT_UNLOCK (srcpad);
@@ -2635,6 +3049,8 @@ gst_pad_set_pad_template (GstPad * pad, GstPadTemplate * templ)
   gst_object_replace ((GstObject **) template_p, (GstObject *) templ);
   GST_OBJECT_UNLOCK (pad);
 
+  caps_cache_invalidate (pad);
+
   if (templ)
     gst_pad_template_pad_created (templ, pad);
 }
@@ -3442,7 +3858,7 @@ probe_hook_marshal (GHook * hook, ProbeMarshall * data)
 {
   GstPad *pad = data->pad;
   GstPadProbeInfo *info = data->info;
-  GstPadProbeType type, flags;
+  GstPadProbeType flags;
   GstPadProbeCallback callback;
   GstPadProbeReturn ret;
   gpointer original_data;
@@ -3458,13 +3874,8 @@ probe_hook_marshal (GHook * hook, ProbeMarshall * data)
   PROBE_COOKIE (hook) = data->cookie;
 
   flags = hook->flags >> G_HOOK_FLAG_USER_SHIFT;
-  type = info->type;
   original_data = info->data;
 
-  /* one of the scheduling types */
-  if ((flags & GST_PAD_PROBE_TYPE_SCHEDULING & type) == 0)
-    goto no_match;
-
   if (G_UNLIKELY (data->handled)) {
     GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
         "probe previously returned HANDLED, not calling again");
@@ -3475,33 +3886,6 @@ probe_hook_marshal (GHook * hook, ProbeMarshall * data)
     goto no_match;
   }
 
-  if (type & GST_PAD_PROBE_TYPE_PUSH) {
-    /* one of the data types for non-idle probes */
-    if ((type & GST_PAD_PROBE_TYPE_IDLE) == 0
-        && (flags & _PAD_PROBE_TYPE_ALL_BOTH_AND_FLUSH & type) == 0)
-      goto no_match;
-  } else if (type & GST_PAD_PROBE_TYPE_PULL) {
-    /* one of the data types for non-idle probes */
-    if ((type & GST_PAD_PROBE_TYPE_BLOCKING) == 0
-        && (flags & _PAD_PROBE_TYPE_ALL_BOTH_AND_FLUSH & type) == 0)
-      goto no_match;
-  } else {
-    /* Type must have PULL or PUSH probe types */
-    g_assert_not_reached ();
-  }
-
-  /* one of the blocking types must match */
-  if ((type & GST_PAD_PROBE_TYPE_BLOCKING) &&
-      (flags & GST_PAD_PROBE_TYPE_BLOCKING & type) == 0)
-    goto no_match;
-  if ((type & GST_PAD_PROBE_TYPE_BLOCKING) == 0 &&
-      (flags & GST_PAD_PROBE_TYPE_BLOCKING))
-    goto no_match;
-  /* only probes that have GST_PAD_PROBE_TYPE_EVENT_FLUSH set */
-  if ((type & GST_PAD_PROBE_TYPE_EVENT_FLUSH) &&
-      (flags & GST_PAD_PROBE_TYPE_EVENT_FLUSH & type) == 0)
-    goto no_match;
-
   GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
       "hook %lu, cookie %u with flags 0x%08x matches", hook->hook_id,
       PROBE_COOKIE (hook), flags);
@@ -3644,7 +4028,9 @@ do_probe_callbacks (GstPad * pad, GstPadProbeInfo * info,
     GstFlowReturn defaultval)
 {
   ProbeMarshall data;
-  guint cookie;
+  ProbeTable *table;
+  GstPadProbeType type = info->type;
+  guint i, cookie;
   gboolean is_block;
 
   data.pad = pad;
@@ -3668,8 +4054,21 @@ again:
       "do probes cookie %u", data.cookie);
   cookie = pad->priv->probe_list_cookie;
 
-  g_hook_list_marshal (&pad->probes, TRUE,
-      (GHookMarshaller) probe_hook_marshal, &data);
+  /* only the probes that match the type are visited. The table can be
+   * replaced by the callbacks, we keep our own ref to it */
+  table = probe_table_get (pad, type);
+  for (i = 0; i < table->n_hooks; i++) {
+    GHook *hook = table->hooks[i];
+
+    /* removed by one of the callbacks */
+    if (!G_HOOK_IS_VALID (hook))
+      continue;
+
+    probe_hook_marshal (hook, &data);
+    if (data.dropped || data.handled)
+      break;
+  }
+  probe_table_unref (pad, table);
 
   /* if the list changed, call the new callbacks (they will not have their
    * cookie set to data.cookie */
@@ -3810,13 +4209,84 @@ gst_pad_set_offset (GstPad * pad, gint64 offset)
       GST_STIME_ARGS (offset));
 
   /* resend all sticky events with updated offset on next buffer push */
-  events_foreach (pad, mark_event_not_received, NULL);
+  events_foreach (pad, FALSE, mark_event_not_received, NULL);
   GST_OBJECT_FLAG_SET (pad, GST_PAD_FLAG_PENDING_EVENTS);
 
 done:
   GST_OBJECT_UNLOCK (pad);
 }
 
+/**
+ * gst_pad_set_batching:
+ * @pad: a source #GstPad
+ * @max_buffers: the maximum number of buffers in a batch, 0 or 1 disables
+ *     batching
+ * @max_latency: the maximum time between the timestamps of the first and the
+ *     last buffer of a batch, or %GST_CLOCK_TIME_NONE
+ *
+ * Makes gst_pad_push() collect the buffers into a #GstBufferList instead of
+ * pushing them one by one. The list is pushed to the peer of @pad when it
+ * contains @max_buffers buffers or when the DTS, or the PTS when there is no
+ * DTS, of a buffer is @max_latency or more after the one of the first buffer.
+ * With a @max_latency, a buffer without timestamps also completes the batch.
+ * @max_latency only bounds the timestamps of the buffers of a batch, it is
+ * checked when a buffer arrives and there is no timeout that pushes the list
+ * while no buffers arrive.
+ * The peer pad then handles the whole list with one call of its chain list
+ * function, which saves the per-buffer cost of the pad functions and probes.
+ * Data probes on @pad see the lists, with %GST_PAD_PROBE_TYPE_BUFFER_LIST.
+ *
+ * gst_pad_push() returns %GST_FLOW_OK for the buffers that are collected and
+ * the result of pushing the list for the buffer that completes a batch. The
+ * buffers are pushed one by one again as long as a push fails.
+ *
+ * Serialized events and queries, and gst_pad_push_list(), first push the
+ * buffers that were collected. A flush or deactivating @pad drops them. A
+ * producer that can stop pushing buffers for a long time should push an
+ * event, like a GAP event, so that the collected buffers aren't held back.
+ *
+ * Since: 1.14
+ */
+void
+gst_pad_set_batching (GstPad * pad, guint max_buffers,
+    GstClockTime max_latency)
+{
+  g_return_if_fail (GST_IS_PAD (pad));
+  g_return_if_fail (GST_PAD_IS_SRC (pad));
+
+  GST_OBJECT_LOCK (pad);
+  GST_DEBUG_OBJECT (pad, "batching %u buffers, latency %" GST_TIME_FORMAT,
+      max_buffers, GST_TIME_ARGS (max_latency));
+  g_atomic_int_set (&pad->priv->batch_max, max_buffers);
+  pad->priv->batch_latency = max_latency;
+  GST_OBJECT_UNLOCK (pad);
+}
+
+/**
+ * gst_pad_get_batching:
+ * @pad: a source #GstPad
+ * @max_buffers: (out) (allow-none): the maximum number of buffers in a batch
+ * @max_latency: (out) (allow-none): the maximum time between the timestamps
+ *     of the buffers of a batch
+ *
+ * Gets the batching configuration of @pad, see gst_pad_set_batching().
+ *
+ * Since: 1.14
+ */
+void
+gst_pad_get_batching (GstPad * pad, guint * max_buffers,
+    GstClockTime * max_latency)
+{
+  g_return_if_fail (GST_IS_PAD (pad));
+
+  GST_OBJECT_LOCK (pad);
+  if (max_buffers)
+    *max_buffers = pad->priv->batch_max;
+  if (max_latency)
+    *max_latency = pad->priv->batch_latency;
+  GST_OBJECT_UNLOCK (pad);
+}
+
 typedef struct
 {
   GstFlowReturn ret;
@@ -3911,7 +4381,7 @@ check_sticky (GstPad * pad, GstEvent * event)
     GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_PENDING_EVENTS);
 
     GST_DEBUG_OBJECT (pad, "pushing all sticky events");
-    events_foreach (pad, push_sticky, &data);
+    events_foreach (pad, TRUE, push_sticky, &data);
 
     /* If there's an EOS event we must push it downstream
      * even if sending a previous sticky event failed.
@@ -3937,6 +4407,160 @@ check_sticky (GstPad * pad, GstEvent * event)
 }
 
 
+/* call with LOCK */
+static void
+caps_cache_clear (GstPad * pad)
+{
+  GstPadPrivate *priv = pad->priv;
+  guint i;
+
+  for (i = 0; i < N_CAPS_CACHE_ENTRIES; i++) {
+    gst_caps_replace (&priv->caps_cache[i].filter, NULL);
+    gst_caps_replace (&priv->caps_cache[i].result, NULL);
+  }
+}
+
+/* the cookie of the topmost bin of @pad, which is returned with a ref in
+ * @top, or NULL when @pad is not in a bin. Call without LOCK, finding the
+ * topmost bin takes the locks of the parents */
+static gint *
+caps_cache_cookie (GstPad * pad, GstObject ** top)
+{
+  GstObject *parent, *next;
+  gint *cookie;
+
+  parent = gst_object_get_parent (GST_OBJECT_CAST (pad));
+  while (parent && (next = gst_object_get_parent (parent))) {
+    gst_object_unref (parent);
+    parent = next;
+  }
+  *top = parent;
+
+  if (parent == NULL || !GST_IS_BIN (parent))
+    return NULL;
+
+  cookie = g_object_get_qdata ((GObject *) parent, caps_cookie_quark);
+  if (G_UNLIKELY (cookie == NULL)) {
+    cookie = g_new (gint, 1);
+    *cookie = g_atomic_int_add (&caps_cache_next, 1 << 16);
+    if (!g_object_replace_qdata ((GObject *) parent, caps_cookie_quark,
+            NULL, cookie, g_free, NULL)) {
+      g_free (cookie);
+      cookie = g_object_get_qdata ((GObject *) parent, caps_cookie_quark);
+    }
+  }
+  return cookie;
+}
+
+/* take the current state of the cookies that cached results of @pad depend
+ * on. Call without LOCK */
+static void
+caps_cache_stamp (GstPad * pad, CapsCacheStamp * stamp)
+{
+  GstObject *top;
+  gint *cookie = caps_cache_cookie (pad, &top);
+
+  stamp->scope = cookie ? top : NULL;
+  stamp->cookie = cookie ? g_atomic_int_get (cookie) : 0;
+  stamp->global = g_atomic_int_get (&caps_cache_global);
+  if (top)
+    gst_object_unref (top);
+}
+
+static inline gboolean
+caps_cache_stamp_equal (const CapsCacheStamp * a, const CapsCacheStamp * b)
+{
+  return a->scope == b->scope && a->cookie == b->cookie
+      && a->global == b->global;
+}
+
+/* make the cached results in the pipeline of @pad stale, or all of them
+ * when @pad is not in a bin. Call without LOCK */
+static void
+caps_cache_invalidate (GstPad * pad)
+{
+  GstObject *top;
+  gint *cookie = caps_cache_cookie (pad, &top);
+
+  if (cookie)
+    g_atomic_int_inc (cookie);
+  else
+    g_atomic_int_inc (&caps_cache_global);
+  if (top)
+    gst_object_unref (top);
+}
+
+/* answer a caps query from the cache, call with LOCK */
+static gboolean
+caps_cache_lookup (GstPad * pad, GstQuery * query,
+    const CapsCacheStamp * stamp)
+{
+  GstPadPrivate *priv = pad->priv;
+  GstCaps *filter;
+  guint i;
+
+  gst_query_parse_caps (query, &filter);
+
+  for (i = 0; i < N_CAPS_CACHE_ENTRIES; i++) {
+    CapsCacheEntry *entry = &priv->caps_cache[i];
+
+    if (entry->result == NULL || !caps_cache_stamp_equal (&entry->stamp,
+            stamp))
+      continue;
+
+    if (entry->filter != filter && (entry->filter == NULL || filter == NULL
+            || !gst_caps_is_strictly_equal (entry->filter, filter)))
+      continue;
+
+    GST_CAT_LOG_OBJECT (GST_CAT_CAPS, pad, "cached result %" GST_PTR_FORMAT,
+        entry->result);
+    gst_query_set_caps_result (query, entry->result);
+    return TRUE;
+  }
+  return FALSE;
+}
+
+/* store the result of a caps query that was started with @stamp, the result
+ * is not valid anymore when the cookies changed in the meantime */
+static void
+caps_cache_store (GstPad * pad, GstQuery * query,
+    const CapsCacheStamp * stamp)
+{
+  GstPadPrivate *priv = pad->priv;
+  CapsCacheEntry *entry = NULL;
+  CapsCacheStamp now;
+  GstCaps *filter, *result;
+  guint i;
+
+  gst_query_parse_caps (query, &filter);
+  gst_query_parse_caps_result (query, &result);
+  if (result == NULL)
+    return;
+
+  caps_cache_stamp (pad, &now);
+  if (!caps_cache_stamp_equal (&now, stamp))
+    return;
+
+  GST_OBJECT_LOCK (pad);
+  /* reuse a stale entry before replacing the oldest one */
+  for (i = 0; i < N_CAPS_CACHE_ENTRIES; i++) {
+    if (priv->caps_cache[i].result == NULL ||
+        !caps_cache_stamp_equal (&priv->caps_cache[i].stamp, stamp)) {
+      entry = &priv->caps_cache[i];
+      break;
+    }
+  }
+  if (entry == NULL) {
+    entry = &priv->caps_cache[priv->caps_cache_next];
+    priv->caps_cache_next = (priv->caps_cache_next + 1) % N_CAPS_CACHE_ENTRIES;
+  }
+
+  gst_caps_replace (&entry->filter, filter);
+  gst_caps_replace (&entry->result, result);
+  entry->stamp = *stamp;
+  GST_OBJECT_UNLOCK (pad);
+}
+
 /**
  * gst_pad_query:
  * @pad: a #GstPad to invoke the default query on.
@@ -3963,6 +4587,8 @@ gst_pad_query (GstPad * pad, GstQuery * query)
   GstPadQueryFunction func;
   GstPadProbeType type;
   GstFlowReturn ret;
+  gboolean cache_caps;
+  CapsCacheStamp stamp;
 
   g_return_val_if_fail (GST_IS_PAD (pad), FALSE);
   g_return_val_if_fail (GST_IS_QUERY (query), FALSE);
@@ -3986,11 +4612,24 @@ gst_pad_query (GstPad * pad, GstQuery * query)
   if (G_UNLIKELY (serialized))
     GST_PAD_STREAM_LOCK (pad);
 
+  /* take the stamp before the query, so that anything that happens while it
+   * runs makes the result stale */
+  cache_caps = G_UNLIKELY (GST_PAD_IS_CACHE_CAPS (pad))
+      && GST_QUERY_TYPE (query) == GST_QUERY_CAPS;
+  if (cache_caps)
+    caps_cache_stamp (pad, &stamp);
+
   GST_OBJECT_LOCK (pad);
   PROBE_PUSH (pad, type | GST_PAD_PROBE_TYPE_PUSH |
       GST_PAD_PROBE_TYPE_BLOCK, query, probe_stopped);
   PROBE_PUSH (pad, type | GST_PAD_PROBE_TYPE_PUSH, query, probe_stopped);
 
+  if (cache_caps && caps_cache_lookup (pad, query, &stamp)) {
+    GST_OBJECT_UNLOCK (pad);
+    res = TRUE;
+    goto answered;
+  }
+
   ACQUIRE_PARENT (pad, parent, no_parent);
   GST_OBJECT_UNLOCK (pad);
 
@@ -4001,6 +4640,10 @@ gst_pad_query (GstPad * pad, GstQuery * query)
 
   RELEASE_PARENT (parent);
 
+  if (cache_caps && res)
+    caps_cache_store (pad, query, &stamp);
+
+answered:
   GST_DEBUG_OBJECT (pad, "sent query %p (%s), result %d", query,
       GST_QUERY_TYPE_NAME (query), res);
   GST_TRACER_PAD_QUERY_POST (pad, query, res);
@@ -4110,6 +4753,10 @@ gst_pad_peer_query (GstPad * pad, GstQuery * query)
 
   serialized = GST_QUERY_IS_SERIALIZED (query);
 
+  if (G_UNLIKELY (g_atomic_int_get (&pad->priv->batch_pending))
+      && serialized && push_batch (pad) != GST_FLOW_OK)
+    goto batch_failed;
+
   GST_OBJECT_LOCK (pad);
   if (GST_PAD_IS_SRC (pad) && serialized) {
     /* all serialized queries on the srcpad trigger push of
@@ -4160,6 +4807,11 @@ sticky_failed:
     GST_OBJECT_UNLOCK (pad);
     return FALSE;
   }
+batch_failed:
+  {
+    GST_DEBUG_OBJECT (pad, "could not push batch");
+    return FALSE;
+  }
 no_peer:
   {
     GST_INFO_OBJECT (pad, "pad has no peer");
@@ -4449,6 +5101,74 @@ gst_pad_chain_list (GstPad * pad, GstBufferList * list)
       GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_PUSH, list);
 }
 
+#ifndef GST_ENABLE_EXTRA_CHECKS
+/* the flags that make a push take the locked path */
+#define FAST_PUSH_FLAGS_MASK (GST_PAD_FLAG_FLUSHING | GST_PAD_FLAG_EOS | \
+    GST_PAD_FLAG_PENDING_EVENTS)
+
+static void
+fast_push_leave (GstPad * pad)
+{
+  GstFlowReturn ret;
+
+  if (!g_atomic_int_dec_and_test (&pad->priv->using))
+    return;
+
+  /* we were the last user and a probe was added meanwhile, it could be an
+   * idle probe that waits for us */
+  if (G_UNLIKELY (g_atomic_int_get (&pad->num_probes) > 0)) {
+    GST_OBJECT_LOCK (pad);
+    if (g_atomic_int_get (&pad->priv->using) == 0)
+      PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PUSH | GST_PAD_PROBE_TYPE_IDLE,
+          done, GST_FLOW_OK);
+  done:
+    GST_OBJECT_UNLOCK (pad);
+  }
+}
+
+/* Pushes @data to the published peer of @pad without taking the LOCK of @pad.
+ * Returns FALSE when the locked path is needed, @data is untouched then. */
+static inline gboolean
+gst_pad_push_data_fast (GstPad * pad, GstPadProbeType type, void *data,
+    GstFlowReturn * ret)
+{
+  GstPad *peer;
+
+  if (G_UNLIKELY (g_atomic_int_get (&GST_OBJECT_FLAGS (pad)) &
+          FAST_PUSH_FLAGS_MASK))
+    return FALSE;
+
+  /* pads with probes or without a published peer take the locked path, bail
+   * out before we count as a user so that idle probes don't see us */
+  if (G_UNLIKELY (g_atomic_int_get (&pad->num_probes) > 0
+          || g_atomic_pointer_get (&pad->priv->fast_peer) == NULL))
+    return FALSE;
+
+  /* mark the pad as being used before we look at the peer, a probe that is
+   * added from now on sees us */
+  g_atomic_int_inc (&pad->priv->using);
+
+  g_atomic_int_inc (&pad->priv->fast_readers);
+  peer = g_atomic_pointer_get (&pad->priv->fast_peer);
+  if (G_LIKELY (peer != NULL))
+    gst_object_ref (peer);
+  g_atomic_int_add (&pad->priv->fast_readers, -1);
+
+  if (G_UNLIKELY (peer == NULL)) {
+    fast_push_leave (pad);
+    return FALSE;
+  }
+
+  *ret = gst_pad_chain_data_unchecked (peer, type, data);
+  gst_object_unref (peer);
+
+  g_atomic_int_set (&pad->ABI.abi.last_flowret, *ret);
+  fast_push_leave (pad);
+
+  return TRUE;
+}
+#endif
+
 static GstFlowReturn
 gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
 {
@@ -4456,6 +5176,11 @@ gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
   GstFlowReturn ret;
   gboolean handled = FALSE;
 
+#ifndef GST_ENABLE_EXTRA_CHECKS
+  if (gst_pad_push_data_fast (pad, type, data, &ret))
+    return ret;
+#endif
+
   GST_OBJECT_LOCK (pad);
   if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
     goto flushing;
@@ -4505,7 +5230,7 @@ gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
 
   /* take ref to peer pad before releasing the lock */
   gst_object_ref (peer);
-  pad->priv->using++;
+  g_atomic_int_inc (&pad->priv->using);
   GST_OBJECT_UNLOCK (pad);
 
   ret = gst_pad_chain_data_unchecked (peer, type, data);
@@ -4515,8 +5240,7 @@ gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
 
   GST_OBJECT_LOCK (pad);
   pad->ABI.abi.last_flowret = ret;
-  pad->priv->using--;
-  if (pad->priv->using == 0) {
+  if (g_atomic_int_dec_and_test (&pad->priv->using)) {
     /* pad is not active anymore, trigger idle callbacks */
     PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PUSH | GST_PAD_PROBE_TYPE_IDLE,
         probe_stopped, ret);
@@ -4595,6 +5319,116 @@ not_linked:
   }
 }
 
+/* pushes the buffers collected for a batch, must be called from the
+ * streaming thread without LOCK */
+static GstFlowReturn
+push_batch (GstPad * pad)
+{
+  GstBufferList *list;
+  GstFlowReturn ret;
+
+  GST_OBJECT_LOCK (pad);
+  list = pad->priv->batch;
+  pad->priv->batch = NULL;
+  g_atomic_int_set (&pad->priv->batch_pending, FALSE);
+  GST_OBJECT_UNLOCK (pad);
+
+  /* dropped by a flush meanwhile */
+  if (list == NULL)
+    return GST_FLOW_OK;
+
+  GST_TRACER_PAD_PUSH_LIST_PRE (pad, list);
+  ret = gst_pad_push_data (pad,
+      GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_PUSH, list);
+  GST_TRACER_PAD_PUSH_LIST_POST (pad, ret);
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_pad_push_batched (GstPad * pad, GstBuffer * buffer)
+{
+  GstPadPrivate *priv = pad->priv;
+  GstClockTime ts;
+  gboolean full;
+  GstFlowReturn ret;
+
+  GST_OBJECT_LOCK (pad);
+  if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
+    goto flushing;
+
+  if (G_UNLIKELY (GST_PAD_IS_EOS (pad)))
+    goto eos;
+
+  if (G_UNLIKELY (GST_PAD_MODE (pad) != GST_PAD_MODE_PUSH))
+    goto wrong_mode;
+
+  /* only collect while the buffers flow, errors are returned right away */
+  if (G_UNLIKELY (priv->batch_max <= 1
+          || pad->ABI.abi.last_flowret != GST_FLOW_OK)) {
+    GST_OBJECT_UNLOCK (pad);
+    goto push_now;
+  }
+
+  ts = GST_BUFFER_DTS_OR_PTS (buffer);
+  if (priv->batch == NULL) {
+    priv->batch = gst_buffer_list_new_sized (priv->batch_max);
+    priv->batch_start = ts;
+    g_atomic_int_set (&priv->batch_pending, TRUE);
+  }
+  gst_buffer_list_add (priv->batch, buffer);
+
+  full = gst_buffer_list_length (priv->batch) >= priv->batch_max;
+  /* without timestamps we can't bound the latency, push what we have */
+  if (GST_CLOCK_TIME_IS_VALID (priv->batch_latency)
+      && (!GST_CLOCK_TIME_IS_VALID (ts)
+          || !GST_CLOCK_TIME_IS_VALID (priv->batch_start)
+          || ts >= priv->batch_start + priv->batch_latency))
+    full = TRUE;
+  GST_OBJECT_UNLOCK (pad);
+
+  if (!full)
+    return GST_FLOW_OK;
+
+  return push_batch (pad);
+
+push_now:
+  if ((ret = push_batch (pad)) != GST_FLOW_OK) {
+    gst_buffer_unref (buffer);
+    return ret;
+  }
+  return gst_pad_push_data (pad,
+      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_PUSH, buffer);
+
+  /* ERRORS */
+flushing:
+  {
+    GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad,
+        "pushing, but pad was flushing");
+    pad->ABI.abi.last_flowret = GST_FLOW_FLUSHING;
+    GST_OBJECT_UNLOCK (pad);
+    gst_buffer_unref (buffer);
+    return GST_FLOW_FLUSHING;
+  }
+eos:
+  {
+    GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad, "pushing, but pad was EOS");
+    pad->ABI.abi.last_flowret = GST_FLOW_EOS;
+    GST_OBJECT_UNLOCK (pad);
+    gst_buffer_unref (buffer);
+    return GST_FLOW_EOS;
+  }
+wrong_mode:
+  {
+    g_critical ("pushing on pad %s:%s but it was not activated in push mode",
+        GST_DEBUG_PAD_NAME (pad));
+    pad->ABI.abi.last_flowret = GST_FLOW_ERROR;
+    GST_OBJECT_UNLOCK (pad);
+    gst_buffer_unref (buffer);
+    return GST_FLOW_ERROR;
+  }
+}
+
 /**
  * gst_pad_push:
  * @pad: a source #GstPad, returns #GST_FLOW_ERROR if not.
@@ -4627,8 +5461,12 @@ gst_pad_push (GstPad * pad, GstBuffer * buffer)
   g_return_val_if_fail (GST_IS_BUFFER (buffer), GST_FLOW_ERROR);
 
   GST_TRACER_PAD_PUSH_PRE (pad, buffer);
-  res = gst_pad_push_data (pad,
-      GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_PUSH, buffer);
+  if (G_UNLIKELY (g_atomic_int_get (&pad->priv->batch_max) > 1
+          || g_atomic_int_get (&pad->priv->batch_pending)))
+    res = gst_pad_push_batched (pad, buffer);
+  else
+    res = gst_pad_push_data (pad,
+        GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_PUSH, buffer);
   GST_TRACER_PAD_PUSH_POST (pad, res);
   return res;
 }
@@ -4666,6 +5504,14 @@ gst_pad_push_list (GstPad * pad, GstBufferList * list)
   g_return_val_if_fail (GST_PAD_IS_SRC (pad), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_IS_BUFFER_LIST (list), GST_FLOW_ERROR);
 
+  /* the buffers collected before go first */
+  if (G_UNLIKELY (g_atomic_int_get (&pad->priv->batch_pending))) {
+    if ((res = push_batch (pad)) != GST_FLOW_OK) {
+      gst_buffer_list_unref (list);
+      return res;
+    }
+  }
+
   GST_TRACER_PAD_PUSH_LIST_PRE (pad, list);
   res = gst_pad_push_data (pad,
       GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_PUSH, list);
@@ -4955,7 +5801,7 @@ gst_pad_pull_range (GstPad * pad, guint64 offset, guint size,
     goto not_linked;
 
   gst_object_ref (peer);
-  pad->priv->using++;
+  g_atomic_int_inc (&pad->priv->using);
   GST_OBJECT_UNLOCK (pad);
 
   ret = gst_pad_get_range_unchecked (peer, offset, size, &res_buf);
@@ -4963,9 +5809,8 @@ gst_pad_pull_range (GstPad * pad, guint64 offset, guint size,
   gst_object_unref (peer);
 
   GST_OBJECT_LOCK (pad);
-  pad->priv->using--;
   pad->ABI.abi.last_flowret = ret;
-  if (pad->priv->using == 0) {
+  if (g_atomic_int_dec_and_test (&pad->priv->using)) {
     /* pad is not active anymore, trigger idle callbacks */
     PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PULL | GST_PAD_PROBE_TYPE_IDLE,
         probe_stopped_unref, ret);
@@ -5064,6 +5909,33 @@ done:
   return ret;
 }
 
+/* STREAM_START, CAPS and SEGMENT must be delivered in this order. Because
+ * the sticky events are stored ordered we can check that this is respected
+ * when a new event is stored: the first event that must be pushed after it
+ * can't be one of those. Should be called with LOCK */
+static void
+check_sticky_order (GstPad * pad, GstEventType type)
+{
+  EventCursor cursor = EVENT_CURSOR_INIT;
+  PadEvent *ev;
+  GstEventType next_type = GST_EVENT_UNKNOWN;
+
+  while ((ev = next_event (pad, &cursor, FALSE))) {
+    next_type = GST_EVENT_TYPE (ev->event);
+    if (next_type != type && sticky_order (next_type) > sticky_order (type))
+      break;
+  }
+  if (ev == NULL)
+    return;
+
+  if (G_UNLIKELY (next_type <= GST_EVENT_SEGMENT
+          || next_type == GST_EVENT_EOS))
+    g_warning (G_STRLOC
+        ":%s:<%s:%s> Sticky event misordering, got '%s' before '%s'",
+        G_STRFUNC, GST_DEBUG_PAD_NAME (pad),
+        gst_event_type_get_name (next_type), gst_event_type_get_name (type));
+}
+
 /* must be called with pad object lock */
 static GstFlowReturn
 store_sticky_event (GstPad * pad, GstEvent * event)
@@ -5071,9 +5943,10 @@ store_sticky_event (GstPad * pad, GstEvent * event)
   guint i, len;
   GstEventType type;
   GArray *events;
+  PadEvent *ev = NULL;
   gboolean res = FALSE;
   const gchar *name = NULL;
-  gboolean insert = TRUE;
+  gint slot;
 
   type = GST_EVENT_TYPE (event);
 
@@ -5098,54 +5971,56 @@ store_sticky_event (GstPad * pad, GstEvent * event)
   if (G_UNLIKELY (GST_PAD_IS_EOS (pad)))
     goto eos;
 
-  if (type & GST_EVENT_TYPE_STICKY_MULTI)
-    name = gst_structure_get_name (gst_event_get_structure (event));
-
-  events = pad->priv->events;
-  len = events->len;
+  if ((slot = sticky_slot (type)) >= 0) {
+    ev = &pad->priv->sticky[slot];
+    if (ev->event == NULL) {
+      check_sticky_order (pad, type);
+      ev->event = gst_event_ref (event);
+      res = TRUE;
+    } else {
+      /* overwrite */
+      res = gst_event_replace (&ev->event, event);
+    }
+  } else {
+    if (type & GST_EVENT_TYPE_STICKY_MULTI)
+      name = gst_structure_get_name (gst_event_get_structure (event));
 
-  for (i = 0; i < len; i++) {
-    PadEvent *ev = &g_array_index (events, PadEvent, i);
+    events = pad->priv->events;
+    len = events->len;
 
-    if (ev->event == NULL)
-      continue;
+    for (i = 0; i < len; i++) {
+      ev = &g_array_index (events, PadEvent, i);
 
-    if (type == GST_EVENT_TYPE (ev->event)) {
-      /* matching types, check matching name if needed */
-      if (name && !gst_event_has_name (ev->event, name))
+      if (ev->event == NULL)
         continue;
 
-      /* overwrite */
-      if ((res = gst_event_replace (&ev->event, event)))
-        ev->received = FALSE;
+      if (type == GST_EVENT_TYPE (ev->event)) {
+        /* matching types, check matching name if needed */
+        if (name && !gst_event_has_name (ev->event, name))
+          continue;
 
-      insert = FALSE;
-      break;
-    }
+        /* overwrite */
+        res = gst_event_replace (&ev->event, event);
+        break;
+      }
 
-    if (type < GST_EVENT_TYPE (ev->event) || (type != GST_EVENT_TYPE (ev->event)
-            && GST_EVENT_TYPE (ev->event) == GST_EVENT_EOS)) {
-      /* STREAM_START, CAPS and SEGMENT must be delivered in this order. By
-       * storing the sticky ordered we can check that this is respected. */
-      if (G_UNLIKELY (GST_EVENT_TYPE (ev->event) <= GST_EVENT_SEGMENT
-              || GST_EVENT_TYPE (ev->event) == GST_EVENT_EOS))
-        g_warning (G_STRLOC
-            ":%s:<%s:%s> Sticky event misordering, got '%s' before '%s'",
-            G_STRFUNC, GST_DEBUG_PAD_NAME (pad),
-            gst_event_type_get_name (GST_EVENT_TYPE (ev->event)),
-            gst_event_type_get_name (type));
-      break;
+      if (type < GST_EVENT_TYPE (ev->event))
+        break;
+    }
+    if (i == len || type != GST_EVENT_TYPE (ev->event)) {
+      PadEvent new_ev;
+
+      check_sticky_order (pad, type);
+      new_ev.event = gst_event_ref (event);
+      new_ev.received = FALSE;
+      g_array_insert_val (events, i, new_ev);
+      ev = &g_array_index (events, PadEvent, i);
+      res = TRUE;
     }
-  }
-  if (insert) {
-    PadEvent ev;
-    ev.event = gst_event_ref (event);
-    ev.received = FALSE;
-    g_array_insert_val (events, i, ev);
-    res = TRUE;
   }
 
   if (res) {
+    set_received (pad, ev, FALSE);
     pad->priv->events_cookie++;
     GST_OBJECT_FLAG_SET (pad, GST_PAD_FLAG_PENDING_EVENTS);
 
@@ -5155,6 +6030,9 @@ store_sticky_event (GstPad * pad, GstEvent * event)
       case GST_EVENT_CAPS:
         GST_OBJECT_UNLOCK (pad);
 
+        /* pads with fixed caps answer caps queries with their caps */
+        caps_cache_invalidate (pad);
+
         GST_DEBUG_OBJECT (pad, "notify caps");
         g_object_notify_by_pspec ((GObject *) pad, pspec_caps);
 
@@ -5244,6 +6122,8 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
   switch (event_type) {
     case GST_EVENT_FLUSH_START:
       GST_PAD_SET_FLUSHING (pad);
+      pad->ABI.abi.last_flowret = GST_FLOW_FLUSHING;
+      drop_batch (pad);
 
       GST_PAD_BLOCK_BROADCAST (pad);
       type |= GST_PAD_PROBE_TYPE_EVENT_FLUSH;
@@ -5278,6 +6158,12 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
         case GST_EVENT_RECONFIGURE:
           if (GST_PAD_IS_SINK (pad))
             GST_OBJECT_FLAG_SET (pad, GST_PAD_FLAG_NEED_RECONFIGURE);
+          /* finding the scope of the cache takes the locks of the parents */
+          GST_OBJECT_UNLOCK (pad);
+          caps_cache_invalidate (pad);
+          GST_OBJECT_LOCK (pad);
+          if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
+            goto flushed;
           break;
         default:
           break;
@@ -5293,7 +6179,7 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
 
         /* Push all sticky events before our current one
          * that have changed */
-        events_foreach (pad, sticky_changed, &data);
+        events_foreach (pad, TRUE, sticky_changed, &data);
       }
       break;
     }
@@ -5311,7 +6197,7 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
 
     /* Push all sticky events before our current one
      * that have changed */
-    events_foreach (pad, sticky_changed, &data);
+    events_foreach (pad, TRUE, sticky_changed, &data);
   }
 
   /* now check the peer pad */
@@ -5320,7 +6206,7 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
     goto not_linked;
 
   gst_object_ref (peerpad);
-  pad->priv->using++;
+  g_atomic_int_inc (&pad->priv->using);
   GST_OBJECT_UNLOCK (pad);
 
   GST_LOG_OBJECT (pad, "sending event %p (%s) to peerpad %" GST_PTR_FORMAT,
@@ -5337,8 +6223,7 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
   gst_object_unref (peerpad);
 
   GST_OBJECT_LOCK (pad);
-  pad->priv->using--;
-  if (pad->priv->using == 0) {
+  if (g_atomic_int_dec_and_test (&pad->priv->using)) {
     /* pad is not active anymore, trigger idle callbacks */
     PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PUSH | GST_PAD_PROBE_TYPE_IDLE,
         idle_probe_stopped, ret);
@@ -5419,6 +6304,7 @@ gst_pad_push_event (GstPad * pad, GstEvent * event)
   gboolean res = FALSE;
   GstPadProbeType type;
   gboolean sticky, serialized;
+  GstFlowReturn batch_ret = GST_FLOW_OK;
 
   g_return_val_if_fail (GST_IS_PAD (pad), FALSE);
   g_return_val_if_fail (GST_IS_EVENT (event), FALSE);
@@ -5437,10 +6323,22 @@ gst_pad_push_event (GstPad * pad, GstEvent * event)
   } else
     goto unknown_direction;
 
-  GST_OBJECT_LOCK (pad);
   sticky = GST_EVENT_IS_STICKY (event);
   serialized = GST_EVENT_IS_SERIALIZED (event);
 
+  /* serialized events go after the buffers collected for a batch. When those
+   * can't be pushed, only sticky events are still stored for later */
+  if (G_UNLIKELY (g_atomic_int_get (&pad->priv->batch_pending))
+      && serialized)
+    batch_ret = push_batch (pad);
+
+  GST_OBJECT_LOCK (pad);
+  if (G_UNLIKELY (batch_ret != GST_FLOW_OK)) {
+    pad->ABI.abi.last_flowret = batch_ret;
+    if (!sticky)
+      goto batch_failed;
+  }
+
   if (sticky) {
     /* srcpad sticky events are stored immediately, the received flag is set
      * to FALSE and will be set to TRUE when we can successfully push the
@@ -5510,6 +6408,14 @@ eos:
     gst_event_unref (event);
     goto done;
   }
+batch_failed:
+  {
+    GST_DEBUG_OBJECT (pad, "could not push batch: %s",
+        gst_flow_get_name (batch_ret));
+    GST_OBJECT_UNLOCK (pad);
+    gst_event_unref (event);
+    goto done;
+  }
 done:
   GST_TRACER_PAD_PUSH_EVENT_POST (pad, FALSE);
   return FALSE;
@@ -5609,6 +6515,11 @@ gst_pad_send_event_unchecked (GstPad * pad, GstEvent * event,
     case GST_EVENT_RECONFIGURE:
       if (GST_PAD_IS_SRC (pad))
         GST_OBJECT_FLAG_SET (pad, GST_PAD_FLAG_NEED_RECONFIGURE);
+      /* finding the scope of the cache takes the locks of the parents, we
+       * check for flushing again below */
+      GST_OBJECT_UNLOCK (pad);
+      caps_cache_invalidate (pad);
+      GST_OBJECT_LOCK (pad);
     default:
       GST_CAT_DEBUG_OBJECT (GST_CAT_EVENT, pad,
           "have event type %" GST_PTR_FORMAT, event);
@@ -5970,7 +6881,7 @@ gst_pad_sticky_events_foreach (GstPad * pad,
   data.user_data = user_data;
 
   GST_OBJECT_LOCK (pad);
-  events_foreach (pad, foreach_dispatch_function, &data);
+  events_foreach (pad, FALSE, foreach_dispatch_function, &data);
   GST_OBJECT_UNLOCK (pad);
 }
 
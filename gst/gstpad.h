@@ -693,6 +693,10 @@ typedef gboolean  (*GstPadStickyEventsForeachFunction) (GstPad *pad, GstEvent **
  *                      the template pad caps instead of query caps to
  *                      compare with the accept caps. Use this in combination
  *                      with %GST_PAD_FLAG_ACCEPT_INTERSECT. (Since 1.6)
+ * @GST_PAD_FLAG_CACHE_CAPS: the results of caps queries on the pad are
+ *                      cached until the pipeline of the pad is relinked or
+ *                      reconfigured.
+ *                      (Since 1.14)
  * @GST_PAD_FLAG_LAST: offset to define more flags
  *
  * Pad state flags
@@ -711,6 +715,7 @@ typedef enum {
   GST_PAD_FLAG_PROXY_SCHEDULING = (GST_OBJECT_FLAG_LAST << 10),
   GST_PAD_FLAG_ACCEPT_INTERSECT = (GST_OBJECT_FLAG_LAST << 11),
   GST_PAD_FLAG_ACCEPT_TEMPLATE  = (GST_OBJECT_FLAG_LAST << 12),
+  GST_PAD_FLAG_CACHE_CAPS       = (GST_OBJECT_FLAG_LAST << 13),
   /* padding */
   GST_PAD_FLAG_LAST        = (GST_OBJECT_FLAG_LAST << 16)
 } GstPadFlags;
@@ -1225,6 +1230,41 @@ struct _GstPadClass {
  * Since: 1.6
  */
 #define GST_PAD_UNSET_ACCEPT_TEMPLATE(pad) (GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_ACCEPT_TEMPLATE))
+/**
+ * GST_PAD_IS_CACHE_CAPS:
+ * @pad: a #GstPad
+ *
+ * Check if the results of caps queries on @pad are cached.
+ *
+ * Since: 1.14
+ */
+#define GST_PAD_IS_CACHE_CAPS(pad)         (GST_OBJECT_FLAG_IS_SET (pad, GST_PAD_FLAG_CACHE_CAPS))
+/**
+ * GST_PAD_SET_CACHE_CAPS:
+ * @pad: a #GstPad
+ *
+ * Cache the results of caps queries on @pad. A cached result is used for
+ * queries with the same filter until a pad is linked or unlinked, a pad
+ * template is set, a RECONFIGURE event is sent, gst_pad_mark_reconfigure()
+ * is called or new caps are set on a pad, anywhere.
+ *
+ * Only use this when the caps the pad's query function returns can only
+ * change with one of these, like for most elements that forward the query
+ * and transform the result. This avoids running the same queries up and
+ * down the pipeline again and again during negotiation.
+ *
+ * Since: 1.14
+ */
+#define GST_PAD_SET_CACHE_CAPS(pad)        (GST_OBJECT_FLAG_SET (pad, GST_PAD_FLAG_CACHE_CAPS))
+/**
+ * GST_PAD_UNSET_CACHE_CAPS:
+ * @pad: a #GstPad
+ *
+ * Stop caching the results of caps queries on @pad.
+ *
+ * Since: 1.14
+ */
+#define GST_PAD_UNSET_CACHE_CAPS(pad)      (GST_OBJECT_FLAG_UNSET (pad, GST_PAD_FLAG_CACHE_CAPS))
 /**
  * GST_PAD_GET_STREAM_LOCK:
  * @pad: a #GstPad
@@ -1472,6 +1512,13 @@ gint64                  gst_pad_get_offset                      (GstPad *pad);
 GST_EXPORT
 void                    gst_pad_set_offset                      (GstPad *pad, gint64 offset);
 
+GST_EXPORT
+void                    gst_pad_set_batching                    (GstPad *pad, guint max_buffers,
+                                                                 GstClockTime max_latency);
+GST_EXPORT
+void                    gst_pad_get_batching                    (GstPad *pad, guint *max_buffers,
+                                                                 GstClockTime *max_latency);
+
 /* data passing functions to peer */
 
 GST_EXPORT
@@ -217,7 +217,8 @@ typedef enum _GstQuarkId
   GST_QUARK_REDIRECT_ENTRY_TAGLISTS = 186,
   GST_QUARK_REDIRECT_ENTRY_STRUCTURES = 187,
   GST_QUARK_EVENT_STREAM_GROUP_DONE = 188,
-  GST_QUARK_MAX = 189
+  GST_QUARK_IDLE_TIMEOUT = 189,
+  GST_QUARK_MAX = 190
 } GstQuarkId;
 
 extern GQuark _priv_gst_quark_table[GST_QUARK_MAX];
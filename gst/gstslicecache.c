@@ -0,0 +1,488 @@
+/* GStreamer
+ * gstslicecache.c: per-thread cache for small allocations
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The slice cache sits in front of g_slice for the allocations that happen
+ * for every buffer: the GstBuffer struct, the GstMemory struct and small
+ * system memory blocks.
+ *
+ * It is a magazine allocator: every thread keeps two magazines (small stacks
+ * of free blocks) per size class so that the common alloc/free pairs are
+ * served without any locking. When both magazines of a thread are empty or
+ * full, a whole magazine is exchanged with a global, locked depot. The depot
+ * only holds a bounded number of magazines per class, surplus blocks are
+ * returned to g_slice immediately.
+ *
+ * Depot magazines that were not needed during the last trim interval are
+ * released again, so that a burst of allocations does not pin memory
+ * forever.
+ *
+ * Because the blocks come from g_slice, this works the same whether the slice
+ * allocator is active or G_SLICE=always-malloc is set. The cache is disabled
+ * when running inside valgrind so that leak checking keeps working, or when
+ * GST_BUFFER_CACHE_SIZE is set to 0.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gst_private.h"
+#include "gstslicecache.h"
+
+/* size classes: 64 byte steps up to 1024 bytes, then 2048 and 4096 */
+#define CLASS_STEP              64
+#define N_LINEAR_CLASSES        (1024 / CLASS_STEP)
+#define N_CLASSES               (N_LINEAR_CLASSES + 2)
+
+/* the number of blocks in a magazine is limited by the default or configured
+ * size and by the amount of memory one magazine may hold */
+#define DEFAULT_MAGAZINE_SIZE   32
+#define MAX_MAGAZINE_SIZE       64
+#define MAX_MAGAZINE_BYTES      (32 * 1024)
+
+/* the max number of full magazines kept in the depot per class */
+#define MAX_DEPOT_MAGAZINES     16
+
+/* unused depot magazines are released after this time */
+#define TRIM_INTERVAL           G_USEC_PER_SEC
+
+typedef struct _Magazine Magazine;
+
+struct _Magazine
+{
+  Magazine *next;
+  guint n_blocks;
+  gpointer blocks[MAX_MAGAZINE_SIZE];
+};
+
+typedef struct
+{
+  Magazine *loaded;
+  Magazine *previous;
+
+  /* only written by the owner thread. Other threads read them with
+   * g_atomic_pointer_get() for the approximate stats, pointer sized so that
+   * the reads don't tear. Where pointers have 32 bits they wrap around after
+   * 2^32 events */
+  gsize hits;
+  gsize misses;
+} ThreadClass;
+
+typedef struct
+{
+  ThreadClass classes[N_CLASSES];
+} ThreadCache;
+
+typedef struct
+{
+  GMutex lock;
+  Magazine *full;
+  guint n_full;
+  /* lowest value of n_full since the last trim, these magazines were not
+   * needed and can be released */
+  guint min_full;
+  guint64 released;
+} Depot;
+
+static gboolean cache_enabled = FALSE;
+static guint magazine_size[N_CLASSES];
+static Depot depots[N_CLASSES];
+
+static GMutex trim_lock;
+static gint64 last_trim;
+
+/* all live thread caches and the counters of exited threads */
+static GMutex threads_lock;
+static GList *threads;
+static guint64 retired_hits, retired_misses;
+
+static void thread_cache_free (gpointer data);
+
+static GPrivate thread_cache = G_PRIVATE_INIT (thread_cache_free);
+
+static inline guint
+size_to_class (gsize size)
+{
+  if (size <= 1024)
+    return size ? (size - 1) / CLASS_STEP : 0;
+  if (size <= 2048)
+    return N_LINEAR_CLASSES;
+  return N_LINEAR_CLASSES + 1;
+}
+
+static inline gsize
+class_to_size (guint cls)
+{
+  if (cls < N_LINEAR_CLASSES)
+    return (cls + 1) * CLASS_STEP;
+  return 2048 << (cls - N_LINEAR_CLASSES);
+}
+
+/* blocks are always allocated with the size of their class, so that they can
+ * be handed out again for any size in the same class */
+static inline gpointer
+backing_alloc (guint cls)
+{
+  return g_slice_alloc (class_to_size (cls));
+}
+
+static inline void
+backing_free (guint cls, gpointer mem)
+{
+  g_slice_free1 (class_to_size (cls), mem);
+}
+
+static void
+magazine_release (guint cls, Magazine * mag)
+{
+  guint i;
+
+  for (i = 0; i < mag->n_blocks; i++)
+    backing_free (cls, mag->blocks[i]);
+  mag->n_blocks = 0;
+}
+
+static void
+depot_trim (guint cls, gboolean all)
+{
+  Depot *depot = &depots[cls];
+  Magazine *mag, *free_list = NULL;
+  guint n;
+
+  g_mutex_lock (&depot->lock);
+  n = all ? depot->n_full : depot->min_full;
+  while (n-- > 0 && (mag = depot->full)) {
+    depot->full = mag->next;
+    depot->n_full--;
+    depot->released += mag->n_blocks;
+    mag->next = free_list;
+    free_list = mag;
+  }
+  depot->min_full = depot->n_full;
+  g_mutex_unlock (&depot->lock);
+
+  while ((mag = free_list)) {
+    free_list = mag->next;
+    magazine_release (cls, mag);
+    g_slice_free (Magazine, mag);
+  }
+}
+
+static void
+maybe_trim (void)
+{
+  gint64 now;
+  guint i;
+
+  /* somebody else is trimming */
+  if (!g_mutex_trylock (&trim_lock))
+    return;
+
+  now = g_get_monotonic_time ();
+  if (now - last_trim >= TRIM_INTERVAL) {
+    GST_CAT_LOG (GST_CAT_MEMORY, "trimming slice cache");
+    for (i = 0; i < N_CLASSES; i++)
+      depot_trim (i, FALSE);
+    last_trim = now;
+  }
+  g_mutex_unlock (&trim_lock);
+}
+
+static Magazine *
+depot_pop (guint cls)
+{
+  Depot *depot = &depots[cls];
+  Magazine *mag;
+
+  g_mutex_lock (&depot->lock);
+  if ((mag = depot->full)) {
+    depot->full = mag->next;
+    depot->n_full--;
+    if (depot->n_full < depot->min_full)
+      depot->min_full = depot->n_full;
+  }
+  g_mutex_unlock (&depot->lock);
+
+  return mag;
+}
+
+/* returns FALSE when the depot is full, the caller then needs to release the
+ * blocks in @mag */
+static gboolean
+depot_push (guint cls, Magazine * mag)
+{
+  Depot *depot = &depots[cls];
+  gboolean res;
+
+  g_mutex_lock (&depot->lock);
+  if ((res = depot->n_full < MAX_DEPOT_MAGAZINES)) {
+    mag->next = depot->full;
+    depot->full = mag;
+    depot->n_full++;
+  } else {
+    depot->released += mag->n_blocks;
+  }
+  g_mutex_unlock (&depot->lock);
+
+  maybe_trim ();
+
+  return res;
+}
+
+static inline ThreadCache *
+get_thread_cache (void)
+{
+  ThreadCache *cache;
+
+  cache = g_private_get (&thread_cache);
+  if (G_UNLIKELY (cache == NULL)) {
+    cache = g_new0 (ThreadCache, 1);
+    g_private_set (&thread_cache, cache);
+
+    g_mutex_lock (&threads_lock);
+    threads = g_list_prepend (threads, cache);
+    g_mutex_unlock (&threads_lock);
+  }
+  return cache;
+}
+
+static void
+thread_class_flush (guint cls, ThreadClass * tc)
+{
+  Magazine *mags[2] = { tc->loaded, tc->previous };
+  guint i;
+
+  for (i = 0; i < 2; i++) {
+    if (mags[i] == NULL)
+      continue;
+
+    if (mags[i]->n_blocks == 0 || !depot_push (cls, mags[i])) {
+      magazine_release (cls, mags[i]);
+      g_slice_free (Magazine, mags[i]);
+    }
+  }
+  tc->loaded = tc->previous = NULL;
+}
+
+/* called when a thread exits, give the blocks back to the depot */
+static void
+thread_cache_free (gpointer data)
+{
+  ThreadCache *cache = data;
+  guint i;
+
+  g_mutex_lock (&threads_lock);
+  threads = g_list_remove (threads, cache);
+  for (i = 0; i < N_CLASSES; i++) {
+    retired_hits += cache->classes[i].hits;
+    retired_misses += cache->classes[i].misses;
+  }
+  g_mutex_unlock (&threads_lock);
+
+  for (i = 0; i < N_CLASSES; i++)
+    thread_class_flush (i, &cache->classes[i]);
+
+  g_free (cache);
+}
+
+void
+_priv_gst_slice_cache_initialize (void)
+{
+  const gchar *env;
+  guint i, size = DEFAULT_MAGAZINE_SIZE;
+
+  if ((env = g_getenv ("GST_BUFFER_CACHE_SIZE")))
+    size = MIN (g_ascii_strtoull (env, NULL, 10), MAX_MAGAZINE_SIZE);
+
+  cache_enabled = size > 0 && !_priv_gst_in_valgrind ();
+
+  for (i = 0; i < N_CLASSES; i++)
+    magazine_size[i] = CLAMP (MAX_MAGAZINE_BYTES / class_to_size (i), 1, size);
+
+  last_trim = g_get_monotonic_time ();
+
+  GST_CAT_DEBUG (GST_CAT_MEMORY, "slice cache %s, magazine size %u",
+      cache_enabled ? "enabled" : "disabled", size);
+}
+
+void
+_priv_gst_slice_cache_cleanup (void)
+{
+  ThreadCache *cache;
+  guint i;
+
+  /* flush the magazines of the calling thread so that the depot trim can
+   * give back everything we have */
+  if ((cache = g_private_get (&thread_cache))) {
+    for (i = 0; i < N_CLASSES; i++)
+      thread_class_flush (i, &cache->classes[i]);
+  }
+  _priv_gst_slice_cache_trim (TRUE);
+}
+
+gpointer
+_priv_gst_slice_cache_alloc (gsize size)
+{
+  ThreadCache *cache;
+  ThreadClass *tc;
+  Magazine *mag;
+  guint cls;
+
+  if (G_UNLIKELY (size > GST_SLICE_CACHE_MAX_BLOCK_SIZE))
+    return g_slice_alloc (size);
+
+  cls = size_to_class (size);
+  if (G_UNLIKELY (!cache_enabled))
+    return backing_alloc (cls);
+
+  cache = get_thread_cache ();
+  tc = &cache->classes[cls];
+
+  if (G_LIKELY (tc->loaded && tc->loaded->n_blocks > 0))
+    goto hit;
+
+  /* loaded magazine is empty, try the previous one */
+  if (tc->previous && tc->previous->n_blocks > 0) {
+    mag = tc->loaded;
+    tc->loaded = tc->previous;
+    tc->previous = mag;
+    goto hit;
+  }
+
+  /* both empty, get a full magazine from the depot */
+  if ((mag = depot_pop (cls))) {
+    if (tc->previous)
+      g_slice_free (Magazine, tc->previous);
+    tc->previous = tc->loaded;
+    tc->loaded = mag;
+    goto hit;
+  }
+
+  tc->misses++;
+  return backing_alloc (cls);
+
+hit:
+  tc->hits++;
+  return tc->loaded->blocks[--tc->loaded->n_blocks];
+}
+
+void
+_priv_gst_slice_cache_free (gsize size, gpointer mem)
+{
+  ThreadCache *cache;
+  ThreadClass *tc;
+  Magazine *mag;
+  guint cls, max;
+
+  if (G_UNLIKELY (size > GST_SLICE_CACHE_MAX_BLOCK_SIZE)) {
+    g_slice_free1 (size, mem);
+    return;
+  }
+
+  cls = size_to_class (size);
+  if (G_UNLIKELY (!cache_enabled)) {
+    backing_free (cls, mem);
+    return;
+  }
+
+  cache = get_thread_cache ();
+  tc = &cache->classes[cls];
+  max = magazine_size[cls];
+
+  if (G_LIKELY (tc->loaded && tc->loaded->n_blocks < max))
+    goto push;
+
+  /* loaded magazine is full, try the previous one */
+  if (tc->previous && tc->previous->n_blocks < max) {
+    mag = tc->loaded;
+    tc->loaded = tc->previous;
+    tc->previous = mag;
+    goto push;
+  }
+
+  /* both full, give the previous one to the depot and start a new one. When
+   * the depot has enough magazines, release the blocks and reuse the
+   * magazine */
+  if (tc->previous && !depot_push (cls, tc->previous)) {
+    mag = tc->previous;
+    magazine_release (cls, mag);
+  } else {
+    mag = g_slice_new (Magazine);
+    mag->n_blocks = 0;
+  }
+  tc->previous = tc->loaded;
+  tc->loaded = mag;
+
+push:
+  tc->loaded->blocks[tc->loaded->n_blocks++] = mem;
+}
+
+/* release all (@all is %TRUE) or only the unused magazines of the depot */
+void
+_priv_gst_slice_cache_trim (gboolean all)
+{
+  guint i;
+
+  g_mutex_lock (&trim_lock);
+  for (i = 0; i < N_CLASSES; i++)
+    depot_trim (i, all);
+  last_trim = g_get_monotonic_time ();
+  g_mutex_unlock (&trim_lock);
+}
+
+GstStructure *
+_priv_gst_slice_cache_get_stats (void)
+{
+  guint64 hits, misses, released = 0, cached = 0;
+  guint i, n_threads;
+  GList *walk;
+
+  g_mutex_lock (&threads_lock);
+  hits = retired_hits;
+  misses = retired_misses;
+  n_threads = g_list_length (threads);
+  for (walk = threads; walk; walk = walk->next) {
+    ThreadCache *cache = walk->data;
+
+    for (i = 0; i < N_CLASSES; i++) {
+      hits += GPOINTER_TO_SIZE (g_atomic_pointer_get (&cache->classes[i].hits));
+      misses +=
+          GPOINTER_TO_SIZE (g_atomic_pointer_get (&cache->classes[i].misses));
+    }
+  }
+  g_mutex_unlock (&threads_lock);
+
+  for (i = 0; i < N_CLASSES; i++) {
+    Depot *depot = &depots[i];
+    Magazine *mag;
+
+    g_mutex_lock (&depot->lock);
+    for (mag = depot->full; mag; mag = mag->next)
+      cached += mag->n_blocks;
+    released += depot->released;
+    g_mutex_unlock (&depot->lock);
+  }
+
+  return gst_structure_new ("GstBufferCacheStats",
+      "enabled", G_TYPE_BOOLEAN, cache_enabled,
+      "hits", G_TYPE_UINT64, hits,
+      "misses", G_TYPE_UINT64, misses,
+      "released", G_TYPE_UINT64, released,
+      "cached", G_TYPE_UINT64, cached, "threads", G_TYPE_UINT, n_threads, NULL);
+}
@@ -0,0 +1,42 @@
+/* GStreamer
+ * gstslicecache.h: Private header for the per-thread slice cache
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_SLICE_CACHE_H__
+#define __GST_SLICE_CACHE_H__
+
+#include <glib.h>
+#include <gst/gststructure.h>
+
+G_BEGIN_DECLS
+
+/* blocks larger than this are never cached and go straight to g_slice */
+#define GST_SLICE_CACHE_MAX_BLOCK_SIZE  4096
+
+G_GNUC_INTERNAL void      _priv_gst_slice_cache_initialize (void);
+G_GNUC_INTERNAL void      _priv_gst_slice_cache_cleanup    (void);
+
+G_GNUC_INTERNAL gpointer  _priv_gst_slice_cache_alloc      (gsize size);
+G_GNUC_INTERNAL void      _priv_gst_slice_cache_free       (gsize size, gpointer mem);
+
+G_GNUC_INTERNAL void      _priv_gst_slice_cache_trim       (gboolean all);
+G_GNUC_INTERNAL GstStructure * _priv_gst_slice_cache_get_stats (void);
+
+G_END_DECLS
+
+#endif /* __GST_SLICE_CACHE_H__ */
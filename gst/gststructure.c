@@ -87,6 +87,14 @@ struct _GstStructureField
   GValue value;
 };
 
+/* Small structures keep their fields in the same allocation as the
+ * structure, the fields move to a separate array when they don't fit anymore.
+ *
+ * The fields are kept in the order in which they were added, which is the
+ * order in which they are serialized. Structures with FIELD_INDEX_MIN_FIELDS
+ * fields or more also keep the field positions sorted by quark, so that
+ * lookups are a binary search. The index is only changed together with the
+ * fields, lookups on immutable structures never write. */
 typedef struct
 {
   GstStructure s;
@@ -94,14 +102,30 @@ typedef struct
   /* owned by parent structure, NULL if no parent */
   gint *parent_refcount;
 
-  GArray *fields;
+  guint fields_len;
+  guint fields_alloc;
+  /* points to arr, or to a separate array when the fields don't fit */
+  GstStructureField *fields;
+  /* the positions of the fields sorted by quark, or NULL */
+  guint *index;
+
+  GstStructureField arr[1];
 } GstStructureImpl;
 
+/* the number of fields allocated together with an empty structure */
+#define STRUCTURE_INLINE_FIELDS 4
+/* below this number of fields a linear scan is fast enough */
+#define FIELD_INDEX_MIN_FIELDS 8
+
 #define GST_STRUCTURE_REFCOUNT(s) (((GstStructureImpl*)(s))->parent_refcount)
 #define GST_STRUCTURE_FIELDS(s) (((GstStructureImpl*)(s))->fields)
+#define GST_STRUCTURE_LEN(s) (((GstStructureImpl*)(s))->fields_len)
+#define GST_STRUCTURE_INDEX(s) (((GstStructureImpl*)(s))->index)
+#define GST_STRUCTURE_IS_USING_DYNAMIC_ARRAY(s) \
+    (((GstStructureImpl*)(s))->fields != ((GstStructureImpl*)(s))->arr)
 
 #define GST_STRUCTURE_FIELD(structure, index) \
-    &g_array_index(GST_STRUCTURE_FIELDS(structure), GstStructureField, (index))
+    (&GST_STRUCTURE_FIELDS(structure)[(index)])
 
 #define IS_MUTABLE(structure) \
     (!GST_STRUCTURE_REFCOUNT(structure) || \
@@ -139,17 +163,129 @@ _priv_gst_structure_initialize (void)
       "GstStructure debug");
 }
 
+static gint
+field_index_compare (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+  const GstStructureField *fields = user_data;
+  GQuark qa = fields[*(const guint *) a].name;
+  GQuark qb = fields[*(const guint *) b].name;
+
+  return qa < qb ? -1 : (qa > qb ? 1 : 0);
+}
+
+/* the position in the index of the field named @name, or where it would go */
+static guint
+field_index_search (const GstStructure * structure, GQuark name)
+{
+  const GstStructureField *fields = GST_STRUCTURE_FIELDS (structure);
+  const guint *index = GST_STRUCTURE_INDEX (structure);
+  guint lo = 0, hi = GST_STRUCTURE_LEN (structure);
+
+  while (lo < hi) {
+    guint mid = lo + (hi - lo) / 2;
+
+    if (fields[index[mid]].name < name)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+static void
+field_index_build (GstStructureImpl * impl)
+{
+  guint i;
+
+  impl->index = g_new (guint, impl->fields_alloc);
+  for (i = 0; i < impl->fields_len; i++)
+    impl->index[i] = i;
+  g_qsort_with_data (impl->index, impl->fields_len, sizeof (guint),
+      field_index_compare, impl->fields);
+}
+
+/* appends @field, the structure must not have a field with the same name */
+static void
+_structure_append_field (GstStructure * structure, GstStructureField * field)
+{
+  GstStructureImpl *impl = (GstStructureImpl *) structure;
+  guint len = impl->fields_len;
+
+  if (G_UNLIKELY (len == impl->fields_alloc)) {
+    guint n_alloc = impl->fields_alloc * 2;
+
+    if (GST_STRUCTURE_IS_USING_DYNAMIC_ARRAY (structure)) {
+      impl->fields = g_renew (GstStructureField, impl->fields, n_alloc);
+    } else {
+      impl->fields = g_new (GstStructureField, n_alloc);
+      memcpy (impl->fields, impl->arr, len * sizeof (GstStructureField));
+    }
+    if (impl->index)
+      impl->index = g_renew (guint, impl->index, n_alloc);
+    impl->fields_alloc = n_alloc;
+  }
+
+  impl->fields[len] = *field;
+
+  if (impl->index) {
+    guint pos = field_index_search (structure, field->name);
+
+    memmove (&impl->index[pos + 1], &impl->index[pos],
+        (len - pos) * sizeof (guint));
+    impl->index[pos] = len;
+    impl->fields_len = len + 1;
+  } else {
+    impl->fields_len = len + 1;
+    if (impl->fields_len >= FIELD_INDEX_MIN_FIELDS)
+      field_index_build (impl);
+  }
+}
+
+/* removes the field at @pos, the value must be unset already */
+static void
+_structure_remove_index (GstStructure * structure, guint pos)
+{
+  GstStructureImpl *impl = (GstStructureImpl *) structure;
+  guint i, j, len = impl->fields_len - 1;
+
+  memmove (&impl->fields[pos], &impl->fields[pos + 1],
+      (len - pos) * sizeof (GstStructureField));
+  impl->fields_len = len;
+
+  if (impl->index == NULL)
+    return;
+
+  if (len < FIELD_INDEX_MIN_FIELDS) {
+    g_free (impl->index);
+    impl->index = NULL;
+    return;
+  }
+
+  /* drop the entry of the field and renumber the fields after it */
+  for (i = 0, j = 0; i <= len; i++) {
+    guint p = impl->index[i];
+
+    if (p != pos)
+      impl->index[j++] = p > pos ? p - 1 : p;
+  }
+}
+
 static GstStructure *
 gst_structure_new_id_empty_with_size (GQuark quark, guint prealloc)
 {
   GstStructureImpl *structure;
+  guint n_alloc;
 
-  structure = g_slice_new (GstStructureImpl);
+  n_alloc = MAX (prealloc, STRUCTURE_INLINE_FIELDS);
+  structure = g_malloc (sizeof (GstStructureImpl) +
+      (n_alloc - 1) * sizeof (GstStructureField));
   ((GstStructure *) structure)->type = _gst_structure_type;
   ((GstStructure *) structure)->name = quark;
   GST_STRUCTURE_REFCOUNT (structure) = NULL;
-  GST_STRUCTURE_FIELDS (structure) =
-      g_array_sized_new (FALSE, FALSE, sizeof (GstStructureField), prealloc);
+  structure->fields_len = 0;
+  structure->fields_alloc = n_alloc;
+  structure->fields = structure->arr;
+  structure->index = NULL;
 
   GST_TRACE ("created structure %p", structure);
 
@@ -343,17 +479,26 @@ gst_structure_copy (const GstStructure * structure)
 
   g_return_val_if_fail (structure != NULL, NULL);
 
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
   new_structure = gst_structure_new_id_empty_with_size (structure->name, len);
 
   for (i = 0; i < len; i++) {
-    GstStructureField new_field = { 0 };
+    GstStructureField *new_field = GST_STRUCTURE_FIELD (new_structure, i);
 
     field = GST_STRUCTURE_FIELD (structure, i);
 
-    new_field.name = field->name;
-    gst_value_init_and_copy (&new_field.value, &field->value);
-    g_array_append_val (GST_STRUCTURE_FIELDS (new_structure), new_field);
+    new_field->name = field->name;
+    memset (&new_field->value, 0, sizeof (GValue));
+    gst_value_init_and_copy (&new_field->value, &field->value);
+  }
+  GST_STRUCTURE_LEN (new_structure) = len;
+
+  /* the fields are in the same positions, so is the index */
+  if (GST_STRUCTURE_INDEX (structure)) {
+    GstStructureImpl *impl = (GstStructureImpl *) new_structure;
+
+    impl->index = g_new (guint, impl->fields_alloc);
+    memcpy (impl->index, GST_STRUCTURE_INDEX (structure), len * sizeof (guint));
   }
   GST_CAT_TRACE (GST_CAT_PERFORMANCE, "doing copy %p -> %p",
       structure, new_structure);
@@ -377,7 +522,7 @@ gst_structure_free (GstStructure * structure)
   g_return_if_fail (structure != NULL);
   g_return_if_fail (GST_STRUCTURE_REFCOUNT (structure) == NULL);
 
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
   for (i = 0; i < len; i++) {
     field = GST_STRUCTURE_FIELD (structure, i);
 
@@ -385,13 +530,15 @@ gst_structure_free (GstStructure * structure)
       g_value_unset (&field->value);
     }
   }
-  g_array_free (GST_STRUCTURE_FIELDS (structure), TRUE);
+  if (GST_STRUCTURE_IS_USING_DYNAMIC_ARRAY (structure))
+    g_free (GST_STRUCTURE_FIELDS (structure));
+  g_free (GST_STRUCTURE_INDEX (structure));
 #ifdef USE_POISONING
   memset (structure, 0xff, sizeof (GstStructure));
 #endif
   GST_TRACE ("free structure %p", structure);
 
-  g_slice_free1 (sizeof (GstStructureImpl), structure);
+  g_free (structure);
 }
 
 /**
@@ -773,9 +920,6 @@ gst_structure_set_field (GstStructure * structure, GstStructureField * field)
 {
   GstStructureField *f;
   GType field_value_type;
-  guint i, len;
-
-  len = GST_STRUCTURE_FIELDS (structure)->len;
 
   field_value_type = G_VALUE_TYPE (&field->value);
   if (field_value_type == G_TYPE_STRING) {
@@ -826,17 +970,14 @@ gst_structure_set_field (GstStructure * structure, GstStructureField * field)
     }
   }
 
-  for (i = 0; i < len; i++) {
-    f = GST_STRUCTURE_FIELD (structure, i);
-
-    if (G_UNLIKELY (f->name == field->name)) {
-      g_value_unset (&f->value);
-      memcpy (f, field, sizeof (GstStructureField));
-      return;
-    }
+  f = gst_structure_id_get_field (structure, field->name);
+  if (G_UNLIKELY (f != NULL)) {
+    g_value_unset (&f->value);
+    memcpy (f, field, sizeof (GstStructureField));
+    return;
   }
 
-  g_array_append_val (GST_STRUCTURE_FIELDS (structure), *field);
+  _structure_append_field (structure, field);
 }
 
 /* If there is no field with the given ID, NULL is returned.
@@ -847,7 +988,18 @@ gst_structure_id_get_field (const GstStructure * structure, GQuark field_id)
   GstStructureField *field;
   guint i, len;
 
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
+
+  if (GST_STRUCTURE_INDEX (structure)) {
+    i = field_index_search (structure, field_id);
+    if (i < len) {
+      field = GST_STRUCTURE_FIELD (structure,
+          GST_STRUCTURE_INDEX (structure)[i]);
+      if (field->name == field_id)
+        return field;
+    }
+    return NULL;
+  }
 
   for (i = 0; i < len; i++) {
     field = GST_STRUCTURE_FIELD (structure, i);
@@ -934,27 +1086,20 @@ gst_structure_remove_field (GstStructure * structure, const gchar * fieldname)
 {
   GstStructureField *field;
   GQuark id;
-  guint i, len;
 
   g_return_if_fail (structure != NULL);
   g_return_if_fail (fieldname != NULL);
   g_return_if_fail (IS_MUTABLE (structure));
 
   id = g_quark_from_string (fieldname);
-  len = GST_STRUCTURE_FIELDS (structure)->len;
-
-  for (i = 0; i < len; i++) {
-    field = GST_STRUCTURE_FIELD (structure, i);
+  field = gst_structure_id_get_field (structure, id);
+  if (field == NULL)
+    return;
 
-    if (field->name == id) {
-      if (G_IS_VALUE (&field->value)) {
-        g_value_unset (&field->value);
-      }
-      GST_STRUCTURE_FIELDS (structure) =
-          g_array_remove_index (GST_STRUCTURE_FIELDS (structure), i);
-      return;
-    }
+  if (G_IS_VALUE (&field->value)) {
+    g_value_unset (&field->value);
   }
+  _structure_remove_index (structure, field - GST_STRUCTURE_FIELDS (structure));
 }
 
 /**
@@ -1020,15 +1165,16 @@ gst_structure_remove_all_fields (GstStructure * structure)
   g_return_if_fail (structure != NULL);
   g_return_if_fail (IS_MUTABLE (structure));
 
-  for (i = GST_STRUCTURE_FIELDS (structure)->len - 1; i >= 0; i--) {
+  for (i = GST_STRUCTURE_LEN (structure) - 1; i >= 0; i--) {
     field = GST_STRUCTURE_FIELD (structure, i);
 
     if (G_IS_VALUE (&field->value)) {
       g_value_unset (&field->value);
     }
-    GST_STRUCTURE_FIELDS (structure) =
-        g_array_remove_index (GST_STRUCTURE_FIELDS (structure), i);
   }
+  GST_STRUCTURE_LEN (structure) = 0;
+  g_free (GST_STRUCTURE_INDEX (structure));
+  GST_STRUCTURE_INDEX (structure) = NULL;
 }
 
 /**
@@ -1071,7 +1217,7 @@ gst_structure_n_fields (const GstStructure * structure)
 {
   g_return_val_if_fail (structure != NULL, 0);
 
-  return GST_STRUCTURE_FIELDS (structure)->len;
+  return GST_STRUCTURE_LEN (structure);
 }
 
 /**
@@ -1089,7 +1235,7 @@ gst_structure_nth_field_name (const GstStructure * structure, guint index)
   GstStructureField *field;
 
   g_return_val_if_fail (structure != NULL, NULL);
-  g_return_val_if_fail (index < GST_STRUCTURE_FIELDS (structure)->len, NULL);
+  g_return_val_if_fail (index < GST_STRUCTURE_LEN (structure), NULL);
 
   field = GST_STRUCTURE_FIELD (structure, index);
 
@@ -1120,7 +1266,7 @@ gst_structure_foreach (const GstStructure * structure,
   g_return_val_if_fail (structure != NULL, FALSE);
   g_return_val_if_fail (func != NULL, FALSE);
 
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
 
   for (i = 0; i < len; i++) {
     field = GST_STRUCTURE_FIELD (structure, i);
@@ -1157,7 +1303,7 @@ gst_structure_map_in_place (GstStructure * structure,
   g_return_val_if_fail (structure != NULL, FALSE);
   g_return_val_if_fail (IS_MUTABLE (structure), FALSE);
   g_return_val_if_fail (func != NULL, FALSE);
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
 
   for (i = 0; i < len; i++) {
     field = GST_STRUCTURE_FIELD (structure, i);
@@ -1195,7 +1341,7 @@ gst_structure_filter_and_map_in_place (GstStructure * structure,
   g_return_if_fail (structure != NULL);
   g_return_if_fail (IS_MUTABLE (structure));
   g_return_if_fail (func != NULL);
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
 
   for (i = 0; i < len;) {
     field = GST_STRUCTURE_FIELD (structure, i);
@@ -1206,9 +1352,8 @@ gst_structure_filter_and_map_in_place (GstStructure * structure,
       if (G_IS_VALUE (&field->value)) {
         g_value_unset (&field->value);
       }
-      GST_STRUCTURE_FIELDS (structure) =
-          g_array_remove_index (GST_STRUCTURE_FIELDS (structure), i);
-      len = GST_STRUCTURE_FIELDS (structure)->len;
+      _structure_remove_index (structure, i);
+      len = GST_STRUCTURE_LEN (structure);
     } else {
       i++;
     }
@@ -1796,7 +1941,7 @@ priv_gst_structure_append_to_gstring (const GstStructure * structure,
 
   g_return_val_if_fail (s != NULL, FALSE);
 
-  len = GST_STRUCTURE_FIELDS (structure)->len;
+  len = GST_STRUCTURE_LEN (structure);
   for (i = 0; i < len; i++) {
     char *t;
     GType type;
@@ -2092,11 +2237,18 @@ gst_structure_from_string (const gchar * string, gchar ** end)
   char *w;
   char *r;
   char save;
+  char buf[GST_PARSE_STACK_BUFFER_SIZE];
+  gsize len;
   GstStructure *structure = NULL;
 
   g_return_val_if_fail (string != NULL, NULL);
 
-  copy = g_strdup (string);
+  /* the string is parsed in place, short ones are copied on the stack */
+  len = strlen (string);
+  if (len < sizeof (buf))
+    copy = memcpy (buf, string, len + 1);
+  else
+    copy = g_strdup (string);
   r = copy;
 
   if (!priv_gst_structure_parse_name (r, &name, &w, &r))
@@ -2119,16 +2271,70 @@ gst_structure_from_string (const gchar * string, gchar ** end)
     g_warning ("gst_structure_from_string did not consume whole string,"
         " but caller did not provide end pointer (\"%s\")", string);
 
-  g_free (copy);
+  if (copy != buf)
+    g_free (copy);
   return structure;
 
 error:
   if (structure)
     gst_structure_free (structure);
-  g_free (copy);
+  if (copy != buf)
+    g_free (copy);
   return NULL;
 }
 
+/**
+ * gst_structure_to_binary:
+ * @structure: a #GstStructure
+ * @array: a #GByteArray to append to
+ *
+ * Appends a compact binary representation of @structure to @array, which
+ * can be turned back into a structure with gst_structure_from_binary().
+ * This is a lot faster to write and to read than gst_structure_to_string().
+ *
+ * The format is versioned and does not depend on the machine that wrote it.
+ * Values of types without a binary representation are stored as their
+ * gst_value_serialize() string.
+ *
+ * Returns: %TRUE if @structure was written, %FALSE if a field holds a value
+ *     that can't be serialized, @array is left unchanged then.
+ *
+ * Since: 1.14
+ */
+gboolean
+gst_structure_to_binary (const GstStructure * structure, GByteArray * array)
+{
+  g_return_val_if_fail (structure != NULL, FALSE);
+  g_return_val_if_fail (array != NULL, FALSE);
+
+  return _priv_gst_binary_write_structure (array, structure);
+}
+
+/**
+ * gst_structure_from_binary:
+ * @data: (array length=size): data written by gst_structure_to_binary()
+ * @size: the size of @data
+ * @consumed: (out) (allow-none): the number of bytes that were read
+ *
+ * Reads a structure that was written with gst_structure_to_binary().
+ * Strings are used in place while reading, so the only allocations are
+ * for the new structure and its values.
+ *
+ * Free-function: gst_structure_free
+ *
+ * Returns: (transfer full) (nullable): a new #GstStructure or %NULL
+ *     when @data does not hold a valid structure.
+ *
+ * Since: 1.14
+ */
+GstStructure *
+gst_structure_from_binary (const guint8 * data, gsize size, gsize * consumed)
+{
+  g_return_val_if_fail (data != NULL || size == 0, NULL);
+
+  return _priv_gst_binary_read_structure (data, size, consumed);
+}
+
 static void
 gst_structure_transform_to_string (const GValue * src_value,
     GValue * dest_value)
@@ -2793,8 +2999,7 @@ gst_structure_is_equal (const GstStructure * structure1,
   if (structure1->name != structure2->name) {
     return FALSE;
   }
-  if (GST_STRUCTURE_FIELDS (structure1)->len !=
-      GST_STRUCTURE_FIELDS (structure2)->len) {
+  if (GST_STRUCTURE_LEN (structure1) != GST_STRUCTURE_LEN (structure2)) {
     return FALSE;
   }
 
@@ -2802,6 +3007,25 @@ gst_structure_is_equal (const GstStructure * structure1,
       (gpointer) structure2);
 }
 
+/* hashes the name and the fields in the order they are stored, structures
+ * that are only equal after reordering their fields hash differently */
+guint
+_priv_gst_structure_hash (const GstStructure * structure)
+{
+  GstStructureField *field;
+  guint i, len, h;
+
+  h = structure->name;
+  len = GST_STRUCTURE_LEN (structure);
+  for (i = 0; i < len; i++) {
+    field = GST_STRUCTURE_FIELD (structure, i);
+    h = (h << 5) - h + field->name;
+    h = (h << 5) - h + _priv_gst_value_hash (&field->value);
+  }
+
+  return h;
+}
+
 
 typedef struct
 {
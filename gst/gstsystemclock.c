@@ -41,19 +41,13 @@
 #include "gstinfo.h"
 #include "gstsystemclock.h"
 #include "gstenumtypes.h"
-#include "gstpoll.h"
 #include "gstutils.h"
 #include "glib-compat-private.h"
 
-#include <errno.h>
-
 #ifdef G_OS_WIN32
 #  define WIN32_LEAN_AND_MEAN   /* prevents from including too many things */
 #  include <windows.h>          /* QueryPerformance* stuff */
 #  undef WIN32_LEAN_AND_MEAN
-#  ifndef EWOULDBLOCK
-#  define EWOULDBLOCK EAGAIN    /* This is just to placate gcc */
-#  endif
 #endif /* G_OS_WIN32 */
 
 #ifdef __APPLE__
@@ -78,13 +72,12 @@ struct _GstSystemClockPrivate
   GThread *thread;              /* thread for async notify */
   gboolean stopping;
 
-  GList *entries;
+  GPtrArray *entries;           /* binary min-heap of the async entries */
+  guint64 entries_seqnum;
+  GstClockEntry *current;       /* async entry the thread is busy with */
   GCond entries_changed;
 
   GstClockType clock_type;
-  GstPoll *timer;
-  gint wakeup_count;            /* the number of entries with a pending wakeup */
-  gboolean async_wakeup;        /* if the wakeup was because of a async list change */
 
 #ifdef G_OS_WIN32
   LARGE_INTEGER start;
@@ -139,7 +132,10 @@ static void gst_system_clock_id_unschedule (GstClock * clock,
     GstClockEntry * entry);
 static void gst_system_clock_async_thread (GstClock * clock);
 static gboolean gst_system_clock_start_async (GstSystemClock * clock);
-static void gst_system_clock_add_wakeup (GstSystemClock * sysclock);
+static void gst_system_clock_entry_wakeup (GstClockEntry * entry,
+    gboolean restart);
+static void gst_system_clock_heap_remove (GPtrArray * heap,
+    GstClockEntryImpl * impl);
 
 static GMutex _gst_sysclock_mutex;
 
@@ -190,9 +186,8 @@ gst_system_clock_init (GstSystemClock * clock)
   clock->priv = priv = GST_SYSTEM_CLOCK_GET_PRIVATE (clock);
 
   priv->clock_type = DEFAULT_CLOCK_TYPE;
-  priv->timer = gst_poll_new_timer ();
 
-  priv->entries = NULL;
+  priv->entries = g_ptr_array_new ();
   g_cond_init (&priv->entries_changed);
 
 #ifdef G_OS_WIN32
@@ -221,20 +216,24 @@ gst_system_clock_dispose (GObject * object)
   GstClock *clock = (GstClock *) object;
   GstSystemClock *sysclock = GST_SYSTEM_CLOCK_CAST (clock);
   GstSystemClockPrivate *priv = sysclock->priv;
-  GList *entries;
+  guint i;
 
   /* else we have to stop the thread */
   GST_OBJECT_LOCK (clock);
   priv->stopping = TRUE;
   /* unschedule all entries */
-  for (entries = priv->entries; entries; entries = g_list_next (entries)) {
-    GstClockEntry *entry = (GstClockEntry *) entries->data;
+  for (i = 0; i < priv->entries->len; i++) {
+    GstClockEntry *entry = g_ptr_array_index (priv->entries, i);
 
     GST_CAT_DEBUG (GST_CAT_CLOCK, "unscheduling entry %p", entry);
     SET_ENTRY_STATUS (entry, GST_CLOCK_UNSCHEDULED);
   }
+  if (priv->current) {
+    GST_CAT_DEBUG (GST_CAT_CLOCK, "unscheduling entry %p", priv->current);
+    SET_ENTRY_STATUS (priv->current, GST_CLOCK_UNSCHEDULED);
+    gst_system_clock_entry_wakeup (priv->current, FALSE);
+  }
   GST_SYSTEM_CLOCK_BROADCAST (clock);
-  gst_system_clock_add_wakeup (sysclock);
   GST_OBJECT_UNLOCK (clock);
 
   if (priv->thread)
@@ -242,11 +241,13 @@ gst_system_clock_dispose (GObject * object)
   priv->thread = NULL;
   GST_CAT_DEBUG (GST_CAT_CLOCK, "joined thread");
 
-  g_list_foreach (priv->entries, (GFunc) gst_clock_id_unref, NULL);
-  g_list_free (priv->entries);
-  priv->entries = NULL;
+  while (priv->entries->len > 0) {
+    GstClockEntryImpl *impl = g_ptr_array_index (priv->entries, 0);
 
-  gst_poll_free (priv->timer);
+    gst_system_clock_heap_remove (priv->entries, impl);
+    gst_clock_id_unref ((GstClockID) impl);
+  }
+  g_ptr_array_free (priv->entries, TRUE);
   g_cond_clear (&priv->entries_changed);
 
   G_OBJECT_CLASS (parent_class)->dispose (object);
@@ -369,55 +370,130 @@ gst_system_clock_obtain (void)
   return clock;
 }
 
+/* Async entries are kept in a binary min-heap on their time, entries with the
+ * same time fire in the order in which they were added. Each entry knows its
+ * position in the heap, so that it can be removed right away when it is
+ * unscheduled. All of this is protected by the object lock. */
+static inline gboolean
+gst_system_clock_entry_before (GstClockEntryImpl * impl1,
+    GstClockEntryImpl * impl2)
+{
+  GstClockTime time1 = GST_CLOCK_ENTRY_TIME ((GstClockEntry *) impl1);
+  GstClockTime time2 = GST_CLOCK_ENTRY_TIME ((GstClockEntry *) impl2);
+
+  if (time1 != time2)
+    return time1 < time2;
+
+  return impl1->heap_seqnum < impl2->heap_seqnum;
+}
+
+static inline void
+gst_system_clock_heap_set (GPtrArray * heap, guint i, GstClockEntryImpl * impl)
+{
+  g_ptr_array_index (heap, i) = impl;
+  impl->heap_index = i;
+}
+
 static void
-gst_system_clock_remove_wakeup (GstSystemClock * sysclock)
+gst_system_clock_heap_sift_up (GPtrArray * heap, guint i)
 {
-  g_return_if_fail (sysclock->priv->wakeup_count > 0);
-
-  sysclock->priv->wakeup_count--;
-  GST_CAT_DEBUG (GST_CAT_CLOCK, "reading control");
-  while (!gst_poll_read_control (sysclock->priv->timer)) {
-    if (errno == EWOULDBLOCK) {
-      /* Try again and give other threads the chance to do something */
-      g_thread_yield ();
-      continue;
-    } else {
-      /* Critical error, GstPoll will have printed a critical warning already */
+  GstClockEntryImpl *impl = g_ptr_array_index (heap, i);
+
+  while (i > 0) {
+    guint parent = (i - 1) / 2;
+    GstClockEntryImpl *pimpl = g_ptr_array_index (heap, parent);
+
+    if (!gst_system_clock_entry_before (impl, pimpl))
       break;
+    gst_system_clock_heap_set (heap, i, pimpl);
+    i = parent;
+  }
+  gst_system_clock_heap_set (heap, i, impl);
+}
+
+static void
+gst_system_clock_heap_sift_down (GPtrArray * heap, guint i)
+{
+  GstClockEntryImpl *impl = g_ptr_array_index (heap, i);
+
+  while (TRUE) {
+    guint child = 2 * i + 1;
+    GstClockEntryImpl *cimpl;
+
+    if (child >= heap->len)
+      break;
+    cimpl = g_ptr_array_index (heap, child);
+    if (child + 1 < heap->len
+        && gst_system_clock_entry_before (g_ptr_array_index (heap, child + 1),
+            cimpl)) {
+      child++;
+      cimpl = g_ptr_array_index (heap, child);
     }
+    if (!gst_system_clock_entry_before (cimpl, impl))
+      break;
+    gst_system_clock_heap_set (heap, i, cimpl);
+    i = child;
   }
-  GST_SYSTEM_CLOCK_BROADCAST (sysclock);
-  GST_CAT_DEBUG (GST_CAT_CLOCK, "wakeup count %d",
-      sysclock->priv->wakeup_count);
+  gst_system_clock_heap_set (heap, i, impl);
 }
 
 static void
-gst_system_clock_add_wakeup (GstSystemClock * sysclock)
+gst_system_clock_heap_push (GPtrArray * heap, GstClockEntryImpl * impl)
 {
-  GST_CAT_DEBUG (GST_CAT_CLOCK, "writing control");
-  gst_poll_write_control (sysclock->priv->timer);
-  sysclock->priv->wakeup_count++;
-  GST_CAT_DEBUG (GST_CAT_CLOCK, "wakeup count %d",
-      sysclock->priv->wakeup_count);
+  g_ptr_array_add (heap, impl);
+  gst_system_clock_heap_sift_up (heap, heap->len - 1);
 }
 
+/* restore the heap order after the time of @impl changed */
 static void
-gst_system_clock_wait_wakeup (GstSystemClock * sysclock)
+gst_system_clock_heap_update (GPtrArray * heap, GstClockEntryImpl * impl)
 {
-  while (sysclock->priv->wakeup_count > 0) {
-    GST_SYSTEM_CLOCK_WAIT (sysclock);
+  gst_system_clock_heap_sift_up (heap, impl->heap_index);
+  gst_system_clock_heap_sift_down (heap, impl->heap_index);
+}
+
+static void
+gst_system_clock_heap_remove (GPtrArray * heap, GstClockEntryImpl * impl)
+{
+  guint i = impl->heap_index;
+
+  /* the last entry takes the place of the removed one */
+  g_ptr_array_remove_index_fast (heap, i);
+  impl->heap_index = -1;
+  if (i < heap->len) {
+    GstClockEntryImpl *moved = g_ptr_array_index (heap, i);
+
+    moved->heap_index = i;
+    gst_system_clock_heap_update (heap, moved);
   }
 }
 
-/* this thread reads the sorted clock entries from the queue.
+/* wake up the thread waiting for @entry, and only that one. With @restart
+ * the async thread stops waiting for @entry because an earlier entry was
+ * added. */
+static void
+gst_system_clock_entry_wakeup (GstClockEntry * entry, gboolean restart)
+{
+  GstClockEntryImpl *impl = (GstClockEntryImpl *) entry;
+
+  g_mutex_lock (&impl->lock);
+  if (restart)
+    entry->woken_up = TRUE;
+  g_cond_signal (&impl->cond);
+  g_mutex_unlock (&impl->lock);
+}
+
+/* this thread takes the earliest clock entry out of the heap.
  *
  * It waits on each of them and fires the callback when the timeout occurs.
  *
- * When an entry in the queue was canceled before we wait for it, it is
+ * When an entry in the heap was canceled before we wait for it, it is
  * simply skipped.
  *
  * When waiting for an entry, it can become canceled, in that case we don't
- * call the callback but move to the next item in the queue.
+ * call the callback but move to the next item in the heap. When an earlier
+ * entry is added while waiting, the entry is put back into the heap and we
+ * start again with the earliest entry.
  *
  * MT safe.
  */
@@ -435,11 +511,12 @@ gst_system_clock_async_thread (GstClock * clock)
   /* now enter our (almost) infinite loop */
   while (!priv->stopping) {
     GstClockEntry *entry;
+    GstClockEntryImpl *impl;
     GstClockTime requested;
     GstClockReturn res;
 
     /* check if something to be done */
-    while (priv->entries == NULL) {
+    while (priv->entries->len == 0) {
       GST_CAT_DEBUG (GST_CAT_CLOCK, "no clock entries, waiting..");
       /* wait for work to do */
       GST_SYSTEM_CLOCK_WAIT (clock);
@@ -449,16 +526,11 @@ gst_system_clock_async_thread (GstClock * clock)
         goto exit;
     }
 
-    /* see if we have a pending wakeup because the order of the list
-     * changed. */
-    if (priv->async_wakeup) {
-      GST_CAT_DEBUG (GST_CAT_CLOCK, "clear async wakeup");
-      gst_system_clock_remove_wakeup (sysclock);
-      priv->async_wakeup = FALSE;
-    }
-
-    /* pick the next entry */
-    entry = priv->entries->data;
+    /* pick the next entry, we take over the ref of the heap */
+    impl = g_ptr_array_index (priv->entries, 0);
+    entry = (GstClockEntry *) impl;
+    gst_system_clock_heap_remove (priv->entries, impl);
+    priv->current = entry;
 
     /* set entry status to busy before we release the clock lock */
     do {
@@ -513,10 +585,17 @@ gst_system_clock_async_thread (GstClock * clock)
           GST_CAT_DEBUG (GST_CAT_CLOCK, "updating periodic entry %p", entry);
           /* adjust time now */
           entry->time = requested + entry->interval;
-          /* and resort the list now */
-          priv->entries =
-              g_list_sort (priv->entries, gst_clock_id_compare_func);
-          /* and restart */
+          if (impl->heap_index >= 0) {
+            /* the callback scheduled it again already */
+            gst_system_clock_heap_update (priv->entries, impl);
+            goto next_entry;
+          }
+          if (GET_ENTRY_STATUS (entry) == GST_CLOCK_UNSCHEDULED)
+            goto next_entry;
+          /* and put it back into the heap, which takes our ref */
+          impl->heap_seqnum = priv->entries_seqnum++;
+          gst_system_clock_heap_push (priv->entries, impl);
+          priv->current = NULL;
           continue;
         } else {
           GST_CAT_DEBUG (GST_CAT_CLOCK, "moving to next entry");
@@ -524,16 +603,18 @@ gst_system_clock_async_thread (GstClock * clock)
         }
       }
       case GST_CLOCK_BUSY:
-        /* somebody unlocked the entry but is was not canceled, This means that
-         * either a new entry was added in front of the queue or some other entry
-         * was canceled. Whatever it is, pick the head entry of the list and
-         * continue waiting. */
+        /* an entry was added in front of this one. Put this one back into the
+         * heap and continue with the earliest entry. */
         GST_CAT_DEBUG (GST_CAT_CLOCK, "async entry %p needs restart", entry);
 
         /* we set the entry back to the OK state. This is needed so that the
          * _unschedule() code can see if an entry is currently being waited
          * on (when its state is BUSY). */
-        SET_ENTRY_STATUS (entry, GST_CLOCK_OK);
+        if (!CAS_ENTRY_STATUS (entry, GST_CLOCK_BUSY, GST_CLOCK_OK)
+            || impl->heap_index >= 0)
+          goto next_entry;
+        gst_system_clock_heap_push (priv->entries, impl);
+        priv->current = NULL;
         continue;
       default:
         GST_CAT_DEBUG (GST_CAT_CLOCK,
@@ -543,8 +624,8 @@ gst_system_clock_async_thread (GstClock * clock)
         goto next_entry;
     }
   next_entry:
-    /* we remove the current entry and unref it */
-    priv->entries = g_list_remove (priv->entries, entry);
+    /* we are done with the current entry and unref it */
+    priv->current = NULL;
     gst_clock_id_unref ((GstClockID) entry);
   }
 exit:
@@ -651,32 +732,14 @@ gst_system_clock_get_resolution (GstClock * clock)
 #endif /* __APPLE__ */
 }
 
-static inline void
-gst_system_clock_cleanup_unscheduled (GstSystemClock * sysclock,
-    GstClockEntry * entry)
-{
-  /* try to clean up.
-   * The unschedule function managed to set the status to
-   * unscheduled. We now take the lock and mark the entry as unscheduled.
-   * This makes sure that the unschedule function doesn't perform a
-   * wakeup anymore. If the unschedule function has a change to perform
-   * the wakeup before us, we clean up here */
-  GST_OBJECT_LOCK (sysclock);
-  entry->unscheduled = TRUE;
-  if (entry->woken_up) {
-    gst_system_clock_remove_wakeup (sysclock);
-  }
-  GST_OBJECT_UNLOCK (sysclock);
-}
-
 /* synchronously wait on the given GstClockEntry.
  *
- * We do this by blocking on the global GstPoll timer with
- * the requested timeout. This allows us to unblock the
- * entry by writing on the control fd.
+ * We do this by blocking on the condition of the entry with the requested
+ * timeout. This allows us to unblock just this entry by signalling the
+ * condition, other waiting entries are not disturbed.
  *
- * Note that writing the global GstPoll unlocks all waiting entries. So
- * we need to check if an unlocked entry has changed when it unlocks.
+ * The async thread passes %FALSE for @restart. It returns GST_CLOCK_BUSY
+ * then when an earlier entry was added while waiting.
  *
  * Entries that arrive too late are simply not waited on and a
  * GST_CLOCK_EARLY result is returned.
@@ -687,16 +750,14 @@ static GstClockReturn
 gst_system_clock_id_wait_jitter_unlocked (GstClock * clock,
     GstClockEntry * entry, GstClockTimeDiff * jitter, gboolean restart)
 {
-  GstSystemClock *sysclock = GST_SYSTEM_CLOCK_CAST (clock);
+  GstClockEntryImpl *impl = (GstClockEntryImpl *) entry;
   GstClockTime entryt, now;
   GstClockTimeDiff diff;
   GstClockReturn status;
 
   status = GET_ENTRY_STATUS (entry);
-  if (G_UNLIKELY (status == GST_CLOCK_UNSCHEDULED)) {
-    gst_system_clock_cleanup_unscheduled (sysclock, entry);
+  if (G_UNLIKELY (status == GST_CLOCK_UNSCHEDULED))
     return GST_CLOCK_UNSCHEDULED;
-  }
 
   /* need to call the overridden method because we want to sync against the time
    * of the clock, whatever the subclass uses as a clock. */
@@ -723,100 +784,71 @@ gst_system_clock_id_wait_jitter_unlocked (GstClock * clock,
 #endif
 
     while (TRUE) {
-      gint pollret;
+      gboolean woken_up;
 
-      /* now wait on the entry, it either times out or the fd is written. The
-       * status of the entry is BUSY only around the poll. */
-      pollret = gst_poll_wait (sysclock->priv->timer, diff);
+      /* now wait on the entry, it either times out or the condition is
+       * signalled. The status of the entry is checked with the lock of the
+       * entry held so that a wakeup can't get lost. The timeout is rounded
+       * up to the microseconds of the monotonic time. */
+      g_mutex_lock (&impl->lock);
+      status = GET_ENTRY_STATUS (entry);
+      woken_up = !restart && entry->woken_up;
+      if (woken_up)
+        entry->woken_up = FALSE;
+      else if (G_LIKELY (status != GST_CLOCK_UNSCHEDULED))
+        g_cond_wait_until (&impl->cond, &impl->lock,
+            g_get_monotonic_time () + (diff + 999) / 1000);
+      g_mutex_unlock (&impl->lock);
 
-      /* get the new status, mark as DONE. We do this so that the unschedule
-       * function knows when we left the poll and doesn't need to wakeup the
-       * poll anymore. */
-      do {
-        status = GET_ENTRY_STATUS (entry);
-        /* we were unscheduled, exit immediately */
-        if (G_UNLIKELY (status == GST_CLOCK_UNSCHEDULED))
-          break;
-        if (G_UNLIKELY (status != GST_CLOCK_BUSY))
-          GST_CAT_ERROR (GST_CAT_CLOCK, "unexpected status %d for entry %p",
-              status, entry);
-      } while (G_UNLIKELY (!CAS_ENTRY_STATUS (entry, status, GST_CLOCK_DONE)));
+      status = GET_ENTRY_STATUS (entry);
 
-      GST_CAT_DEBUG (GST_CAT_CLOCK, "entry %p unlocked, status %d, ret %d",
-          entry, status, pollret);
+      GST_CAT_DEBUG (GST_CAT_CLOCK, "entry %p unlocked, status %d", entry,
+          status);
 
-      if (G_UNLIKELY (status == GST_CLOCK_UNSCHEDULED)) {
-        gst_system_clock_cleanup_unscheduled (sysclock, entry);
+      if (G_UNLIKELY (status == GST_CLOCK_UNSCHEDULED))
         goto done;
-      } else {
-        if (G_UNLIKELY (pollret != 0)) {
-          /* some other id got unlocked */
-          if (!restart) {
-            /* this can happen if the entry got unlocked because of an async
-             * entry was added to the head of the async queue. */
-            GST_CAT_DEBUG (GST_CAT_CLOCK, "wakeup waiting for entry %p", entry);
-            goto done;
-          }
 
-          /* wait till all the entries got woken up */
-          GST_OBJECT_LOCK (sysclock);
-          gst_system_clock_wait_wakeup (sysclock);
-          GST_OBJECT_UNLOCK (sysclock);
+      if (G_UNLIKELY (woken_up)) {
+        /* this can happen if an async entry was added in front of this
+         * one */
+        GST_CAT_DEBUG (GST_CAT_CLOCK, "wakeup waiting for entry %p", entry);
+        goto done;
+      }
 
-          GST_CAT_DEBUG (GST_CAT_CLOCK, "entry %p needs to be restarted",
-              entry);
+      /* reschedule if the wait returned early */
+      now = gst_clock_get_time (clock);
+      diff = GST_CLOCK_DIFF (now, entryt);
+
+      if (diff <= 0) {
+        /* timeout, this is fine, we can report success now */
+        if (G_UNLIKELY (!CAS_ENTRY_STATUS (entry, GST_CLOCK_BUSY,
+                    GST_CLOCK_OK))) {
+          status = GET_ENTRY_STATUS (entry);
+          if (status != GST_CLOCK_UNSCHEDULED)
+            GST_CAT_ERROR (GST_CAT_CLOCK, "unexpected status %d for entry %p",
+                status, entry);
+          goto done;
         } else {
-          GST_CAT_DEBUG (GST_CAT_CLOCK, "entry %p unlocked after timeout",
-              entry);
+          status = GST_CLOCK_OK;
         }
 
-        /* reschedule if gst_poll_wait returned early or we have to reschedule after
-         * an unlock*/
-        now = gst_clock_get_time (clock);
-        diff = GST_CLOCK_DIFF (now, entryt);
-
-        if (diff <= 0) {
-          /* timeout, this is fine, we can report success now */
-          if (G_UNLIKELY (!CAS_ENTRY_STATUS (entry, GST_CLOCK_DONE,
-                      GST_CLOCK_OK))) {
-            status = GET_ENTRY_STATUS (entry);
-            if (status != GST_CLOCK_UNSCHEDULED)
-              GST_CAT_ERROR (GST_CAT_CLOCK, "unexpected status %d for entry %p",
-                  status, entry);
-            goto done;
-          } else {
-            status = GST_CLOCK_OK;
-          }
-
-          GST_CAT_DEBUG (GST_CAT_CLOCK,
-              "entry %p finished, diff %" G_GINT64_FORMAT, entry, diff);
+        GST_CAT_DEBUG (GST_CAT_CLOCK,
+            "entry %p finished, diff %" G_GINT64_FORMAT, entry, diff);
 
 #ifdef WAIT_DEBUGGING
-          final = gst_system_clock_get_internal_time (clock);
-          GST_CAT_DEBUG (GST_CAT_CLOCK, "Waited for %" G_GINT64_FORMAT
-              " got %" G_GINT64_FORMAT " diff %" G_GINT64_FORMAT
-              " %g target-offset %" G_GINT64_FORMAT " %g", entryt, now,
-              now - entryt,
-              (double) (GstClockTimeDiff) (now - entryt) / GST_SECOND,
-              (final - target),
-              ((double) (GstClockTimeDiff) (final - target)) / GST_SECOND);
+        final = gst_system_clock_get_internal_time (clock);
+        GST_CAT_DEBUG (GST_CAT_CLOCK, "Waited for %" G_GINT64_FORMAT
+            " got %" G_GINT64_FORMAT " diff %" G_GINT64_FORMAT
+            " %g target-offset %" G_GINT64_FORMAT " %g", entryt, now,
+            now - entryt,
+            (double) (GstClockTimeDiff) (now - entryt) / GST_SECOND,
+            (final - target),
+            ((double) (GstClockTimeDiff) (final - target)) / GST_SECOND);
 #endif
-          goto done;
-        } else {
-          GST_CAT_DEBUG (GST_CAT_CLOCK,
-              "entry %p restart, diff %" G_GINT64_FORMAT, entry, diff);
-          /* we are going to poll again, set status back to busy */
-          do {
-            status = GET_ENTRY_STATUS (entry);
-            /* we were unscheduled, exit immediately */
-            if (G_UNLIKELY (status == GST_CLOCK_UNSCHEDULED))
-              goto done;
-            if (G_UNLIKELY (status != GST_CLOCK_DONE))
-              GST_CAT_ERROR (GST_CAT_CLOCK, "unexpected status %d for entry %p",
-                  status, entry);
-          } while (G_UNLIKELY (!CAS_ENTRY_STATUS (entry, status,
-                      GST_CLOCK_BUSY)));
-        }
+        goto done;
+      } else {
+        GST_CAT_DEBUG (GST_CAT_CLOCK,
+            "entry %p restart, diff %" G_GINT64_FORMAT, entry, diff);
       }
     }
   } else {
@@ -824,9 +856,7 @@ gst_system_clock_id_wait_jitter_unlocked (GstClock * clock,
     if (G_UNLIKELY (diff == 0)) {
       if (G_UNLIKELY (!CAS_ENTRY_STATUS (entry, status, GST_CLOCK_OK))) {
         status = GET_ENTRY_STATUS (entry);
-        if (G_LIKELY (status == GST_CLOCK_UNSCHEDULED))
-          gst_system_clock_cleanup_unscheduled (sysclock, entry);
-        else
+        if (G_UNLIKELY (status != GST_CLOCK_UNSCHEDULED))
           GST_CAT_ERROR (GST_CAT_CLOCK, "unexpected status %d for entry %p",
               status, entry);
       } else {
@@ -835,9 +865,7 @@ gst_system_clock_id_wait_jitter_unlocked (GstClock * clock,
     } else {
       if (G_UNLIKELY (!CAS_ENTRY_STATUS (entry, status, GST_CLOCK_EARLY))) {
         status = GET_ENTRY_STATUS (entry);
-        if (G_LIKELY (status == GST_CLOCK_UNSCHEDULED))
-          gst_system_clock_cleanup_unscheduled (sysclock, entry);
-        else
+        if (G_UNLIKELY (status != GST_CLOCK_UNSCHEDULED))
           GST_CAT_ERROR (GST_CAT_CLOCK, "unexpected status %d for entry %p",
               status, entry);
       } else {
@@ -903,10 +931,9 @@ no_thread:
   return FALSE;
 }
 
-/* Add an entry to the list of pending async waits. The entry is inserted
- * in sorted order. If we inserted the entry at the head of the list, we
- * need to signal the thread as it might either be waiting on it or waiting
- * for a new entry.
+/* Add an entry to the heap of pending async waits. If the entry is now the
+ * earliest one, we need to signal the thread as it might either be waiting
+ * on a later entry or waiting for a new entry.
  *
  * MT safe.
  */
@@ -915,7 +942,8 @@ gst_system_clock_id_wait_async (GstClock * clock, GstClockEntry * entry)
 {
   GstSystemClock *sysclock;
   GstSystemClockPrivate *priv;
-  GstClockEntry *head;
+  GstClockEntryImpl *impl = (GstClockEntryImpl *) entry;
+  GstClockEntry *current;
 
   sysclock = GST_SYSTEM_CLOCK_CAST (clock);
   priv = sysclock->priv;
@@ -930,42 +958,39 @@ gst_system_clock_id_wait_async (GstClock * clock, GstClockEntry * entry)
   if (G_UNLIKELY (GET_ENTRY_STATUS (entry) == GST_CLOCK_UNSCHEDULED))
     goto was_unscheduled;
 
-  if (priv->entries)
-    head = priv->entries->data;
-  else
-    head = NULL;
-
-  /* need to take a ref */
-  gst_clock_id_ref ((GstClockID) entry);
-  /* insert the entry in sorted order */
-  priv->entries = g_list_insert_sorted (priv->entries, entry,
-      gst_clock_id_compare_func);
-
-  /* only need to send the signal if the entry was added to the
-   * front, else the thread is just waiting for another entry and
-   * will get to this entry automatically. */
-  if (priv->entries->data == entry) {
-    GST_CAT_DEBUG (GST_CAT_CLOCK, "async entry added to head %p", head);
-    if (head == NULL) {
-      /* the list was empty before, signal the cond so that the async thread can
-       * start taking a look at the queue */
+  impl->heap_seqnum = priv->entries_seqnum++;
+  if (G_UNLIKELY (impl->heap_index >= 0)) {
+    /* the entry is pending already, it only needs to be moved */
+    gst_system_clock_heap_update (priv->entries, impl);
+  } else {
+    /* need to take a ref */
+    gst_clock_id_ref ((GstClockID) entry);
+    gst_system_clock_heap_push (priv->entries, impl);
+  }
+
+  /* only need to send the signal if the entry is the earliest one, else the
+   * thread is just waiting for another entry and will get to this entry
+   * automatically. */
+  if (impl->heap_index == 0) {
+    current = priv->current;
+    if (current == NULL) {
+      /* the thread is not busy with an entry, signal the cond so that it can
+       * start taking a look at the heap */
       GST_CAT_DEBUG (GST_CAT_CLOCK, "first entry, sending signal");
       GST_SYSTEM_CLOCK_BROADCAST (clock);
-    } else {
+    } else if (gst_system_clock_entry_before (impl,
+            (GstClockEntryImpl *) current)) {
       GstClockReturn status;
 
-      status = GET_ENTRY_STATUS (head);
-      GST_CAT_DEBUG (GST_CAT_CLOCK, "head entry %p status %d", head, status);
+      status = GET_ENTRY_STATUS (current);
+      GST_CAT_DEBUG (GST_CAT_CLOCK, "current entry %p status %d", current,
+          status);
 
       if (status == GST_CLOCK_BUSY) {
-        GST_CAT_DEBUG (GST_CAT_CLOCK, "head entry is busy");
-        /* the async thread was waiting for an entry, unlock the wait so that it
-         * looks at the new head entry instead, we only need to do this once */
-        if (!priv->async_wakeup) {
-          GST_CAT_DEBUG (GST_CAT_CLOCK, "wakeup async thread");
-          priv->async_wakeup = TRUE;
-          gst_system_clock_add_wakeup (sysclock);
-        }
+        /* the async thread is waiting for a later entry, unlock the wait so
+         * that it looks at the new earliest entry instead */
+        GST_CAT_DEBUG (GST_CAT_CLOCK, "wakeup async thread");
+        gst_system_clock_entry_wakeup (current, TRUE);
       }
     }
   }
@@ -987,10 +1012,9 @@ was_unscheduled:
   }
 }
 
-/* unschedule an entry. This will set the state of the entry to GST_CLOCK_UNSCHEDULED
- * and will signal any thread waiting for entries to recheck their entry.
- * We cannot really decide if the signal is needed or not because the entry
- * could be waited on in async or sync mode.
+/* unschedule an entry. This will set the state of the entry to
+ * GST_CLOCK_UNSCHEDULED and will wake up the thread waiting for the entry,
+ * if any. A pending async entry is removed from the heap right away.
  *
  * MT safe.
  */
@@ -998,6 +1022,7 @@ static void
 gst_system_clock_id_unschedule (GstClock * clock, GstClockEntry * entry)
 {
   GstSystemClock *sysclock;
+  GstClockEntryImpl *impl = (GstClockEntryImpl *) entry;
   GstClockReturn status;
 
   sysclock = GST_SYSTEM_CLOCK_CAST (clock);
@@ -1011,16 +1036,17 @@ gst_system_clock_id_unschedule (GstClock * clock, GstClockEntry * entry)
   } while (G_UNLIKELY (!CAS_ENTRY_STATUS (entry, status,
               GST_CLOCK_UNSCHEDULED)));
 
+  if (impl->heap_index >= 0) {
+    /* the caller still has a ref, so this can't free the entry */
+    gst_system_clock_heap_remove (sysclock->priv->entries, impl);
+    gst_clock_id_unref ((GstClockID) entry);
+  }
+
   if (G_LIKELY (status == GST_CLOCK_BUSY)) {
-    /* the entry was being busy, wake up all entries so that they recheck their
-     * status. We cannot wake up just one entry because allocating such a
-     * datastructure for each entry would be too heavy and unlocking an entry
-     * is usually done when shutting down or some other exceptional case. */
+    /* the entry was being busy, wake up the thread waiting for it so that
+     * it rechecks its status */
     GST_CAT_DEBUG (GST_CAT_CLOCK, "entry was BUSY, doing wakeup");
-    if (!entry->unscheduled && !entry->woken_up) {
-      gst_system_clock_add_wakeup (sysclock);
-      entry->woken_up = TRUE;
-    }
+    gst_system_clock_entry_wakeup (entry, FALSE);
   }
   GST_OBJECT_UNLOCK (clock);
 }
@@ -157,6 +157,33 @@ static GArray *gst_value_union_funcs;
 static GArray *gst_value_intersect_funcs;
 static GArray *gst_value_subtract_funcs;
 
+/* The union, intersect and subtract functions of pairs of fundamental types
+ * are looked up directly in these tables, indexed by a slot for each of the
+ * two types. Pairs with other types, like GstStructure, are still found by
+ * walking the arrays above. */
+#define DISPATCH_N_SLOTS 16
+/* no functions are registered for the type, slot 0 of the tables is empty */
+#define DISPATCH_SLOT_NONE 0
+/* the functions of the type have to be looked up in the arrays */
+#define DISPATCH_SLOT_SCAN 0xff
+
+typedef struct _GstValueDispatch GstValueDispatch;
+struct _GstValueDispatch
+{
+  gpointer func;
+  /* the function takes the values in the other order */
+  gboolean swap;
+};
+
+static guint8 gst_value_dispatch_slots[FUNDAMENTAL_TYPE_ID_MAX + 1];
+static guint gst_value_n_dispatch_slots = 1;
+static GstValueDispatch
+    gst_value_union_dispatch[DISPATCH_N_SLOTS][DISPATCH_N_SLOTS];
+static GstValueDispatch
+    gst_value_intersect_dispatch[DISPATCH_N_SLOTS][DISPATCH_N_SLOTS];
+static GstValueDispatch
+    gst_value_subtract_dispatch[DISPATCH_N_SLOTS][DISPATCH_N_SLOTS];
+
 /* Forward declarations */
 static gchar *gst_value_serialize_fraction (const GValue * value);
 
@@ -191,6 +218,56 @@ gst_value_hash_add_type (GType type, const GstValueTable * table)
   g_hash_table_insert (gst_value_hash, (gpointer) type, (gpointer) table);
 }
 
+static inline guint
+gst_value_dispatch_slot (GType type)
+{
+  if (G_LIKELY (G_TYPE_IS_FUNDAMENTAL (type)))
+    return gst_value_dispatch_slots[FUNDAMENTAL_TYPE_ID (type)];
+  else
+    return DISPATCH_SLOT_SCAN;
+}
+
+static guint
+gst_value_dispatch_slot_new (GType type)
+{
+  guint8 *slot = &gst_value_dispatch_slots[FUNDAMENTAL_TYPE_ID (type)];
+
+  if (*slot == DISPATCH_SLOT_NONE) {
+    if (gst_value_n_dispatch_slots < DISPATCH_N_SLOTS)
+      *slot = gst_value_n_dispatch_slots++;
+    else
+      *slot = DISPATCH_SLOT_SCAN;
+  }
+  return *slot;
+}
+
+/* adds @func for @type1 and @type2 to @table, and for @type2 and @type1 when
+ * the function is @symmetric. Functions that were registered earlier for
+ * the same types are kept, like they are found first in the arrays. */
+static void
+gst_value_dispatch_add (GstValueDispatch table[][DISPATCH_N_SLOTS],
+    GType type1, GType type2, gpointer func, gboolean symmetric)
+{
+  guint slot1, slot2;
+
+  if (!G_TYPE_IS_FUNDAMENTAL (type1) || !G_TYPE_IS_FUNDAMENTAL (type2))
+    return;
+
+  slot1 = gst_value_dispatch_slot_new (type1);
+  slot2 = gst_value_dispatch_slot_new (type2);
+  if (slot1 == DISPATCH_SLOT_SCAN || slot2 == DISPATCH_SLOT_SCAN)
+    return;
+
+  if (table[slot1][slot2].func == NULL) {
+    table[slot1][slot2].func = func;
+    table[slot1][slot2].swap = FALSE;
+  }
+  if (symmetric && table[slot2][slot1].func == NULL) {
+    table[slot2][slot1].func = func;
+    table[slot2][slot1].swap = TRUE;
+  }
+}
+
 /********
  * list *
  ********/
@@ -2507,6 +2584,137 @@ _priv_gst_value_parse_simple_string (gchar * str, gchar ** end)
   return (s != str);
 }
 
+/* Reads an optional '-' and at most 9 decimal digits, which always fit in a
+ * gint. @leading_zero is set when there is more than one digit and the first
+ * one is a 0, gst_value_deserialize() reads those integers as octal. */
+static const gchar *
+gst_value_scan_decimal (const gchar * s, gint * val, gboolean * leading_zero)
+{
+  const gchar *digits;
+  gboolean negative = FALSE;
+  gint v = 0;
+
+  if (*s == '-') {
+    negative = TRUE;
+    s++;
+  }
+  digits = s;
+  while (g_ascii_isdigit (*s) && s - digits < 9) {
+    v = v * 10 + (*s - '0');
+    s++;
+  }
+  if (s == digits || g_ascii_isdigit (*s))
+    return NULL;
+
+  *val = negative ? -v : v;
+  *leading_zero = digits[0] == '0' && s - digits > 1;
+
+  return s;
+}
+
+/* Words that would be deserialized as something else than a string when
+ * probing the types in turn: named integer constants, booleans, the NULL
+ * string and infinity or NaN doubles */
+static gboolean
+gst_value_is_plain_word (const gchar * s)
+{
+  static const gchar *reserved[] = {
+    "min", "max", "little_endian", "big_endian", "byte_order",
+    "true", "yes", "t", "false", "no", "f"
+  };
+  const gchar *p;
+  guint i, hex;
+
+  if (!g_ascii_isalpha (*s))
+    return FALSE;
+
+  for (p = s; *p; p++) {
+    if (!g_ascii_isalnum (*p) && *p != '_' && *p != '-' && *p != '.'
+        && *p != '/')
+      return FALSE;
+  }
+
+  /* a hex number followed by a negative one is a flag set */
+  for (hex = 0; g_ascii_isxdigit (s[hex]); hex++);
+  if (hex > 0 && s[hex] == '-')
+    return FALSE;
+
+  if (strcmp (s, "NULL") == 0 || g_ascii_strncasecmp (s, "inf", 3) == 0
+      || g_ascii_strncasecmp (s, "nan", 3) == 0)
+    return FALSE;
+
+  for (i = 0; i < G_N_ELEMENTS (reserved); i++) {
+    if (g_ascii_strcasecmp (s, reserved[i]) == 0)
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* Builds the most common values, small decimal integers, decimal fractions
+ * and doubles and plain words, directly instead of going through
+ * gst_value_deserialize() for every type that is tried. Anything the
+ * deserializers could read differently is left to them. @value is
+ * initialized to @type already, or not initialized if @type is
+ * G_TYPE_INVALID because there was no type cast. */
+static gboolean
+gst_value_parse_fast (GValue * value, const gchar * s, GType type)
+{
+  const gchar *end;
+  gboolean leading_zero;
+  gdouble d;
+  gchar *d_end;
+  gint num, den;
+
+  if (type != G_TYPE_INVALID && type != G_TYPE_INT
+      && type != GST_TYPE_FRACTION)
+    return FALSE;
+
+  if (type == G_TYPE_INVALID && gst_value_is_plain_word (s)) {
+    g_value_init (value, G_TYPE_STRING);
+    g_value_set_string (value, s);
+    return TRUE;
+  }
+
+  end = gst_value_scan_decimal (s, &num, &leading_zero);
+  if (end == NULL)
+    return FALSE;
+
+  if (*end == '\0') {
+    if (type == GST_TYPE_FRACTION) {
+      gst_value_set_fraction (value, num, 1);
+      return TRUE;
+    }
+    if (leading_zero)
+      return FALSE;
+    if (type == G_TYPE_INVALID)
+      g_value_init (value, G_TYPE_INT);
+    g_value_set_int (value, num);
+    return TRUE;
+  }
+
+  if (*end == '/' && type != G_TYPE_INT) {
+    end = gst_value_scan_decimal (end + 1, &den, &leading_zero);
+    if (end == NULL || *end != '\0' || den == 0)
+      return FALSE;
+    if (type == G_TYPE_INVALID)
+      g_value_init (value, GST_TYPE_FRACTION);
+    gst_value_set_fraction (value, num, den);
+    return TRUE;
+  }
+
+  if (*end == '.' && type == G_TYPE_INVALID) {
+    d = g_ascii_strtod (s, &d_end);
+    if (*d_end != '\0')
+      return FALSE;
+    g_value_init (value, G_TYPE_DOUBLE);
+    g_value_set_double (value, d);
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
 gboolean
 _priv_gst_value_parse_value (gchar * str,
     gchar ** after, GValue * value, GType default_type)
@@ -2580,12 +2788,16 @@ _priv_gst_value_parse_value (gchar * str,
       c = *value_end;
       *value_end = '\0';
 
-      for (i = 0; i < G_N_ELEMENTS (try_types); i++) {
-        g_value_init (value, try_types[i]);
-        ret = gst_value_deserialize (value, value_s);
-        if (ret)
-          break;
-        g_value_unset (value);
+      if (gst_value_parse_fast (value, value_s, G_TYPE_INVALID)) {
+        ret = TRUE;
+      } else {
+        for (i = 0; i < G_N_ELEMENTS (try_types); i++) {
+          g_value_init (value, try_types[i]);
+          ret = gst_value_deserialize (value, value_s);
+          if (ret)
+            break;
+          g_value_unset (value);
+        }
       }
     } else {
       g_value_init (value, type);
@@ -2597,7 +2809,8 @@ _priv_gst_value_parse_value (gchar * str,
       c = *value_end;
       *value_end = '\0';
 
-      ret = gst_value_deserialize (value, value_s);
+      ret = gst_value_parse_fast (value, value_s, type)
+          || gst_value_deserialize (value, value_s);
       if (G_UNLIKELY (!ret))
         g_value_unset (value);
     }
@@ -5594,6 +5807,115 @@ gst_value_compare (const GValue * value1, const GValue * value2)
   return _gst_value_compare_nolist (value1, value2);
 }
 
+/* mixes @v into the running hash @h, the result depends on the order in
+ * which the values are mixed in */
+#define HASH_MIX(h,v) (((h) << 5) - (h) + (guint) (v))
+
+/*
+ * _priv_gst_value_hash:
+ * @value: a value to hash
+ *
+ * Hashes @value the way it is represented, so that values that are the same
+ * also hash the same. Values that gst_value_compare() only considers equal
+ * (like 1/2 and 2/4, lists with their items in another order, or "{ 1 }" and
+ * 1) can hash differently. Values of types that are not known here only hash
+ * their type.
+ *
+ * Returns: the hash of @value
+ */
+guint
+_priv_gst_value_hash (const GValue * value)
+{
+  GType type = G_VALUE_TYPE (value);
+  guint h = HASH_MIX (0, type);
+
+  if (type == GST_TYPE_LIST || type == GST_TYPE_ARRAY) {
+    guint i, len = VALUE_LIST_SIZE (value);
+
+    for (i = 0; i < len; i++)
+      h = HASH_MIX (h, _priv_gst_value_hash (VALUE_LIST_GET_VALUE (value, i)));
+  } else if (type == GST_TYPE_FRACTION) {
+    h = HASH_MIX (h, gst_value_get_fraction_numerator (value));
+    h = HASH_MIX (h, gst_value_get_fraction_denominator (value));
+  } else if (type == GST_TYPE_INT_RANGE) {
+    h = HASH_MIX (h, gst_value_get_int_range_min (value));
+    h = HASH_MIX (h, gst_value_get_int_range_max (value));
+    h = HASH_MIX (h, gst_value_get_int_range_step (value));
+  } else if (type == GST_TYPE_INT64_RANGE) {
+    gint64 v;
+
+    v = gst_value_get_int64_range_min (value);
+    h = HASH_MIX (h, g_int64_hash (&v));
+    v = gst_value_get_int64_range_max (value);
+    h = HASH_MIX (h, g_int64_hash (&v));
+    v = gst_value_get_int64_range_step (value);
+    h = HASH_MIX (h, g_int64_hash (&v));
+  } else if (type == GST_TYPE_DOUBLE_RANGE) {
+    gdouble v;
+
+    v = gst_value_get_double_range_min (value);
+    h = HASH_MIX (h, g_double_hash (&v));
+    v = gst_value_get_double_range_max (value);
+    h = HASH_MIX (h, g_double_hash (&v));
+  } else if (type == GST_TYPE_FRACTION_RANGE) {
+    h = HASH_MIX (h,
+        _priv_gst_value_hash (gst_value_get_fraction_range_min (value)));
+    h = HASH_MIX (h,
+        _priv_gst_value_hash (gst_value_get_fraction_range_max (value)));
+  } else if (type == GST_TYPE_BITMASK) {
+    guint64 v = gst_value_get_bitmask (value);
+
+    h = HASH_MIX (h, g_int64_hash (&v));
+  } else if (G_TYPE_IS_A (type, GST_TYPE_FLAG_SET)) {
+    h = HASH_MIX (h, gst_value_get_flagset_flags (value));
+    h = HASH_MIX (h, gst_value_get_flagset_mask (value));
+  } else if (type == GST_TYPE_STRUCTURE) {
+    const GstStructure *s = gst_value_get_structure (value);
+
+    if (s)
+      h = HASH_MIX (h, _priv_gst_structure_hash (s));
+  } else if (type == GST_TYPE_CAPS) {
+    const GstCaps *caps = gst_value_get_caps (value);
+
+    if (caps)
+      h = HASH_MIX (h, _priv_gst_caps_hash (caps));
+  } else {
+    switch (G_TYPE_FUNDAMENTAL (type)) {
+      case G_TYPE_BOOLEAN:
+        h = HASH_MIX (h, ! !g_value_get_boolean (value));
+        break;
+      case G_TYPE_INT:
+        h = HASH_MIX (h, g_value_get_int (value));
+        break;
+      case G_TYPE_UINT:
+        h = HASH_MIX (h, g_value_get_uint (value));
+        break;
+      case G_TYPE_INT64:
+      case G_TYPE_UINT64:
+        /* same storage for both */
+        h = HASH_MIX (h, g_int64_hash (&value->data[0].v_int64));
+        break;
+      case G_TYPE_DOUBLE:
+        h = HASH_MIX (h, g_double_hash (&value->data[0].v_double));
+        break;
+      case G_TYPE_ENUM:
+        h = HASH_MIX (h, g_value_get_enum (value));
+        break;
+      case G_TYPE_FLAGS:
+        h = HASH_MIX (h, g_value_get_flags (value));
+        break;
+      case G_TYPE_STRING:
+        if (g_value_get_string (value))
+          h = HASH_MIX (h, g_str_hash (g_value_get_string (value)));
+        break;
+      default:
+        break;
+    }
+  }
+
+  return h;
+}
+
 /*
  * gst_value_compare_with_func:
  * @value1: a value to compare
@@ -5620,6 +5942,39 @@ gst_value_compare_with_func (const GValue * value1, const GValue * value2,
 
 /* union */
 
+/* finds the union function for @type1 and @type2, @swap is set when the
+ * function takes the values the other way around */
+static GstValueUnionFunc
+gst_value_find_union_func (GType type1, GType type2, gboolean * swap)
+{
+  const GstValueUnionInfo *union_info;
+  const GstValueDispatch *dispatch;
+  guint i, len, slot1, slot2;
+
+  slot1 = gst_value_dispatch_slot (type1);
+  slot2 = gst_value_dispatch_slot (type2);
+  if (G_LIKELY (slot1 != DISPATCH_SLOT_SCAN && slot2 != DISPATCH_SLOT_SCAN)) {
+    dispatch = &gst_value_union_dispatch[slot1][slot2];
+    *swap = dispatch->swap;
+    return (GstValueUnionFunc) dispatch->func;
+  }
+
+  len = gst_value_union_funcs->len;
+  for (i = 0; i < len; i++) {
+    union_info = &g_array_index (gst_value_union_funcs, GstValueUnionInfo, i);
+    if (union_info->type1 == type1 && union_info->type2 == type2) {
+      *swap = FALSE;
+      return union_info->func;
+    }
+    if (union_info->type1 == type2 && union_info->type2 == type1) {
+      *swap = TRUE;
+      return union_info->func;
+    }
+  }
+
+  return NULL;
+}
+
 /**
  * gst_value_can_union:
  * @value1: a value to union
@@ -5639,25 +5994,13 @@ gst_value_compare_with_func (const GValue * value1, const GValue * value2,
 gboolean
 gst_value_can_union (const GValue * value1, const GValue * value2)
 {
-  GstValueUnionInfo *union_info;
-  guint i, len;
+  gboolean swap;
 
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
   g_return_val_if_fail (G_IS_VALUE (value2), FALSE);
 
-  len = gst_value_union_funcs->len;
-
-  for (i = 0; i < len; i++) {
-    union_info = &g_array_index (gst_value_union_funcs, GstValueUnionInfo, i);
-    if (union_info->type1 == G_VALUE_TYPE (value1) &&
-        union_info->type2 == G_VALUE_TYPE (value2))
-      return TRUE;
-    if (union_info->type1 == G_VALUE_TYPE (value2) &&
-        union_info->type2 == G_VALUE_TYPE (value1))
-      return TRUE;
-  }
-
-  return FALSE;
+  return gst_value_find_union_func (G_VALUE_TYPE (value1),
+      G_VALUE_TYPE (value2), &swap) != NULL;
 }
 
 /**
@@ -5673,9 +6016,8 @@ gst_value_can_union (const GValue * value1, const GValue * value2)
 gboolean
 gst_value_union (GValue * dest, const GValue * value1, const GValue * value2)
 {
-  const GstValueUnionInfo *union_info;
-  guint i, len;
-  GType type1, type2;
+  GstValueUnionFunc func;
+  gboolean swap;
 
   g_return_val_if_fail (dest != NULL, FALSE);
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
@@ -5683,18 +6025,12 @@ gst_value_union (GValue * dest, const GValue * value1, const GValue * value2)
   g_return_val_if_fail (gst_value_list_or_array_are_compatible (value1, value2),
       FALSE);
 
-  len = gst_value_union_funcs->len;
-  type1 = G_VALUE_TYPE (value1);
-  type2 = G_VALUE_TYPE (value2);
-
-  for (i = 0; i < len; i++) {
-    union_info = &g_array_index (gst_value_union_funcs, GstValueUnionInfo, i);
-    if (union_info->type1 == type1 && union_info->type2 == type2) {
-      return union_info->func (dest, value1, value2);
-    }
-    if (union_info->type1 == type2 && union_info->type2 == type1) {
-      return union_info->func (dest, value2, value1);
-    }
+  func = gst_value_find_union_func (G_VALUE_TYPE (value1),
+      G_VALUE_TYPE (value2), &swap);
+  if (func) {
+    if (swap)
+      return func (dest, value2, value1);
+    return func (dest, value1, value2);
   }
 
   gst_value_list_concat (dest, value1, value2);
@@ -5723,10 +6059,46 @@ gst_value_register_union_func (GType type1, GType type2, GstValueUnionFunc func)
   union_info.func = func;
 
   g_array_append_val (gst_value_union_funcs, union_info);
+  gst_value_dispatch_add (gst_value_union_dispatch, type1, type2,
+      (gpointer) func, TRUE);
 }
 
 /* intersection */
 
+/* finds the intersect function for @type1 and @type2, @swap is set when the
+ * function takes the values the other way around */
+static GstValueIntersectFunc
+gst_value_find_intersect_func (GType type1, GType type2, gboolean * swap)
+{
+  const GstValueIntersectInfo *intersect_info;
+  const GstValueDispatch *dispatch;
+  guint i, len, slot1, slot2;
+
+  slot1 = gst_value_dispatch_slot (type1);
+  slot2 = gst_value_dispatch_slot (type2);
+  if (G_LIKELY (slot1 != DISPATCH_SLOT_SCAN && slot2 != DISPATCH_SLOT_SCAN)) {
+    dispatch = &gst_value_intersect_dispatch[slot1][slot2];
+    *swap = dispatch->swap;
+    return (GstValueIntersectFunc) dispatch->func;
+  }
+
+  len = gst_value_intersect_funcs->len;
+  for (i = 0; i < len; i++) {
+    intersect_info = &g_array_index (gst_value_intersect_funcs,
+        GstValueIntersectInfo, i);
+    if (intersect_info->type1 == type1 && intersect_info->type2 == type2) {
+      *swap = FALSE;
+      return intersect_info->func;
+    }
+    if (intersect_info->type1 == type2 && intersect_info->type2 == type1) {
+      *swap = TRUE;
+      return intersect_info->func;
+    }
+  }
+
+  return NULL;
+}
+
 /**
  * gst_value_can_intersect:
  * @value1: a value to intersect
@@ -5741,9 +6113,8 @@ gst_value_register_union_func (GType type1, GType type2, GstValueUnionFunc func)
 gboolean
 gst_value_can_intersect (const GValue * value1, const GValue * value2)
 {
-  GstValueIntersectInfo *intersect_info;
-  guint i, len;
   GType type1, type2;
+  gboolean swap;
 
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
   g_return_val_if_fail (G_IS_VALUE (value2), FALSE);
@@ -5775,14 +6146,8 @@ gst_value_can_intersect (const GValue * value1, const GValue * value2)
   }
 
   /* check registered intersect functions */
-  len = gst_value_intersect_funcs->len;
-  for (i = 0; i < len; i++) {
-    intersect_info = &g_array_index (gst_value_intersect_funcs,
-        GstValueIntersectInfo, i);
-    if ((intersect_info->type1 == type1 && intersect_info->type2 == type2) ||
-        (intersect_info->type1 == type2 && intersect_info->type2 == type1))
-      return TRUE;
-  }
+  if (gst_value_find_intersect_func (type1, type2, &swap))
+    return TRUE;
 
   return gst_value_can_compare_unchecked (value1, value2);
 }
@@ -5807,9 +6172,9 @@ gboolean
 gst_value_intersect (GValue * dest, const GValue * value1,
     const GValue * value2)
 {
-  GstValueIntersectInfo *intersect_info;
-  guint i, len;
+  GstValueIntersectFunc func;
   GType type1, type2;
+  gboolean swap;
 
   g_return_val_if_fail (G_IS_VALUE (value1), FALSE);
   g_return_val_if_fail (G_IS_VALUE (value2), FALSE);
@@ -5829,16 +6194,11 @@ gst_value_intersect (GValue * dest, const GValue * value1,
     return TRUE;
   }
 
-  len = gst_value_intersect_funcs->len;
-  for (i = 0; i < len; i++) {
-    intersect_info = &g_array_index (gst_value_intersect_funcs,
-        GstValueIntersectInfo, i);
-    if (intersect_info->type1 == type1 && intersect_info->type2 == type2) {
-      return intersect_info->func (dest, value1, value2);
-    }
-    if (intersect_info->type1 == type2 && intersect_info->type2 == type1) {
-      return intersect_info->func (dest, value2, value1);
-    }
+  func = gst_value_find_intersect_func (type1, type2, &swap);
+  if (func) {
+    if (swap)
+      return func (dest, value2, value1);
+    return func (dest, value1, value2);
   }
 
   /* Failed to find a direct intersection, check if these are
@@ -5877,11 +6237,37 @@ gst_value_register_intersect_func (GType type1, GType type2,
   intersect_info.func = func;
 
   g_array_append_val (gst_value_intersect_funcs, intersect_info);
+  gst_value_dispatch_add (gst_value_intersect_dispatch, type1, type2,
+      (gpointer) func, TRUE);
 }
 
 
 /* subtraction */
 
+static GstValueSubtractFunc
+gst_value_find_subtract_func (GType mtype, GType stype)
+{
+  const GstValueSubtractInfo *info;
+  const GstValueDispatch *dispatch;
+  guint i, len, slot1, slot2;
+
+  slot1 = gst_value_dispatch_slot (mtype);
+  slot2 = gst_value_dispatch_slot (stype);
+  if (G_LIKELY (slot1 != DISPATCH_SLOT_SCAN && slot2 != DISPATCH_SLOT_SCAN)) {
+    dispatch = &gst_value_subtract_dispatch[slot1][slot2];
+    return (GstValueSubtractFunc) dispatch->func;
+  }
+
+  len = gst_value_subtract_funcs->len;
+  for (i = 0; i < len; i++) {
+    info = &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo, i);
+    if (info->minuend == mtype && info->subtrahend == stype)
+      return info->func;
+  }
+
+  return NULL;
+}
+
 /**
  * gst_value_subtract:
  * @dest: (out caller-allocates) (allow-none): the destination value
@@ -5900,8 +6286,7 @@ gboolean
 gst_value_subtract (GValue * dest, const GValue * minuend,
     const GValue * subtrahend)
 {
-  GstValueSubtractInfo *info;
-  guint i, len;
+  GstValueSubtractFunc func;
   GType mtype, stype;
 
   g_return_val_if_fail (G_IS_VALUE (minuend), FALSE);
@@ -5916,13 +6301,9 @@ gst_value_subtract (GValue * dest, const GValue * minuend,
   if (stype == GST_TYPE_LIST)
     return gst_value_subtract_list (dest, minuend, subtrahend);
 
-  len = gst_value_subtract_funcs->len;
-  for (i = 0; i < len; i++) {
-    info = &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo, i);
-    if (info->minuend == mtype && info->subtrahend == stype) {
-      return info->func (dest, minuend, subtrahend);
-    }
-  }
+  func = gst_value_find_subtract_func (mtype, stype);
+  if (func)
+    return func (dest, minuend, subtrahend);
 
   if (_gst_value_compare_nolist (minuend, subtrahend) != GST_VALUE_EQUAL) {
     if (dest)
@@ -5959,8 +6340,6 @@ gst_value_subtract (GValue * dest, const GValue * minuend,
 gboolean
 gst_value_can_subtract (const GValue * minuend, const GValue * subtrahend)
 {
-  GstValueSubtractInfo *info;
-  guint i, len;
   GType mtype, stype;
 
   g_return_val_if_fail (G_IS_VALUE (minuend), FALSE);
@@ -5975,12 +6354,8 @@ gst_value_can_subtract (const GValue * minuend, const GValue * subtrahend)
   if (mtype == GST_TYPE_STRUCTURE || stype == GST_TYPE_STRUCTURE)
     return FALSE;
 
-  len = gst_value_subtract_funcs->len;
-  for (i = 0; i < len; i++) {
-    info = &g_array_index (gst_value_subtract_funcs, GstValueSubtractInfo, i);
-    if (info->minuend == mtype && info->subtrahend == stype)
-      return TRUE;
-  }
+  if (gst_value_find_subtract_func (mtype, stype))
+    return TRUE;
 
   return gst_value_can_compare_unchecked (minuend, subtrahend);
 }
@@ -6011,6 +6386,8 @@ gst_value_register_subtract_func (GType minuend_type, GType subtrahend_type,
   info.func = func;
 
   g_array_append_val (gst_value_subtract_funcs, info);
+  gst_value_dispatch_add (gst_value_subtract_dispatch, minuend_type,
+      subtrahend_type, (gpointer) func, FALSE);
 }
 
 /**
@@ -6160,6 +6537,841 @@ gst_value_deserialize (GValue * dest, const gchar * src)
   return FALSE;
 }
 
+/************************
+ * binary serialization *
+ ************************/
+
+/* Structures and caps are written as a header of two bytes, the format
+ * version and 'S' or 'C', followed by:
+ *
+ *   structure: name, number of fields, field name and value per field
+ *   caps:      ANY flag, number of structures, structure and features
+ *              per structure
+ *   features:  0 for none (system memory), 1 for ANY, or 2 followed by
+ *              the number of features and their names
+ *   value:     a BinaryTag for the type followed by its payload
+ *
+ * Numbers are LEB128 varints, signed numbers are zigzag encoded first.
+ * Strings are a varint length followed by the bytes and a terminating 0 so
+ * that they can be used in place when reading. Doubles and floats are
+ * stored as they are in memory on little endian machines.
+ *
+ * Values of types that have no tag are written as their type name and
+ * gst_value_serialize() string.
+ */
+#define BINARY_VERSION 1
+#define BINARY_KIND_STRUCTURE 'S'
+#define BINARY_KIND_CAPS 'C'
+/* nesting of lists, arrays, structures and caps in values */
+#define BINARY_MAX_DEPTH 32
+
+typedef enum
+{
+  BINARY_TAG_INT = 1,
+  BINARY_TAG_UINT,
+  BINARY_TAG_INT64,
+  BINARY_TAG_UINT64,
+  BINARY_TAG_FALSE,
+  BINARY_TAG_TRUE,
+  BINARY_TAG_DOUBLE,
+  BINARY_TAG_FLOAT,
+  BINARY_TAG_STRING,
+  BINARY_TAG_NULL_STRING,
+  BINARY_TAG_FRACTION,
+  BINARY_TAG_INT_RANGE,
+  BINARY_TAG_INT64_RANGE,
+  BINARY_TAG_DOUBLE_RANGE,
+  BINARY_TAG_FRACTION_RANGE,
+  BINARY_TAG_LIST,
+  BINARY_TAG_ARRAY,
+  BINARY_TAG_BITMASK,
+  /* type name, flags and mask */
+  BINARY_TAG_FLAG_SET,
+  /* type name and value */
+  BINARY_TAG_ENUM,
+  BINARY_TAG_FLAGS,
+  BINARY_TAG_STRUCTURE,
+  BINARY_TAG_NULL_STRUCTURE,
+  BINARY_TAG_CAPS,
+  BINARY_TAG_NULL_CAPS,
+  /* type name and gst_value_serialize() string */
+  BINARY_TAG_SERIALIZED
+} BinaryTag;
+
+typedef struct
+{
+  const guint8 *data;
+  const guint8 *end;
+  guint depth;
+} BinaryReader;
+
+static gboolean binary_write_structure (GByteArray * array,
+    const GstStructure * structure, guint depth);
+static gboolean binary_write_caps (GByteArray * array, const GstCaps * caps,
+    guint depth);
+static GstStructure *binary_read_structure (BinaryReader * reader);
+static GstCaps *binary_read_caps (BinaryReader * reader);
+
+static void
+binary_write_byte (GByteArray * array, guint8 b)
+{
+  g_byte_array_append (array, &b, 1);
+}
+
+static void
+binary_write_varint (GByteArray * array, guint64 v)
+{
+  guint8 buf[10];
+  guint n = 0;
+
+  while (v >= 0x80) {
+    buf[n++] = (v & 0x7f) | 0x80;
+    v >>= 7;
+  }
+  buf[n++] = v;
+  g_byte_array_append (array, buf, n);
+}
+
+static void
+binary_write_zigzag (GByteArray * array, gint64 v)
+{
+  binary_write_varint (array, ((guint64) v << 1) ^ (guint64) (v >> 63));
+}
+
+static void
+binary_write_string (GByteArray * array, const gchar * str)
+{
+  gsize len = strlen (str);
+
+  binary_write_varint (array, len);
+  g_byte_array_append (array, (const guint8 *) str, len + 1);
+}
+
+static void
+binary_write_double (GByteArray * array, gdouble d)
+{
+  guint8 buf[8];
+
+  GST_WRITE_DOUBLE_LE (buf, d);
+  g_byte_array_append (array, buf, 8);
+}
+
+static gboolean
+binary_write_value (GByteArray * array, const GValue * value, guint depth)
+{
+  GType type = G_VALUE_TYPE (value);
+
+  if (depth > BINARY_MAX_DEPTH)
+    return FALSE;
+
+  switch (type) {
+    case G_TYPE_INT:
+      binary_write_byte (array, BINARY_TAG_INT);
+      binary_write_zigzag (array, g_value_get_int (value));
+      return TRUE;
+    case G_TYPE_UINT:
+      binary_write_byte (array, BINARY_TAG_UINT);
+      binary_write_varint (array, g_value_get_uint (value));
+      return TRUE;
+    case G_TYPE_INT64:
+      binary_write_byte (array, BINARY_TAG_INT64);
+      binary_write_zigzag (array, g_value_get_int64 (value));
+      return TRUE;
+    case G_TYPE_UINT64:
+      binary_write_byte (array, BINARY_TAG_UINT64);
+      binary_write_varint (array, g_value_get_uint64 (value));
+      return TRUE;
+    case G_TYPE_BOOLEAN:
+      binary_write_byte (array, g_value_get_boolean (value) ?
+          BINARY_TAG_TRUE : BINARY_TAG_FALSE);
+      return TRUE;
+    case G_TYPE_DOUBLE:
+      binary_write_byte (array, BINARY_TAG_DOUBLE);
+      binary_write_double (array, g_value_get_double (value));
+      return TRUE;
+    case G_TYPE_FLOAT:{
+      guint8 buf[4];
+
+      binary_write_byte (array, BINARY_TAG_FLOAT);
+      GST_WRITE_FLOAT_LE (buf, g_value_get_float (value));
+      g_byte_array_append (array, buf, 4);
+      return TRUE;
+    }
+    case G_TYPE_STRING:
+      if (g_value_get_string (value) == NULL) {
+        binary_write_byte (array, BINARY_TAG_NULL_STRING);
+      } else {
+        binary_write_byte (array, BINARY_TAG_STRING);
+        binary_write_string (array, g_value_get_string (value));
+      }
+      return TRUE;
+    default:
+      break;
+  }
+
+  if (type == GST_TYPE_FRACTION) {
+    binary_write_byte (array, BINARY_TAG_FRACTION);
+    binary_write_zigzag (array, gst_value_get_fraction_numerator (value));
+    binary_write_zigzag (array, gst_value_get_fraction_denominator (value));
+  } else if (type == GST_TYPE_INT_RANGE) {
+    binary_write_byte (array, BINARY_TAG_INT_RANGE);
+    binary_write_zigzag (array, gst_value_get_int_range_min (value));
+    binary_write_zigzag (array, gst_value_get_int_range_max (value));
+    binary_write_zigzag (array, gst_value_get_int_range_step (value));
+  } else if (type == GST_TYPE_INT64_RANGE) {
+    binary_write_byte (array, BINARY_TAG_INT64_RANGE);
+    binary_write_zigzag (array, gst_value_get_int64_range_min (value));
+    binary_write_zigzag (array, gst_value_get_int64_range_max (value));
+    binary_write_zigzag (array, gst_value_get_int64_range_step (value));
+  } else if (type == GST_TYPE_DOUBLE_RANGE) {
+    binary_write_byte (array, BINARY_TAG_DOUBLE_RANGE);
+    binary_write_double (array, gst_value_get_double_range_min (value));
+    binary_write_double (array, gst_value_get_double_range_max (value));
+  } else if (type == GST_TYPE_FRACTION_RANGE) {
+    const GValue *min = gst_value_get_fraction_range_min (value);
+    const GValue *max = gst_value_get_fraction_range_max (value);
+
+    binary_write_byte (array, BINARY_TAG_FRACTION_RANGE);
+    binary_write_zigzag (array, gst_value_get_fraction_numerator (min));
+    binary_write_zigzag (array, gst_value_get_fraction_denominator (min));
+    binary_write_zigzag (array, gst_value_get_fraction_numerator (max));
+    binary_write_zigzag (array, gst_value_get_fraction_denominator (max));
+  } else if (type == GST_TYPE_LIST || type == GST_TYPE_ARRAY) {
+    guint i, len = VALUE_LIST_SIZE (value);
+
+    binary_write_byte (array, type == GST_TYPE_LIST ?
+        BINARY_TAG_LIST : BINARY_TAG_ARRAY);
+    binary_write_varint (array, len);
+    for (i = 0; i < len; i++) {
+      if (!binary_write_value (array, VALUE_LIST_GET_VALUE (value, i),
+              depth + 1))
+        return FALSE;
+    }
+  } else if (type == GST_TYPE_BITMASK) {
+    binary_write_byte (array, BINARY_TAG_BITMASK);
+    binary_write_varint (array, gst_value_get_bitmask (value));
+  } else if (G_TYPE_IS_A (type, GST_TYPE_FLAG_SET)) {
+    binary_write_byte (array, BINARY_TAG_FLAG_SET);
+    binary_write_string (array, g_type_name (type));
+    binary_write_varint (array, gst_value_get_flagset_flags (value));
+    binary_write_varint (array, gst_value_get_flagset_mask (value));
+  } else if (G_TYPE_FUNDAMENTAL (type) == G_TYPE_ENUM) {
+    binary_write_byte (array, BINARY_TAG_ENUM);
+    binary_write_string (array, g_type_name (type));
+    binary_write_zigzag (array, g_value_get_enum (value));
+  } else if (G_TYPE_FUNDAMENTAL (type) == G_TYPE_FLAGS) {
+    binary_write_byte (array, BINARY_TAG_FLAGS);
+    binary_write_string (array, g_type_name (type));
+    binary_write_varint (array, g_value_get_flags (value));
+  } else if (type == GST_TYPE_STRUCTURE) {
+    const GstStructure *s = gst_value_get_structure (value);
+
+    if (s == NULL) {
+      binary_write_byte (array, BINARY_TAG_NULL_STRUCTURE);
+    } else {
+      binary_write_byte (array, BINARY_TAG_STRUCTURE);
+      return binary_write_structure (array, s, depth + 1);
+    }
+  } else if (type == GST_TYPE_CAPS) {
+    const GstCaps *caps = gst_value_get_caps (value);
+
+    if (caps == NULL) {
+      binary_write_byte (array, BINARY_TAG_NULL_CAPS);
+    } else {
+      binary_write_byte (array, BINARY_TAG_CAPS);
+      return binary_write_caps (array, caps, depth + 1);
+    }
+  } else {
+    gchar *str = gst_value_serialize (value);
+
+    if (str == NULL)
+      return FALSE;
+
+    binary_write_byte (array, BINARY_TAG_SERIALIZED);
+    binary_write_string (array, g_type_name (type));
+    binary_write_string (array, str);
+    g_free (str);
+  }
+
+  return TRUE;
+}
+
+typedef struct
+{
+  GByteArray *array;
+  guint depth;
+} BinaryWriteData;
+
+static gboolean
+binary_write_field (GQuark field_id, const GValue * value, gpointer user_data)
+{
+  BinaryWriteData *data = user_data;
+
+  binary_write_string (data->array, g_quark_to_string (field_id));
+  return binary_write_value (data->array, value, data->depth);
+}
+
+static gboolean
+binary_write_structure (GByteArray * array, const GstStructure * structure,
+    guint depth)
+{
+  BinaryWriteData data = { array, depth };
+
+  binary_write_string (array, gst_structure_get_name (structure));
+  binary_write_varint (array, gst_structure_n_fields (structure));
+
+  return gst_structure_foreach (structure, binary_write_field, &data);
+}
+
+static gboolean
+binary_write_caps (GByteArray * array, const GstCaps * caps, guint depth)
+{
+  GstCapsFeatures *features;
+  guint i, j, n, len;
+
+  binary_write_byte (array, gst_caps_is_any (caps));
+  len = gst_caps_get_size (caps);
+  binary_write_varint (array, len);
+
+  for (i = 0; i < len; i++) {
+    if (!binary_write_structure (array, gst_caps_get_structure (caps, i),
+            depth))
+      return FALSE;
+
+    features = gst_caps_get_features (caps, i);
+    if (features == NULL) {
+      binary_write_byte (array, 0);
+    } else if (gst_caps_features_is_any (features)) {
+      binary_write_byte (array, 1);
+    } else {
+      n = gst_caps_features_get_size (features);
+      binary_write_byte (array, 2);
+      binary_write_varint (array, n);
+      for (j = 0; j < n; j++)
+        binary_write_string (array, gst_caps_features_get_nth (features, j));
+    }
+  }
+
+  return TRUE;
+}
+
+gboolean
+_priv_gst_binary_write_structure (GByteArray * array,
+    const GstStructure * structure)
+{
+  guint len = array->len;
+
+  binary_write_byte (array, BINARY_VERSION);
+  binary_write_byte (array, BINARY_KIND_STRUCTURE);
+  if (binary_write_structure (array, structure, 0))
+    return TRUE;
+
+  g_byte_array_set_size (array, len);
+  return FALSE;
+}
+
+gboolean
+_priv_gst_binary_write_caps (GByteArray * array, const GstCaps * caps)
+{
+  guint len = array->len;
+
+  binary_write_byte (array, BINARY_VERSION);
+  binary_write_byte (array, BINARY_KIND_CAPS);
+  if (binary_write_caps (array, caps, 0))
+    return TRUE;
+
+  g_byte_array_set_size (array, len);
+  return FALSE;
+}
+
+static gboolean
+binary_read_byte (BinaryReader * reader, guint8 * b)
+{
+  if (reader->data >= reader->end)
+    return FALSE;
+
+  *b = *reader->data++;
+  return TRUE;
+}
+
+static gboolean
+binary_read_varint (BinaryReader * reader, guint64 * v)
+{
+  guint shift;
+
+  *v = 0;
+  for (shift = 0; shift < 64; shift += 7) {
+    guint8 b;
+
+    if (!binary_read_byte (reader, &b))
+      return FALSE;
+
+    *v |= (guint64) (b & 0x7f) << shift;
+    if (!(b & 0x80))
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+static gboolean
+binary_read_zigzag (BinaryReader * reader, gint64 * v)
+{
+  guint64 u;
+
+  if (!binary_read_varint (reader, &u))
+    return FALSE;
+
+  *v = (gint64) (u >> 1) ^ -(gint64) (u & 1);
+  return TRUE;
+}
+
+static gboolean
+binary_read_int (BinaryReader * reader, gint * v)
+{
+  gint64 v64;
+
+  if (!binary_read_zigzag (reader, &v64) || v64 < G_MININT || v64 > G_MAXINT)
+    return FALSE;
+
+  *v = v64;
+  return TRUE;
+}
+
+static gboolean
+binary_read_uint (BinaryReader * reader, guint * v)
+{
+  guint64 v64;
+
+  if (!binary_read_varint (reader, &v64) || v64 > G_MAXUINT)
+    return FALSE;
+
+  *v = v64;
+  return TRUE;
+}
+
+/* the string stays in the data that is read */
+static const gchar *
+binary_read_string (BinaryReader * reader)
+{
+  const gchar *str;
+  guint64 len;
+
+  if (!binary_read_varint (reader, &len)
+      || len >= (guint64) (reader->end - reader->data)
+      || reader->data[len] != '\0')
+    return NULL;
+
+  str = (const gchar *) reader->data;
+  reader->data += len + 1;
+
+  return str;
+}
+
+static gboolean
+binary_read_double (BinaryReader * reader, gdouble * d)
+{
+  if (reader->end - reader->data < 8)
+    return FALSE;
+
+  *d = GST_READ_DOUBLE_LE (reader->data);
+  reader->data += 8;
+  return TRUE;
+}
+
+/* reads a type name, the type has to be a @fundamental unless that is
+ * G_TYPE_INVALID */
+static GType
+binary_read_type (BinaryReader * reader, GType fundamental)
+{
+  const gchar *name = binary_read_string (reader);
+  GType type;
+
+  if (name == NULL)
+    return G_TYPE_INVALID;
+
+  /* g_value_init() needs a value type that is not abstract */
+  type = g_type_from_name (name);
+  if (type == G_TYPE_INVALID || !G_TYPE_IS_VALUE_TYPE (type)
+      || G_TYPE_IS_ABSTRACT (type)
+      || (fundamental != G_TYPE_INVALID && !G_TYPE_IS_A (type, fundamental)))
+    return G_TYPE_INVALID;
+
+  return type;
+}
+
+static gboolean binary_read_value (BinaryReader * reader, GValue * value);
+
+static gboolean
+binary_read_list (BinaryReader * reader, GValue * value, GType type)
+{
+  GValue item = G_VALUE_INIT;
+  guint64 i, len;
+
+  /* every item takes at least one byte */
+  if (!binary_read_varint (reader, &len)
+      || len > (guint64) (reader->end - reader->data))
+    return FALSE;
+
+  g_value_init (value, type);
+  for (i = 0; i < len; i++) {
+    if (!binary_read_value (reader, &item)) {
+      g_value_unset (value);
+      return FALSE;
+    }
+    if (type == GST_TYPE_LIST)
+      _gst_value_list_append_and_take_value (value, &item);
+    else
+      _gst_value_array_append_and_take_value (value, &item);
+  }
+
+  return TRUE;
+}
+
+/* reads a value into the uninitialized @value, which is left uninitialized
+ * when the data is invalid */
+static gboolean
+binary_read_value (BinaryReader * reader, GValue * value)
+{
+  guint8 tag;
+  gint64 i1, i2, i3;
+  guint64 u1, u2;
+  gdouble d1, d2;
+  gint n1, n2, n3, n4;
+  const gchar *str;
+  GType type;
+  gboolean ret = FALSE;
+
+  if (reader->depth > BINARY_MAX_DEPTH || !binary_read_byte (reader, &tag))
+    return FALSE;
+
+  reader->depth++;
+
+  switch (tag) {
+    case BINARY_TAG_INT:
+      if (binary_read_int (reader, &n1)) {
+        g_value_init (value, G_TYPE_INT);
+        g_value_set_int (value, n1);
+        ret = TRUE;
+      }
+      break;
+    case BINARY_TAG_UINT:{
+      guint u;
+
+      if (binary_read_uint (reader, &u)) {
+        g_value_init (value, G_TYPE_UINT);
+        g_value_set_uint (value, u);
+        ret = TRUE;
+      }
+      break;
+    }
+    case BINARY_TAG_INT64:
+      if (binary_read_zigzag (reader, &i1)) {
+        g_value_init (value, G_TYPE_INT64);
+        g_value_set_int64 (value, i1);
+        ret = TRUE;
+      }
+      break;
+    case BINARY_TAG_UINT64:
+      if (binary_read_varint (reader, &u1)) {
+        g_value_init (value, G_TYPE_UINT64);
+        g_value_set_uint64 (value, u1);
+        ret = TRUE;
+      }
+      break;
+    case BINARY_TAG_FALSE:
+    case BINARY_TAG_TRUE:
+      g_value_init (value, G_TYPE_BOOLEAN);
+      g_value_set_boolean (value, tag == BINARY_TAG_TRUE);
+      ret = TRUE;
+      break;
+    case BINARY_TAG_DOUBLE:
+      if (binary_read_double (reader, &d1)) {
+        g_value_init (value, G_TYPE_DOUBLE);
+        g_value_set_double (value, d1);
+        ret = TRUE;
+      }
+      break;
+    case BINARY_TAG_FLOAT:
+      if (reader->end - reader->data >= 4) {
+        g_value_init (value, G_TYPE_FLOAT);
+        g_value_set_float (value, GST_READ_FLOAT_LE (reader->data));
+        reader->data += 4;
+        ret = TRUE;
+      }
+      break;
+    case BINARY_TAG_STRING:
+      if ((str = binary_read_string (reader))) {
+        g_value_init (value, G_TYPE_STRING);
+        g_value_set_string (value, str);
+        ret = TRUE;
+      }
+      break;
+    case BINARY_TAG_NULL_STRING:
+      g_value_init (value, G_TYPE_STRING);
+      ret = TRUE;
+      break;
+    case BINARY_TAG_FRACTION:
+      if (binary_read_int (reader, &n1) && binary_read_int (reader, &n3)
+          && n3 != 0 && n1 != G_MININT && n3 != G_MININT) {
+        g_value_init (value, GST_TYPE_FRACTION);
+        gst_value_set_fraction (value, n1, n3);
+        ret = TRUE;
+      }
+      break;
+    case BINARY_TAG_INT_RANGE:
+      if (binary_read_int (reader, &n1) && binary_read_int (reader, &n2)
+          && binary_read_int (reader, &n3) && n3 > 0 && n1 < n2
+          && n1 % n3 == 0 && n2 % n3 == 0) {
+        g_value_init (value, GST_TYPE_INT_RANGE);
+        gst_value_set_int_range_step (value, n1, n2, n3);
+        ret = TRUE;
+      }
+      break;
+    case BINARY_TAG_INT64_RANGE:
+      if (binary_read_zigzag (reader, &i1) && binary_read_zigzag (reader, &i2)
+          && binary_read_zigzag (reader, &i3) && i3 > 0 && i1 < i2
+          && i1 % i3 == 0 && i2 % i3 == 0) {
+        g_value_init (value, GST_TYPE_INT64_RANGE);
+        gst_value_set_int64_range_step (value, i1, i2, i3);
+        ret = TRUE;
+      }
+      break;
+    case BINARY_TAG_DOUBLE_RANGE:
+      if (binary_read_double (reader, &d1) && binary_read_double (reader, &d2)
+          && d1 < d2) {
+        g_value_init (value, GST_TYPE_DOUBLE_RANGE);
+        gst_value_set_double_range (value, d1, d2);
+        ret = TRUE;
+      }
+      break;
+    case BINARY_TAG_FRACTION_RANGE:
+      if (binary_read_int (reader, &n1) && binary_read_int (reader, &n3)
+          && binary_read_int (reader, &n2) && binary_read_int (reader, &n4)
+          && n3 != 0 && n4 != 0 && n1 != G_MININT && n2 != G_MININT
+          && n3 != G_MININT && n4 != G_MININT
+          && gst_util_fraction_compare (n1, n3, n2, n4) < 0) {
+        g_value_init (value, GST_TYPE_FRACTION_RANGE);
+        gst_value_set_fraction_range_full (value, n1, n3, n2, n4);
+        ret = TRUE;
+      }
+      break;
+    case BINARY_TAG_LIST:
+      ret = binary_read_list (reader, value, GST_TYPE_LIST);
+      break;
+    case BINARY_TAG_ARRAY:
+      ret = binary_read_list (reader, value, GST_TYPE_ARRAY);
+      break;
+    case BINARY_TAG_BITMASK:
+      if (binary_read_varint (reader, &u1)) {
+        g_value_init (value, GST_TYPE_BITMASK);
+        gst_value_set_bitmask (value, u1);
+        ret = TRUE;
+      }
+      break;
+    case BINARY_TAG_FLAG_SET:
+      if ((type = binary_read_type (reader, GST_TYPE_FLAG_SET))
+          && binary_read_varint (reader, &u1) && u1 <= G_MAXUINT
+          && binary_read_varint (reader, &u2) && u2 <= G_MAXUINT) {
+        g_value_init (value, type);
+        gst_value_set_flagset (value, u1, u2);
+        ret = TRUE;
+      }
+      break;
+    case BINARY_TAG_ENUM:
+      if ((type = binary_read_type (reader, G_TYPE_ENUM))
+          && binary_read_int (reader, &n1)) {
+        g_value_init (value, type);
+        g_value_set_enum (value, n1);
+        ret = TRUE;
+      }
+      break;
+    case BINARY_TAG_FLAGS:{
+      guint u;
+
+      if ((type = binary_read_type (reader, G_TYPE_FLAGS))
+          && binary_read_uint (reader, &u)) {
+        g_value_init (value, type);
+        g_value_set_flags (value, u);
+        ret = TRUE;
+      }
+      break;
+    }
+    case BINARY_TAG_STRUCTURE:{
+      GstStructure *s = binary_read_structure (reader);
+
+      if (s) {
+        g_value_init (value, GST_TYPE_STRUCTURE);
+        g_value_take_boxed (value, s);
+        ret = TRUE;
+      }
+      break;
+    }
+    case BINARY_TAG_NULL_STRUCTURE:
+      g_value_init (value, GST_TYPE_STRUCTURE);
+      ret = TRUE;
+      break;
+    case BINARY_TAG_CAPS:{
+      GstCaps *caps = binary_read_caps (reader);
+
+      if (caps) {
+        g_value_init (value, GST_TYPE_CAPS);
+        g_value_take_boxed (value, caps);
+        ret = TRUE;
+      }
+      break;
+    }
+    case BINARY_TAG_NULL_CAPS:
+      g_value_init (value, GST_TYPE_CAPS);
+      ret = TRUE;
+      break;
+    case BINARY_TAG_SERIALIZED:
+      if ((type = binary_read_type (reader, G_TYPE_INVALID))
+          && (str = binary_read_string (reader))) {
+        g_value_init (value, type);
+        ret = gst_value_deserialize (value, str);
+        if (!ret)
+          g_value_unset (value);
+      }
+      break;
+    default:
+      break;
+  }
+
+  reader->depth--;
+
+  return ret;
+}
+
+static GstStructure *
+binary_read_structure (BinaryReader * reader)
+{
+  GstStructure *structure;
+  GValue value = G_VALUE_INIT;
+  const gchar *name;
+  guint64 i, n_fields;
+
+  name = binary_read_string (reader);
+  if (name == NULL || *name == '\0')
+    return NULL;
+
+  /* every field takes at least two bytes */
+  if (!binary_read_varint (reader, &n_fields)
+      || n_fields > (guint64) (reader->end - reader->data) / 2)
+    return NULL;
+
+  structure = gst_structure_new_id_empty (g_quark_from_string (name));
+  for (i = 0; i < n_fields; i++) {
+    name = binary_read_string (reader);
+    if (name == NULL || *name == '\0'
+        || !binary_read_value (reader, &value)) {
+      gst_structure_free (structure);
+      return NULL;
+    }
+    gst_structure_id_take_value (structure, g_quark_from_string (name),
+        &value);
+  }
+
+  return structure;
+}
+
+static GstCaps *
+binary_read_caps (BinaryReader * reader)
+{
+  GstStructure *structure;
+  GstCapsFeatures *features;
+  GstCaps *caps;
+  const gchar *name;
+  guint64 i, j, len, n;
+  guint8 b;
+
+  if (!binary_read_byte (reader, &b) || b > 1)
+    return NULL;
+
+  /* every structure takes at least three bytes */
+  if (!binary_read_varint (reader, &len)
+      || len > (guint64) (reader->end - reader->data) / 3)
+    return NULL;
+
+  if (b)
+    return len == 0 ? gst_caps_new_any () : NULL;
+
+  caps = gst_caps_new_empty ();
+  for (i = 0; i < len; i++) {
+    structure = binary_read_structure (reader);
+    if (structure == NULL || !binary_read_byte (reader, &b) || b > 2)
+      goto error;
+
+    features = NULL;
+    if (b == 1) {
+      features = gst_caps_features_new_any ();
+    } else if (b == 2) {
+      if (!binary_read_varint (reader, &n)
+          || n > (guint64) (reader->end - reader->data))
+        goto error;
+
+      features = gst_caps_features_new_empty ();
+      for (j = 0; j < n; j++) {
+        if (!(name = binary_read_string (reader))
+            || !_priv_gst_caps_feature_name_is_valid (name)) {
+          gst_caps_features_free (features);
+          goto error;
+        }
+        gst_caps_features_add (features, name);
+      }
+    }
+    gst_caps_append_structure_full (caps, structure, features);
+  }
+
+  return caps;
+
+error:
+  if (structure)
+    gst_structure_free (structure);
+  gst_caps_unref (caps);
+  return NULL;
+}
+
+static gboolean
+binary_read_header (BinaryReader * reader, guint8 kind)
+{
+  guint8 version, b;
+
+  return binary_read_byte (reader, &version) && version == BINARY_VERSION
+      && binary_read_byte (reader, &b) && b == kind;
+}
+
+GstStructure *
+_priv_gst_binary_read_structure (const guint8 * data, gsize size,
+    gsize * consumed)
+{
+  BinaryReader reader = { data, data + size, 0 };
+  GstStructure *structure = NULL;
+
+  if (binary_read_header (&reader, BINARY_KIND_STRUCTURE))
+    structure = binary_read_structure (&reader);
+
+  if (structure && consumed)
+    *consumed = reader.data - data;
+
+  return structure;
+}
+
+GstCaps *
+_priv_gst_binary_read_caps (const guint8 * data, gsize size, gsize * consumed)
+{
+  BinaryReader reader = { data, data + size, 0 };
+  GstCaps *caps = NULL;
+
+  if (binary_read_header (&reader, BINARY_KIND_CAPS))
+    caps = binary_read_caps (&reader);
+
+  if (caps && consumed)
+    *consumed = reader.data - data;
+
+  return caps;
+}
+
 static gboolean
 structure_field_is_fixed (GQuark field_id, const GValue * val,
     gpointer user_data)
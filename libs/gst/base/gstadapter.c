@@ -126,6 +126,7 @@
 
 #include <gst/gst_private.h>
 #include "gstadapter.h"
+#include "gstbytereader.h"
 #include <string.h>
 
 /* default size for the assembled data buffer */
@@ -511,10 +512,26 @@ gst_adapter_map (GstAdapter * adapter, gsize size)
 
     csize = gst_buffer_get_size (cur);
     if (csize >= size + skip) {
-      if (!gst_buffer_map (cur, &adapter->info, GST_MAP_READ))
-        return FALSE;
+      guint idx, length;
+      gsize mskip;
 
-      return (guint8 *) adapter->info.data + skip;
+      if (gst_buffer_n_memory (cur) == 1) {
+        if (!gst_buffer_map (cur, &adapter->info, GST_MAP_READ))
+          return FALSE;
+
+        return (guint8 *) adapter->info.data + skip;
+      }
+
+      /* only map the memory that contains the data, mapping the complete
+       * buffer would merge all of its memory. When the data spans several
+       * memories we only copy what is needed below. */
+      if (gst_buffer_find_memory (cur, skip, size, &idx, &length, &mskip)
+          && length == 1) {
+        if (!gst_buffer_map_range (cur, idx, 1, &adapter->info, GST_MAP_READ))
+          return FALSE;
+
+        return (guint8 *) adapter->info.data + mskip;
+      }
     }
     /* We may be able to efficiently merge buffers in our pool to
      * gather a big enough chunk to return it from the head buffer directly */
@@ -1626,6 +1643,38 @@ gst_adapter_prev_dts_at_offset (GstAdapter * adapter, gsize offset,
   return dts;
 }
 
+/* buffers with at most this many memories are mapped without allocating */
+#define SCAN_STACK_INFOS 16
+
+static GstMapInfo *
+scan_map_buffer (GstBuffer * buf, GstMapInfo * stack_infos, guint * n_infos)
+{
+  GstMapInfo *infos = stack_infos;
+  guint n;
+
+  n = gst_buffer_n_memory (buf);
+  if (G_UNLIKELY (n > SCAN_STACK_INFOS))
+    infos = g_new (GstMapInfo, n);
+
+  if (!gst_buffer_map_memories (buf, 0, -1, infos, GST_MAP_READ)) {
+    if (infos != stack_infos)
+      g_free (infos);
+    return NULL;
+  }
+
+  *n_infos = n;
+  return infos;
+}
+
+static void
+scan_unmap_buffer (GstBuffer * buf, GstMapInfo * infos, guint n_infos,
+    GstMapInfo * stack_infos)
+{
+  gst_buffer_unmap_memories (buf, infos, n_infos);
+  if (infos != stack_infos)
+    g_free (infos);
+}
+
 /**
  * gst_adapter_masked_scan_uint32_peek:
  * @adapter: a #GstAdapter
@@ -1654,11 +1703,15 @@ gst_adapter_masked_scan_uint32_peek (GstAdapter * adapter, guint32 mask,
     guint32 pattern, gsize offset, gsize size, guint32 * value)
 {
   GSList *g;
-  gsize skip, bsize, i;
+  gsize skip, pos, bsize, head, i;
   guint32 state;
-  GstMapInfo info;
+  GstMapInfo stack_infos[SCAN_STACK_INFOS];
+  GstMapInfo *infos;
+  guint m, n_infos;
   guint8 *bdata;
   GstBuffer *buf;
+  gssize result = -1;
+  gboolean start_code;
 
   g_return_val_if_fail (size > 0, -1);
   g_return_val_if_fail (offset + size <= adapter->size, -1);
@@ -1690,56 +1743,88 @@ gst_adapter_masked_scan_uint32_peek (GstAdapter * adapter, guint32 mask,
     buf = g->data;
     bsize = gst_buffer_get_size (buf);
   }
-  /* get the data now */
-  if (!gst_buffer_map (buf, &info, GST_MAP_READ))
+  /* get the data now, the memories are mapped separately so that buffers
+   * with multiple memories don't need to be merged */
+  infos = scan_map_buffer (buf, stack_infos, &n_infos);
+  if (infos == NULL)
     return -1;
 
-  bdata = (guint8 *) info.data + skip;
-  bsize = info.size - skip;
-  skip = 0;
+  /* and position on the first memory */
+  for (m = 0; skip >= infos[m].size; m++)
+    skip -= infos[m].size;
+
+  bdata = (guint8 *) infos[m].data + skip;
+  bsize = infos[m].size - skip;
+  pos = 0;
 
   /* set the state to something that does not match */
   state = ~pattern;
 
+  /* the MPEG and H264 start code is searched with the vectorized scan of
+   * GstByteReader, only the first bytes of every memory go through the state
+   * machine to find the start codes that begin in the previous memory */
+  start_code = (pattern == 0x00000100 && mask == 0xffffff00);
+
   /* now find data */
   do {
     bsize = MIN (bsize, size);
-    for (i = 0; i < bsize; i++) {
+    head = (start_code && bsize <= G_MAXUINT) ? MIN (bsize, 3) : bsize;
+    for (i = 0; i < head; i++) {
       state = ((state << 8) | bdata[i]);
       if (G_UNLIKELY ((state & mask) == pattern)) {
         /* we have a match but we need to have skipped at
          * least 4 bytes to fill the state. */
-        if (G_LIKELY (skip + i >= 3)) {
+        if (G_LIKELY (pos + i >= 3)) {
           if (G_LIKELY (value))
             *value = state;
-          gst_buffer_unmap (buf, &info);
-          return offset + skip + i - 3;
+          result = offset + pos + i - 3;
+          goto done;
         }
       }
     }
+    if (head < bsize) {
+      GstByteReader reader = GST_BYTE_READER_INIT (bdata, bsize);
+      guint found;
+
+      found = gst_byte_reader_masked_scan_uint32_peek (&reader, mask, pattern,
+          0, bsize, value);
+      if (found != (guint) - 1) {
+        result = offset + pos + found;
+        goto done;
+      }
+      /* keep the last bytes for the start codes across the boundary */
+      for (i = MAX (head, bsize - 3); i < bsize; i++)
+        state = ((state << 8) | bdata[i]);
+    }
     size -= bsize;
     if (size == 0)
       break;
 
-    /* nothing found yet, go to next buffer */
-    skip += bsize;
-    g = g_slist_next (g);
-    adapter->scan_offset += info.size;
-    adapter->scan_entry = g;
-    gst_buffer_unmap (buf, &info);
-    buf = g->data;
-
-    if (!gst_buffer_map (buf, &info, GST_MAP_READ))
-      return -1;
+    /* nothing found yet, go to the next memory or buffer */
+    pos += bsize;
+    m++;
+    /* skip buffers without memory too */
+    while (m == n_infos) {
+      g = g_slist_next (g);
+      adapter->scan_offset += gst_buffer_get_size (buf);
+      adapter->scan_entry = g;
+      scan_unmap_buffer (buf, infos, n_infos, stack_infos);
+      buf = g->data;
+
+      infos = scan_map_buffer (buf, stack_infos, &n_infos);
+      if (infos == NULL)
+        return -1;
+      m = 0;
+    }
 
-    bsize = info.size;
-    bdata = info.data;
+    bsize = infos[m].size;
+    bdata = infos[m].data;
   } while (TRUE);
 
-  gst_buffer_unmap (buf, &info);
+done:
+  scan_unmap_buffer (buf, infos, n_infos, stack_infos);
 
-  /* nothing found */
-  return -1;
+  return result;
 }
 
 /**
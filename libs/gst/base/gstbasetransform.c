@@ -61,6 +61,13 @@
  *     will automatically set/unset passthrough based on whether the
  *     element negotiates the same caps on both pads.
  *
+ *   * Buffer lists are kept together in passthrough mode: transform_ip is
+ *     called for every buffer and the buffers are pushed as one list.
+ *     Elements that push events from transform_ip should handle buffer
+ *     lists themselves, or the events could overtake the buffers. Elements
+ *     that install their own chain function get the buffers of a list one
+ *     by one.
+ *
  *   * #GstBaseTransformClass.passthrough_on_same_caps on an element that
  *     doesn't implement a transform_caps function is useful for elements that
  *     only inspect data (such as level)
@@ -270,6 +277,8 @@ static GstFlowReturn gst_base_transform_getrange (GstPad * pad,
     GstObject * parent, guint64 offset, guint length, GstBuffer ** buffer);
 static GstFlowReturn gst_base_transform_chain (GstPad * pad, GstObject * parent,
     GstBuffer * buffer);
+static GstFlowReturn gst_base_transform_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 static GstCaps *gst_base_transform_default_transform_caps (GstBaseTransform *
     trans, GstPadDirection direction, GstCaps * caps, GstCaps * filter);
 static GstCaps *gst_base_transform_default_fixate_caps (GstBaseTransform *
@@ -381,6 +390,8 @@ gst_base_transform_init (GstBaseTransform * trans,
       GST_DEBUG_FUNCPTR (gst_base_transform_sink_event));
   gst_pad_set_chain_function (trans->sinkpad,
       GST_DEBUG_FUNCPTR (gst_base_transform_chain));
+  gst_pad_set_chain_list_function (trans->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_base_transform_chain_list));
   gst_pad_set_activatemode_function (trans->sinkpad,
       GST_DEBUG_FUNCPTR (gst_base_transform_sink_activate_mode));
   gst_pad_set_query_function (trans->sinkpad,
@@ -2233,11 +2244,12 @@ pull_error:
 /* The flow of the chain function is the reverse of the
  * getrange() function - we have data, feed it to the sub-class
  * and then iterate, pushing buffers it generates until it either
- * wants more data or returns an error */
+ * wants more data or returns an error. The output buffers are pushed, or
+ * added to @out when it is not %NULL */
 static GstFlowReturn
-gst_base_transform_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+gst_base_transform_handle_buffer (GstBaseTransform * trans, GstBuffer * buffer,
+    GstBufferList * out)
 {
-  GstBaseTransform *trans = GST_BASE_TRANSFORM (parent);
   GstBaseTransformClass *klass = GST_BASE_TRANSFORM_GET_CLASS (trans);
   GstBaseTransformPrivate *priv = trans->priv;
   GstFlowReturn ret;
@@ -2309,7 +2321,10 @@ gst_base_transform_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
         }
         priv->processed++;
 
-        ret = gst_pad_push (trans->srcpad, outbuf);
+        if (out != NULL)
+          gst_buffer_list_add (out, outbuf);
+        else
+          ret = gst_pad_push (trans->srcpad, outbuf);
       } else {
         GST_DEBUG_OBJECT (trans, "we got return %s", gst_flow_get_name (ret));
         gst_buffer_unref (outbuf);
@@ -2328,6 +2343,93 @@ done:
   return ret;
 }
 
+static GstFlowReturn
+gst_base_transform_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  return gst_base_transform_handle_buffer (GST_BASE_TRANSFORM (parent), buffer,
+      NULL);
+}
+
+typedef struct
+{
+  GstBaseTransform *trans;
+  GstBufferList *out;
+  GstFlowReturn ret;
+} ChainListData;
+
+static gboolean
+chain_list_buffer (GstBuffer ** buffer, guint idx, gpointer user_data)
+{
+  ChainListData *data = user_data;
+  GstBuffer *buf = *buffer;
+
+  /* take the buffer out of the list so that in place transforms don't need
+   * to copy it */
+  *buffer = NULL;
+  data->ret = gst_base_transform_handle_buffer (data->trans, buf, data->out);
+
+  return data->ret == GST_FLOW_OK;
+}
+
+static GstFlowReturn
+gst_base_transform_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstBaseTransform *trans = GST_BASE_TRANSFORM (parent);
+  ChainListData data;
+  GstFlowReturn ret;
+  guint i, len;
+
+  len = gst_buffer_list_length (list);
+
+  /* a subclass that installed its own chain function expects to see every
+   * buffer there */
+  if (G_UNLIKELY (GST_PAD_CHAINFUNC (pad) != gst_base_transform_chain)) {
+    GstPadChainFunction chain = GST_PAD_CHAINFUNC (pad);
+
+    GST_LOG_OBJECT (trans, "chaining list of %u buffers one by one", len);
+
+    ret = GST_FLOW_OK;
+    for (i = 0; i < len && ret == GST_FLOW_OK; i++)
+      ret = chain (pad, parent, gst_buffer_ref (gst_buffer_list_get (list, i)));
+    gst_buffer_list_unref (list);
+
+    return ret;
+  }
+
+  data.trans = trans;
+  data.ret = GST_FLOW_OK;
+  data.out = NULL;
+  /* in passthrough mode the output buffers are collected and pushed as one
+   * list, otherwise they are pushed one by one */
+  if (gst_base_transform_is_passthrough (trans))
+    data.out = gst_buffer_list_new_sized (len);
+
+  GST_LOG_OBJECT (trans, "handling list of %u buffers%s", len,
+      data.out ? ", keeping it together" : "");
+
+  list = gst_buffer_list_make_writable (list);
+  gst_buffer_list_foreach (list, chain_list_buffer, &data);
+  gst_buffer_list_unref (list);
+
+  ret = data.ret;
+  if (data.out != NULL) {
+    /* the buffers before a failing one are pushed, like when they would have
+     * been pushed one by one */
+    if (gst_buffer_list_length (data.out) > 0) {
+      GstFlowReturn push_ret;
+
+      push_ret = gst_pad_push_list (trans->srcpad, data.out);
+      if (ret == GST_FLOW_OK)
+        ret = push_ret;
+    } else {
+      gst_buffer_list_unref (data.out);
+    }
+  }
+
+  return ret;
+}
+
 static void
 gst_base_transform_set_property (GObject * object, guint prop_id,
     const GValue * value, GParamSpec * pspec)
@@ -26,8 +26,19 @@
 #define GST_BYTE_READER_DISABLE_INLINES
 #include "gstbytereader.h"
 
+#include <gst/gstcpu.h>
 #include <string.h>
 
+#ifdef GST_CPU_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef GST_CPU_HAVE_AVX
+#include <immintrin.h>
+#endif
+#ifdef GST_CPU_HAVE_NEON64
+#include <arm_neon.h>
+#endif
+
 /**
  * SECTION:gstbytereader
  * @title: GstByteReader
@@ -821,12 +832,15 @@ gst_byte_reader_dup_data (GstByteReader * reader, guint size, guint8 ** val)
 }
 
 /* Special optimized scan for mask 0xffffff00 and pattern 0x00000100 */
-static inline gint
-_scan_for_start_code (const guint8 * data, guint size)
+static gint
+scan_for_start_code_generic (const guint8 * data, guint size)
 {
   guint8 *pdata = (guint8 *) data;
   guint8 *pend = (guint8 *) (data + size - 4);
 
+  if (size < 4)
+    return -1;
+
   while (pdata <= pend) {
     if (pdata[2] > 1) {
       pdata += 3;
@@ -843,6 +857,120 @@ _scan_for_start_code (const guint8 * data, guint size)
   return -1;
 }
 
+/* The vector versions look for the 0 byte a start code begins with in whole
+ * blocks and only check the positions of the 0 bytes they found. The rest
+ * that doesn't fill a block is scanned by the generic version. */
+
+static inline gint
+scan_for_start_code_tail (const guint8 * data, guint size, guint offset)
+{
+  gint ret = scan_for_start_code_generic (data + offset, size - offset);
+
+  return ret == -1 ? -1 : ret + offset;
+}
+
+#if defined(GST_CPU_HAVE_SSE2) || defined(GST_CPU_HAVE_AVX)
+#if defined(__GNUC__)
+#define FIRST_BIT(mask) __builtin_ctz (mask)
+#else
+#define FIRST_BIT(mask) g_bit_nth_lsf (mask, -1)
+#endif
+
+/* check the positions of the 0 bytes in @mask of the block at @offset */
+static inline gint
+check_zero_mask (const guint8 * data, guint size, guint offset, guint mask)
+{
+  while (mask) {
+    guint pos = offset + FIRST_BIT (mask);
+
+    if (pos + 4 > size)
+      break;
+    if (data[pos + 1] == 0 && data[pos + 2] == 1)
+      return pos;
+    mask &= mask - 1;
+  }
+  return -1;
+}
+#endif
+
+#ifdef GST_CPU_HAVE_SSE2
+static gint
+scan_for_start_code_sse2 (const guint8 * data, guint size)
+{
+  const __m128i zero = _mm_setzero_si128 ();
+  guint i;
+  gint ret;
+
+  for (i = 0; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128 ((const __m128i *) (data + i));
+    guint mask = _mm_movemask_epi8 (_mm_cmpeq_epi8 (v, zero));
+
+    if (G_UNLIKELY (mask) && (ret = check_zero_mask (data, size, i, mask)) >= 0)
+      return ret;
+  }
+  return scan_for_start_code_tail (data, size, i);
+}
+#endif
+
+#ifdef GST_CPU_HAVE_AVX
+GST_CPU_TARGET ("avx2")
+static gint
+scan_for_start_code_avx2 (const guint8 * data, guint size)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  guint i;
+  gint ret;
+
+  for (i = 0; i + 32 <= size; i += 32) {
+    __m256i v = _mm256_loadu_si256 ((const __m256i *) (data + i));
+    guint mask = (guint) _mm256_movemask_epi8 (_mm256_cmpeq_epi8 (v, zero));
+
+    if (G_UNLIKELY (mask) && (ret = check_zero_mask (data, size, i, mask)) >= 0)
+      return ret;
+  }
+  return scan_for_start_code_tail (data, size, i);
+}
+#endif
+
+#ifdef GST_CPU_HAVE_NEON64
+static gint
+scan_for_start_code_neon (const guint8 * data, guint size)
+{
+  const uint8x16_t zero = vdupq_n_u8 (0);
+  guint i, j;
+
+  for (i = 0; i + 16 <= size; i += 16) {
+    uint8x16_t v = vld1q_u8 (data + i);
+
+    if (G_LIKELY (vmaxvq_u8 (vceqq_u8 (v, zero)) == 0))
+      continue;
+
+    for (j = i; j < i + 16 && j + 4 <= size; j++) {
+      if (data[j] == 0 && data[j + 1] == 0 && data[j + 2] == 1)
+        return j;
+    }
+  }
+
+  return scan_for_start_code_tail (data, size, i);
+}
+#endif
+
+static const GstCpuImpl scan_for_start_code_impls[] = {
+#ifdef GST_CPU_HAVE_AVX
+  {"avx2", GST_CPU_FLAG_AVX2, (gpointer) scan_for_start_code_avx2},
+#endif
+#ifdef GST_CPU_HAVE_SSE2
+  {"sse2", GST_CPU_FLAG_SSE2, (gpointer) scan_for_start_code_sse2},
+#endif
+#ifdef GST_CPU_HAVE_NEON64
+  {"neon", GST_CPU_FLAG_NEON, (gpointer) scan_for_start_code_neon},
+#endif
+  {"generic", GST_CPU_FLAG_NONE, (gpointer) scan_for_start_code_generic}
+};
+
+GST_CPU_DISPATCH (gint, _scan_for_start_code, scan_for_start_code_impls,
+    (const guint8 * data, guint size), (data, size));
+
 static inline guint
 _masked_scan_uint32_peek (const GstByteReader * reader,
     guint32 mask, guint32 pattern, guint offset, guint size, guint32 * value)
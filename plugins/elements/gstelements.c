@@ -46,6 +46,8 @@
 #include "gstqueue2.h"
 #include "gsttee.h"
 #include "gsttypefindelement.h"
+#include "gstunixfdsink.h"
+#include "gstunixfdsrc.h"
 #include "gstvalve.h"
 #include "gststreamiddemux.h"
 
@@ -113,6 +115,14 @@ plugin_init (GstPlugin * plugin)
   if (!gst_element_register (plugin, "valve", GST_RANK_NONE,
           gst_valve_get_type ()))
     return FALSE;
+#ifdef HAVE_SYS_UN_H
+  if (!gst_element_register (plugin, "unixfdsink", GST_RANK_NONE,
+          gst_unix_fd_sink_get_type ()))
+    return FALSE;
+  if (!gst_element_register (plugin, "unixfdsrc", GST_RANK_NONE,
+          gst_unix_fd_src_get_type ()))
+    return FALSE;
+#endif
 
   if (!gst_element_register (plugin, "streamiddemux", GST_RANK_PRIMARY,
           gst_streamid_demux_get_type ()))
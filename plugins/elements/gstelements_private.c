@@ -190,22 +190,20 @@ gst_writev (gint fd, const struct iovec *iov, gint iovcnt, gsize total_bytes)
 static gsize
 fill_vectors (struct iovec *vecs, GstMapInfo * maps, guint n, GstBuffer * buf)
 {
-  GstMemory *mem;
   gsize size = 0;
   guint i;
 
   g_assert (gst_buffer_n_memory (buf) == n);
 
+  /* map the memories one by one, we don't want to merge them */
+  if (!gst_buffer_map_memories (buf, 0, -1, maps, GST_MAP_READ)) {
+    GST_WARNING ("Failed to map buffer %p for reading", buf);
+    memset (maps, 0, n * sizeof (GstMapInfo));
+  }
+
   for (i = 0; i < n; ++i) {
-    mem = gst_buffer_peek_memory (buf, i);
-    if (gst_memory_map (mem, &maps[i], GST_MAP_READ)) {
-      vecs[i].iov_base = maps[i].data;
-      vecs[i].iov_len = maps[i].size;
-    } else {
-      GST_WARNING ("Failed to map memory %p for reading", mem);
-      vecs[i].iov_base = (void *) "";
-      vecs[i].iov_len = 0;
-    }
+    vecs[i].iov_base = maps[i].data ? maps[i].data : (void *) "";
+    vecs[i].iov_len = maps[i].size;
     size += vecs[i].iov_len;
   }
 
@@ -214,19 +212,29 @@ fill_vectors (struct iovec *vecs, GstMapInfo * maps, guint n, GstBuffer * buf)
 
 GstFlowReturn
 gst_writev_buffers (GstObject * sink, gint fd, GstPoll * fdset,
-    GstBuffer ** buffers, guint num_buffers, guint8 * mem_nums,
+    GstBuffer ** buffers, guint num_buffers, guint * mem_nums,
     guint total_mem_num, guint64 * bytes_written, guint64 skip)
 {
-  struct iovec *vecs;
+  struct iovec *vecs, *alloc_vecs;
   GstMapInfo *map_infos;
   GstFlowReturn flow_ret;
+  gboolean on_heap;
   gsize size = 0;
   guint i, j;
 
   GST_LOG_OBJECT (sink, "%u buffers, %u memories", num_buffers, total_mem_num);
 
-  vecs = g_newa (struct iovec, total_mem_num);
-  map_infos = g_newa (GstMapInfo, total_mem_num);
+  /* buffers can have any number of memories, don't blow up the stack */
+  on_heap = total_mem_num * (sizeof (struct iovec) + sizeof (GstMapInfo)) >
+      FDSINK_MAX_ALLOCA_SIZE;
+  if (on_heap) {
+    alloc_vecs = g_new (struct iovec, total_mem_num);
+    map_infos = g_new (GstMapInfo, total_mem_num);
+  } else {
+    alloc_vecs = g_newa (struct iovec, total_mem_num);
+    map_infos = g_newa (GstMapInfo, total_mem_num);
+  }
+  vecs = alloc_vecs;
 
   /* populate output vectors */
   for (i = 0, j = 0; i < num_buffers; ++i) {
@@ -312,8 +320,15 @@ gst_writev_buffers (GstObject * sink, gint fd, GstPoll * fdset,
 
 out:
 
-  for (i = 0; i < total_mem_num; ++i)
-    gst_memory_unmap (map_infos[i].memory, &map_infos[i]);
+  for (i = 0, j = 0; i < num_buffers; ++i) {
+    gst_buffer_unmap_memories (buffers[i], &map_infos[j], mem_nums[i]);
+    j += mem_nums[i];
+  }
+
+  if (on_heap) {
+    g_free (alloc_vecs);
+    g_free (map_infos);
+  }
 
   return flow_ret;
 
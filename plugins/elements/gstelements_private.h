@@ -36,7 +36,7 @@ gchar *   gst_buffer_get_meta_string (GstBuffer * buffer);
 G_GNUC_INTERNAL
 GstFlowReturn  gst_writev_buffers (GstObject * sink, gint fd, GstPoll * fdset,
                                    GstBuffer ** buffers, guint num_buffers,
-                                   guint8 * mem_nums, guint total_mem_num,
+                                   guint * mem_nums, guint total_mem_num,
                                    guint64 * bytes_written, guint64 skip);
 
 G_END_DECLS
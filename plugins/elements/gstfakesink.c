@@ -132,6 +132,10 @@ static GstFlowReturn gst_fake_sink_preroll (GstBaseSink * bsink,
     GstBuffer * buffer);
 static GstFlowReturn gst_fake_sink_render (GstBaseSink * bsink,
     GstBuffer * buffer);
+static GstFlowReturn gst_fake_sink_render_list (GstBaseSink * bsink,
+    GstBufferList * list);
+static GstFlowReturn gst_fake_sink_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 static gboolean gst_fake_sink_event (GstBaseSink * bsink, GstEvent * event);
 static gboolean gst_fake_sink_query (GstBaseSink * bsink, GstQuery * query);
 
@@ -240,12 +244,16 @@ gst_fake_sink_class_init (GstFakeSinkClass * klass)
   gstbase_sink_class->event = GST_DEBUG_FUNCPTR (gst_fake_sink_event);
   gstbase_sink_class->preroll = GST_DEBUG_FUNCPTR (gst_fake_sink_preroll);
   gstbase_sink_class->render = GST_DEBUG_FUNCPTR (gst_fake_sink_render);
+  gstbase_sink_class->render_list =
+      GST_DEBUG_FUNCPTR (gst_fake_sink_render_list);
   gstbase_sink_class->query = GST_DEBUG_FUNCPTR (gst_fake_sink_query);
 }
 
 static void
 gst_fake_sink_init (GstFakeSink * fakesink)
 {
+  GstPad *sinkpad = GST_BASE_SINK_PAD (fakesink);
+
   fakesink->silent = DEFAULT_SILENT;
   fakesink->dump = DEFAULT_DUMP;
   fakesink->last_message = g_strdup (DEFAULT_LAST_MESSAGE);
@@ -256,6 +264,11 @@ gst_fake_sink_init (GstFakeSink * fakesink)
   gst_base_sink_set_sync (GST_BASE_SINK (fakesink), DEFAULT_SYNC);
   gst_base_sink_set_drop_out_of_segment (GST_BASE_SINK (fakesink),
       DEFAULT_DROP_OUT_OF_SEGMENT);
+
+  /* basesink only installs its chain_list function on the pad */
+  fakesink->parent_chain_list = GST_PAD_CHAINLISTFUNC (sinkpad);
+  gst_pad_set_chain_list_function (sinkpad,
+      GST_DEBUG_FUNCPTR (gst_fake_sink_chain_list));
 }
 
 static void
@@ -517,6 +530,41 @@ eos:
   }
 }
 
+static GstFlowReturn
+gst_fake_sink_render_list (GstBaseSink * bsink, GstBufferList * list)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint i, len;
+
+  len = gst_buffer_list_length (list);
+  for (i = 0; i < len && ret == GST_FLOW_OK; i++)
+    ret = gst_fake_sink_render (bsink, gst_buffer_list_get (list, i));
+
+  return ret;
+}
+
+/* basesink only synchronizes on the first buffer of a list, when syncing
+ * every buffer is chained on its own to keep the timing of the buffers */
+static GstFlowReturn
+gst_fake_sink_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstPadChainFunction chain;
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint i, len;
+
+  if (!gst_base_sink_get_sync (GST_BASE_SINK_CAST (parent)))
+    return GST_FAKE_SINK_CAST (parent)->parent_chain_list (pad, parent, list);
+
+  chain = GST_PAD_CHAINFUNC (pad);
+  len = gst_buffer_list_length (list);
+  for (i = 0; i < len && ret == GST_FLOW_OK; i++)
+    ret = chain (pad, parent, gst_buffer_ref (gst_buffer_list_get (list, i)));
+  gst_buffer_list_unref (list);
+
+  return ret;
+}
+
 static gboolean
 gst_fake_sink_query (GstBaseSink * bsink, GstQuery * query)
 {
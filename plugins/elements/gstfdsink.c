@@ -242,7 +242,7 @@ gst_fd_sink_query (GstBaseSink * bsink, GstQuery * query)
 
 static GstFlowReturn
 gst_fd_sink_render_buffers (GstFdSink * sink, GstBuffer ** buffers,
-    guint num_buffers, guint8 * mem_nums, guint total_mems)
+    guint num_buffers, guint * mem_nums, guint total_mems)
 {
   GstFlowReturn ret;
   guint64 skip = 0;
@@ -274,7 +274,7 @@ gst_fd_sink_render_list (GstBaseSink * bsink, GstBufferList * buffer_list)
   GstFlowReturn flow;
   GstBuffer **buffers;
   GstFdSink *sink;
-  guint8 *mem_nums;
+  guint *mem_nums;
   guint total_mems;
   guint i, num_buffers;
 
@@ -286,7 +286,7 @@ gst_fd_sink_render_list (GstBaseSink * bsink, GstBufferList * buffer_list)
 
   /* extract buffers from list and count memories */
   buffers = g_newa (GstBuffer *, num_buffers);
-  mem_nums = g_newa (guint8, num_buffers);
+  mem_nums = g_newa (guint, num_buffers);
   for (i = 0, total_mems = 0; i < num_buffers; ++i) {
     buffers[i] = gst_buffer_list_get (buffer_list, i);
     mem_nums[i] = gst_buffer_n_memory (buffers[i]);
@@ -311,7 +311,7 @@ gst_fd_sink_render (GstBaseSink * bsink, GstBuffer * buffer)
 {
   GstFlowReturn flow;
   GstFdSink *sink;
-  guint8 n_mem;
+  guint n_mem;
 
   sink = GST_FD_SINK_CAST (bsink);
 
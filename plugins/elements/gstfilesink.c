@@ -655,7 +655,7 @@ gst_file_sink_get_current_offset (GstFileSink * filesink, guint64 * p_pos)
 
 static GstFlowReturn
 gst_file_sink_render_buffers (GstFileSink * sink, GstBuffer ** buffers,
-    guint num_buffers, guint8 * mem_nums, guint total_mems)
+    guint num_buffers, guint * mem_nums, guint total_mems)
 {
   GST_DEBUG_OBJECT (sink,
       "writing %u buffers (%u memories) at position %" G_GUINT64_FORMAT,
@@ -671,7 +671,7 @@ gst_file_sink_render_list (GstBaseSink * bsink, GstBufferList * buffer_list)
   GstFlowReturn flow;
   GstBuffer **buffers;
   GstFileSink *sink;
-  guint8 *mem_nums;
+  guint *mem_nums;
   guint total_mems;
   guint i, num_buffers;
   gboolean sync_after = FALSE;
@@ -684,7 +684,7 @@ gst_file_sink_render_list (GstBaseSink * bsink, GstBufferList * buffer_list)
 
   /* extract buffers from list and count memories */
   buffers = g_newa (GstBuffer *, num_buffers);
-  mem_nums = g_newa (guint8, num_buffers);
+  mem_nums = g_newa (guint, num_buffers);
   for (i = 0, total_mems = 0; i < num_buffers; ++i) {
     buffers[i] = gst_buffer_list_get (buffer_list, i);
     mem_nums[i] = gst_buffer_n_memory (buffers[i]);
@@ -720,7 +720,7 @@ gst_file_sink_render (GstBaseSink * sink, GstBuffer * buffer)
 {
   GstFileSink *filesink;
   GstFlowReturn flow;
-  guint8 n_mem;
+  guint n_mem;
 
   filesink = GST_FILE_SINK_CAST (sink);
 
@@ -111,6 +111,8 @@ static void gst_identity_get_property (GObject * object, guint prop_id,
 
 static gboolean gst_identity_sink_event (GstBaseTransform * trans,
     GstEvent * event);
+static GstFlowReturn gst_identity_chain_list (GstPad * pad,
+    GstObject * parent, GstBufferList * list);
 static GstFlowReturn gst_identity_transform_ip (GstBaseTransform * trans,
     GstBuffer * buf);
 static gboolean gst_identity_start (GstBaseTransform * trans);
@@ -276,6 +278,8 @@ gst_identity_class_init (GstIdentityClass * klass)
 static void
 gst_identity_init (GstIdentity * identity)
 {
+  GstPad *sinkpad;
+
   identity->sleep_time = DEFAULT_SLEEP_TIME;
   identity->error_after = DEFAULT_ERROR_AFTER;
   identity->drop_probability = DEFAULT_DROP_PROBABILITY;
@@ -293,6 +297,14 @@ gst_identity_init (GstIdentity * identity)
   g_cond_init (&identity->blocked_cond);
 
   gst_base_transform_set_gap_aware (GST_BASE_TRANSFORM_CAST (identity), TRUE);
+
+  /* basetransform keeps buffer lists together in passthrough mode, we wrap
+   * its chain_list function for the cases where that can't be done. It is
+   * only installed on the pad, so it is kept per instance */
+  sinkpad = GST_BASE_TRANSFORM_SINK_PAD (identity);
+  identity->parent_chain_list = GST_PAD_CHAINLISTFUNC (sinkpad);
+  gst_pad_set_chain_list_function (sinkpad,
+      GST_DEBUG_FUNCPTR (gst_identity_chain_list));
 }
 
 static void
@@ -601,6 +613,39 @@ gst_identity_update_last_message_for_buffer (GstIdentity * identity,
   gst_identity_notify_last_message (identity);
 }
 
+static GstFlowReturn
+gst_identity_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstIdentity *identity = GST_IDENTITY (parent);
+  GstPadChainFunction chain;
+  GstFlowReturn ret = GST_FLOW_OK;
+  gboolean keep_list;
+  guint i, len;
+
+  /* dropped buffers are replaced by gap events and sync and sleep-time pace
+   * every buffer, all of that only works when the buffers are pushed one by
+   * one */
+  GST_OBJECT_LOCK (identity);
+  keep_list = identity->drop_probability <= 0.0
+      && identity->drop_buffer_flags == 0 && !identity->sync
+      && identity->sleep_time == 0 && identity->error_after < 0;
+  GST_OBJECT_UNLOCK (identity);
+
+  if (keep_list)
+    return identity->parent_chain_list (pad, parent, list);
+
+  GST_LOG_OBJECT (identity, "handling buffer list one buffer at a time");
+
+  chain = GST_PAD_CHAINFUNC (pad);
+  len = gst_buffer_list_length (list);
+  for (i = 0; i < len && ret == GST_FLOW_OK; i++)
+    ret = chain (pad, parent, gst_buffer_ref (gst_buffer_list_get (list, i)));
+  gst_buffer_list_unref (list);
+
+  return ret;
+}
+
 static GstFlowReturn
 gst_identity_transform_ip (GstBaseTransform * trans, GstBuffer * buf)
 {
@@ -79,6 +79,7 @@ struct _GstIdentity {
   gboolean       blocked;
   GstClockTimeDiff  ts_offset;
   gboolean       drop_allocation;
+  GstPadChainListFunction parent_chain_list;
 };
 
 struct _GstIdentityClass {
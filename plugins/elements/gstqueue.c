@@ -54,6 +54,13 @@
  * the specified minimum thresholds require (by default: when the queue is
  * empty). The #GstQueue::overrun signal is emitted when the queue is filled
  * up. Both signals are emitted from the context of the streaming thread.
+ *
+ * When the memory budget of the process, set with
+ * gst_allocator_set_memory_budget(), gets exceeded, the queue posts an element
+ * message named "GstMemoryBudgetExceeded" with its current level in the
+ * "current-level-buffers", "current-level-bytes" and "current-level-time"
+ * fields. The message is posted once every time the budget gets exceeded so
+ * that the application can find the queue that holds on to the memory.
  */
 
 #include "gst/gst_private.h"
@@ -1173,11 +1180,39 @@ discont_first_buffer (GstBuffer ** buffer, guint i, gpointer user_data)
   return FALSE;
 }
 
+/* with the lock, returns a message to post after releasing it */
+static GstMessage *
+gst_queue_check_memory_budget (GstQueue * queue)
+{
+  GstStructure *s;
+
+  if (G_LIKELY (!gst_allocator_memory_budget_exceeded ())) {
+    queue->over_budget = FALSE;
+    return NULL;
+  }
+
+  if (queue->over_budget)
+    return NULL;
+  queue->over_budget = TRUE;
+
+  GST_WARNING_OBJECT (queue, "memory budget exceeded, queue holds %u buffers, "
+      "%u bytes, %" GST_TIME_FORMAT, queue->cur_level.buffers,
+      queue->cur_level.bytes, GST_TIME_ARGS (queue->cur_level.time));
+
+  s = gst_structure_new ("GstMemoryBudgetExceeded",
+      "current-level-buffers", G_TYPE_UINT, queue->cur_level.buffers,
+      "current-level-bytes", G_TYPE_UINT, queue->cur_level.bytes,
+      "current-level-time", G_TYPE_UINT64, queue->cur_level.time, NULL);
+
+  return gst_message_new_element (GST_OBJECT_CAST (queue), s);
+}
+
 static GstFlowReturn
 gst_queue_chain_buffer_or_list (GstPad * pad, GstObject * parent,
     GstMiniObject * obj, gboolean is_list)
 {
   GstQueue *queue;
+  GstMessage *msg;
 
   queue = GST_QUEUE_CAST (parent);
 
@@ -1286,8 +1321,12 @@ gst_queue_chain_buffer_or_list (GstPad * pad, GstObject * parent,
     gst_queue_locked_enqueue_buffer_list (queue, obj);
   else
     gst_queue_locked_enqueue_buffer (queue, obj);
+  msg = gst_queue_check_memory_budget (queue);
   GST_QUEUE_MUTEX_UNLOCK (queue);
 
+  if (G_UNLIKELY (msg))
+    gst_element_post_message (GST_ELEMENT_CAST (queue), msg);
+
   return GST_FLOW_OK;
 
   /* special conditions */
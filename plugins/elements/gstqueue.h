@@ -138,6 +138,9 @@ struct _GstQueue {
   GstQuery *last_handled_query;
 
   gboolean flush_on_eos; /* flush on EOS */
+
+  /* memory budget exceeded message was posted */
+  gboolean over_budget;
 };
 
 struct _GstQueueClass {
@@ -0,0 +1,324 @@
+/* GStreamer
+ * gstunixfdprotocol.c: wire protocol shared by unixfdsink and unixfdsrc
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <errno.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include "gstunixfdprotocol.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+#ifndef MSG_CMSG_CLOEXEC
+#define MSG_CMSG_CLOEXEC 0
+#endif
+
+/* the only meta that is transported, it's the only core meta that has a
+ * meaning outside of the process that created it */
+#define REFERENCE_TIMESTAMP_META_NAME "GstReferenceTimestampMeta"
+
+/* Returns: %FALSE with errno set when the message could not be sent, EAGAIN
+ * when @blocking is %FALSE and the socket is full */
+gboolean
+gst_unix_fd_send_message (gint socket, GstUnixFdMessageType type,
+    gconstpointer payload, gsize payload_size, const gint * fds, guint n_fds,
+    gboolean blocking)
+{
+  GstUnixFdMessageHeader header;
+  struct msghdr msg = { 0, };
+  struct iovec iov[2];
+  union
+  {
+    struct cmsghdr hdr;
+    gchar buf[CMSG_SPACE (sizeof (gint) * GST_UNIX_FD_MAX_FDS)];
+  } control;
+  gssize res;
+  gint flags;
+
+  g_return_val_if_fail (n_fds <= GST_UNIX_FD_MAX_FDS, FALSE);
+  g_return_val_if_fail (payload_size + sizeof (header) <=
+      GST_UNIX_FD_MAX_MESSAGE_SIZE, FALSE);
+
+  header.type = type;
+  header.payload_size = payload_size;
+
+  iov[0].iov_base = &header;
+  iov[0].iov_len = sizeof (header);
+  iov[1].iov_base = (gpointer) payload;
+  iov[1].iov_len = payload_size;
+
+  msg.msg_iov = iov;
+  msg.msg_iovlen = 2;
+
+  if (n_fds > 0) {
+    struct cmsghdr *cmsg;
+
+    memset (&control, 0, sizeof (control));
+    msg.msg_control = control.buf;
+    msg.msg_controllen = CMSG_SPACE (sizeof (gint) * n_fds);
+
+    cmsg = CMSG_FIRSTHDR (&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN (sizeof (gint) * n_fds);
+    memcpy (CMSG_DATA (cmsg), fds, sizeof (gint) * n_fds);
+  }
+
+  flags = MSG_NOSIGNAL;
+  if (!blocking)
+    flags |= MSG_DONTWAIT;
+
+  do {
+    res = sendmsg (socket, &msg, flags);
+  } while (res < 0 && errno == EINTR);
+
+  if (res < 0)
+    return FALSE;
+
+  /* seqpacket sockets send the datagram atomically or not at all */
+  if (res != sizeof (header) + payload_size) {
+    errno = EMSGSIZE;
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static void
+close_fds (gint * fds, guint n_fds)
+{
+  guint i;
+
+  for (i = 0; i < n_fds; i++)
+    close (fds[i]);
+}
+
+/* Returns: the size of the payload stored in @payload, 0 when the peer closed
+ * the connection or -1 with errno set on error. The caller owns the fds
+ * returned in @fds, at most GST_UNIX_FD_MAX_FDS are returned. */
+gssize
+gst_unix_fd_receive_message (gint socket, gboolean blocking,
+    GstUnixFdMessageType * type, gpointer payload, gsize max_size,
+    gint * fds, guint * n_fds)
+{
+  GstUnixFdMessageHeader header;
+  struct msghdr msg = { 0, };
+  struct cmsghdr *cmsg;
+  struct iovec iov[2];
+  union
+  {
+    struct cmsghdr hdr;
+    gchar buf[CMSG_SPACE (sizeof (gint) * GST_UNIX_FD_MAX_FDS)];
+  } control;
+  gssize res;
+  gint flags;
+
+  *n_fds = 0;
+
+  iov[0].iov_base = &header;
+  iov[0].iov_len = sizeof (header);
+  iov[1].iov_base = payload;
+  iov[1].iov_len = max_size;
+
+  msg.msg_iov = iov;
+  msg.msg_iovlen = 2;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof (control.buf);
+
+  flags = MSG_CMSG_CLOEXEC;
+  if (!blocking)
+    flags |= MSG_DONTWAIT;
+
+  do {
+    res = recvmsg (socket, &msg, flags);
+  } while (res < 0 && errno == EINTR);
+
+  if (res <= 0)
+    return res;
+
+  for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+    if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+      guint n = (cmsg->cmsg_len - CMSG_LEN (0)) / sizeof (gint);
+
+      n = MIN (n, GST_UNIX_FD_MAX_FDS - *n_fds);
+      memcpy (fds + *n_fds, CMSG_DATA (cmsg), n * sizeof (gint));
+      *n_fds += n;
+    }
+  }
+
+  if (msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) {
+    errno = EMSGSIZE;
+    goto error;
+  }
+
+  if (res < sizeof (header) || header.payload_size != res - sizeof (header)
+      || header.payload_size == 0) {
+    errno = EPROTO;
+    goto error;
+  }
+
+  *type = header.type;
+
+  return header.payload_size;
+
+error:
+  {
+    close_fds (fds, *n_fds);
+    *n_fds = 0;
+    return -1;
+  }
+}
+
+static gboolean
+filter_serializable (GQuark field_id, GValue * value, gpointer user_data)
+{
+  gchar *str;
+
+  str = gst_value_serialize (value);
+  if (str == NULL)
+    return FALSE;
+
+  g_free (str);
+  return TRUE;
+}
+
+gchar *
+gst_unix_fd_serialize_event (GstEvent * event)
+{
+  const GstStructure *s;
+  GstStructure *copy;
+  gchar *str;
+
+  s = gst_event_get_structure (event);
+  if (s == NULL)
+    return g_strdup ("");
+
+  /* drop what only makes sense in this process, like the GstStream object
+   * of the stream-start event */
+  copy = gst_structure_copy (s);
+  gst_structure_filter_and_map_in_place (copy, filter_serializable, NULL);
+  str = gst_structure_to_string (copy);
+  gst_structure_free (copy);
+
+  return str;
+}
+
+GstEvent *
+gst_unix_fd_deserialize_event (GstEventType type, guint32 seqnum,
+    const gchar * str)
+{
+  GstStructure *s = NULL;
+  GstEvent *event;
+
+  if (str[0] != '\0') {
+    s = gst_structure_from_string (str, NULL);
+    if (s == NULL)
+      return NULL;
+  }
+
+  event = gst_event_new_custom (type, s);
+  if (event && seqnum != GST_SEQNUM_INVALID)
+    gst_event_set_seqnum (event, seqnum);
+
+  return event;
+}
+
+gchar *
+gst_unix_fd_serialize_metas (GstBuffer * buffer)
+{
+  GstReferenceTimestampMeta *meta;
+  gpointer state = NULL;
+  GstCaps *metas = NULL;
+  gchar *str;
+
+  while ((meta = (GstReferenceTimestampMeta *)
+          gst_buffer_iterate_meta_filtered (buffer, &state,
+              GST_REFERENCE_TIMESTAMP_META_API_TYPE))) {
+    if (metas == NULL)
+      metas = gst_caps_new_empty ();
+
+    gst_caps_append_structure (metas,
+        gst_structure_new (REFERENCE_TIMESTAMP_META_NAME,
+            "reference", GST_TYPE_CAPS, meta->reference,
+            "timestamp", G_TYPE_UINT64, meta->timestamp,
+            "duration", G_TYPE_UINT64, meta->duration, NULL));
+  }
+
+  if (metas == NULL)
+    return g_strdup ("");
+
+  str = gst_caps_to_string (metas);
+  gst_caps_unref (metas);
+
+  return str;
+}
+
+/* Returns: %FALSE when @str does not describe valid metas */
+gboolean
+gst_unix_fd_deserialize_metas (GstBuffer * buffer, const gchar * str)
+{
+  GstCaps *metas;
+  guint i, n;
+
+  if (str[0] == '\0')
+    return TRUE;
+
+  metas = gst_caps_from_string (str);
+  if (metas == NULL)
+    return FALSE;
+
+  n = gst_caps_get_size (metas);
+  for (i = 0; i < n; i++) {
+    GstStructure *s = gst_caps_get_structure (metas, i);
+    const GValue *reference;
+    guint64 timestamp, duration;
+
+    if (!gst_structure_has_name (s, REFERENCE_TIMESTAMP_META_NAME))
+      continue;
+
+    reference = gst_structure_get_value (s, "reference");
+    if (reference == NULL || !GST_VALUE_HOLDS_CAPS (reference)
+        || gst_value_get_caps (reference) == NULL
+        || !gst_structure_get_uint64 (s, "timestamp", &timestamp)
+        || !gst_structure_get_uint64 (s, "duration", &duration))
+      goto invalid;
+
+    gst_buffer_add_reference_timestamp_meta (buffer,
+        (GstCaps *) gst_value_get_caps (reference), timestamp, duration);
+  }
+  gst_caps_unref (metas);
+
+  return TRUE;
+
+invalid:
+  {
+    gst_caps_unref (metas);
+    return FALSE;
+  }
+}
@@ -0,0 +1,103 @@
+/* GStreamer
+ * gstunixfdprotocol.h: wire protocol shared by unixfdsink and unixfdsrc
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_UNIX_FD_PROTOCOL_H__
+#define __GST_UNIX_FD_PROTOCOL_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* Every message is exactly one SOCK_SEQPACKET datagram: a
+ * GstUnixFdMessageHeader followed by the payload. BUFFER messages carry one
+ * memfd file descriptor per memory as SCM_RIGHTS ancillary data. All integers
+ * are in host byte order, both peers live on the same machine. */
+
+#define GST_UNIX_FD_MAX_FDS           16
+#define GST_UNIX_FD_MAX_MESSAGE_SIZE  (64 * 1024)
+
+typedef enum {
+  GST_UNIX_FD_MESSAGE_EVENT   = 1,
+  GST_UNIX_FD_MESSAGE_BUFFER  = 2,
+  GST_UNIX_FD_MESSAGE_RELEASE = 3
+} GstUnixFdMessageType;
+
+typedef struct {
+  guint32 type;
+  guint32 payload_size;
+} GstUnixFdMessageHeader;
+
+/* EVENT: followed by the NUL terminated serialized event structure, an empty
+ * string when the event has no structure */
+typedef struct {
+  guint32 type;
+  guint32 seqnum;
+} GstUnixFdEventPayload;
+
+/* BUFFER: followed by @n_memory GstUnixFdMemoryPayload, one for each passed
+ * fd, and the NUL terminated serialized metas */
+typedef struct {
+  guint64 id;
+  guint64 pts;
+  guint64 dts;
+  guint64 duration;
+  guint64 offset;
+  guint64 offset_end;
+  guint32 flags;
+  guint32 n_memory;
+} GstUnixFdBufferPayload;
+
+typedef struct {
+  guint64 offset;
+  guint64 size;
+} GstUnixFdMemoryPayload;
+
+/* RELEASE: sent back by the receiver when the buffer @id was freed */
+typedef struct {
+  guint64 id;
+} GstUnixFdReleasePayload;
+
+G_GNUC_INTERNAL
+gboolean   gst_unix_fd_send_message    (gint socket, GstUnixFdMessageType type,
+                                        gconstpointer payload, gsize payload_size,
+                                        const gint * fds, guint n_fds,
+                                        gboolean blocking);
+
+G_GNUC_INTERNAL
+gssize     gst_unix_fd_receive_message (gint socket, gboolean blocking,
+                                        GstUnixFdMessageType * type,
+                                        gpointer payload, gsize max_size,
+                                        gint * fds, guint * n_fds);
+
+G_GNUC_INTERNAL
+gchar *    gst_unix_fd_serialize_event   (GstEvent * event);
+
+G_GNUC_INTERNAL
+GstEvent * gst_unix_fd_deserialize_event (GstEventType type, guint32 seqnum,
+                                          const gchar * str);
+
+G_GNUC_INTERNAL
+gchar *    gst_unix_fd_serialize_metas   (GstBuffer * buffer);
+
+G_GNUC_INTERNAL
+gboolean   gst_unix_fd_deserialize_metas (GstBuffer * buffer, const gchar * str);
+
+G_END_DECLS
+
+#endif /* __GST_UNIX_FD_PROTOCOL_H__ */
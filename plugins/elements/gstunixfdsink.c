@@ -0,0 +1,773 @@
+/* GStreamer
+ * gstunixfdsink.c: send buffers to another process over a Unix socket
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:element-unixfdsink
+ * @title: unixfdsink
+ * @see_also: #GstUnixFdSrc
+ *
+ * Send buffers to a #GstUnixFdSrc in another process without copying the
+ * data.
+ *
+ * The element listens on the Unix socket #GstUnixFdSink:socket-path and
+ * serves one client at a time. Buffer memory is passed as memfd file
+ * descriptors, together with the timestamps, flags and
+ * #GstReferenceTimestampMeta of the buffer. Caps, segments and all other
+ * serialized events are forwarded too and the sticky events are replayed
+ * when a client connects.
+ *
+ * The element proposes the memfd allocator to upstream, so that buffers can
+ * be sent without any copy. Other memory is copied into memfd memory once.
+ * Buffers are kept alive until the client dropped them. A client that holds
+ * more than #GstUnixFdSink:max-buffers buffers is disconnected.
+ *
+ * ## Example launch lines
+ * |[
+ * gst-launch-1.0 videotestsrc ! video/x-raw,format=I420 ! unixfdsink socket-path=/tmp/video
+ * gst-launch-1.0 unixfdsrc socket-path=/tmp/video ! autovideosink
+ * ]|
+ *
+ * Since: 1.14
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "../../gst/gst-i18n-lib.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <errno.h>
+#include <string.h>
+
+#include "gstunixfdsink.h"
+#include "gstunixfdprotocol.h"
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+GST_DEBUG_CATEGORY_STATIC (gst_unix_fd_sink_debug);
+#define GST_CAT_DEFAULT gst_unix_fd_sink_debug
+
+#define DEFAULT_MAX_BUFFERS 1024
+
+enum
+{
+  PROP_0,
+  PROP_SOCKET_PATH,
+  PROP_MAX_BUFFERS
+};
+
+#define _do_init \
+  GST_DEBUG_CATEGORY_INIT (gst_unix_fd_sink_debug, "unixfdsink", 0, "unixfdsink element");
+#define gst_unix_fd_sink_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstUnixFdSink, gst_unix_fd_sink, GST_TYPE_BASE_SINK,
+    _do_init);
+
+static void gst_unix_fd_sink_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_unix_fd_sink_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+static void gst_unix_fd_sink_finalize (GObject * obj);
+
+static gboolean gst_unix_fd_sink_start (GstBaseSink * bsink);
+static gboolean gst_unix_fd_sink_stop (GstBaseSink * bsink);
+static gboolean gst_unix_fd_sink_unlock (GstBaseSink * bsink);
+static gboolean gst_unix_fd_sink_unlock_stop (GstBaseSink * bsink);
+static gboolean gst_unix_fd_sink_event (GstBaseSink * bsink, GstEvent * event);
+static gboolean gst_unix_fd_sink_propose_allocation (GstBaseSink * bsink,
+    GstQuery * query);
+static GstFlowReturn gst_unix_fd_sink_render (GstBaseSink * bsink,
+    GstBuffer * buffer);
+
+static void
+gst_unix_fd_sink_class_init (GstUnixFdSinkClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstElementClass *gstelement_class;
+  GstBaseSinkClass *gstbasesink_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gstelement_class = GST_ELEMENT_CLASS (klass);
+  gstbasesink_class = GST_BASE_SINK_CLASS (klass);
+
+  gobject_class->set_property = gst_unix_fd_sink_set_property;
+  gobject_class->get_property = gst_unix_fd_sink_get_property;
+  gobject_class->finalize = gst_unix_fd_sink_finalize;
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "Unix file descriptor sink",
+      "Sink/Network",
+      "Send buffers as file descriptors over a Unix socket",
+      "The GStreamer maintainers <gstreamer-devel@lists.freedesktop.org>");
+  gst_element_class_add_static_pad_template (gstelement_class, &sinktemplate);
+
+  gstbasesink_class->start = GST_DEBUG_FUNCPTR (gst_unix_fd_sink_start);
+  gstbasesink_class->stop = GST_DEBUG_FUNCPTR (gst_unix_fd_sink_stop);
+  gstbasesink_class->unlock = GST_DEBUG_FUNCPTR (gst_unix_fd_sink_unlock);
+  gstbasesink_class->unlock_stop =
+      GST_DEBUG_FUNCPTR (gst_unix_fd_sink_unlock_stop);
+  gstbasesink_class->event = GST_DEBUG_FUNCPTR (gst_unix_fd_sink_event);
+  gstbasesink_class->propose_allocation =
+      GST_DEBUG_FUNCPTR (gst_unix_fd_sink_propose_allocation);
+  gstbasesink_class->render = GST_DEBUG_FUNCPTR (gst_unix_fd_sink_render);
+
+  g_object_class_install_property (gobject_class, PROP_SOCKET_PATH,
+      g_param_spec_string ("socket-path", "Socket Path",
+          "Path of the Unix socket to listen on", NULL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_MAX_BUFFERS,
+      g_param_spec_uint ("max-buffers", "Max Buffers",
+          "Maximum number of buffers the client may hold before it is "
+          "disconnected", 1, G_MAXUINT, DEFAULT_MAX_BUFFERS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gst_unix_fd_sink_init (GstUnixFdSink * sink)
+{
+  gst_poll_fd_init (&sink->listen_fd);
+  gst_poll_fd_init (&sink->client_fd);
+
+  sink->max_buffers = DEFAULT_MAX_BUFFERS;
+  sink->buffers = g_hash_table_new_full (g_int64_hash, g_int64_equal, g_free,
+      (GDestroyNotify) gst_buffer_unref);
+}
+
+static void
+gst_unix_fd_sink_finalize (GObject * obj)
+{
+  GstUnixFdSink *sink = GST_UNIX_FD_SINK (obj);
+
+  g_free (sink->socket_path);
+  g_hash_table_unref (sink->buffers);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static void
+gst_unix_fd_sink_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstUnixFdSink *sink = GST_UNIX_FD_SINK (object);
+
+  switch (prop_id) {
+    case PROP_SOCKET_PATH:
+      GST_OBJECT_LOCK (sink);
+      g_free (sink->socket_path);
+      sink->socket_path = g_value_dup_string (value);
+      GST_OBJECT_UNLOCK (sink);
+      break;
+    case PROP_MAX_BUFFERS:
+      GST_OBJECT_LOCK (sink);
+      sink->max_buffers = g_value_get_uint (value);
+      GST_OBJECT_UNLOCK (sink);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_unix_fd_sink_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstUnixFdSink *sink = GST_UNIX_FD_SINK (object);
+
+  switch (prop_id) {
+    case PROP_SOCKET_PATH:
+      GST_OBJECT_LOCK (sink);
+      g_value_set_string (value, sink->socket_path);
+      GST_OBJECT_UNLOCK (sink);
+      break;
+    case PROP_MAX_BUFFERS:
+      GST_OBJECT_LOCK (sink);
+      g_value_set_uint (value, sink->max_buffers);
+      GST_OBJECT_UNLOCK (sink);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static gboolean
+set_nonblocking (gint fd)
+{
+  gint flags;
+
+  flags = fcntl (fd, F_GETFL);
+  if (flags < 0 || fcntl (fd, F_SETFL, flags | O_NONBLOCK) < 0)
+    return FALSE;
+
+  return fcntl (fd, F_SETFD, FD_CLOEXEC) == 0;
+}
+
+static void
+gst_unix_fd_sink_close_client (GstUnixFdSink * sink)
+{
+  if (sink->client_fd.fd < 0)
+    return;
+
+  GST_DEBUG_OBJECT (sink, "closing client %d, dropping %u buffers",
+      sink->client_fd.fd, g_hash_table_size (sink->buffers));
+
+  gst_poll_remove_fd (sink->fdset, &sink->client_fd);
+  close (sink->client_fd.fd);
+  gst_poll_fd_init (&sink->client_fd);
+
+  /* the client is gone together with its references to our memory */
+  g_hash_table_remove_all (sink->buffers);
+}
+
+static gboolean
+gst_unix_fd_sink_start (GstBaseSink * bsink)
+{
+  GstUnixFdSink *sink = GST_UNIX_FD_SINK (bsink);
+  struct sockaddr_un addr;
+  gint fd;
+
+  sink->allocator = gst_allocator_find (GST_ALLOCATOR_MEMFD);
+  if (sink->allocator == NULL)
+    goto no_memfd;
+
+  if (sink->socket_path == NULL || sink->socket_path[0] == '\0')
+    goto no_path;
+
+  if (strlen (sink->socket_path) >= sizeof (addr.sun_path))
+    goto path_too_long;
+
+  if ((sink->fdset = gst_poll_new (TRUE)) == NULL)
+    goto socket_pair;
+
+  fd = socket (AF_UNIX, SOCK_SEQPACKET, 0);
+  if (fd < 0)
+    goto socket_failed;
+
+  memset (&addr, 0, sizeof (addr));
+  addr.sun_family = AF_UNIX;
+  strcpy (addr.sun_path, sink->socket_path);
+
+  /* a stale socket of a previous run would make bind fail */
+  unlink (sink->socket_path);
+
+  if (!set_nonblocking (fd)
+      || bind (fd, (struct sockaddr *) &addr, sizeof (addr)) < 0
+      || listen (fd, 1) < 0) {
+    close (fd);
+    goto socket_failed;
+  }
+
+  sink->listen_fd.fd = fd;
+  gst_poll_add_fd (sink->fdset, &sink->listen_fd);
+  gst_poll_fd_ctl_read (sink->fdset, &sink->listen_fd, TRUE);
+
+  sink->next_id = 0;
+
+  GST_DEBUG_OBJECT (sink, "listening on %s", sink->socket_path);
+
+  return TRUE;
+
+  /* ERRORS */
+no_memfd:
+  {
+    GST_ELEMENT_ERROR (sink, RESOURCE, SETTINGS, (NULL),
+        ("memfd memory is not supported on this system"));
+    return FALSE;
+  }
+no_path:
+  {
+    GST_ELEMENT_ERROR (sink, RESOURCE, NOT_FOUND,
+        (_("No file name specified for writing.")), (NULL));
+    goto cleanup;
+  }
+path_too_long:
+  {
+    GST_ELEMENT_ERROR (sink, RESOURCE, SETTINGS, (NULL),
+        ("Socket path \"%s\" is too long", sink->socket_path));
+    goto cleanup;
+  }
+socket_pair:
+  {
+    GST_ELEMENT_ERROR (sink, RESOURCE, OPEN_READ_WRITE, (NULL),
+        GST_ERROR_SYSTEM);
+    goto cleanup;
+  }
+socket_failed:
+  {
+    GST_ELEMENT_ERROR (sink, RESOURCE, OPEN_WRITE,
+        (_("Could not open resource for writing.")),
+        ("Could not listen on %s: %s", sink->socket_path,
+            g_strerror (errno)));
+    gst_poll_free (sink->fdset);
+    sink->fdset = NULL;
+    goto cleanup;
+  }
+cleanup:
+  {
+    gst_object_unref (sink->allocator);
+    sink->allocator = NULL;
+    return FALSE;
+  }
+}
+
+static gboolean
+gst_unix_fd_sink_stop (GstBaseSink * bsink)
+{
+  GstUnixFdSink *sink = GST_UNIX_FD_SINK (bsink);
+
+  if (sink->fdset) {
+    gst_unix_fd_sink_close_client (sink);
+
+    close (sink->listen_fd.fd);
+    gst_poll_fd_init (&sink->listen_fd);
+    unlink (sink->socket_path);
+
+    gst_poll_free (sink->fdset);
+    sink->fdset = NULL;
+  }
+
+  if (sink->allocator) {
+    gst_object_unref (sink->allocator);
+    sink->allocator = NULL;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+gst_unix_fd_sink_unlock (GstBaseSink * bsink)
+{
+  GstUnixFdSink *sink = GST_UNIX_FD_SINK (bsink);
+
+  GST_LOG_OBJECT (sink, "Flushing");
+  GST_OBJECT_LOCK (sink);
+  sink->unlock = TRUE;
+  gst_poll_set_flushing (sink->fdset, TRUE);
+  GST_OBJECT_UNLOCK (sink);
+
+  return TRUE;
+}
+
+static gboolean
+gst_unix_fd_sink_unlock_stop (GstBaseSink * bsink)
+{
+  GstUnixFdSink *sink = GST_UNIX_FD_SINK (bsink);
+
+  GST_LOG_OBJECT (sink, "No longer flushing");
+  GST_OBJECT_LOCK (sink);
+  sink->unlock = FALSE;
+  gst_poll_set_flushing (sink->fdset, FALSE);
+  GST_OBJECT_UNLOCK (sink);
+
+  return TRUE;
+}
+
+/* read all pending release messages of the client, returns FALSE when the
+ * client went away */
+static gboolean
+gst_unix_fd_sink_read_releases (GstUnixFdSink * sink)
+{
+  GstUnixFdReleasePayload release;
+  GstUnixFdMessageType type;
+  gint fds[GST_UNIX_FD_MAX_FDS];
+  guint n_fds;
+  gssize res;
+
+  while (sink->client_fd.fd >= 0) {
+    res = gst_unix_fd_receive_message (sink->client_fd.fd, FALSE, &type,
+        &release, sizeof (release), fds, &n_fds);
+
+    if (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      break;
+
+    if (res <= 0) {
+      GST_WARNING_OBJECT (sink, "client disconnected: %s",
+          res == 0 ? "closed" : g_strerror (errno));
+      gst_unix_fd_sink_close_client (sink);
+      return FALSE;
+    }
+
+    while (n_fds > 0)
+      close (fds[--n_fds]);
+
+    if (type != GST_UNIX_FD_MESSAGE_RELEASE || res != sizeof (release)) {
+      GST_WARNING_OBJECT (sink, "ignoring unexpected message %d", type);
+      continue;
+    }
+
+    GST_LOG_OBJECT (sink, "client released buffer %" G_GUINT64_FORMAT,
+        release.id);
+    if (!g_hash_table_remove (sink->buffers, &release.id))
+      GST_WARNING_OBJECT (sink, "unknown buffer %" G_GUINT64_FORMAT,
+          release.id);
+  }
+
+  return TRUE;
+}
+
+/* wait for the socket to become ready, must be called with the PREROLL_LOCK.
+ * Returns GST_FLOW_OK when the caller should try again. */
+static GstFlowReturn
+gst_unix_fd_sink_wait (GstUnixFdSink * sink, gboolean write)
+{
+  gint res;
+
+  if (sink->client_fd.fd >= 0)
+    gst_poll_fd_ctl_write (sink->fdset, &sink->client_fd, write);
+
+  do {
+    res = gst_poll_wait (sink->fdset, GST_CLOCK_TIME_NONE);
+  } while (res == -1 && (errno == EINTR || errno == EAGAIN));
+
+  if (res == -1) {
+    if (errno != EBUSY)
+      goto poll_error;
+
+    /* unlocked, wait until we are allowed to continue again */
+    return gst_base_sink_wait_preroll (GST_BASE_SINK (sink));
+  }
+
+  /* always process releases so that the client never blocks on us */
+  if (sink->client_fd.fd >= 0 &&
+      (gst_poll_fd_can_read (sink->fdset, &sink->client_fd) ||
+          gst_poll_fd_has_closed (sink->fdset, &sink->client_fd)))
+    gst_unix_fd_sink_read_releases (sink);
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+poll_error:
+  {
+    GST_ELEMENT_ERROR (sink, RESOURCE, READ, (NULL),
+        ("poll on socket failed: %s", g_strerror (errno)));
+    return GST_FLOW_ERROR;
+  }
+}
+
+/* Returns GST_FLOW_CUSTOM_SUCCESS when the client disconnected */
+static GstFlowReturn
+gst_unix_fd_sink_send (GstUnixFdSink * sink, GstUnixFdMessageType type,
+    gconstpointer payload, gsize payload_size, const gint * fds, guint n_fds)
+{
+  GstFlowReturn ret;
+
+  for (;;) {
+    if (sink->client_fd.fd < 0)
+      return GST_FLOW_CUSTOM_SUCCESS;
+
+    if (gst_unix_fd_send_message (sink->client_fd.fd, type, payload,
+            payload_size, fds, n_fds, FALSE))
+      return GST_FLOW_OK;
+
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      GST_WARNING_OBJECT (sink, "failed to send to client: %s",
+          g_strerror (errno));
+      gst_unix_fd_sink_close_client (sink);
+      return GST_FLOW_CUSTOM_SUCCESS;
+    }
+
+    ret = gst_unix_fd_sink_wait (sink, TRUE);
+    if (ret != GST_FLOW_OK)
+      return ret;
+  }
+}
+
+static GstFlowReturn
+gst_unix_fd_sink_send_event (GstUnixFdSink * sink, GstEvent * event)
+{
+  GstUnixFdEventPayload *payload;
+  GstFlowReturn ret;
+  gchar *str;
+  gsize len;
+
+  str = gst_unix_fd_serialize_event (event);
+  len = strlen (str) + 1;
+
+  if (sizeof (GstUnixFdMessageHeader) + sizeof (*payload) + len >
+      GST_UNIX_FD_MAX_MESSAGE_SIZE) {
+    GST_WARNING_OBJECT (sink, "dropping too large event %" GST_PTR_FORMAT,
+        event);
+    g_free (str);
+    return GST_FLOW_OK;
+  }
+
+  payload = g_malloc (sizeof (*payload) + len);
+  payload->type = GST_EVENT_TYPE (event);
+  payload->seqnum = GST_EVENT_SEQNUM (event);
+  memcpy (payload + 1, str, len);
+  g_free (str);
+
+  GST_DEBUG_OBJECT (sink, "sending event %" GST_PTR_FORMAT, event);
+
+  ret = gst_unix_fd_sink_send (sink, GST_UNIX_FD_MESSAGE_EVENT, payload,
+      sizeof (*payload) + len, NULL, 0);
+  g_free (payload);
+
+  return ret;
+}
+
+static gboolean
+send_sticky_event (GstPad * pad, GstEvent ** event, gpointer user_data)
+{
+  GstUnixFdSink *sink = user_data;
+
+  if (GST_EVENT_TYPE (*event) == GST_EVENT_EOS)
+    return TRUE;
+
+  return gst_unix_fd_sink_send_event (sink, *event) == GST_FLOW_OK;
+}
+
+/* wait for a client to connect, must be called with the PREROLL_LOCK */
+static GstFlowReturn
+gst_unix_fd_sink_wait_client (GstUnixFdSink * sink)
+{
+  GstFlowReturn ret;
+  gint fd;
+
+  while (sink->client_fd.fd < 0) {
+    fd = accept (sink->listen_fd.fd, NULL, NULL);
+
+    if (fd >= 0) {
+      if (!set_nonblocking (fd)) {
+        close (fd);
+        continue;
+      }
+
+      GST_DEBUG_OBJECT (sink, "client %d connected", fd);
+      sink->client_fd.fd = fd;
+      gst_poll_add_fd (sink->fdset, &sink->client_fd);
+      gst_poll_fd_ctl_read (sink->fdset, &sink->client_fd, TRUE);
+
+      /* bring the new client up to date with caps, segment, tags, ... */
+      gst_pad_sticky_events_foreach (GST_BASE_SINK_PAD (sink),
+          send_sticky_event, sink);
+      continue;
+    }
+
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR
+        && errno != ECONNABORTED)
+      goto accept_error;
+
+    GST_LOG_OBJECT (sink, "waiting for client");
+    ret = gst_unix_fd_sink_wait (sink, FALSE);
+    if (ret != GST_FLOW_OK)
+      return ret;
+  }
+
+  return GST_FLOW_OK;
+
+  /* ERRORS */
+accept_error:
+  {
+    GST_ELEMENT_ERROR (sink, RESOURCE, OPEN_WRITE, (NULL),
+        ("Failed to accept client: %s", g_strerror (errno)));
+    return GST_FLOW_ERROR;
+  }
+}
+
+static gboolean
+gst_unix_fd_sink_event (GstBaseSink * bsink, GstEvent * event)
+{
+  GstUnixFdSink *sink = GST_UNIX_FD_SINK (bsink);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_FLUSH_STOP:
+      break;
+    default:
+      /* sticky events are replayed when a client connects */
+      if (GST_EVENT_IS_SERIALIZED (event) && sink->client_fd.fd >= 0) {
+        if (gst_unix_fd_sink_send_event (sink, event) < GST_FLOW_OK) {
+          gst_event_unref (event);
+          return FALSE;
+        }
+      }
+      break;
+  }
+
+  return GST_BASE_SINK_CLASS (parent_class)->event (bsink, event);
+}
+
+static gboolean
+gst_unix_fd_sink_propose_allocation (GstBaseSink * bsink, GstQuery * query)
+{
+  GstUnixFdSink *sink = GST_UNIX_FD_SINK (bsink);
+
+  /* with memfd memory from upstream we never have to copy */
+  if (sink->allocator)
+    gst_query_add_allocation_param (query, sink->allocator, NULL);
+
+  return TRUE;
+}
+
+/* get a buffer with only memfd memory to send for @buffer */
+static GstBuffer *
+gst_unix_fd_sink_get_memfd_buffer (GstUnixFdSink * sink, GstBuffer * buffer)
+{
+  GstBuffer *copy;
+  GstMemory *mem;
+  GstMapInfo map;
+  guint i, n_mem;
+  gsize size;
+
+  n_mem = gst_buffer_n_memory (buffer);
+  if (n_mem <= GST_UNIX_FD_MAX_FDS) {
+    for (i = 0; i < n_mem; i++) {
+      if (!gst_is_memfd_memory (gst_buffer_peek_memory (buffer, i)))
+        break;
+    }
+    if (i == n_mem)
+      return gst_buffer_ref (buffer);
+  }
+
+  size = gst_buffer_get_size (buffer);
+
+  GST_LOG_OBJECT (sink, "copying %" G_GSIZE_FORMAT " bytes into memfd memory",
+      size);
+
+  copy = gst_buffer_new ();
+  if (size == 0)
+    return copy;
+
+  mem = gst_allocator_alloc (sink->allocator, size, NULL);
+  if (mem == NULL || !gst_memory_map (mem, &map, GST_MAP_WRITE)) {
+    if (mem)
+      gst_memory_unref (mem);
+    gst_buffer_unref (copy);
+    return NULL;
+  }
+
+  gst_buffer_extract (buffer, 0, map.data, size);
+  gst_memory_unmap (mem, &map);
+  gst_buffer_append_memory (copy, mem);
+
+  return copy;
+}
+
+static GstFlowReturn
+gst_unix_fd_sink_render (GstBaseSink * bsink, GstBuffer * buffer)
+{
+  GstUnixFdSink *sink = GST_UNIX_FD_SINK (bsink);
+  GstUnixFdBufferPayload *payload;
+  GstUnixFdMemoryPayload *mems;
+  gint fds[GST_UNIX_FD_MAX_FDS];
+  GstBuffer *held;
+  GstFlowReturn ret;
+  gchar *metas;
+  gsize metas_len, payload_size;
+  guint i, n_mem, max_buffers;
+
+  ret = gst_unix_fd_sink_wait_client (sink);
+  if (ret != GST_FLOW_OK)
+    return ret;
+
+  gst_unix_fd_sink_read_releases (sink);
+
+  /* a client that doesn't release its buffers would make us keep all memory
+   * alive, we drop it like one that went away */
+  GST_OBJECT_LOCK (sink);
+  max_buffers = sink->max_buffers;
+  GST_OBJECT_UNLOCK (sink);
+  if (g_hash_table_size (sink->buffers) >= max_buffers) {
+    GST_WARNING_OBJECT (sink, "client holds %u buffers, disconnecting it",
+        g_hash_table_size (sink->buffers));
+    gst_unix_fd_sink_close_client (sink);
+    return GST_FLOW_OK;
+  }
+
+  held = gst_unix_fd_sink_get_memfd_buffer (sink, buffer);
+  if (held == NULL)
+    goto alloc_failed;
+
+  n_mem = gst_buffer_n_memory (held);
+
+  metas = gst_unix_fd_serialize_metas (buffer);
+  metas_len = strlen (metas) + 1;
+
+  payload_size = sizeof (*payload) + n_mem * sizeof (*mems) + metas_len;
+  if (sizeof (GstUnixFdMessageHeader) + payload_size >
+      GST_UNIX_FD_MAX_MESSAGE_SIZE) {
+    GST_WARNING_OBJECT (sink, "dropping too large metas");
+    payload_size -= metas_len - 1;
+    metas[0] = '\0';
+    metas_len = 1;
+  }
+
+  payload = g_malloc (payload_size);
+  payload->id = ++sink->next_id;
+  payload->pts = GST_BUFFER_PTS (buffer);
+  payload->dts = GST_BUFFER_DTS (buffer);
+  payload->duration = GST_BUFFER_DURATION (buffer);
+  payload->offset = GST_BUFFER_OFFSET (buffer);
+  payload->offset_end = GST_BUFFER_OFFSET_END (buffer);
+  payload->flags = GST_BUFFER_FLAGS (buffer) &
+      ~(GST_MINI_OBJECT_FLAG_LAST - 1) & ~GST_BUFFER_FLAG_TAG_MEMORY;
+  payload->n_memory = n_mem;
+
+  mems = (GstUnixFdMemoryPayload *) (payload + 1);
+  for (i = 0; i < n_mem; i++) {
+    gsize offset, size;
+
+    gst_memfd_memory_get_fd_info (gst_buffer_peek_memory (held, i), &fds[i],
+        &offset, &size);
+    mems[i].offset = offset;
+    mems[i].size = size;
+  }
+  memcpy (mems + n_mem, metas, metas_len);
+  g_free (metas);
+
+  GST_LOG_OBJECT (sink, "sending buffer %" G_GUINT64_FORMAT " with %u fds",
+      payload->id, n_mem);
+
+  ret = gst_unix_fd_sink_send (sink, GST_UNIX_FD_MESSAGE_BUFFER, payload,
+      payload_size, fds, n_mem);
+
+  /* keep the memory alive and untouched until the client released it */
+  if (ret == GST_FLOW_OK && n_mem > 0)
+    g_hash_table_insert (sink->buffers, g_memdup (&payload->id,
+            sizeof (payload->id)), held);
+  else
+    gst_buffer_unref (held);
+
+  g_free (payload);
+
+  /* a client that went away is not an error, the next one gets the rest */
+  if (ret == GST_FLOW_CUSTOM_SUCCESS)
+    ret = GST_FLOW_OK;
+
+  return ret;
+
+  /* ERRORS */
+alloc_failed:
+  {
+    GST_ELEMENT_ERROR (sink, RESOURCE, FAILED, (NULL),
+        ("Failed to allocate memfd memory"));
+    return GST_FLOW_ERROR;
+  }
+}
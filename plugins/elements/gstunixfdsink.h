@@ -0,0 +1,77 @@
+/* GStreamer
+ * gstunixfdsink.h: send buffers to another process over a Unix socket
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef __GST_UNIX_FD_SINK_H__
+#define __GST_UNIX_FD_SINK_H__
+
+#include <gst/gst.h>
+#include <gst/base/gstbasesink.h>
+
+G_BEGIN_DECLS
+
+
+#define GST_TYPE_UNIX_FD_SINK \
+  (gst_unix_fd_sink_get_type())
+#define GST_UNIX_FD_SINK(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_UNIX_FD_SINK,GstUnixFdSink))
+#define GST_UNIX_FD_SINK_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_UNIX_FD_SINK,GstUnixFdSinkClass))
+#define GST_IS_UNIX_FD_SINK(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_UNIX_FD_SINK))
+#define GST_IS_UNIX_FD_SINK_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_UNIX_FD_SINK))
+#define GST_UNIX_FD_SINK_CAST(obj) ((GstUnixFdSink *)(obj))
+
+typedef struct _GstUnixFdSink GstUnixFdSink;
+typedef struct _GstUnixFdSinkClass GstUnixFdSinkClass;
+
+/**
+ * GstUnixFdSink:
+ *
+ * The opaque #GstUnixFdSink data structure.
+ */
+struct _GstUnixFdSink {
+  GstBaseSink parent;
+
+  gchar *socket_path;
+
+  GstAllocator *allocator;
+
+  GstPoll *fdset;
+  GstPollFD listen_fd;
+  GstPollFD client_fd;
+
+  /* buffers the client did not release yet, indexed by id */
+  GHashTable *buffers;
+  guint64 next_id;
+  guint max_buffers; /* OBJECT LOCK */
+
+  gboolean unlock; /* OBJECT LOCK */
+};
+
+struct _GstUnixFdSinkClass {
+  GstBaseSinkClass parent_class;
+};
+
+G_GNUC_INTERNAL GType gst_unix_fd_sink_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_UNIX_FD_SINK_H__ */
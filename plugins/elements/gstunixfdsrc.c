@@ -0,0 +1,632 @@
+/* GStreamer
+ * gstunixfdsrc.c: receive buffers from another process over a Unix socket
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:element-unixfdsrc
+ * @title: unixfdsrc
+ * @see_also: #GstUnixFdSink
+ *
+ * Receive buffers from a #GstUnixFdSink in another process.
+ *
+ * The element connects to the Unix socket #GstUnixFdSrc:socket-path and maps
+ * the memfd file descriptors it receives without copying the data. The
+ * buffer memory is read-only, the sender is notified when the buffer is
+ * freed so that it can reuse the memory. The caps and segment of the sender
+ * are used for the stream of the element, its other serialized events except
+ * stream-start are forwarded downstream.
+ *
+ * ## Example launch line
+ * |[
+ * gst-launch-1.0 unixfdsrc socket-path=/tmp/video ! autovideosink
+ * ]|
+ *
+ * Since: 1.14
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include "../../gst/gst-i18n-lib.h"
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <errno.h>
+#include <string.h>
+
+#include "gstunixfdsrc.h"
+#include "gstunixfdprotocol.h"
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+GST_DEBUG_CATEGORY_STATIC (gst_unix_fd_src_debug);
+#define GST_CAT_DEFAULT gst_unix_fd_src_debug
+
+enum
+{
+  PROP_0,
+  PROP_SOCKET_PATH
+};
+
+/* the socket is shared with the buffers that are still in flight so that
+ * they can be released after the element stopped */
+struct _GstUnixFdConnection
+{
+  gint refcount;
+
+  GMutex lock;
+  gint fd;                      /* -1 when closed, protected by lock */
+};
+
+typedef struct
+{
+  GstUnixFdConnection *connection;
+  guint64 id;
+  gint n_memory;
+} GstUnixFdRelease;
+
+static GQuark release_quark;
+
+#define _do_init \
+  GST_DEBUG_CATEGORY_INIT (gst_unix_fd_src_debug, "unixfdsrc", 0, "unixfdsrc element"); \
+  release_quark = g_quark_from_static_string ("GstUnixFdSrcRelease");
+#define gst_unix_fd_src_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstUnixFdSrc, gst_unix_fd_src, GST_TYPE_PUSH_SRC,
+    _do_init);
+
+static void gst_unix_fd_src_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec);
+static void gst_unix_fd_src_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec);
+static void gst_unix_fd_src_finalize (GObject * obj);
+
+static gboolean gst_unix_fd_src_start (GstBaseSrc * bsrc);
+static gboolean gst_unix_fd_src_stop (GstBaseSrc * bsrc);
+static gboolean gst_unix_fd_src_unlock (GstBaseSrc * bsrc);
+static gboolean gst_unix_fd_src_unlock_stop (GstBaseSrc * bsrc);
+static GstFlowReturn gst_unix_fd_src_create (GstPushSrc * psrc,
+    GstBuffer ** outbuf);
+
+static void
+gst_unix_fd_src_class_init (GstUnixFdSrcClass * klass)
+{
+  GObjectClass *gobject_class;
+  GstElementClass *gstelement_class;
+  GstBaseSrcClass *gstbasesrc_class;
+  GstPushSrcClass *gstpush_src_class;
+
+  gobject_class = G_OBJECT_CLASS (klass);
+  gstelement_class = GST_ELEMENT_CLASS (klass);
+  gstbasesrc_class = GST_BASE_SRC_CLASS (klass);
+  gstpush_src_class = GST_PUSH_SRC_CLASS (klass);
+
+  gobject_class->set_property = gst_unix_fd_src_set_property;
+  gobject_class->get_property = gst_unix_fd_src_get_property;
+  gobject_class->finalize = gst_unix_fd_src_finalize;
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "Unix file descriptor source",
+      "Source/Network",
+      "Receive buffers as file descriptors over a Unix socket",
+      "The GStreamer maintainers <gstreamer-devel@lists.freedesktop.org>");
+  gst_element_class_add_static_pad_template (gstelement_class, &srctemplate);
+
+  gstbasesrc_class->start = GST_DEBUG_FUNCPTR (gst_unix_fd_src_start);
+  gstbasesrc_class->stop = GST_DEBUG_FUNCPTR (gst_unix_fd_src_stop);
+  gstbasesrc_class->unlock = GST_DEBUG_FUNCPTR (gst_unix_fd_src_unlock);
+  gstbasesrc_class->unlock_stop =
+      GST_DEBUG_FUNCPTR (gst_unix_fd_src_unlock_stop);
+  gstpush_src_class->create = GST_DEBUG_FUNCPTR (gst_unix_fd_src_create);
+
+  g_object_class_install_property (gobject_class, PROP_SOCKET_PATH,
+      g_param_spec_string ("socket-path", "Socket Path",
+          "Path of the Unix socket to connect to", NULL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gst_unix_fd_src_init (GstUnixFdSrc * src)
+{
+  gst_poll_fd_init (&src->socket_fd);
+
+  gst_base_src_set_format (GST_BASE_SRC (src), GST_FORMAT_TIME);
+}
+
+static void
+gst_unix_fd_src_finalize (GObject * obj)
+{
+  GstUnixFdSrc *src = GST_UNIX_FD_SRC (obj);
+
+  g_free (src->socket_path);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static void
+gst_unix_fd_src_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstUnixFdSrc *src = GST_UNIX_FD_SRC (object);
+
+  switch (prop_id) {
+    case PROP_SOCKET_PATH:
+      GST_OBJECT_LOCK (src);
+      g_free (src->socket_path);
+      src->socket_path = g_value_dup_string (value);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_unix_fd_src_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstUnixFdSrc *src = GST_UNIX_FD_SRC (object);
+
+  switch (prop_id) {
+    case PROP_SOCKET_PATH:
+      GST_OBJECT_LOCK (src);
+      g_value_set_string (value, src->socket_path);
+      GST_OBJECT_UNLOCK (src);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static GstUnixFdConnection *
+gst_unix_fd_connection_new (gint fd)
+{
+  GstUnixFdConnection *conn;
+
+  conn = g_slice_new (GstUnixFdConnection);
+  conn->refcount = 1;
+  g_mutex_init (&conn->lock);
+  conn->fd = fd;
+
+  return conn;
+}
+
+static GstUnixFdConnection *
+gst_unix_fd_connection_ref (GstUnixFdConnection * conn)
+{
+  g_atomic_int_inc (&conn->refcount);
+  return conn;
+}
+
+static void
+gst_unix_fd_connection_unref (GstUnixFdConnection * conn)
+{
+  if (!g_atomic_int_dec_and_test (&conn->refcount))
+    return;
+
+  if (conn->fd >= 0)
+    close (conn->fd);
+  g_mutex_clear (&conn->lock);
+  g_slice_free (GstUnixFdConnection, conn);
+}
+
+static void
+gst_unix_fd_connection_close (GstUnixFdConnection * conn)
+{
+  g_mutex_lock (&conn->lock);
+  if (conn->fd >= 0) {
+    close (conn->fd);
+    conn->fd = -1;
+  }
+  g_mutex_unlock (&conn->lock);
+}
+
+/* called from the qdata destroy notify of each memory, the last memory of
+ * a buffer to go away tells the sender it can reuse it */
+static void
+gst_unix_fd_src_release_memory (GstUnixFdRelease * release)
+{
+  GstUnixFdConnection *conn = release->connection;
+  GstUnixFdReleasePayload payload;
+
+  if (!g_atomic_int_dec_and_test (&release->n_memory))
+    return;
+
+  payload.id = release->id;
+
+  g_mutex_lock (&conn->lock);
+  if (conn->fd >= 0) {
+    GST_LOG ("releasing buffer %" G_GUINT64_FORMAT, release->id);
+    if (!gst_unix_fd_send_message (conn->fd, GST_UNIX_FD_MESSAGE_RELEASE,
+            &payload, sizeof (payload), NULL, 0, TRUE))
+      GST_WARNING ("failed to release buffer %" G_GUINT64_FORMAT ": %s",
+          release->id, g_strerror (errno));
+  }
+  g_mutex_unlock (&conn->lock);
+
+  gst_unix_fd_connection_unref (conn);
+  g_slice_free (GstUnixFdRelease, release);
+}
+
+static gboolean
+gst_unix_fd_src_start (GstBaseSrc * bsrc)
+{
+  GstUnixFdSrc *src = GST_UNIX_FD_SRC (bsrc);
+  struct sockaddr_un addr;
+  gint fd;
+
+  if (src->socket_path == NULL || src->socket_path[0] == '\0')
+    goto no_path;
+
+  if (strlen (src->socket_path) >= sizeof (addr.sun_path))
+    goto path_too_long;
+
+  if ((src->fdset = gst_poll_new (TRUE)) == NULL)
+    goto socket_pair;
+
+  fd = socket (AF_UNIX, SOCK_SEQPACKET, 0);
+  if (fd < 0)
+    goto connect_failed;
+
+  memset (&addr, 0, sizeof (addr));
+  addr.sun_family = AF_UNIX;
+  strcpy (addr.sun_path, src->socket_path);
+
+  if (fcntl (fd, F_SETFD, FD_CLOEXEC) < 0
+      || connect (fd, (struct sockaddr *) &addr, sizeof (addr)) < 0) {
+    close (fd);
+    goto connect_failed;
+  }
+
+  src->socket_fd.fd = fd;
+  gst_poll_add_fd (src->fdset, &src->socket_fd);
+  gst_poll_fd_ctl_read (src->fdset, &src->socket_fd, TRUE);
+
+  src->connection = gst_unix_fd_connection_new (fd);
+  src->message = g_malloc (GST_UNIX_FD_MAX_MESSAGE_SIZE);
+
+  GST_DEBUG_OBJECT (src, "connected to %s", src->socket_path);
+
+  return TRUE;
+
+  /* ERRORS */
+no_path:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, NOT_FOUND,
+        (_("No file name specified for reading.")), (NULL));
+    return FALSE;
+  }
+path_too_long:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, SETTINGS, (NULL),
+        ("Socket path \"%s\" is too long", src->socket_path));
+    return FALSE;
+  }
+socket_pair:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, OPEN_READ_WRITE, (NULL),
+        GST_ERROR_SYSTEM);
+    return FALSE;
+  }
+connect_failed:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, OPEN_READ,
+        (_("Could not open resource for reading.")),
+        ("Could not connect to %s: %s", src->socket_path,
+            g_strerror (errno)));
+    gst_poll_free (src->fdset);
+    src->fdset = NULL;
+    return FALSE;
+  }
+}
+
+static gboolean
+gst_unix_fd_src_stop (GstBaseSrc * bsrc)
+{
+  GstUnixFdSrc *src = GST_UNIX_FD_SRC (bsrc);
+
+  if (src->connection) {
+    /* buffers still in flight can't be released anymore, the sender drops
+     * them when it sees the connection closing */
+    gst_unix_fd_connection_close (src->connection);
+    gst_unix_fd_connection_unref (src->connection);
+    src->connection = NULL;
+    gst_poll_fd_init (&src->socket_fd);
+  }
+
+  if (src->fdset) {
+    gst_poll_free (src->fdset);
+    src->fdset = NULL;
+  }
+
+  g_free (src->message);
+  src->message = NULL;
+
+  return TRUE;
+}
+
+static gboolean
+gst_unix_fd_src_unlock (GstBaseSrc * bsrc)
+{
+  GstUnixFdSrc *src = GST_UNIX_FD_SRC (bsrc);
+
+  GST_LOG_OBJECT (src, "Flushing");
+  GST_OBJECT_LOCK (src);
+  gst_poll_set_flushing (src->fdset, TRUE);
+  GST_OBJECT_UNLOCK (src);
+
+  return TRUE;
+}
+
+static gboolean
+gst_unix_fd_src_unlock_stop (GstBaseSrc * bsrc)
+{
+  GstUnixFdSrc *src = GST_UNIX_FD_SRC (bsrc);
+
+  GST_LOG_OBJECT (src, "No longer flushing");
+  GST_OBJECT_LOCK (src);
+  gst_poll_set_flushing (src->fdset, FALSE);
+  GST_OBJECT_UNLOCK (src);
+
+  return TRUE;
+}
+
+/* Returns GST_FLOW_OK when the event was handled and the next message
+ * should be read */
+static GstFlowReturn
+gst_unix_fd_src_handle_event (GstUnixFdSrc * src, const guint8 * data,
+    gsize size)
+{
+  GstBaseSrc *bsrc = GST_BASE_SRC (src);
+  const GstUnixFdEventPayload *payload;
+  GstEvent *event;
+
+  payload = (const GstUnixFdEventPayload *) data;
+  if (size <= sizeof (*payload) || data[size - 1] != '\0')
+    goto invalid;
+
+  event = gst_unix_fd_deserialize_event (payload->type, payload->seqnum,
+      (const gchar *) (payload + 1));
+  if (event == NULL)
+    goto invalid;
+
+  GST_DEBUG_OBJECT (src, "received event %" GST_PTR_FORMAT, event);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_EOS:
+      gst_event_unref (event);
+      return GST_FLOW_EOS;
+    case GST_EVENT_CAPS:
+    {
+      GstCaps *caps;
+
+      gst_event_parse_caps (event, &caps);
+      if (!gst_base_src_set_caps (bsrc, caps)) {
+        gst_event_unref (event);
+        return GST_FLOW_NOT_NEGOTIATED;
+      }
+      gst_event_unref (event);
+      break;
+    }
+    case GST_EVENT_STREAM_START:
+      /* the base class already started our own stream */
+      gst_event_unref (event);
+      break;
+    case GST_EVENT_SEGMENT:
+    {
+      const GstSegment *segment;
+
+      /* the base class pushes its segment before the next buffer, mark it
+       * pending and make it the one of the sender */
+      gst_event_parse_segment (event, &segment);
+      gst_base_src_new_seamless_segment (bsrc, segment->start, segment->stop,
+          segment->time);
+      GST_OBJECT_LOCK (src);
+      gst_segment_copy_into (segment, &bsrc->segment);
+      GST_OBJECT_UNLOCK (src);
+      gst_event_unref (event);
+      break;
+    }
+    default:
+      gst_pad_push_event (GST_BASE_SRC_PAD (src), event);
+      break;
+  }
+
+  return GST_FLOW_OK;
+
+invalid:
+  {
+    GST_WARNING_OBJECT (src, "ignoring invalid event message");
+    return GST_FLOW_OK;
+  }
+}
+
+static GstBuffer *
+gst_unix_fd_src_handle_buffer (GstUnixFdSrc * src, const guint8 * data,
+    gsize size, gint * fds, guint n_fds)
+{
+  const GstUnixFdBufferPayload *payload;
+  const GstUnixFdMemoryPayload *mems;
+  GstUnixFdRelease *release;
+  GstBuffer *buffer;
+  guint i;
+
+  payload = (const GstUnixFdBufferPayload *) data;
+  if (size <= sizeof (*payload) || payload->n_memory != n_fds
+      || size <= sizeof (*payload) + n_fds * sizeof (*mems)
+      || data[size - 1] != '\0')
+    goto invalid;
+
+  mems = (const GstUnixFdMemoryPayload *) (payload + 1);
+
+  buffer = gst_buffer_new ();
+  for (i = 0; i < n_fds; i++) {
+    GstMemory *mem;
+
+    /* the sender still owns the data, we only read it */
+    mem = gst_memfd_memory_import (fds[i], mems[i].offset, mems[i].size,
+        GST_MAP_READ);
+    if (mem == NULL)
+      goto import_failed;
+    fds[i] = -1;
+
+    gst_buffer_append_memory (buffer, mem);
+  }
+
+  GST_BUFFER_PTS (buffer) = payload->pts;
+  GST_BUFFER_DTS (buffer) = payload->dts;
+  GST_BUFFER_DURATION (buffer) = payload->duration;
+  GST_BUFFER_OFFSET (buffer) = payload->offset;
+  GST_BUFFER_OFFSET_END (buffer) = payload->offset_end;
+  GST_BUFFER_FLAG_SET (buffer, payload->flags);
+
+  if (n_fds > 0) {
+    release = g_slice_new (GstUnixFdRelease);
+    release->connection = gst_unix_fd_connection_ref (src->connection);
+    release->id = payload->id;
+    release->n_memory = n_fds;
+
+    /* track the memory and not the buffer, copies of the buffer share it */
+    for (i = 0; i < n_fds; i++)
+      gst_mini_object_set_qdata (GST_MINI_OBJECT_CAST (gst_buffer_peek_memory
+              (buffer, i)), release_quark, release,
+          (GDestroyNotify) gst_unix_fd_src_release_memory);
+  }
+
+  /* the memory is tracked now, dropping the buffer releases it */
+  if (!gst_unix_fd_deserialize_metas (buffer, (const gchar *) (mems + n_fds)))
+    goto invalid_metas;
+
+  GST_LOG_OBJECT (src, "received buffer %" G_GUINT64_FORMAT ": %"
+      GST_PTR_FORMAT, payload->id, buffer);
+
+  return buffer;
+
+  /* ERRORS */
+invalid:
+  {
+    GST_WARNING_OBJECT (src, "ignoring invalid buffer message");
+    for (i = 0; i < n_fds; i++)
+      close (fds[i]);
+    return NULL;
+  }
+import_failed:
+  {
+    GST_WARNING_OBJECT (src, "failed to import fd %d", fds[i]);
+    for (; i < n_fds; i++)
+      close (fds[i]);
+    gst_buffer_unref (buffer);
+    return NULL;
+  }
+invalid_metas:
+  {
+    GST_WARNING_OBJECT (src, "ignoring buffer message with invalid metas");
+    gst_buffer_unref (buffer);
+    return NULL;
+  }
+}
+
+static GstFlowReturn
+gst_unix_fd_src_create (GstPushSrc * psrc, GstBuffer ** outbuf)
+{
+  GstUnixFdSrc *src = GST_UNIX_FD_SRC (psrc);
+  guint8 *data;
+  GstFlowReturn ret = GST_FLOW_OK;
+  GstUnixFdMessageType type;
+  gint fds[GST_UNIX_FD_MAX_FDS];
+  guint n_fds;
+  gssize res;
+
+  data = src->message;
+
+  *outbuf = NULL;
+  while (*outbuf == NULL && ret == GST_FLOW_OK) {
+    res = gst_poll_wait (src->fdset, GST_CLOCK_TIME_NONE);
+    if (G_UNLIKELY (res == -1)) {
+      if (errno == EINTR || errno == EAGAIN)
+        continue;
+      else if (errno == EBUSY)
+        goto stopped;
+      else
+        goto poll_error;
+    }
+
+    res = gst_unix_fd_receive_message (src->socket_fd.fd, FALSE, &type, data,
+        GST_UNIX_FD_MAX_MESSAGE_SIZE, fds, &n_fds);
+
+    if (res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      continue;
+    if (res < 0)
+      goto read_error;
+    if (res == 0)
+      goto closed;
+
+    switch (type) {
+      case GST_UNIX_FD_MESSAGE_EVENT:
+        while (n_fds > 0)
+          close (fds[--n_fds]);
+        ret = gst_unix_fd_src_handle_event (src, data, res);
+        break;
+      case GST_UNIX_FD_MESSAGE_BUFFER:
+        *outbuf = gst_unix_fd_src_handle_buffer (src, data, res, fds, n_fds);
+        break;
+      default:
+        GST_WARNING_OBJECT (src, "ignoring unexpected message %d", type);
+        while (n_fds > 0)
+          close (fds[--n_fds]);
+        break;
+    }
+  }
+
+  return ret;
+
+  /* ERRORS */
+stopped:
+  {
+    GST_DEBUG_OBJECT (src, "poll stopped");
+    return GST_FLOW_FLUSHING;
+  }
+poll_error:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL),
+        ("poll on socket failed: %s", g_strerror (errno)));
+    return GST_FLOW_ERROR;
+  }
+read_error:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL),
+        ("read on socket failed: %s", g_strerror (errno)));
+    return GST_FLOW_ERROR;
+  }
+closed:
+  {
+    GST_ELEMENT_ERROR (src, RESOURCE, READ, (NULL),
+        ("connection closed by the sender"));
+    return GST_FLOW_ERROR;
+  }
+}
@@ -0,0 +1,74 @@
+/* GStreamer
+ * gstunixfdsrc.h: receive buffers from another process over a Unix socket
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef __GST_UNIX_FD_SRC_H__
+#define __GST_UNIX_FD_SRC_H__
+
+#include <gst/gst.h>
+#include <gst/base/gstpushsrc.h>
+
+G_BEGIN_DECLS
+
+
+#define GST_TYPE_UNIX_FD_SRC \
+  (gst_unix_fd_src_get_type())
+#define GST_UNIX_FD_SRC(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_UNIX_FD_SRC,GstUnixFdSrc))
+#define GST_UNIX_FD_SRC_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_UNIX_FD_SRC,GstUnixFdSrcClass))
+#define GST_IS_UNIX_FD_SRC(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_UNIX_FD_SRC))
+#define GST_IS_UNIX_FD_SRC_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_UNIX_FD_SRC))
+#define GST_UNIX_FD_SRC_CAST(obj) ((GstUnixFdSrc *)(obj))
+
+typedef struct _GstUnixFdSrc GstUnixFdSrc;
+typedef struct _GstUnixFdSrcClass GstUnixFdSrcClass;
+typedef struct _GstUnixFdConnection GstUnixFdConnection;
+
+/**
+ * GstUnixFdSrc:
+ *
+ * The opaque #GstUnixFdSrc data structure.
+ */
+struct _GstUnixFdSrc {
+  GstPushSrc parent;
+
+  gchar *socket_path;
+
+  GstPoll *fdset;
+  GstPollFD socket_fd;
+
+  /* shared with the buffers that are still in flight */
+  GstUnixFdConnection *connection;
+
+  /* receive buffer for one message */
+  guint8 *message;
+};
+
+struct _GstUnixFdSrcClass {
+  GstPushSrcClass parent_class;
+};
+
+G_GNUC_INTERNAL GType gst_unix_fd_src_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_UNIX_FD_SRC_H__ */
@@ -1,7 +1,7 @@
 /* GStreamer
  * Copyright (C) 2005 Andy Wingo <wingo@pobox.com>
  *
- * caps.c: benchmark for caps creation and destruction
+ * caps.c: benchmark for caps creation, destruction and intersection
  *
  * This library is free software; you can redistribute it and/or
  * modify it under the terms of the GNU Library General Public
@@ -40,12 +40,90 @@
   "rate = (int) [ 1, MAX ], " \
   "channels = (int) [ 1, MAX ]"
 
+/* what a demuxer can output and what the decoders in the registry accept,
+ * roughly the sizes decodebin has to match against each other */
+#define DEMUX_SRC_CAPS \
+  "video/x-h264, stream-format = (string) { avc, avc3, byte-stream }, " \
+  "alignment = (string) { au, nal }; " \
+  "video/x-h265, stream-format = (string) { hvc1, hev1, byte-stream }, " \
+  "alignment = (string) au; " \
+  "video/mpeg, mpegversion = (int) { 1, 2, 4 }, systemstream = (boolean) false; " \
+  "video/x-vp8; video/x-vp9; video/x-theora; video/x-wmv, wmvversion = (int) 3; " \
+  "audio/mpeg, mpegversion = (int) 1, layer = (int) [ 1, 3 ]; " \
+  "audio/mpeg, mpegversion = (int) { 2, 4 }, stream-format = (string) { raw, adts }; " \
+  "audio/x-ac3; audio/x-eac3; audio/x-dts; audio/x-opus; audio/x-vorbis; " \
+  "audio/x-flac, framed = (boolean) true; " \
+  "text/x-raw, format = (string) { pango-markup, utf8 }; " \
+  "subpicture/x-dvb; application/x-subtitle-vtt"
+
+#define DECODER_SINK_CAPS \
+  "video/x-h264, stream-format = (string) { avc, byte-stream }, " \
+  "alignment = (string) au, profile = (string) { constrained-baseline, " \
+  "baseline, main, high }, width = (int) [ 1, 4096 ], height = (int) [ 1, 4096 ]; " \
+  "video/x-h265, stream-format = (string) { hvc1, hev1 }, alignment = (string) au, " \
+  "profile = (string) { main, main-10 }; " \
+  "video/mpeg, mpegversion = (int) [ 1, 2 ], systemstream = (boolean) false, " \
+  "parsed = (boolean) true; " \
+  "video/mpeg, mpegversion = (int) 4, systemstream = (boolean) false, " \
+  "parsed = (boolean) true; " \
+  "video/x-vp8; video/x-vp9, width = (int) [ 1, 8192 ], height = (int) [ 1, 8192 ]; " \
+  "video/x-theora; " \
+  "video/x-divx, divxversion = (int) [ 3, 5 ]; video/x-xvid; " \
+  "video/x-wmv, wmvversion = (int) [ 1, 3 ], format = (string) { WMV1, WMV2, WMV3, WVC1 }; " \
+  "audio/mpeg, mpegversion = (int) 1, layer = (int) [ 1, 3 ], parsed = (boolean) true; " \
+  "audio/mpeg, mpegversion = (int) 4, stream-format = (string) raw, " \
+  "framed = (boolean) true; " \
+  "audio/x-ac3, framed = (boolean) true; audio/x-eac3, framed = (boolean) true; " \
+  "audio/x-dts, framed = (boolean) true; " \
+  "audio/x-opus, channel-mapping-family = (int) [ 0, 255 ]; " \
+  "audio/x-vorbis; audio/x-flac, framed = (boolean) true; " \
+  "audio/x-alaw, rate = (int) [ 8000, 192000 ], channels = (int) [ 1, 2 ]; " \
+  "audio/x-mulaw, rate = (int) [ 8000, 192000 ], channels = (int) [ 1, 2 ]; " \
+  "audio/x-wma, wmaversion = (int) [ 1, 3 ]; audio/AMR; audio/AMR-WB; " \
+  "text/x-raw, format = (string) { pango-markup, utf8 }"
+
+#define NUM_INTERSECTS 10000
+
+/* the caps are only cached when they are not writable, so run once with
+ * the caps as they were created and once with an extra ref on them */
+static void
+run_intersections (GstCaps * caps1, GstCaps * caps2, const gchar * what)
+{
+  GstClockTime start, end;
+  GstCaps *res;
+  gint i;
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_INTERSECTS; i++) {
+    res = gst_caps_intersect (caps1, caps2);
+    gst_caps_unref (res);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d intersections, %s\n",
+      GST_TIME_ARGS (end - start), i, what);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_INTERSECTS; i++)
+    gst_caps_is_subset (caps1, caps2);
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d subset checks, %s\n",
+      GST_TIME_ARGS (end - start), i, what);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_INTERSECTS; i++)
+    gst_caps_can_intersect (caps2, caps1);
+  end = gst_util_get_timestamp ();
+  g_print ("%" GST_TIME_FORMAT " - %d can-intersect checks, %s\n",
+      GST_TIME_ARGS (end - start), i, what);
+}
+
 
 gint
 main (gint argc, gchar * argv[])
 {
   GstCaps **capses;
   GstCaps *protocaps;
+  GstCaps *demux_caps, *decoder_caps;
   GstClockTime start, end;
   gint i;
 
@@ -71,5 +149,19 @@ main (gint argc, gchar * argv[])
   g_free (capses);
   gst_caps_unref (protocaps);
 
+  demux_caps = gst_caps_from_string (DEMUX_SRC_CAPS);
+  decoder_caps = gst_caps_from_string (DECODER_SINK_CAPS);
+
+  run_intersections (demux_caps, decoder_caps, "writable caps");
+
+  gst_caps_ref (demux_caps);
+  gst_caps_ref (decoder_caps);
+  run_intersections (demux_caps, decoder_caps, "shared caps");
+  gst_caps_unref (demux_caps);
+  gst_caps_unref (decoder_caps);
+
+  gst_caps_unref (demux_caps);
+  gst_caps_unref (decoder_caps);
+
   return 0;
 }
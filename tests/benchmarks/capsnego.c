@@ -28,6 +28,9 @@
  *  -c children: is the number of branches on each level
  *  -f <flavour>: can be "audio" or "video" and is controlling the kind of
  *                elements that are used.
+ *
+ * The measurement is repeated with caps query caching enabled on all pads and
+ * the speedup is reported.
  */
 
 #include <gst/gst.h>
@@ -133,6 +136,27 @@ create_nodes (GstBin * bin, GstElement * sink, gint depth, gint children,
   return TRUE;
 }
 
+static void
+enable_caps_cache (GstBin * bin)
+{
+  GstIterator *it, *pads;
+  GValue item = G_VALUE_INIT, pad = G_VALUE_INIT;
+
+  it = gst_bin_iterate_recurse (bin);
+  while (gst_iterator_next (it, &item) == GST_ITERATOR_OK) {
+    pads = gst_element_iterate_pads (g_value_get_object (&item));
+    while (gst_iterator_next (pads, &pad) == GST_ITERATOR_OK) {
+      GST_PAD_SET_CACHE_CAPS (g_value_get_object (&pad));
+      g_value_reset (&pad);
+    }
+    gst_iterator_free (pads);
+    g_value_reset (&item);
+  }
+  g_value_unset (&pad);
+  g_value_unset (&item);
+  gst_iterator_free (it);
+}
+
 static void
 event_loop (GstElement * bin)
 {
@@ -181,6 +205,23 @@ event_loop (GstElement * bin)
   gst_object_unref (bus);
 }
 
+static GstClockTime
+run_loops (GstBin * bin, gint loops)
+{
+  GstClockTime start, end;
+  gint i;
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < loops; ++i) {
+    gst_element_set_state (GST_ELEMENT (bin), GST_STATE_PAUSED);
+    event_loop (GST_ELEMENT (bin));
+    gst_element_set_state (GST_ELEMENT (bin), GST_STATE_READY);
+  }
+  end = gst_util_get_timestamp ();
+
+  return end - start;
+}
+
 gint
 main (gint argc, gchar * argv[])
 {
@@ -206,9 +247,8 @@ main (gint argc, gchar * argv[])
   };
   GError *err = NULL;
   GstBin *bin;
-  GstClockTime start, end;
+  GstClockTime start, end, uncached, cached;
   GstElement *sink, *new_sink;
-  gint i;
 
   g_set_prgname ("capsnego");
 
@@ -252,15 +292,15 @@ main (gint argc, gchar * argv[])
   gst_element_set_state (GST_ELEMENT (bin), GST_STATE_READY);
   GST_DEBUG_BIN_TO_DOT_FILE (bin, GST_DEBUG_GRAPH_SHOW_MEDIA_TYPE, "capsnego");
 
-  start = gst_util_get_timestamp ();
-  for (i = 0; i < loops; ++i) {
-    gst_element_set_state (GST_ELEMENT (bin), GST_STATE_PAUSED);
-    event_loop (GST_ELEMENT (bin));
-    gst_element_set_state (GST_ELEMENT (bin), GST_STATE_READY);
-  }
-  end = gst_util_get_timestamp ();
+  uncached = run_loops (bin, loops);
   g_print ("%" GST_TIME_FORMAT " reached PAUSED state (%d loop iterations)\n",
-      GST_TIME_ARGS (end - start), loops);
+      GST_TIME_ARGS (uncached), loops);
+
+  enable_caps_cache (bin);
+  cached = run_loops (bin, loops);
+  g_print ("%" GST_TIME_FORMAT " reached PAUSED state with cached caps "
+      "queries (%d loop iterations)\n", GST_TIME_ARGS (cached), loops);
+  g_print ("speedup %.2fx\n", (gdouble) uncached / MAX (cached, 1));
   /* clean up */
 Error:
   gst_element_set_state (GST_ELEMENT (bin), GST_STATE_NULL);
@@ -0,0 +1,104 @@
+/* GStreamer
+ * capsparse.c: measure parsing of caps strings
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Parses fixed caps with and without type casts and template-like caps with
+ * gst_caps_from_string(). Each string is parsed over and over again, which
+ * is served from the cache of recently parsed strings, and in N_VARIANTS
+ * variants that differ in one field, which are more than the cache holds.
+ */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+
+#define N_VARIANTS 64
+
+static const struct
+{
+  const gchar *name;
+  const gchar *string;
+} caps_strings[] = {
+  {
+  "typed", "video/x-raw, format=(string)I420, width=(int)1920, "
+        "height=(int)1080, interlace-mode=(string)progressive, "
+        "pixel-aspect-ratio=(fraction)1/1, colorimetry=(string)bt709, "
+        "framerate=(fraction)30000/1001"}, {
+  "untyped", "video/x-raw, format=I420, width=1920, height=1080, "
+        "interlace-mode=progressive, pixel-aspect-ratio=1/1, "
+        "colorimetry=bt709, framerate=30000/1001"}, {
+  "template", "video/x-h264, stream-format=(string){ avc, avc3, "
+        "byte-stream }, alignment=(string){ au, nal }, "
+        "width=(int)[ 1, 4096 ], height=(int)[ 1, 4096 ], "
+        "framerate=(fraction)[ 0/1, 2147483647/1 ]; "
+        "audio/x-raw, format=(string){ S16LE, S24LE, S32LE, F32LE }, "
+        "layout=(string)interleaved, rate=(int)[ 1, 2147483647 ], "
+        "channels=(int)[ 1, 2147483647 ]"}
+};
+
+static void
+run (const gchar * name, const gchar * caps_string, guint loops)
+{
+  gchar *variants[N_VARIANTS];
+  GstCaps *caps;
+  GstClockTime start, end;
+  guint i;
+
+  for (i = 0; i < N_VARIANTS; i++)
+    variants[i] = g_strdup_printf ("%s, variant=(int)%u", caps_string, i);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < loops; i++) {
+    caps = gst_caps_from_string (caps_string);
+    gst_caps_unref (caps);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%-8s: %8.1f ns per repeated string",
+      name, (gdouble) (end - start) / loops);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < loops; i++) {
+    caps = gst_caps_from_string (variants[i % N_VARIANTS]);
+    gst_caps_unref (caps);
+  }
+  end = gst_util_get_timestamp ();
+  g_print (", %8.1f ns per distinct string\n",
+      (gdouble) (end - start) / loops);
+
+  for (i = 0; i < N_VARIANTS; i++)
+    g_free (variants[i]);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint i, loops = 100000;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    loops = atoi (argv[1]);
+  if (loops < 1) {
+    g_print ("usage: %s [loops]\n", argv[0]);
+    exit (-1);
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (caps_strings); i++)
+    run (caps_strings[i].name, caps_strings[i].string, loops);
+
+  return 0;
+}
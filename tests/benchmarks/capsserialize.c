@@ -0,0 +1,129 @@
+/* GStreamer
+ * capsserialize.c: measure string and binary serialization of caps
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Writes and reads a fixed caps and a template-like caps with
+ * gst_caps_to_string()/gst_caps_from_string() and with
+ * gst_caps_to_binary()/gst_caps_from_binary(), and prints the time per
+ * operation and the size of both representations. Converting the same
+ * string again is served from the cache of parsed caps strings, capsparse
+ * measures the parsing itself.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+
+static const gchar *caps_strings[] = {
+  "video/x-raw, format=(string)I420, width=(int)1920, height=(int)1080, "
+      "interlace-mode=(string)progressive, pixel-aspect-ratio=(fraction)1/1, "
+      "colorimetry=(string)bt709, framerate=(fraction)30000/1001",
+  "video/x-h264, stream-format=(string){ avc, avc3, byte-stream }, "
+      "alignment=(string){ au, nal }, profile=(string){ constrained-baseline, "
+      "baseline, main, high }, width=(int)[ 1, 4096 ], "
+      "height=(int)[ 1, 4096 ], framerate=(fraction)[ 0/1, 2147483647/1 ]; "
+      "video/mpeg, mpegversion=(int){ 1, 2, 4 }, "
+      "systemstream=(boolean)false, parsed=(boolean)true; "
+      "audio/mpeg, mpegversion=(int)4, stream-format=(string){ raw, adts }, "
+      "rate=(int)[ 8000, 96000 ], channels=(int)[ 1, 8 ]; "
+      "audio/x-raw, format=(string){ S16LE, S24LE, S32LE, F32LE }, "
+      "layout=(string)interleaved, rate=(int)[ 1, 2147483647 ], "
+      "channels=(int)[ 1, 2147483647 ]; "
+      "video/x-raw(memory:GLMemory), format=(string)RGBA, "
+      "texture-target=(string)2D",
+};
+
+static void
+run (const gchar * caps_string, guint loops)
+{
+  GstCaps *caps, *copy;
+  GByteArray *array;
+  GstClockTime start, end;
+  gchar *str = NULL;
+  gsize str_len;
+  guint i;
+
+  caps = gst_caps_from_string (caps_string);
+  array = g_byte_array_new ();
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < loops; i++) {
+    g_free (str);
+    str = gst_caps_to_string (caps);
+  }
+  end = gst_util_get_timestamp ();
+  str_len = strlen (str) + 1;
+  g_print ("%u structures: %8.1f ns per to_string",
+      gst_caps_get_size (caps), (gdouble) (end - start) / loops);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < loops; i++) {
+    copy = gst_caps_from_string (str);
+    gst_caps_unref (copy);
+  }
+  end = gst_util_get_timestamp ();
+  g_print (", %8.1f ns per from_string, %4" G_GSIZE_FORMAT " bytes\n",
+      (gdouble) (end - start) / loops, str_len);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < loops; i++) {
+    g_byte_array_set_size (array, 0);
+    gst_caps_to_binary (caps, array);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%u structures: %8.1f ns per to_binary",
+      gst_caps_get_size (caps), (gdouble) (end - start) / loops);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < loops; i++) {
+    copy = gst_caps_from_binary (array->data, array->len, NULL);
+    gst_caps_unref (copy);
+  }
+  end = gst_util_get_timestamp ();
+  g_print (", %8.1f ns per from_binary, %4u bytes\n",
+      (gdouble) (end - start) / loops, array->len);
+
+  copy = gst_caps_from_binary (array->data, array->len, NULL);
+  if (!gst_caps_is_strictly_equal (caps, copy))
+    g_printerr ("caps changed in the binary round trip\n");
+  gst_caps_unref (copy);
+
+  g_byte_array_unref (array);
+  g_free (str);
+  gst_caps_unref (caps);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint i, loops = 100000;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    loops = atoi (argv[1]);
+  if (loops < 1) {
+    g_print ("usage: %s [loops]\n", argv[0]);
+    exit (-1);
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (caps_strings); i++)
+    run (caps_strings[i], loops);
+
+  return 0;
+}
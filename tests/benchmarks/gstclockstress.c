@@ -23,10 +23,26 @@
 #include <gst/glib-compat-private.h>
 
 #define MAX_THREADS  100
+#define MAX_WAITERS  10000
+#define ASYNC_PER_WAITER 10
 
 static gboolean running = TRUE;
 static gint count = 0;
 
+typedef struct
+{
+  GThread *thread;
+  GMutex lock;
+  GstClockID id;
+  guint waits;
+  guint unscheduled;
+  GstClockTime late;
+} Waiter;
+
+static GMutex async_lock;
+static guint async_count = 0;
+static GstClockTime async_late = 0;
+
 static void *
 run_test (void *user_data)
 {
@@ -43,18 +59,149 @@ run_test (void *user_data)
   return NULL;
 }
 
+/* waits for 1 to 10 ms over and over again, the main thread unschedules
+ * some of the waits */
+static void *
+run_waiter (void *user_data)
+{
+  Waiter *w = user_data;
+  GstClock *sysclock = gst_system_clock_obtain ();
+
+  while (running) {
+    GstClockTime target;
+    GstClockID id;
+
+    target = gst_clock_get_time (sysclock) +
+        g_random_int_range (1, 11) * GST_MSECOND;
+    id = gst_clock_new_single_shot_id (sysclock, target);
+
+    g_mutex_lock (&w->lock);
+    w->id = id;
+    g_mutex_unlock (&w->lock);
+
+    if (gst_clock_id_wait (id, NULL) == GST_CLOCK_UNSCHEDULED) {
+      w->unscheduled++;
+    } else {
+      w->late += gst_clock_get_time (sysclock) - target;
+      w->waits++;
+    }
+
+    g_mutex_lock (&w->lock);
+    w->id = NULL;
+    g_mutex_unlock (&w->lock);
+    gst_clock_id_unref (id);
+  }
+
+  gst_object_unref (sysclock);
+  return NULL;
+}
+
+static void
+run_waiters (GstClock * sysclock, gint num_waiters)
+{
+  Waiter *waiters;
+  GstClockTime start;
+  guint waits = 0, unscheduled = 0;
+  GstClockTime late = 0;
+  gint t;
+
+  running = TRUE;
+  waiters = g_new0 (Waiter, num_waiters);
+  for (t = 0; t < num_waiters; t++) {
+    g_mutex_init (&waiters[t].lock);
+    waiters[t].thread = g_thread_new ("clockwaiter", run_waiter, &waiters[t]);
+  }
+
+  /* unschedule a random wait every millisecond for 5 seconds */
+  start = gst_util_get_timestamp ();
+  while (gst_util_get_timestamp () - start < 5 * GST_SECOND) {
+    Waiter *w = &waiters[g_random_int_range (0, num_waiters)];
+
+    g_mutex_lock (&w->lock);
+    if (w->id)
+      gst_clock_id_unschedule (w->id);
+    g_mutex_unlock (&w->lock);
+    g_usleep (1000);
+  }
+
+  running = FALSE;
+  for (t = 0; t < num_waiters; t++) {
+    g_thread_join (waiters[t].thread);
+    g_mutex_clear (&waiters[t].lock);
+    waits += waiters[t].waits;
+    unscheduled += waiters[t].unscheduled;
+    late += waiters[t].late;
+  }
+  g_free (waiters);
+
+  g_print ("%d waiters: %u waits, %u unscheduled, %" G_GUINT64_FORMAT
+      " ns late on average\n", num_waiters, waits, unscheduled,
+      waits ? late / waits : 0);
+}
+
+static gboolean
+async_callback (GstClock * clock, GstClockTime time, GstClockID id,
+    gpointer user_data)
+{
+  GstClockTime now = gst_clock_get_time (clock);
+
+  g_mutex_lock (&async_lock);
+  async_late += now > time ? now - time : 0;
+  async_count++;
+  g_mutex_unlock (&async_lock);
+
+  return TRUE;
+}
+
+/* schedules entries at random times within the next second */
+static void
+run_async (GstClock * sysclock, gint num_entries)
+{
+  GstClockID *ids;
+  GstClockTime base, start, end;
+  gint t;
+
+  ids = g_new (GstClockID, num_entries);
+  base = gst_clock_get_time (sysclock) + 100 * GST_MSECOND;
+
+  start = gst_util_get_timestamp ();
+  for (t = 0; t < num_entries; t++) {
+    ids[t] = gst_clock_new_single_shot_id (sysclock,
+        base + g_random_int_range (0, 1000) * GST_MSECOND);
+    gst_clock_id_wait_async (ids[t], async_callback, NULL, NULL);
+  }
+  end = gst_util_get_timestamp ();
+
+  /* unschedule every tenth entry */
+  for (t = 0; t < num_entries; t += 10)
+    gst_clock_id_unschedule (ids[t]);
+
+  g_usleep (G_USEC_PER_SEC * 3 / 2);
+
+  g_mutex_lock (&async_lock);
+  g_print ("%d async entries: %.1f ns per wait_async, %u callbacks, %"
+      G_GUINT64_FORMAT " ns late on average\n", num_entries,
+      (gdouble) (end - start) / num_entries, async_count,
+      async_count ? async_late / async_count : 0);
+  g_mutex_unlock (&async_lock);
+
+  for (t = 0; t < num_entries; t++)
+    gst_clock_id_unref (ids[t]);
+  g_free (ids);
+}
+
 gint
 main (gint argc, gchar * argv[])
 {
   GThread *threads[MAX_THREADS];
-  gint num_threads;
+  gint num_threads, num_waiters = 1000;
   gint t;
   GstClock *sysclock;
 
   gst_init (&argc, &argv);
 
-  if (argc != 2) {
-    g_print ("usage: %s <num_threads>\n", argv[0]);
+  if (argc != 2 && argc != 3) {
+    g_print ("usage: %s <num_threads> [num_waiters]\n", argv[0]);
     exit (-1);
   }
 
@@ -65,6 +212,14 @@ main (gint argc, gchar * argv[])
     exit (-2);
   }
 
+  if (argc == 3)
+    num_waiters = atoi (argv[2]);
+
+  if (num_waiters < 0 || num_waiters > MAX_WAITERS) {
+    g_print ("number of waiters must be between 0 and %d\n", MAX_WAITERS);
+    exit (-2);
+  }
+
   sysclock = gst_system_clock_obtain ();
 
   for (t = 0; t < num_threads; t++) {
@@ -94,6 +249,11 @@ main (gint argc, gchar * argv[])
 
   g_print ("performed %d get_time operations\n", count);
 
+  if (num_waiters > 0) {
+    run_waiters (sysclock, num_waiters);
+    run_async (sysclock, num_waiters * ASYNC_PER_WAITER);
+  }
+
   gst_object_unref (sysclock);
 
   return 0;
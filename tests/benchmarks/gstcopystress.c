@@ -0,0 +1,156 @@
+/* GStreamer
+ * gstcopystress.c: measure large buffer copies and their cache impact
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Every iteration copies a buffer and then walks a small working set, like
+ * the other elements of a pipeline would do with their state. A copy that
+ * evicts the cache makes the walk slower. Compare with the copy kernels
+ * disabled by running with GST_MEMCPY_STREAM_THRESHOLD=0.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+
+/* the working set, small enough to stay in the cache when nothing evicts it */
+#define HOT_SIZE  (256 * 1024)
+
+static guint8 *hot;
+
+static guint
+walk_hot (void)
+{
+  guint i, sum = 0;
+
+  /* one read per cache line */
+  for (i = 0; i < HOT_SIZE; i += 64)
+    sum += hot[i];
+
+  return sum;
+}
+
+typedef void (*CopyFunc) (GstBuffer * src, GstBuffer * dest, gsize size);
+
+static void
+copy_memcpy (GstBuffer * src, GstBuffer * dest, gsize size)
+{
+  GstMapInfo sinfo, dinfo;
+
+  gst_buffer_map (src, &sinfo, GST_MAP_READ);
+  gst_buffer_map (dest, &dinfo, GST_MAP_WRITE);
+  memcpy (dinfo.data, sinfo.data, size);
+  gst_buffer_unmap (dest, &dinfo);
+  gst_buffer_unmap (src, &sinfo);
+}
+
+static void
+copy_extract (GstBuffer * src, GstBuffer * dest, gsize size)
+{
+  GstMapInfo dinfo;
+
+  gst_buffer_map (dest, &dinfo, GST_MAP_WRITE);
+  gst_buffer_extract (src, 0, dinfo.data, size);
+  gst_buffer_unmap (dest, &dinfo);
+}
+
+static void
+copy_fill (GstBuffer * src, GstBuffer * dest, gsize size)
+{
+  GstMapInfo sinfo;
+
+  gst_buffer_map (src, &sinfo, GST_MAP_READ);
+  gst_buffer_fill (dest, 0, sinfo.data, size);
+  gst_buffer_unmap (src, &sinfo);
+}
+
+static void
+copy_deep (GstBuffer * src, GstBuffer * dest, gsize size)
+{
+  gst_buffer_unref (gst_buffer_copy_deep (src));
+}
+
+static void
+run_test (const gchar * name, CopyFunc func, GstBuffer * src,
+    GstBuffer * dest, gsize size, guint iterations)
+{
+  GstClockTime start, copy_time = 0, walk_time = 0;
+  guint i, sum = 0;
+
+  /* warm up */
+  func (src, dest, size);
+
+  for (i = 0; i < iterations; i++) {
+    start = gst_util_get_timestamp ();
+    func (src, dest, size);
+    copy_time += gst_util_get_timestamp () - start;
+
+    start = gst_util_get_timestamp ();
+    sum += walk_hot ();
+    walk_time += gst_util_get_timestamp () - start;
+  }
+
+  g_print ("%-8s %8.1f MB/s  copy %" GST_TIME_FORMAT "  walk %"
+      GST_TIME_FORMAT " (%u)\n", name,
+      (gdouble) size * iterations / (1024 * 1024) /
+      ((gdouble) copy_time / GST_SECOND), GST_TIME_ARGS (copy_time /
+          iterations), GST_TIME_ARGS (walk_time / iterations), sum & 1);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstBuffer *src, *dest;
+  guint iterations;
+  gsize size;
+
+  gst_init (&argc, &argv);
+
+  if (argc != 3) {
+    g_print ("usage: %s <size in KB> <iterations>\n", argv[0]);
+    exit (-1);
+  }
+
+  size = (gsize) g_ascii_strtoull (argv[1], NULL, 10) * 1024;
+  iterations = atoi (argv[2]);
+  if (size == 0 || iterations < 1) {
+    g_print ("size and iterations must be > 0\n");
+    exit (-1);
+  }
+
+  hot = g_malloc0 (HOT_SIZE);
+  src = gst_buffer_new_allocate (NULL, size, NULL);
+  dest = gst_buffer_new_allocate (NULL, size, NULL);
+  gst_buffer_memset (src, 0, 0x55, size);
+  gst_buffer_memset (dest, 0, 0xaa, size);
+
+  g_print ("copying %" G_GSIZE_FORMAT " bytes %u times, threshold %s\n",
+      size, iterations, g_getenv ("GST_MEMCPY_STREAM_THRESHOLD") ?
+      g_getenv ("GST_MEMCPY_STREAM_THRESHOLD") : "default");
+
+  run_test ("memcpy", copy_memcpy, src, dest, size, iterations);
+  run_test ("extract", copy_extract, src, dest, size, iterations);
+  run_test ("fill", copy_fill, src, dest, size, iterations);
+  run_test ("deep", copy_deep, src, dest, size, iterations);
+
+  gst_buffer_unref (src);
+  gst_buffer_unref (dest);
+  g_free (hot);
+
+  return 0;
+}
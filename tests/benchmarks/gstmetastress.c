@@ -0,0 +1,139 @@
+/* GStreamer
+ * gstmetastress.c: measure meta copying and lookups from many threads
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+
+#define MAX_THREADS  1000
+
+static guint64 nbcopies;
+static GMutex mutex;
+static GstBuffer *source;
+
+static void *
+run_test (void *user_data)
+{
+  gint threadid = GPOINTER_TO_INT (user_data);
+  const GstMetaInfo *info;
+  GstClockTime start, end;
+  GstBuffer *buf;
+  guint64 nb;
+
+  g_mutex_lock (&mutex);
+  g_mutex_unlock (&mutex);
+
+  start = gst_util_get_timestamp ();
+
+  for (nb = nbcopies; nb; nb--) {
+    /* what a transform does for each buffer: look up the info of the metas
+     * it cares about and copy the metas of a region */
+    info = gst_meta_get_info ("GstReferenceTimestampMeta");
+    g_assert (info != NULL);
+    buf = gst_buffer_copy_region (source, GST_BUFFER_COPY_ALL, 0, 10);
+    g_assert (gst_buffer_get_meta (buf, info->api) != NULL);
+    gst_buffer_unref (buf);
+  }
+
+  end = gst_util_get_timestamp ();
+  g_print ("total %" GST_TIME_FORMAT " - average %" GST_TIME_FORMAT
+      "  - Thread %d\n", GST_TIME_ARGS (end - start),
+      GST_TIME_ARGS ((end - start) / nbcopies), threadid);
+
+  return NULL;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GThread *threads[MAX_THREADS];
+  GstClockTime start, end;
+  GstBuffer *parent;
+  GstCaps *reference;
+  gint num_threads;
+  gint t, i;
+
+  gst_init (&argc, &argv);
+  g_mutex_init (&mutex);
+
+  if (argc != 3) {
+    g_print ("usage: %s <num_threads> <nbcopies>\n", argv[0]);
+    exit (-1);
+  }
+
+  num_threads = atoi (argv[1]);
+  nbcopies = atoi (argv[2]);
+
+  if (num_threads <= 0 || num_threads > MAX_THREADS) {
+    g_print ("number of threads must be between 0 and %d\n", MAX_THREADS);
+    exit (-2);
+  }
+
+  if (nbcopies <= 0) {
+    g_print ("number of copies must be greater than 0\n");
+    exit (-3);
+  }
+
+  /* a buffer with a few metas of different APIs, like a video frame */
+  source = gst_buffer_new_allocate (NULL, 100, NULL);
+  reference = gst_caps_new_empty_simple ("timestamp/x-test");
+  for (i = 0; i < 4; i++)
+    gst_buffer_add_reference_timestamp_meta (source, reference, i * GST_SECOND,
+        GST_CLOCK_TIME_NONE);
+  parent = gst_buffer_new ();
+  gst_buffer_add_parent_buffer_meta (source, parent);
+  gst_buffer_unref (parent);
+  gst_caps_unref (reference);
+
+  g_mutex_lock (&mutex);
+
+  printf ("main(): Creating %d threads.\n", num_threads);
+  for (t = 0; t < num_threads; t++) {
+    GError *error = NULL;
+
+    threads[t] = g_thread_try_new ("metastresstest", run_test,
+        GINT_TO_POINTER (t), &error);
+
+    if (error) {
+      printf ("ERROR: g_thread_try_new() %s\n", error->message);
+      g_clear_error (&error);
+      exit (-1);
+    }
+  }
+
+  /* Signal all threads to start */
+  start = gst_util_get_timestamp ();
+  g_mutex_unlock (&mutex);
+
+  for (t = 0; t < num_threads; t++) {
+    if (threads[t])
+      g_thread_join (threads[t]);
+  }
+
+  end = gst_util_get_timestamp ();
+  g_print ("*** total %" GST_TIME_FORMAT " - average %" GST_TIME_FORMAT
+      "  - Done copying %" G_GUINT64_FORMAT " buffers\n",
+      GST_TIME_ARGS (end - start),
+      GST_TIME_ARGS ((end - start) / (num_threads * nbcopies)),
+      num_threads * nbcopies);
+
+  gst_buffer_unref (source);
+
+  return 0;
+}
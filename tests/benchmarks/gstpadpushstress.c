@@ -0,0 +1,148 @@
+/* GStreamer
+ * gstpadpushstress.c: measure the cost of a buffer push between pads
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Pushes the same small buffer through a chain of identity elements into a
+ * fakesink and prints the time per push and per pad link. The optional third
+ * argument installs that many empty probes on every source pad, which makes
+ * the pushes take the locked path. Every other probe is an event probe that
+ * the buffers should not have to visit. Run with 0, 1, 5 and 20 probes to
+ * see how dispatch scales.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <gst/gst.h>
+
+static GstPadProbeReturn
+probe_cb (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  return GST_PAD_PROBE_OK;
+}
+
+static void
+add_pad_probes (GstPad * pad, guint probes)
+{
+  guint i;
+
+  for (i = 0; i < probes; i++) {
+    gst_pad_add_probe (pad, (i % 2) ? GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM :
+        GST_PAD_PROBE_TYPE_BUFFER, probe_cb, NULL, NULL);
+  }
+}
+
+static void
+add_probes (GstElement * element, guint probes)
+{
+  GstIterator *it;
+  GValue item = G_VALUE_INIT;
+
+  it = gst_element_iterate_src_pads (element);
+  while (gst_iterator_next (it, &item) == GST_ITERATOR_OK) {
+    add_pad_probes (g_value_get_object (&item), probes);
+    g_value_reset (&item);
+  }
+  g_value_unset (&item);
+  gst_iterator_free (it);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstElement *pipeline, *sink, *current, *last = NULL;
+  GstPad *srcpad, *sinkpad;
+  GstSegment segment;
+  GstBuffer *buffer;
+  GstClockTime start, end;
+  guint i, identities, pushes, probes = 0;
+
+  gst_init (&argc, &argv);
+
+  if (argc < 3) {
+    g_print ("usage: %s <identities> <pushes> [probes-per-pad]\n", argv[0]);
+    exit (-1);
+  }
+
+  identities = atoi (argv[1]);
+  pushes = atoi (argv[2]);
+  if (argc > 3)
+    probes = atoi (argv[3]);
+  if (pushes < 1) {
+    g_print ("pushes must be > 0\n");
+    exit (-1);
+  }
+
+  pipeline = gst_pipeline_new (NULL);
+  for (i = 0; i < identities; i++) {
+    current = gst_element_factory_make ("identity", NULL);
+    g_assert (current);
+    g_object_set (current, "silent", TRUE, NULL);
+    gst_bin_add (GST_BIN (pipeline), current);
+    if (last && !gst_element_link (last, current))
+      g_assert_not_reached ();
+    add_probes (current, probes);
+    last = current;
+  }
+  sink = gst_element_factory_make ("fakesink", NULL);
+  g_assert (sink);
+  g_object_set (sink, "sync", FALSE, NULL);
+  gst_bin_add (GST_BIN (pipeline), sink);
+  if (last && !gst_element_link (last, sink))
+    g_assert_not_reached ();
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_element_get_static_pad (last ? last : sink, "sink");
+  if (gst_pad_link (srcpad, sinkpad) != GST_PAD_LINK_OK)
+    g_assert_not_reached ();
+  gst_object_unref (sinkpad);
+  add_pad_probes (srcpad, probes);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  gst_pad_set_active (srcpad, TRUE);
+
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("padpush"));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  buffer = gst_buffer_new_allocate (NULL, 64, NULL);
+
+  /* warm up */
+  for (i = 0; i < 1000; i++)
+    gst_pad_push (srcpad, gst_buffer_ref (buffer));
+
+  g_print ("pushing %u buffers through %u identities with %u probes per pad\n",
+      pushes, identities, probes);
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < pushes; i++)
+    gst_pad_push (srcpad, gst_buffer_ref (buffer));
+  end = gst_util_get_timestamp ();
+
+  g_print ("%" GST_TIME_FORMAT " total, %.1f ns per push, "
+      "%.1f ns per link\n", GST_TIME_ARGS (end - start),
+      (gdouble) (end - start) / pushes,
+      (gdouble) (end - start) / pushes / (identities + 1));
+
+  gst_buffer_unref (buffer);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (srcpad);
+  gst_object_unref (pipeline);
+
+  return 0;
+}
@@ -24,6 +24,71 @@
 
 #define BUFFER_SIZE (1400)
 
+#define MAX_THREADS (32)
+
+static const gint thread_counts[] = { 1, 4, MAX_THREADS };
+
+typedef struct
+{
+  GstBufferPool *pool;
+  guint64 nbuffers;
+} ThreadData;
+
+static gpointer
+run_thread (gpointer user_data)
+{
+  ThreadData *data = user_data;
+  GstBuffer *tmp;
+  guint64 i;
+
+  for (i = 0; i < data->nbuffers; i++) {
+    if (gst_buffer_pool_acquire_buffer (data->pool, &tmp, NULL) != GST_FLOW_OK)
+      g_error ("failed to acquire buffer");
+    gst_buffer_unref (tmp);
+  }
+  return NULL;
+}
+
+/* acquire and release @nbuffers buffers in total from @num_threads threads.
+ * With @max_buffers smaller than @num_threads, threads have to wait for each
+ * other's buffers. */
+static void
+run_threads (gint num_threads, guint max_buffers, guint64 nbuffers)
+{
+  GThread *threads[MAX_THREADS];
+  GstClockTime start, end;
+  GstClockTimeDiff dur;
+  GstBufferPool *pool;
+  GstStructure *conf;
+  ThreadData data;
+  gint t;
+
+  pool = gst_buffer_pool_new ();
+  conf = gst_buffer_pool_get_config (pool);
+  gst_buffer_pool_config_set_params (conf, NULL, BUFFER_SIZE, 0, max_buffers);
+  gst_buffer_pool_set_config (pool, conf);
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  data.pool = pool;
+  data.nbuffers = MAX (nbuffers / num_threads, 1);
+
+  start = gst_util_get_timestamp ();
+  for (t = 0; t < num_threads; t++)
+    threads[t] = g_thread_new ("poolstress", run_thread, &data);
+  for (t = 0; t < num_threads; t++)
+    g_thread_join (threads[t]);
+  end = gst_util_get_timestamp ();
+
+  dur = GST_CLOCK_DIFF (start, end);
+  g_print ("*** total %" GST_TIME_FORMAT " - average %" GST_TIME_FORMAT
+      "  - %2d threads, max %2u buffers\n", GST_TIME_ARGS (dur),
+      GST_TIME_ARGS (dur / (data.nbuffers * num_threads)), num_threads,
+      max_buffers);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
 gint
 main (gint argc, gchar * argv[])
 {
@@ -90,5 +155,12 @@ main (gint argc, gchar * argv[])
   gst_buffer_pool_set_active (pool, FALSE);
   gst_object_unref (pool);
 
+  /* contended acquire and release, first with enough buffers for everyone
+   * and then with threads waiting for free buffers */
+  for (i = 0; i < G_N_ELEMENTS (thread_counts); i++)
+    run_threads (thread_counts[i], 0, nbuffers);
+  for (i = 0; i < G_N_ELEMENTS (thread_counts); i++)
+    run_threads (thread_counts[i], MAX (thread_counts[i] / 2, 1), nbuffers);
+
   return 0;
 }
@@ -0,0 +1,96 @@
+/* GStreamer
+ * gststructurestress.c: measure field access and copies of structures
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Builds structures with 4, 16 and 64 integer fields and measures getting
+ * every field, setting every field and copying the structure.
+ */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+
+static const guint n_fields[] = { 4, 16, 64 };
+
+static void
+run (guint fields, guint loops)
+{
+  GstStructure *s, *copy;
+  GQuark *quarks;
+  GstClockTime start, end;
+  guint i, j;
+  gint val;
+
+  quarks = g_new (GQuark, fields);
+  s = gst_structure_new_empty ("test");
+  for (i = 0; i < fields; i++) {
+    gchar *name = g_strdup_printf ("field-%u", i);
+
+    quarks[i] = g_quark_from_string (name);
+    gst_structure_id_set (s, quarks[i], G_TYPE_INT, i, NULL);
+    g_free (name);
+  }
+
+  start = gst_util_get_timestamp ();
+  for (j = 0; j < loops; j++) {
+    for (i = 0; i < fields; i++)
+      gst_structure_id_get (s, quarks[i], G_TYPE_INT, &val, NULL);
+  }
+  end = gst_util_get_timestamp ();
+  g_print ("%2u fields: %6.1f ns per get", fields,
+      (gdouble) (end - start) / ((gdouble) loops * fields));
+
+  start = gst_util_get_timestamp ();
+  for (j = 0; j < loops; j++) {
+    for (i = 0; i < fields; i++)
+      gst_structure_id_set (s, quarks[i], G_TYPE_INT, j, NULL);
+  }
+  end = gst_util_get_timestamp ();
+  g_print (", %6.1f ns per set",
+      (gdouble) (end - start) / ((gdouble) loops * fields));
+
+  start = gst_util_get_timestamp ();
+  for (j = 0; j < loops; j++) {
+    copy = gst_structure_copy (s);
+    gst_structure_free (copy);
+  }
+  end = gst_util_get_timestamp ();
+  g_print (", %8.1f ns per copy\n", (gdouble) (end - start) / loops);
+
+  gst_structure_free (s);
+  g_free (quarks);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint i, loops = 100000;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    loops = atoi (argv[1]);
+  if (loops < 1) {
+    g_print ("usage: %s [loops]\n", argv[0]);
+    exit (-1);
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (n_fields); i++)
+    run (n_fields[i], loops);
+
+  return 0;
+}
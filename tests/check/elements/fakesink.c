@@ -26,6 +26,7 @@
 
 #include <gst/base/gstpushsrc.h>
 #include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
 
 typedef struct
 {
@@ -1169,6 +1170,63 @@ GST_START_TEST (test_last_message_deep_notify)
 
 GST_END_TEST;
 
+static void
+offset_handoff (GstElement * fakesink, GstBuffer * buf, GstPad * pad,
+    GArray * offsets)
+{
+  guint64 offset = GST_BUFFER_OFFSET (buf);
+
+  g_array_append_val (offsets, offset);
+}
+
+static GstBufferList *
+make_buffer_list (guint first, guint n_buffers)
+{
+  GstBufferList *list = gst_buffer_list_new_sized (n_buffers);
+  guint i;
+
+  for (i = 0; i < n_buffers; i++) {
+    GstBuffer *buf = gst_buffer_new_and_alloc (4);
+
+    GST_BUFFER_OFFSET (buf) = first + i;
+    gst_buffer_list_add (list, buf);
+  }
+  return list;
+}
+
+GST_START_TEST (test_chain_list)
+{
+  GstHarness *h = gst_harness_new ("fakesink");
+  GArray *offsets = g_array_new (FALSE, FALSE, sizeof (guint64));
+  guint i;
+
+  g_object_set (h->element, "signal-handoffs", TRUE, "sync", FALSE, NULL);
+  g_signal_connect (h->element, "handoff", G_CALLBACK (offset_handoff),
+      offsets);
+  gst_harness_set_src_caps_str (h, "mycaps");
+
+  /* rendered as a list without sync */
+  fail_unless_equals_int (gst_pad_push_list (h->srcpad,
+          make_buffer_list (0, 4)), GST_FLOW_OK);
+  fail_unless_equals_int (offsets->len, 4);
+
+  /* and buffer by buffer with sync, the buffers have no timestamps so that
+   * nothing waits for the clock */
+  g_object_set (h->element, "sync", TRUE, NULL);
+  fail_unless_equals_int (gst_pad_push_list (h->srcpad,
+          make_buffer_list (4, 4)), GST_FLOW_OK);
+  fail_unless_equals_int (offsets->len, 8);
+
+  /* every buffer is handed off once and in order */
+  for (i = 0; i < offsets->len; i++)
+    fail_unless_equals_uint64 (g_array_index (offsets, guint64, i), i);
+
+  gst_harness_teardown (h);
+  g_array_free (offsets, TRUE);
+}
+
+GST_END_TEST;
+
 static Suite *
 fakesink_suite (void)
 {
@@ -1185,6 +1243,7 @@ fakesink_suite (void)
   tcase_add_test (tc_chain, test_position);
   tcase_add_test (tc_chain, test_notify_race);
   tcase_add_test (tc_chain, test_last_message_notify);
+  tcase_add_test (tc_chain, test_chain_list);
   tcase_skip_broken_test (tc_chain, test_last_message_deep_notify);
 
   return s;
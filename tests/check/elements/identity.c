@@ -99,6 +99,62 @@ GST_START_TEST (test_signal_handoffs)
 
 GST_END_TEST;
 
+static GstPadProbeReturn
+count_lists_probe (GstPad * pad, GstPadProbeInfo * info, gint * n_lists)
+{
+  *n_lists += 1;
+  return GST_PAD_PROBE_OK;
+}
+
+static GstBufferList *
+make_buffer_list (guint n_buffers)
+{
+  GstBufferList *list = gst_buffer_list_new ();
+  guint i;
+
+  for (i = 0; i < n_buffers; i++) {
+    GstBuffer *buf = gst_buffer_new_and_alloc (4);
+
+    /* mark every other buffer so that they can be dropped */
+    if (i % 2)
+      GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT);
+    gst_buffer_list_add (list, buf);
+  }
+  return list;
+}
+
+GST_START_TEST (test_buffer_list)
+{
+  GstHarness *h = gst_harness_new ("identity");
+  GstPad *srcpad;
+  gint n_lists = 0;
+
+  gst_harness_set_src_caps_str (h, "mycaps");
+
+  srcpad = gst_element_get_static_pad (h->element, "src");
+  gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER_LIST,
+      (GstPadProbeCallback) count_lists_probe, &n_lists, NULL);
+
+  /* in passthrough mode the list is pushed on as one list */
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_pad_push_list (h->srcpad, make_buffer_list (4)));
+  fail_unless_equals_int (1, n_lists);
+  fail_unless_equals_int (4, gst_harness_buffers_in_queue (h));
+
+  /* dropping buffers needs them to be handled one by one */
+  g_object_set (h->element, "drop-buffer-flags", GST_BUFFER_FLAG_DELTA_UNIT,
+      NULL);
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_pad_push_list (h->srcpad, make_buffer_list (4)));
+  fail_unless_equals_int (1, n_lists);
+  fail_unless_equals_int (6, gst_harness_buffers_in_queue (h));
+
+  gst_object_unref (srcpad);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_sync_on_timestamp)
 {
   /* the reason to use the queue in front of the identity element
@@ -189,6 +245,7 @@ identity_suite (void)
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_one_buffer);
   tcase_add_test (tc_chain, test_signal_handoffs);
+  tcase_add_test (tc_chain, test_buffer_list);
   tcase_add_test (tc_chain, test_sync_on_timestamp);
   tcase_add_test (tc_chain, test_stopping_element_unschedules_sync);
 
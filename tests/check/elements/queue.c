@@ -156,6 +156,9 @@ cleanup (void)
 
   gst_check_teardown_element (queue);
   queue = NULL;
+
+  /* don't leave a budget behind for the next test, also when one failed */
+  gst_allocator_set_memory_budget (0);
 }
 
 /* setup the sinkpad on a playing queue element. gst_check_setup_sink_pad()
@@ -1146,6 +1149,51 @@ GST_START_TEST (test_initial_events_nodelay)
 
 GST_END_TEST;
 
+GST_START_TEST (test_memory_budget_message)
+{
+  GstBus *bus;
+  GstMessage *msg;
+  const GstStructure *s;
+  guint buffers;
+
+  bus = gst_bus_new ();
+  gst_element_set_bus (queue, bus);
+
+  block_src ();
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+  gst_check_setup_events (mysrcpad, queue, NULL, GST_FORMAT_BYTES);
+
+  /* the queue holds the only memory of the process over the budget */
+  gst_allocator_set_memory_budget (1);
+  fail_unless (gst_pad_push (mysrcpad, gst_buffer_new_and_alloc (100)) ==
+      GST_FLOW_OK);
+  fail_unless (gst_pad_push (mysrcpad, gst_buffer_new_and_alloc (100)) ==
+      GST_FLOW_OK);
+  gst_allocator_set_memory_budget (0);
+
+  /* only one message for one excursion over the budget */
+  msg = gst_bus_pop_filtered (bus, GST_MESSAGE_ELEMENT);
+  fail_unless (msg != NULL);
+  fail_unless (GST_MESSAGE_SRC (msg) == GST_OBJECT (queue));
+  s = gst_message_get_structure (msg);
+  fail_unless (gst_structure_has_name (s, "GstMemoryBudgetExceeded"));
+  fail_unless (gst_structure_get_uint (s, "current-level-buffers", &buffers));
+  fail_unless (buffers >= 1);
+  fail_unless (gst_structure_has_field (s, "current-level-bytes"));
+  fail_unless (gst_structure_has_field (s, "current-level-time"));
+  gst_message_unref (msg);
+  fail_unless (gst_bus_pop_filtered (bus, GST_MESSAGE_ELEMENT) == NULL);
+
+  unblock_src ();
+  gst_element_set_state (queue, GST_STATE_NULL);
+  gst_element_set_bus (queue, NULL);
+  gst_object_unref (bus);
+}
+
+GST_END_TEST;
+
 static Suite *
 queue_suite (void)
 {
@@ -1168,6 +1216,7 @@ queue_suite (void)
   tcase_add_test (tc_chain, test_sticky_not_linked);
   tcase_add_test (tc_chain, test_time_level_buffer_list);
   tcase_add_test (tc_chain, test_initial_events_nodelay);
+  tcase_add_test (tc_chain, test_memory_budget_message);
 
   return s;
 }
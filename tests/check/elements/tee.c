@@ -942,6 +942,98 @@ GST_START_TEST (test_allocation_query_empty)
 GST_END_TEST;
 
 
+static void
+offset_handoff (GstElement * fakesink, GstBuffer * buf, GstPad * pad,
+    GArray * offsets)
+{
+  guint64 offset = GST_BUFFER_OFFSET (buf);
+
+  g_array_append_val (offsets, offset);
+}
+
+/* buffer lists pushed into tee ! queue ! fakesink reach every branch
+ * complete and in order */
+GST_START_TEST (test_buffer_lists)
+{
+#define NUM_BRANCHES 3
+#define NUM_LISTS 10
+#define LIST_LENGTH 4
+  GstElement *pipeline, *tee, *queue, *sink;
+  GArray *offsets[NUM_BRANCHES];
+  GstPad *srcpad;
+  GstCaps *caps;
+  GstBus *bus;
+  GstMessage *msg;
+  guint i, j;
+
+  static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+      GST_PAD_SRC,
+      GST_PAD_ALWAYS,
+      GST_STATIC_CAPS_ANY);
+
+  pipeline = gst_pipeline_new ("pipeline");
+  tee = gst_check_setup_element ("tee");
+  fail_unless (gst_bin_add (GST_BIN (pipeline), tee));
+
+  for (i = 0; i < NUM_BRANCHES; i++) {
+    offsets[i] = g_array_new (FALSE, FALSE, sizeof (guint64));
+
+    queue = gst_check_setup_element ("queue");
+    sink = gst_check_setup_element ("fakesink");
+    g_object_set (sink, "signal-handoffs", TRUE, "sync", FALSE, NULL);
+    g_signal_connect (sink, "handoff", (GCallback) offset_handoff,
+        offsets[i]);
+    fail_unless (gst_bin_add (GST_BIN (pipeline), queue));
+    fail_unless (gst_bin_add (GST_BIN (pipeline), sink));
+    fail_unless (gst_element_link_many (tee, queue, sink, NULL));
+  }
+
+  srcpad = gst_check_setup_src_pad (tee, &srctemplate);
+  gst_pad_set_active (srcpad, TRUE);
+
+  bus = gst_element_get_bus (pipeline);
+  fail_if (gst_element_set_state (pipeline,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_FAILURE);
+
+  caps = gst_caps_new_empty_simple ("test/test");
+  gst_check_setup_events (srcpad, tee, caps, GST_FORMAT_BYTES);
+  gst_caps_unref (caps);
+
+  for (i = 0; i < NUM_LISTS; i++) {
+    GstBufferList *list = gst_buffer_list_new_sized (LIST_LENGTH);
+
+    for (j = 0; j < LIST_LENGTH; j++) {
+      GstBuffer *buf = gst_buffer_new ();
+
+      GST_BUFFER_OFFSET (buf) = i * LIST_LENGTH + j;
+      gst_buffer_list_add (list, buf);
+    }
+    fail_unless_equals_int (gst_pad_push_list (srcpad, list), GST_FLOW_OK);
+  }
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_eos ()));
+
+  msg = gst_bus_poll (bus, GST_MESSAGE_EOS | GST_MESSAGE_ERROR, -1);
+  fail_if (GST_MESSAGE_TYPE (msg) != GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+
+  for (i = 0; i < NUM_BRANCHES; i++) {
+    fail_unless_equals_int (offsets[i]->len, NUM_LISTS * LIST_LENGTH);
+    for (j = 0; j < offsets[i]->len; j++)
+      fail_unless_equals_uint64 (g_array_index (offsets[i], guint64, j), j);
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_check_teardown_src_pad (tee);
+  gst_object_unref (bus);
+  gst_object_unref (pipeline);
+
+  for (i = 0; i < NUM_BRANCHES; i++)
+    g_array_free (offsets[i], TRUE);
+}
+
+GST_END_TEST;
+
 static Suite *
 tee_suite (void)
 {
@@ -964,6 +1056,7 @@ tee_suite (void)
   tcase_add_test (tc_chain, test_allocation_query_allow_not_linked);
   tcase_add_test (tc_chain, test_allocation_query_failure);
   tcase_add_test (tc_chain, test_allocation_query_empty);
+  tcase_add_test (tc_chain, test_buffer_lists);
 
   return s;
 }
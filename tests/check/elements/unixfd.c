@@ -0,0 +1,181 @@
+/* GStreamer
+ *
+ * unit test for unixfdsink and unixfdsrc
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <unistd.h>
+
+#include <gst/check/gstcheck.h>
+
+#define NUM_BUFFERS 10
+#define BUFFER_SIZE 4096
+
+static GstCaps *reference_caps;
+
+static void
+sender_handoff (GstElement * fakesrc, GstBuffer * buf, GstPad * pad,
+    gint * count)
+{
+  GstMapInfo map;
+
+  GST_BUFFER_PTS (buf) = *count * GST_SECOND;
+  GST_BUFFER_DURATION (buf) = GST_SECOND;
+
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_WRITE));
+  memset (map.data, *count, map.size);
+  gst_buffer_unmap (buf, &map);
+
+  gst_buffer_add_reference_timestamp_meta (buf, reference_caps,
+      *count * GST_MSECOND, GST_CLOCK_TIME_NONE);
+
+  *count += 1;
+}
+
+static void
+receiver_handoff (GstElement * fakesink, GstBuffer * buf, GstPad * pad,
+    gint * count)
+{
+  GstReferenceTimestampMeta *meta;
+  GstMapInfo map;
+  gsize i;
+
+  fail_unless_equals_uint64 (GST_BUFFER_PTS (buf), *count * GST_SECOND);
+  fail_unless_equals_uint64 (GST_BUFFER_DURATION (buf), GST_SECOND);
+
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+  fail_unless_equals_int (map.size, BUFFER_SIZE);
+  for (i = 0; i < map.size; i++)
+    fail_unless_equals_int (map.data[i], *count);
+  gst_buffer_unmap (buf, &map);
+
+  /* the data of the sender is never writable here */
+  fail_unless (gst_memory_is_type (gst_buffer_peek_memory (buf, 0),
+          GST_ALLOCATOR_MEMFD));
+  fail_unless (GST_MEMORY_IS_READONLY (gst_buffer_peek_memory (buf, 0)));
+
+  meta = gst_buffer_get_reference_timestamp_meta (buf, reference_caps);
+  fail_unless (meta != NULL);
+  fail_unless_equals_uint64 (meta->timestamp, *count * GST_MSECOND);
+  fail_unless_equals_uint64 (meta->duration, GST_CLOCK_TIME_NONE);
+
+  *count += 1;
+}
+
+static void
+wait_for_eos (GstElement * pipeline)
+{
+  GstBus *bus;
+  GstMessage *msg;
+
+  bus = gst_element_get_bus (pipeline);
+  msg = gst_bus_timed_pop_filtered (bus, 10 * GST_SECOND,
+      GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  fail_unless (msg != NULL);
+  fail_unless_equals_int (GST_MESSAGE_TYPE (msg), GST_MESSAGE_EOS);
+  gst_message_unref (msg);
+  gst_object_unref (bus);
+}
+
+GST_START_TEST (test_round_trip)
+{
+  GstElement *sender, *fakesrc, *sendfilter, *sink;
+  GstElement *receiver, *src, *recvfilter, *fakesink;
+  gint sent = 0, received = 0;
+  GstCaps *caps;
+  gchar *path;
+
+  reference_caps = gst_caps_new_empty_simple ("timestamp/x-test");
+  path = g_strdup_printf ("%s/gst-unixfd-test-%d", g_get_tmp_dir (),
+      (gint) getpid ());
+
+  sender = gst_pipeline_new ("sender");
+  fakesrc = gst_element_factory_make ("fakesrc", NULL);
+  sendfilter = gst_element_factory_make ("capsfilter", NULL);
+  sink = gst_element_factory_make ("unixfdsink", NULL);
+  g_object_set (fakesrc, "num-buffers", NUM_BUFFERS, "sizemax", BUFFER_SIZE,
+      "signal-handoffs", TRUE, NULL);
+  gst_util_set_object_arg (G_OBJECT (fakesrc), "sizetype", "fixed");
+  g_signal_connect (fakesrc, "handoff", G_CALLBACK (sender_handoff), &sent);
+  g_object_set (sink, "socket-path", path, "sync", FALSE, NULL);
+  gst_bin_add_many (GST_BIN (sender), fakesrc, sendfilter, sink, NULL);
+  fail_unless (gst_element_link_many (fakesrc, sendfilter, sink, NULL));
+
+  receiver = gst_pipeline_new ("receiver");
+  src = gst_element_factory_make ("unixfdsrc", NULL);
+  recvfilter = gst_element_factory_make ("capsfilter", NULL);
+  fakesink = gst_element_factory_make ("fakesink", NULL);
+  g_object_set (src, "socket-path", path, NULL);
+  g_object_set (fakesink, "signal-handoffs", TRUE, "sync", FALSE, NULL);
+  g_signal_connect (fakesink, "handoff", G_CALLBACK (receiver_handoff),
+      &received);
+  gst_bin_add_many (GST_BIN (receiver), src, recvfilter, fakesink, NULL);
+  fail_unless (gst_element_link_many (src, recvfilter, fakesink, NULL));
+
+  /* the caps of the sender must make it through */
+  caps = gst_caps_new_empty_simple ("application/x-unixfd-test");
+  g_object_set (sendfilter, "caps", caps, NULL);
+  g_object_set (recvfilter, "caps", caps, NULL);
+
+  /* the sink prerolls the first buffer right away and only waits for a
+   * client when it renders it */
+  fail_unless_equals_int (gst_element_set_state (sender, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_ASYNC);
+  fail_unless (gst_element_set_state (receiver,
+          GST_STATE_PLAYING) != GST_STATE_CHANGE_FAILURE);
+
+  wait_for_eos (receiver);
+  wait_for_eos (sender);
+
+  fail_unless_equals_int (sent, NUM_BUFFERS);
+  fail_unless_equals_int (received, NUM_BUFFERS);
+
+  gst_element_set_state (receiver, GST_STATE_NULL);
+  gst_element_set_state (sender, GST_STATE_NULL);
+  gst_object_unref (receiver);
+  gst_object_unref (sender);
+
+  fail_if (g_file_test (path, G_FILE_TEST_EXISTS));
+
+  gst_caps_unref (caps);
+  gst_caps_unref (reference_caps);
+  g_free (path);
+}
+
+GST_END_TEST;
+
+static Suite *
+unixfd_suite (void)
+{
+  Suite *s = suite_create ("unixfd");
+  TCase *tc_chain = tcase_create ("general");
+  GstAllocator *allocator;
+
+  suite_add_tcase (s, tc_chain);
+
+  /* needs memfd support */
+  allocator = gst_allocator_find (GST_ALLOCATOR_MEMFD);
+  if (allocator && gst_registry_check_feature_version (gst_registry_get (),
+          "unixfdsink", GST_VERSION_MAJOR, GST_VERSION_MINOR, 0))
+    tcase_add_test (tc_chain, test_round_trip);
+  if (allocator)
+    gst_object_unref (allocator);
+
+  return s;
+}
+
+GST_CHECK_MAIN (unixfd);
@@ -890,6 +890,188 @@ GST_START_TEST (test_parent_buffer_meta)
 GST_END_TEST;
 
 
+GST_START_TEST (test_cache_stats)
+{
+  GstStructure *stats;
+  GstBuffer *buf;
+  guint64 hits_before, hits_after, misses, cached;
+  gboolean enabled;
+  gint i;
+
+  /* warm up the cache of this thread */
+  buf = gst_buffer_new_allocate (NULL, 100, NULL);
+  gst_buffer_unref (buf);
+
+  stats = gst_buffer_cache_get_stats ();
+  fail_unless (gst_structure_get (stats, "enabled", G_TYPE_BOOLEAN, &enabled,
+          "hits", G_TYPE_UINT64, &hits_before, "misses", G_TYPE_UINT64,
+          &misses, NULL));
+  gst_structure_free (stats);
+
+  for (i = 0; i < 100; i++) {
+    buf = gst_buffer_new_allocate (NULL, 100, NULL);
+    gst_buffer_unref (buf);
+  }
+
+  stats = gst_buffer_cache_get_stats ();
+  fail_unless (gst_structure_get_uint64 (stats, "hits", &hits_after));
+  gst_structure_free (stats);
+
+  /* the cache is disabled in valgrind */
+  if (enabled) {
+    /* buffer struct and memory block for each buffer */
+    fail_unless (hits_after >= hits_before + 200);
+  } else {
+    fail_unless_equals_uint64 (hits_after, hits_before);
+  }
+
+  /* nothing is left in the depot after trimming */
+  gst_buffer_cache_trim ();
+
+  stats = gst_buffer_cache_get_stats ();
+  fail_unless (gst_structure_get_uint64 (stats, "cached", &cached));
+  fail_unless_equals_uint64 (cached, 0);
+  gst_structure_free (stats);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_many_memory)
+{
+  GstMemory *mems[64];
+  GstBuffer *buf, *copy;
+  guint8 data[64 * 4];
+  guint i;
+
+  fail_unless (gst_buffer_get_max_memory () >= G_N_ELEMENTS (mems));
+
+  buf = gst_buffer_new ();
+  for (i = 0; i < G_N_ELEMENTS (mems); i++) {
+    mems[i] = gst_allocator_alloc (NULL, 4, NULL);
+    gst_memory_memset (mems[i], 0, i, 4);
+    gst_buffer_append_memory (buf, mems[i]);
+  }
+
+  /* memory is never merged */
+  fail_unless_equals_int (gst_buffer_n_memory (buf), G_N_ELEMENTS (mems));
+  for (i = 0; i < G_N_ELEMENTS (mems); i++)
+    fail_unless (gst_buffer_peek_memory (buf, i) == mems[i]);
+  fail_unless_equals_int (gst_buffer_get_size (buf), sizeof (data));
+
+  fail_unless_equals_int (gst_buffer_extract (buf, 0, data, sizeof (data)),
+      sizeof (data));
+  for (i = 0; i < sizeof (data); i++)
+    fail_unless_equals_int (data[i], i / 4);
+
+  copy = gst_buffer_copy (buf);
+  fail_unless_equals_int (gst_buffer_n_memory (copy), G_N_ELEMENTS (mems));
+  fail_unless (gst_buffer_peek_memory (copy, 40) == mems[40]);
+
+  /* insert and remove in the overflow part */
+  gst_buffer_insert_memory (buf, 20, gst_memory_ref (mems[0]));
+  fail_unless_equals_int (gst_buffer_n_memory (buf), G_N_ELEMENTS (mems) + 1);
+  fail_unless (gst_buffer_peek_memory (buf, 20) == mems[0]);
+  fail_unless (gst_buffer_peek_memory (buf, 21) == mems[20]);
+  gst_buffer_remove_memory_range (buf, 10, 30);
+  fail_unless_equals_int (gst_buffer_n_memory (buf),
+      G_N_ELEMENTS (mems) + 1 - 30);
+  fail_unless (gst_buffer_peek_memory (buf, 10) == mems[39]);
+
+  gst_buffer_unref (copy);
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_map_memories)
+{
+  GstMapInfo infos[3];
+  GstMemory *mem[3];
+  GstBuffer *buf;
+  guint i;
+
+  buf = gst_buffer_new ();
+  for (i = 0; i < G_N_ELEMENTS (mem); i++) {
+    mem[i] = gst_allocator_alloc (NULL, 10 + i, NULL);
+    gst_memory_memset (mem[i], 0, 'a' + i, 10 + i);
+    gst_buffer_append_memory (buf, mem[i]);
+  }
+
+  fail_unless (gst_buffer_map_memories (buf, 0, -1, infos, GST_MAP_READ));
+  for (i = 0; i < G_N_ELEMENTS (mem); i++) {
+    fail_unless (infos[i].memory == mem[i]);
+    fail_unless_equals_int (infos[i].size, 10 + i);
+    fail_unless_equals_int (infos[i].data[0], 'a' + i);
+  }
+  gst_buffer_unmap_memories (buf, infos, G_N_ELEMENTS (mem));
+
+  /* nothing was merged */
+  fail_unless_equals_int (gst_buffer_n_memory (buf), G_N_ELEMENTS (mem));
+
+  /* a range */
+  fail_unless (gst_buffer_map_memories (buf, 1, 2, infos, GST_MAP_WRITE));
+  fail_unless (infos[0].memory == mem[1]);
+  fail_unless (infos[1].memory == mem[2]);
+  infos[1].data[0] = 'z';
+  gst_buffer_unmap_memories (buf, infos, 2);
+
+  fail_unless (gst_buffer_memcmp (buf, 21, "z", 1) == 0);
+  fail_unless_equals_int (gst_buffer_n_memory (buf), G_N_ELEMENTS (mem));
+
+  gst_buffer_unref (buf);
+
+  /* an empty buffer maps nothing */
+  buf = gst_buffer_new ();
+  fail_unless (gst_buffer_map_memories (buf, 0, -1, infos, GST_MAP_READ));
+  gst_buffer_unmap_memories (buf, infos, 0);
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+/* large enough for the non-temporal copy */
+#define LARGE_COPY_SIZE (5 * 1024 * 1024 + 13)
+
+GST_START_TEST (test_large_copy)
+{
+  GstBuffer *buf, *copy;
+  guint8 *data, *out;
+  GstMapInfo info;
+  gsize i;
+
+  data = g_malloc (LARGE_COPY_SIZE);
+  for (i = 0; i < LARGE_COPY_SIZE; i++)
+    data[i] = i % 251;
+
+  /* unaligned start and end in the buffer */
+  buf = gst_buffer_new_allocate (NULL, LARGE_COPY_SIZE + 3, NULL);
+  gst_buffer_memset (buf, 0, 0xff, LARGE_COPY_SIZE + 3);
+  fail_unless_equals_int (gst_buffer_fill (buf, 3, data, LARGE_COPY_SIZE),
+      LARGE_COPY_SIZE);
+  fail_unless (gst_buffer_memcmp (buf, 3, data, LARGE_COPY_SIZE) == 0);
+  fail_unless_equals_int (gst_buffer_extract (buf, 0, data, 3), 3);
+  fail_unless (data[0] == 0xff && data[1] == 0xff && data[2] == 0xff);
+
+  out = g_malloc (LARGE_COPY_SIZE + 1);
+  out[LARGE_COPY_SIZE] = 0x42;
+  fail_unless_equals_int (gst_buffer_extract (buf, 3, out + 1,
+          LARGE_COPY_SIZE), LARGE_COPY_SIZE);
+  fail_unless (out[LARGE_COPY_SIZE] == (LARGE_COPY_SIZE - 1) % 251);
+  fail_unless (gst_buffer_memcmp (buf, 4, out + 2, LARGE_COPY_SIZE - 1) == 0);
+
+  copy = gst_buffer_copy_deep (buf);
+  fail_unless (gst_buffer_map (copy, &info, GST_MAP_READ));
+  fail_unless (gst_buffer_memcmp (buf, 0, info.data, info.size) == 0);
+  gst_buffer_unmap (copy, &info);
+
+  gst_buffer_unref (copy);
+  gst_buffer_unref (buf);
+  g_free (out);
+  g_free (data);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_buffer_suite (void)
 {
@@ -910,9 +1092,13 @@ gst_buffer_suite (void)
   tcase_add_test (tc_chain, test_resize);
   tcase_add_test (tc_chain, test_map);
   tcase_add_test (tc_chain, test_map_range);
+  tcase_add_test (tc_chain, test_map_memories);
+  tcase_add_test (tc_chain, test_large_copy);
   tcase_add_test (tc_chain, test_find);
   tcase_add_test (tc_chain, test_fill);
   tcase_add_test (tc_chain, test_parent_buffer_meta);
+  tcase_add_test (tc_chain, test_cache_stats);
+  tcase_add_test (tc_chain, test_many_memory);
 
   return s;
 }
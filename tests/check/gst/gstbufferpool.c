@@ -300,6 +300,214 @@ GST_START_TEST (test_flushing_pool_returns_flushing)
 
 GST_END_TEST;
 
+static guint
+get_stat_uint (GstBufferPool * pool, const gchar * field)
+{
+  GstStructure *stats = gst_buffer_pool_get_stats (pool);
+  guint64 val64;
+  guint val;
+
+  if (gst_structure_get_uint (stats, field, &val)) {
+    gst_structure_free (stats);
+    return val;
+  }
+
+  fail_unless (gst_structure_get_uint64 (stats, field, &val64));
+  gst_structure_free (stats);
+  return val64;
+}
+
+static gpointer
+acquire_and_release (GstBufferPool * pool)
+{
+  GstBuffer *buf = NULL;
+
+  fail_unless_equals_int (gst_buffer_pool_acquire_buffer (pool, &buf, NULL),
+      GST_FLOW_OK);
+  gst_buffer_unref (buf);
+
+  return NULL;
+}
+
+static void
+wait_for_waiter (GstBufferPool * pool)
+{
+  while (get_stat_uint (pool, "waiters") == 0)
+    g_thread_yield ();
+}
+
+GST_START_TEST (test_pool_stats)
+{
+  GstBufferPool *pool = create_pool (10, 0, 1);
+  GstBuffer *buf = NULL;
+  GstStructure *stats;
+  GstClockTime blocked_time;
+  GThread *thread;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+  fail_unless_equals_int (get_stat_uint (pool, "allocations"), 1);
+  fail_unless_equals_int (get_stat_uint (pool, "outstanding"), 1);
+
+  /* the pool is exhausted, the thread has to wait for our buffer */
+  thread = g_thread_new ("acquire", (GThreadFunc) acquire_and_release, pool);
+  wait_for_waiter (pool);
+  gst_buffer_unref (buf);
+  g_thread_join (thread);
+
+  stats = gst_buffer_pool_get_stats (pool);
+  fail_unless (gst_structure_has_name (stats, "GstBufferPoolStats"));
+  fail_unless_equals_int (get_stat_uint (pool, "allocations"), 1);
+  fail_unless_equals_int (get_stat_uint (pool, "reuses"), 1);
+  fail_unless_equals_int (get_stat_uint (pool, "waits"), 1);
+  fail_unless_equals_int (get_stat_uint (pool, "buffers"), 1);
+  fail_unless_equals_int (get_stat_uint (pool, "outstanding"), 0);
+  fail_unless_equals_int (get_stat_uint (pool, "peak-outstanding"), 2);
+  fail_unless (gst_structure_get_uint64 (stats, "blocked-time",
+          &blocked_time));
+  fail_unless (blocked_time > 0);
+  gst_structure_free (stats);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pool_idle_trim)
+{
+  GstBufferPool *pool = create_pool (10, 1, 0);
+  GstBuffer *bufs[4];
+  GstStructure *conf;
+  GstClockTime timeout;
+  gint i;
+
+  conf = gst_buffer_pool_get_config (pool);
+  fail_if (gst_buffer_pool_config_get_idle_timeout (conf, &timeout));
+  fail_unless_equals_uint64 (timeout, GST_CLOCK_TIME_NONE);
+  gst_buffer_pool_config_set_idle_timeout (conf, 20 * GST_MSECOND);
+  fail_unless (gst_buffer_pool_config_get_idle_timeout (conf, &timeout));
+  fail_unless_equals_uint64 (timeout, 20 * GST_MSECOND);
+  fail_unless (gst_buffer_pool_set_config (pool, conf));
+
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  /* grow on demand */
+  for (i = 0; i < 4; i++)
+    gst_buffer_pool_acquire_buffer (pool, &bufs[i], NULL);
+  for (i = 0; i < 4; i++)
+    gst_buffer_unref (bufs[i]);
+  fail_unless_equals_int (get_stat_uint (pool, "buffers"), 4);
+
+  /* only one buffer is used from now on, the idle ones are freed but the
+   * pool does not shrink below its minimum */
+  for (i = 0; i < 20 && get_stat_uint (pool, "buffers") > 1; i++) {
+    g_usleep (50000);
+    acquire_and_release (pool);
+  }
+  fail_unless_equals_int (get_stat_uint (pool, "buffers"), 1);
+  fail_unless_equals_int (get_stat_uint (pool, "trimmed"), 3);
+
+  for (i = 0; i < 3; i++) {
+    g_usleep (50000);
+    acquire_and_release (pool);
+  }
+  fail_unless_equals_int (get_stat_uint (pool, "buffers"), 1);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pool_memory_budget)
+{
+  GstBufferPool *pool = create_pool (1000, 0, 0);
+  GstBufferPoolAcquireParams params = { 0, };
+  GstBuffer *buf = NULL, *buf2 = NULL;
+  GThread *thread;
+
+  /* memory is only accounted while there is a budget */
+  gst_allocator_set_memory_budget (1);
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+  fail_unless (buf != NULL);
+  fail_unless (get_stat_uint (pool, "live-bytes") >= 1000);
+  fail_unless_equals_int (get_stat_uint (pool, "peak-bytes"),
+      get_stat_uint (pool, "live-bytes"));
+
+  /* over the budget the pool doesn't grow without waiting */
+  params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+  fail_unless_equals_int (gst_buffer_pool_acquire_buffer (pool, &buf2,
+          &params), GST_FLOW_EOS);
+
+  /* but waits a little for our buffer to come back */
+  thread = g_thread_new ("acquire", (GThreadFunc) acquire_and_release, pool);
+  wait_for_waiter (pool);
+  gst_buffer_unref (buf);
+  g_thread_join (thread);
+  fail_unless_equals_int (get_stat_uint (pool, "allocations"), 1);
+  fail_unless_equals_int (get_stat_uint (pool, "reuses"), 1);
+  fail_unless_equals_int (get_stat_uint (pool, "waits"), 1);
+
+  /* an empty pool always allocates */
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_buffer_pool_set_active (pool, TRUE);
+  fail_unless_equals_int (get_stat_uint (pool, "buffers"), 0);
+  fail_unless_equals_int (gst_buffer_pool_acquire_buffer (pool, &buf2, NULL),
+      GST_FLOW_OK);
+  gst_allocator_set_memory_budget (0);
+
+  gst_buffer_unref (buf2);
+  gst_buffer_pool_set_active (pool, FALSE);
+  fail_unless_equals_int (get_stat_uint (pool, "live-bytes"), 0);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pool_memory_budget_freed)
+{
+  GstBufferPool *pool = create_pool (1000, 0, 0);
+  GstAllocator *other;
+  GstMemory *mem;
+  GstBuffer *buf = NULL;
+  GThread *thread;
+
+  gst_allocator_set_memory_budget (1024 * 1024);
+
+  /* another allocator holds the memory of the budget */
+  other = gst_huge_page_allocator_new (-1, GST_HUGE_PAGE_ALLOCATOR_FLAG_NONE);
+  mem = gst_allocator_alloc (other, 4 * 1024 * 1024, NULL);
+  fail_unless (mem != NULL);
+  fail_unless (gst_allocator_memory_budget_exceeded ());
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  gst_buffer_pool_acquire_buffer (pool, &buf, NULL);
+  fail_unless (buf != NULL);
+
+  /* when that memory is freed the waiting acquire allocates, even though we
+   * still hold the buffer it could have waited for */
+  thread = g_thread_new ("acquire", (GThreadFunc) acquire_and_release, pool);
+  wait_for_waiter (pool);
+  gst_memory_unref (mem);
+  fail_if (gst_allocator_memory_budget_exceeded ());
+  g_thread_join (thread);
+  fail_unless_equals_int (get_stat_uint (pool, "allocations"), 2);
+  fail_unless_equals_int (get_stat_uint (pool, "waits"), 1);
+  fail_unless_equals_int (get_stat_uint (pool, "outstanding"), 1);
+
+  gst_buffer_unref (buf);
+  gst_allocator_set_memory_budget (0);
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (other);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_buffer_pool_suite (void)
 {
@@ -318,6 +526,10 @@ gst_buffer_pool_suite (void)
   tcase_add_test (tc_chain, test_pool_activation_and_config);
   tcase_add_test (tc_chain, test_pool_config_validate);
   tcase_add_test (tc_chain, test_flushing_pool_returns_flushing);
+  tcase_add_test (tc_chain, test_pool_stats);
+  tcase_add_test (tc_chain, test_pool_idle_trim);
+  tcase_add_test (tc_chain, test_pool_memory_budget);
+  tcase_add_test (tc_chain, test_pool_memory_budget_freed);
 
   return s;
 }
@@ -1386,6 +1386,227 @@ GST_START_TEST (test_filter_and_map_in_place)
 
 GST_END_TEST;
 
+GST_START_TEST (test_intern)
+{
+  GstCaps *caps, *caps2, *interned, *interned2;
+
+  caps = gst_caps_from_string ("video/x-raw, format=I420; audio/x-raw");
+  caps2 = gst_caps_copy (caps);
+
+  interned = gst_caps_intern (gst_caps_ref (caps));
+  fail_unless (interned == caps);
+  fail_if (gst_caps_is_writable (interned));
+
+  interned2 = gst_caps_intern (gst_caps_ref (caps2));
+  fail_unless (interned2 == caps);
+  gst_caps_unref (interned2);
+  gst_caps_unref (caps2);
+
+  /* only strictly equal caps are the same */
+  caps2 = gst_caps_from_string ("audio/x-raw; video/x-raw, format=I420");
+  interned2 = gst_caps_intern (gst_caps_ref (caps2));
+  fail_unless (interned2 == caps2);
+  gst_caps_unref (interned2);
+  gst_caps_unref (caps2);
+
+  gst_caps_unref (interned);
+  gst_caps_unref (caps);
+}
+
+GST_END_TEST;
+
+#define CACHE_CAPS1 "video/x-h264, stream-format=(string){avc,byte-stream}; " \
+    "video/x-h265; video/mpeg, mpegversion=(int){1,2,4}; " \
+    "audio/mpeg, mpegversion=(int)[1,4]; audio/x-ac3"
+#define CACHE_CAPS2 "video/x-h264, stream-format=(string)avc; " \
+    "video/mpeg, mpegversion=(int)[2,4]; audio/x-ac3, framed=(boolean)true; " \
+    "audio/x-opus"
+
+GST_START_TEST (test_intersect_cache)
+{
+  GstCaps *caps1, *caps2, *copy1, *copy2, *expected, *expected_first;
+  GstCaps *res;
+  gboolean subset, can_intersect;
+
+  caps1 = gst_caps_from_string (CACHE_CAPS1);
+  caps2 = gst_caps_from_string (CACHE_CAPS2);
+
+  expected = gst_caps_intersect (caps1, caps2);
+  expected_first =
+      gst_caps_intersect_full (caps1, caps2, GST_CAPS_INTERSECT_FIRST);
+  subset = gst_caps_is_subset (caps2, caps1);
+  can_intersect = gst_caps_can_intersect (caps1, caps2);
+  fail_unless (can_intersect);
+
+  /* the cache keeps copies, the caps stay writable */
+  fail_unless (gst_caps_is_writable (caps1));
+  fail_unless (gst_caps_is_writable (caps2));
+
+  /* the cached result is shared */
+  res = gst_caps_intersect (caps1, caps2);
+  fail_unless (res == expected);
+  fail_if (gst_caps_is_writable (res));
+  gst_caps_unref (res);
+
+  /* equal caps find the same result */
+  copy1 = gst_caps_copy (caps1);
+  copy2 = gst_caps_copy (caps2);
+  res = gst_caps_intersect (copy1, copy2);
+  fail_unless (res == expected);
+  gst_caps_unref (res);
+
+  /* the other mode is cached separately */
+  res = gst_caps_intersect_full (copy1, copy2, GST_CAPS_INTERSECT_FIRST);
+  fail_unless (res == expected_first);
+  gst_caps_unref (res);
+
+  fail_unless_equals_int (gst_caps_is_subset (copy2, copy1), subset);
+  fail_unless_equals_int (gst_caps_can_intersect (copy1, copy2),
+      can_intersect);
+
+  /* changing the caps after they were cached gives a new result */
+  gst_caps_set_simple (caps1, "cached", G_TYPE_BOOLEAN, TRUE, NULL);
+  res = gst_caps_intersect (caps1, caps2);
+  fail_if (res == expected);
+  fail_unless (gst_structure_has_field (gst_caps_get_structure (res, 0),
+          "cached"));
+  gst_caps_unref (res);
+  res = gst_caps_intersect (copy1, copy2);
+  fail_unless (res == expected);
+  gst_caps_unref (res);
+
+  gst_caps_unref (expected);
+  gst_caps_unref (expected_first);
+  gst_caps_unref (copy1);
+  gst_caps_unref (copy2);
+  gst_caps_unref (caps1);
+  gst_caps_unref (caps2);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_from_string_cache)
+{
+  GstCaps *caps1, *caps2, *caps3;
+  gint rate;
+
+  caps1 = gst_caps_from_string (CACHE_CAPS1);
+  caps2 = gst_caps_from_string (CACHE_CAPS1);
+  fail_unless (caps1 != caps2);
+  fail_unless (gst_caps_is_writable (caps1));
+  fail_unless (gst_caps_is_writable (caps2));
+  fail_unless (gst_caps_is_strictly_equal (caps1, caps2));
+
+  /* changing the caps doesn't change what the next caller gets */
+  gst_caps_set_simple (caps2, "rate", G_TYPE_INT, 48000, NULL);
+  caps3 = gst_caps_from_string (CACHE_CAPS1);
+  fail_unless (gst_caps_is_strictly_equal (caps1, caps3));
+  fail_if (gst_structure_get_int (gst_caps_get_structure (caps3, 0), "rate",
+          &rate));
+  gst_caps_unref (caps3);
+  gst_caps_unref (caps2);
+  gst_caps_unref (caps1);
+
+  caps1 = gst_caps_from_string ("ANY");
+  caps2 = gst_caps_from_string ("ANY");
+  fail_unless (gst_caps_is_any (caps2));
+  gst_caps_unref (caps2);
+  gst_caps_unref (caps1);
+
+  fail_unless (gst_caps_from_string ("video/x-raw, width=(int)") == NULL);
+  fail_unless (gst_caps_from_string ("video/x-raw, width=(int)") == NULL);
+}
+
+GST_END_TEST;
+
+static void
+check_binary_round_trip (GstCaps * caps)
+{
+  GByteArray *bytes = g_byte_array_new ();
+  GstCaps *caps2;
+  gsize consumed;
+
+  fail_unless (gst_caps_to_binary (caps, bytes));
+  caps2 = gst_caps_from_binary (bytes->data, bytes->len, &consumed);
+  fail_unless (caps2 != NULL);
+  fail_unless_equals_int (consumed, bytes->len);
+  fail_unless (gst_caps_is_strictly_equal (caps, caps2));
+  fail_unless_equals_int (gst_caps_is_any (caps), gst_caps_is_any (caps2));
+  gst_caps_unref (caps2);
+
+  fail_unless (gst_structure_from_binary (bytes->data, bytes->len,
+          NULL) == NULL);
+  if (bytes->len > 2)
+    fail_unless (gst_caps_from_binary (bytes->data, bytes->len - 1,
+            NULL) == NULL);
+
+  g_byte_array_unref (bytes);
+  gst_caps_unref (caps);
+}
+
+GST_START_TEST (test_binary)
+{
+  GstCaps *caps, *inner;
+
+  check_binary_round_trip (gst_caps_new_any ());
+  check_binary_round_trip (gst_caps_new_empty ());
+  check_binary_round_trip (gst_caps_from_string ("audio/x-raw, "
+          "format=(string){ S16LE, F32LE }, rate=(int)[ 1, 2147483647 ], "
+          "channels=(int)2, channel-mask=(bitmask)0x3; "
+          "video/x-raw(memory:GLMemory, meta:GstVideoOverlayComposition), "
+          "format=(string)RGBA, framerate=(fraction)[ 0/1, 30/1 ]; "
+          "video/x-raw(ANY); video/x-raw(memory:SystemMemory)"));
+  check_binary_round_trip (gst_caps_from_string (non_simple_caps_string));
+
+  /* caps nested in caps are kept intact */
+  inner = gst_caps_from_string ("video/x-raw, width=(int)[ 1, 100 ]; "
+      "audio/x-raw");
+  caps = gst_caps_new_simple ("nested", "caps", GST_TYPE_CAPS, inner, NULL);
+  gst_caps_unref (inner);
+  check_binary_round_trip (caps);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_binary_invalid)
+{
+  /* a structure "s" with the fraction field "f" = 1/1 */
+  guint8 fraction[] = { 1, 'S', 1, 's', 0, 1, 1, 'f', 0, 11,
+    0x02, 0x02, 0x00, 0x00, 0x00, 0x00
+  };
+  /* a structure "s" with the enum field "e" of the type "GEnum" */
+  const guint8 abstract_enum[] = { 1, 'S', 1, 's', 0, 1, 1, 'e', 0, 20,
+    5, 'G', 'E', 'n', 'u', 'm', 0, 0x00
+  };
+  /* the caps "s(memory:X)" */
+  guint8 features[] = { 1, 'C', 0, 1, 1, 's', 0, 0, 2, 1,
+    8, 'm', 'e', 'm', 'o', 'r', 'y', ':', 'X', 0
+  };
+  GstStructure *s;
+  GstCaps *caps;
+
+  s = gst_structure_from_binary (fraction, 12, NULL);
+  fail_unless (s != NULL);
+  gst_structure_free (s);
+  /* G_MININT/1 */
+  fraction[10] = fraction[11] = fraction[12] = fraction[13] = 0xff;
+  fraction[14] = 0x0f;
+  fraction[15] = 0x02;
+  fail_unless (gst_structure_from_binary (fraction, 16, NULL) == NULL);
+
+  fail_unless (gst_structure_from_binary (abstract_enum,
+          sizeof (abstract_enum), NULL) == NULL);
+
+  caps = gst_caps_from_binary (features, sizeof (features), NULL);
+  fail_unless (caps != NULL);
+  gst_caps_unref (caps);
+  features[17] = 'x';
+  fail_unless (gst_caps_from_binary (features, sizeof (features),
+          NULL) == NULL);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_caps_suite (void)
 {
@@ -1420,6 +1641,11 @@ gst_caps_suite (void)
   tcase_add_test (tc_chain, test_foreach);
   tcase_add_test (tc_chain, test_map_in_place);
   tcase_add_test (tc_chain, test_filter_and_map_in_place);
+  tcase_add_test (tc_chain, test_intern);
+  tcase_add_test (tc_chain, test_intersect_cache);
+  tcase_add_test (tc_chain, test_from_string_cache);
+  tcase_add_test (tc_chain, test_binary);
+  tcase_add_test (tc_chain, test_binary_invalid);
 
   return s;
 }
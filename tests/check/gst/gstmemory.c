@@ -24,6 +24,10 @@
 # include "config.h"
 #endif
 
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
 #include <gst/check/gstcheck.h>
 
 GST_START_TEST (test_submemory)
@@ -537,6 +541,232 @@ GST_START_TEST (test_alloc_params)
 
 GST_END_TEST;
 
+GST_START_TEST (test_huge_page_allocator)
+{
+  GstAllocator *allocator;
+  GstAllocationParams params;
+  GstMemory *mem, *sub, *copy;
+  GstMapInfo info;
+  gsize size = 8 * 1024 * 1024;
+
+  allocator = gst_allocator_find (GST_ALLOCATOR_HUGE_PAGE);
+  /* not supported on this platform */
+  if (allocator == NULL)
+    return;
+
+  gst_allocation_params_init (&params);
+  params.align = 63;
+  params.prefix = 16;
+  mem = gst_allocator_alloc (allocator, size, &params);
+  fail_unless (mem != NULL);
+  fail_unless (gst_memory_is_type (mem, GST_ALLOCATOR_HUGE_PAGE));
+  fail_unless (gst_memory_get_sizes (mem, NULL, NULL) == size);
+
+  fail_unless (gst_memory_map (mem, &info, GST_MAP_WRITE));
+  fail_unless (((guintptr) info.data & 63) == 0);
+  memset (info.data, 0xaa, info.size);
+  gst_memory_unmap (mem, &info);
+
+  sub = gst_memory_share (mem, 1024, 1024);
+  fail_unless (gst_memory_map (sub, &info, GST_MAP_READ));
+  fail_unless (info.size == 1024);
+  fail_unless (info.data[0] == 0xaa);
+  gst_memory_unmap (sub, &info);
+  gst_memory_unref (sub);
+
+  copy = gst_memory_copy (mem, 0, -1);
+  fail_unless (gst_memory_is_type (copy, GST_ALLOCATOR_HUGE_PAGE));
+  fail_unless (gst_memory_map (copy, &info, GST_MAP_READ));
+  fail_unless (info.size == size);
+  fail_unless (info.data[size - 1] == 0xaa);
+  gst_memory_unmap (copy, &info);
+  gst_memory_unref (copy);
+  gst_memory_unref (mem);
+
+  /* small allocations come from system memory */
+  mem = gst_allocator_alloc (allocator, 100, NULL);
+  fail_unless (gst_memory_is_type (mem, GST_ALLOCATOR_SYSMEM));
+  gst_memory_unref (mem);
+
+  gst_object_unref (allocator);
+
+  allocator = gst_huge_page_allocator_new (-1,
+      GST_HUGE_PAGE_ALLOCATOR_FLAG_PREFAULT);
+  mem = gst_allocator_alloc (allocator, size, NULL);
+  fail_unless (mem != NULL);
+  fail_unless (gst_memory_map (mem, &info, GST_MAP_READ));
+  fail_unless (info.data[0] == 0);
+  gst_memory_unmap (mem, &info);
+  gst_memory_unref (mem);
+  gst_object_unref (allocator);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_memfd_allocator)
+{
+  GstAllocator *allocator;
+  GstMemory *mem, *sub, *imported;
+  GstMapInfo info;
+  gsize offset, size;
+  gint fd;
+
+  allocator = gst_allocator_find (GST_ALLOCATOR_MEMFD);
+  /* not supported on this platform */
+  if (allocator == NULL)
+    return;
+
+  mem = gst_allocator_alloc (allocator, 4096, NULL);
+  fail_unless (mem != NULL);
+  fail_unless (gst_is_memfd_memory (mem));
+
+  fail_unless (gst_memory_map (mem, &info, GST_MAP_WRITE));
+  memset (info.data, 0x55, info.size);
+  gst_memory_unmap (mem, &info);
+
+  fail_unless (gst_memfd_memory_get_fd_info (mem, &fd, &offset, &size));
+  fail_unless (fd >= 0);
+  fail_unless_equals_int (size, 4096);
+
+  /* sub memory refers to a region of the same fd */
+  sub = gst_memory_share (mem, 100, 200);
+  fail_unless (gst_is_memfd_memory (sub));
+  fail_unless (gst_memfd_memory_get_fd_info (sub, &fd, &offset, &size));
+  fail_unless_equals_int (size, 200);
+  gst_memory_unref (sub);
+
+  /* import a duplicate of the fd like another process would */
+  fail_unless (gst_memfd_memory_get_fd_info (mem, &fd, &offset, &size));
+  imported = gst_memfd_memory_import (dup (fd), offset, size, GST_MAP_READ);
+  fail_unless (imported != NULL);
+  fail_unless (gst_is_memfd_memory (imported));
+  fail_unless (GST_MEMORY_IS_READONLY (imported));
+  fail_if (gst_memory_map (imported, &info, GST_MAP_WRITE));
+  fail_unless (gst_memory_map (imported, &info, GST_MAP_READ));
+  fail_unless (info.data[0] == 0x55);
+  gst_memory_unmap (imported, &info);
+  gst_memory_unref (imported);
+
+  imported = gst_memfd_memory_import (dup (fd), offset, size,
+      GST_MAP_READWRITE);
+  fail_unless (imported != NULL);
+  fail_if (GST_MEMORY_IS_READONLY (imported));
+
+  fail_unless (gst_memory_map (imported, &info, GST_MAP_READWRITE));
+  fail_unless_equals_int (info.size, 4096);
+  fail_unless (info.data[0] == 0x55);
+  fail_unless (info.data[4095] == 0x55);
+  info.data[0] = 0x66;
+  gst_memory_unmap (imported, &info);
+
+  /* both refer to the same pages */
+  fail_unless (gst_memory_map (mem, &info, GST_MAP_READ));
+  fail_unless (info.data[0] == 0x66);
+  gst_memory_unmap (mem, &info);
+
+  gst_memory_unref (imported);
+
+  /* regions outside of the file are refused, the fd stays with the caller */
+  fail_unless (gst_memfd_memory_get_fd_info (mem, &fd, &offset, &size));
+  fd = dup (fd);
+  fail_unless (gst_memfd_memory_import (fd, offset, 1 << 20,
+          GST_MAP_READ) == NULL);
+  fail_unless (gst_memfd_memory_import (fd, G_MAXSIZE, 2,
+          GST_MAP_READ) == NULL);
+  fail_unless (gst_memfd_memory_import (fd, 1, G_MAXSIZE,
+          GST_MAP_READ) == NULL);
+  fail_unless_equals_int (close (fd), 0);
+
+  gst_memory_unref (mem);
+
+  /* system memory has no fd */
+  mem = gst_allocator_alloc (NULL, 100, NULL);
+  fail_if (gst_is_memfd_memory (mem));
+  fail_if (gst_memfd_memory_get_fd_info (mem, &fd, NULL, NULL));
+  gst_memory_unref (mem);
+
+  gst_object_unref (allocator);
+}
+
+GST_END_TEST;
+
+static guint64
+get_live_bytes (GstAllocator * allocator)
+{
+  GstStructure *stats;
+  guint64 live;
+
+  stats = gst_allocator_get_stats (allocator);
+  fail_unless (stats != NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "live-bytes", &live));
+  gst_structure_free (stats);
+
+  return live;
+}
+
+GST_START_TEST (test_allocator_stats)
+{
+  GstAllocator *alloc;
+  GstMemory *mem, *sub;
+  guint64 live, total, peak;
+  GstStructure *stats;
+  gsize maxsize;
+
+  alloc = gst_allocator_find (NULL);
+  fail_unless (alloc != NULL);
+
+  /* without a budget nothing is accounted */
+  live = get_live_bytes (alloc);
+  mem = gst_allocator_alloc (alloc, 1000, NULL);
+  fail_unless_equals_uint64 (get_live_bytes (alloc), live);
+  gst_allocator_set_memory_budget (G_MAXSIZE);
+  gst_memory_unref (mem);
+  fail_unless_equals_uint64 (get_live_bytes (alloc), live);
+
+  total = get_live_bytes (NULL);
+
+  mem = gst_allocator_alloc (alloc, 1000, NULL);
+  gst_memory_get_sizes (mem, NULL, &maxsize);
+  fail_unless (maxsize >= 1000);
+  fail_unless_equals_uint64 (get_live_bytes (alloc), live + maxsize);
+  fail_unless_equals_uint64 (get_live_bytes (NULL), total + maxsize);
+
+  stats = gst_allocator_get_stats (alloc);
+  fail_unless (gst_structure_get_uint64 (stats, "peak-bytes", &peak));
+  fail_unless (peak >= live + maxsize);
+  fail_if (gst_structure_has_field (stats, "budget"));
+  gst_structure_free (stats);
+
+  /* shared memory doesn't own data */
+  sub = gst_memory_share (mem, 10, 100);
+  fail_unless_equals_uint64 (get_live_bytes (alloc), live + maxsize);
+  gst_memory_unref (sub);
+  fail_unless_equals_uint64 (get_live_bytes (alloc), live + maxsize);
+
+  /* the budget only reports, allocation keeps working */
+  fail_if (gst_allocator_memory_budget_exceeded ());
+  fail_unless_equals_uint64 (gst_allocator_get_memory_budget (), G_MAXSIZE);
+  gst_allocator_set_memory_budget (total + maxsize - 1);
+  fail_unless_equals_uint64 (gst_allocator_get_memory_budget (),
+      total + maxsize - 1);
+  fail_unless (gst_allocator_memory_budget_exceeded ());
+  sub = gst_allocator_alloc (alloc, 1000, NULL);
+  fail_unless (sub != NULL);
+  gst_memory_unref (sub);
+
+  gst_memory_unref (mem);
+  fail_if (gst_allocator_memory_budget_exceeded ());
+  fail_unless_equals_uint64 (get_live_bytes (alloc), live);
+  fail_unless_equals_uint64 (get_live_bytes (NULL), total);
+
+  gst_allocator_set_memory_budget (0);
+  fail_if (gst_allocator_memory_budget_exceeded ());
+
+  gst_object_unref (alloc);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_lock)
 {
   GstMemory *mem;
@@ -757,6 +987,9 @@ gst_memory_suite (void)
   tcase_add_test (tc_chain, test_map_resize);
   tcase_add_test (tc_chain, test_alloc_params);
   tcase_add_test (tc_chain, test_lock);
+  tcase_add_test (tc_chain, test_huge_page_allocator);
+  tcase_add_test (tc_chain, test_memfd_allocator);
+  tcase_add_test (tc_chain, test_allocator_stats);
 #ifndef GST_DISABLE_GST_DEBUG
   tcase_add_test (tc_chain, test_no_error_and_no_warning_on_map_failure);
 #endif
@@ -463,6 +463,60 @@ GST_START_TEST (test_meta_iterate)
 
 GST_END_TEST;
 
+static gboolean
+foreach_meta_remove_api (GstBuffer * buffer, GstMeta ** meta, gpointer api)
+{
+  if ((*meta)->info->api == GPOINTER_TO_SIZE (api))
+    *meta = NULL;
+
+  return TRUE;
+}
+
+GST_START_TEST (test_meta_lookup_many)
+{
+  GstBuffer *buffer;
+  GstMeta *foo, *test[12], *meta;
+  guint i;
+
+  buffer = gst_buffer_new_and_alloc (4);
+
+  /* more metas than the buffer indexes */
+  foo = (GstMeta *) GST_META_FOO_ADD (buffer);
+  for (i = 0; i < G_N_ELEMENTS (test); i++)
+    test[i] = (GstMeta *) GST_META_TEST_ADD (buffer);
+  fail_unless_equals_int (count_buffer_meta (buffer), 13);
+
+  /* the most recently added meta is found first */
+  fail_unless (gst_buffer_get_meta (buffer, GST_META_FOO_API_TYPE) == foo);
+  fail_unless (gst_buffer_get_meta (buffer,
+          GST_META_TEST_API_TYPE) == test[11]);
+
+  fail_unless (gst_buffer_remove_meta (buffer, test[11]));
+  fail_unless (gst_buffer_get_meta (buffer,
+          GST_META_TEST_API_TYPE) == test[10]);
+  fail_unless (gst_buffer_get_meta (buffer, GST_META_FOO_API_TYPE) == foo);
+
+  /* the item of a removed meta is reused */
+  meta = (GstMeta *) GST_META_TEST_ADD (buffer);
+  fail_unless (meta == test[11]);
+  fail_unless (gst_buffer_get_meta (buffer, GST_META_TEST_API_TYPE) == meta);
+
+  /* remove the first and some following metas in one go */
+  gst_buffer_foreach_meta (buffer, foreach_meta_remove_api,
+      GSIZE_TO_POINTER (GST_META_TEST_API_TYPE));
+  fail_unless_equals_int (count_buffer_meta (buffer), 1);
+  fail_unless (gst_buffer_get_meta (buffer, GST_META_TEST_API_TYPE) == NULL);
+  fail_unless (gst_buffer_get_meta (buffer, GST_META_FOO_API_TYPE) == foo);
+
+  fail_unless (gst_buffer_remove_meta (buffer, foo));
+  fail_unless (gst_buffer_get_meta (buffer, GST_META_FOO_API_TYPE) == NULL);
+  fail_unless_equals_int (count_buffer_meta (buffer), 0);
+
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_buffermeta_suite (void)
 {
@@ -474,6 +528,7 @@ gst_buffermeta_suite (void)
   tcase_add_test (tc_chain, test_meta_locked);
   tcase_add_test (tc_chain, test_meta_foreach_remove_one);
   tcase_add_test (tc_chain, test_meta_iterate);
+  tcase_add_test (tc_chain, test_meta_lookup_many);
 
   return s;
 }
@@ -1463,6 +1463,326 @@ GST_START_TEST (test_pad_blocking_with_probe_type_idle)
 
 GST_END_TEST;
 
+static guint idle_probe_count;
+
+static GstPadProbeReturn
+idle_probe_count_cb (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  idle_probe_count++;
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (test_pad_probe_idle_count)
+{
+  GstPad *srcpad, *sinkpad;
+  gulong id;
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, idletest_sink_pad_chain);
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_pad_set_active (srcpad, TRUE);
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_stream_start ("test")));
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_segment (&dummy_segment)));
+
+  /* called right away on an idle pad */
+  idle_probe_running = FALSE;
+  idle_probe_count = 0;
+  id = gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_IDLE,
+      idle_probe_count_cb, NULL, NULL);
+  fail_unless_equals_int (idle_probe_count, 1);
+
+  /* and once more after each push */
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+      GST_FLOW_OK);
+  fail_unless_equals_int (idle_probe_count, 2);
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+      GST_FLOW_OK);
+  fail_unless_equals_int (idle_probe_count, 3);
+
+  /* pushes without probes don't call anything */
+  gst_pad_remove_probe (srcpad, id);
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+      GST_FLOW_OK);
+  fail_unless_equals_int (idle_probe_count, 3);
+
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+}
+
+GST_END_TEST;
+
+#define PROBE_PUSH_BUFFERS 20000
+
+static gint probe_push_chained;
+static gint probe_push_probed;
+
+static GstFlowReturn
+probe_push_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  g_atomic_int_inc (&probe_push_chained);
+  gst_buffer_unref (buf);
+  return GST_FLOW_OK;
+}
+
+static GstPadProbeReturn
+probe_push_count (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  g_atomic_int_inc (&probe_push_probed);
+  return GST_PAD_PROBE_OK;
+}
+
+static gpointer
+push_buffers_async (GstPad * pad)
+{
+  gint i;
+
+  for (i = 0; i < PROBE_PUSH_BUFFERS; i++)
+    fail_unless_equals_int (gst_pad_push (pad, gst_buffer_new ()),
+        GST_FLOW_OK);
+
+  return NULL;
+}
+
+/* probes come and go while buffers are pushed, no buffer may get lost and a
+ * probe must see the buffers pushed while it is installed */
+GST_START_TEST (test_pad_probe_add_remove_while_pushing)
+{
+  GstPad *srcpad, *sinkpad;
+  GThread *thread;
+  gulong id;
+  gint probed;
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, probe_push_chain);
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_pad_set_active (srcpad, TRUE);
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_stream_start ("test")) == TRUE);
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_segment (&dummy_segment)) == TRUE);
+
+  probe_push_chained = 0;
+  probe_push_probed = 0;
+  thread = g_thread_try_new ("gst-check", (GThreadFunc) push_buffers_async,
+      srcpad, NULL);
+
+  while (g_atomic_int_get (&probe_push_chained) < PROBE_PUSH_BUFFERS / 2) {
+    probed = g_atomic_int_get (&probe_push_probed);
+    id = gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER,
+        probe_push_count, NULL, NULL);
+    /* wait until a push went through the probe */
+    while (g_atomic_int_get (&probe_push_probed) == probed &&
+        g_atomic_int_get (&probe_push_chained) < PROBE_PUSH_BUFFERS)
+      g_thread_yield ();
+    gst_pad_remove_probe (srcpad, id);
+  }
+
+  g_thread_join (thread);
+  fail_unless_equals_int (probe_push_chained, PROBE_PUSH_BUFFERS);
+
+  /* a probe added when nothing is pushed sees the next buffer */
+  probed = probe_push_probed;
+  id = gst_pad_add_probe (srcpad, GST_PAD_PROBE_TYPE_BUFFER,
+      probe_push_count, NULL, NULL);
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+      GST_FLOW_OK);
+  fail_unless_equals_int (probe_push_probed, probed + 1);
+  gst_pad_remove_probe (srcpad, id);
+
+  /* and the removed probe doesn't see the next one */
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+      GST_FLOW_OK);
+  fail_unless_equals_int (probe_push_probed, probed + 1);
+
+  /* unlinking stops the direct pushes too */
+  fail_unless (gst_pad_unlink (srcpad, sinkpad));
+  fail_unless_equals_int (gst_pad_push (srcpad, gst_buffer_new ()),
+      GST_FLOW_NOT_LINKED);
+  fail_unless_equals_int (probe_push_chained, PROBE_PUSH_BUFFERS + 2);
+
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+}
+
+GST_END_TEST;
+
+static guint batch_buffers;
+static guint batch_lists;
+
+static GstFlowReturn
+batch_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  batch_buffers++;
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+static GstFlowReturn
+batch_chain_list (GstPad * pad, GstObject * parent, GstBufferList * list)
+{
+  batch_lists++;
+  batch_buffers += gst_buffer_list_length (list);
+  gst_buffer_list_unref (list);
+  return GST_FLOW_OK;
+}
+
+static GstBuffer *
+batch_buffer (GstClockTime pts)
+{
+  GstBuffer *buffer = gst_buffer_new ();
+
+  GST_BUFFER_PTS (buffer) = pts;
+  return buffer;
+}
+
+GST_START_TEST (test_push_batching)
+{
+  GstPad *srcpad, *sinkpad;
+  GstClockTime latency;
+  guint i, max;
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, batch_chain);
+  gst_pad_set_chain_list_function (sinkpad, batch_chain_list);
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_pad_set_active (srcpad, TRUE);
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_stream_start ("test")));
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_segment (&dummy_segment)));
+
+  gst_pad_set_batching (srcpad, 4, GST_CLOCK_TIME_NONE);
+  gst_pad_get_batching (srcpad, &max, &latency);
+  fail_unless_equals_int (max, 4);
+  fail_unless (latency == GST_CLOCK_TIME_NONE);
+
+  /* full batches are pushed as lists */
+  batch_buffers = batch_lists = 0;
+  for (i = 0; i < 10; i++)
+    fail_unless_equals_int (gst_pad_push (srcpad, batch_buffer (i)),
+        GST_FLOW_OK);
+  fail_unless_equals_int (batch_lists, 2);
+  fail_unless_equals_int (batch_buffers, 8);
+
+  /* a serialized event pushes the rest first */
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_gap (0, 0)));
+  fail_unless_equals_int (batch_lists, 3);
+  fail_unless_equals_int (batch_buffers, 10);
+
+  /* the timestamps of a batch span at most the latency */
+  gst_pad_set_batching (srcpad, 100, 10 * GST_MSECOND);
+  batch_buffers = batch_lists = 0;
+  for (i = 0; i < 3; i++)
+    fail_unless_equals_int (gst_pad_push (srcpad,
+            batch_buffer (i * 5 * GST_MSECOND)), GST_FLOW_OK);
+  fail_unless_equals_int (batch_lists, 1);
+  fail_unless_equals_int (batch_buffers, 3);
+
+  /* a buffer without timestamp completes the batch */
+  fail_unless_equals_int (gst_pad_push (srcpad, batch_buffer (0)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (batch_lists, 1);
+  fail_unless_equals_int (gst_pad_push (srcpad,
+          batch_buffer (GST_CLOCK_TIME_NONE)), GST_FLOW_OK);
+  fail_unless_equals_int (batch_lists, 2);
+  fail_unless_equals_int (batch_buffers, 5);
+
+  /* a flush drops the collected buffers */
+  fail_unless_equals_int (gst_pad_push (srcpad, batch_buffer (0)),
+      GST_FLOW_OK);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_flush_start ()));
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_flush_stop (TRUE)));
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_segment (&dummy_segment)));
+  fail_unless_equals_int (batch_buffers, 5);
+
+  /* disabled, buffers go straight to the chain function */
+  fail_unless_equals_int (gst_pad_push (srcpad, batch_buffer (0)),
+      GST_FLOW_OK);
+  gst_pad_set_batching (srcpad, 0, GST_CLOCK_TIME_NONE);
+  fail_unless_equals_int (gst_pad_push (srcpad, batch_buffer (0)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (batch_lists, 3);
+  fail_unless_equals_int (batch_buffers, 7);
+  fail_unless_equals_int (gst_pad_push (srcpad, batch_buffer (0)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (batch_lists, 3);
+  fail_unless_equals_int (batch_buffers, 8);
+
+  /* errors are returned right away */
+  gst_pad_set_batching (srcpad, 4, GST_CLOCK_TIME_NONE);
+  gst_pad_unlink (srcpad, sinkpad);
+  fail_unless_equals_int (gst_pad_push (srcpad, batch_buffer (0)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (gst_pad_push_list (srcpad, gst_buffer_list_new ()),
+      GST_FLOW_NOT_LINKED);
+  fail_unless_equals_int (gst_pad_push (srcpad, batch_buffer (0)),
+      GST_FLOW_NOT_LINKED);
+
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_push_batching_flushing_eos)
+{
+  GstPad *srcpad, *sinkpad;
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, batch_chain);
+  gst_pad_set_chain_list_function (sinkpad, batch_chain_list);
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_pad_set_active (srcpad, TRUE);
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_stream_start ("test")));
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_segment (&dummy_segment)));
+  gst_pad_set_batching (srcpad, 4, GST_CLOCK_TIME_NONE);
+  batch_buffers = batch_lists = 0;
+
+  /* pushing while flushing is refused instead of collected */
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_flush_start ()));
+  fail_unless_equals_int (gst_pad_get_last_flow_return (srcpad),
+      GST_FLOW_FLUSHING);
+  fail_unless_equals_int (gst_pad_push (srcpad, batch_buffer (0)),
+      GST_FLOW_FLUSHING);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_flush_stop (TRUE)));
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_segment (&dummy_segment)));
+  fail_unless_equals_int (gst_pad_get_last_flow_return (srcpad), GST_FLOW_OK);
+
+  /* the first buffers after the flush form a new batch */
+  fail_unless_equals_int (gst_pad_push (srcpad, batch_buffer (0)),
+      GST_FLOW_OK);
+  fail_unless_equals_int (batch_buffers, 0);
+
+  /* EOS pushes the collected buffers, later pushes are refused */
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_eos ()));
+  fail_unless_equals_int (batch_lists, 1);
+  fail_unless_equals_int (batch_buffers, 1);
+  fail_unless_equals_int (gst_pad_push (srcpad, batch_buffer (0)),
+      GST_FLOW_EOS);
+  fail_unless_equals_int (gst_pad_get_last_flow_return (srcpad), GST_FLOW_EOS);
+  fail_unless_equals_int (batch_buffers, 1);
+
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+}
+
+GST_END_TEST;
+
 static gboolean pull_probe_called;
 static gboolean pull_probe_called_with_bad_type;
 static gboolean pull_probe_called_with_bad_data;
@@ -1730,6 +2050,175 @@ GST_START_TEST (test_pad_probe_remove)
 
 GST_END_TEST;
 
+static GstPadProbeReturn
+probe_count_cb (GstPad * pad, GstPadProbeInfo * info, gint * count)
+{
+  *count += 1;
+  return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+probe_remove_other_cb (GstPad * pad, GstPadProbeInfo * info, gulong * id)
+{
+  if (*id != 0) {
+    gst_pad_remove_probe (pad, *id);
+    *id = 0;
+  }
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (test_pad_probe_dispatch_types)
+{
+  GstPad *pad;
+  gint buffers = 0, events = 0, removed = 0, added = 0;
+  gulong removed_id;
+
+  pad = gst_pad_new ("src", GST_PAD_SRC);
+  fail_unless (pad != NULL);
+  gst_pad_set_active (pad, TRUE);
+
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) probe_count_cb, &buffers, NULL);
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+      (GstPadProbeCallback) probe_count_cb, &events, NULL);
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) probe_remove_other_cb, &removed_id, NULL);
+  removed_id = gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) probe_count_cb, &removed, NULL);
+  fail_unless_equals_int (pad->num_probes, 4);
+
+  /* only the probes for the type are called */
+  gst_pad_push_event (pad, gst_event_new_stream_start ("test"));
+  fail_unless_equals_int (events, 1);
+  fail_unless_equals_int (buffers, 0);
+
+  /* a probe removed by an earlier probe of the same dispatch is not called */
+  gst_pad_push (pad, gst_buffer_new ());
+  fail_unless_equals_int (buffers, 1);
+  fail_unless_equals_int (removed, 0);
+  fail_unless_equals_int (events, 1);
+  fail_unless_equals_int (pad->num_probes, 3);
+
+  /* probes added later are called for the next items */
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER,
+      (GstPadProbeCallback) probe_count_cb, &added, NULL);
+  gst_pad_push (pad, gst_buffer_new ());
+  fail_unless_equals_int (buffers, 2);
+  fail_unless_equals_int (added, 1);
+  fail_unless_equals_int (removed, 0);
+
+  gst_object_unref (pad);
+}
+
+GST_END_TEST;
+
+static gint caps_queries;
+
+static gboolean
+count_caps_query_func (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) == GST_QUERY_CAPS)
+    caps_queries++;
+  return gst_pad_query_default (pad, parent, query);
+}
+
+GST_START_TEST (test_pad_caps_query_cache)
+{
+  GstPad *pad;
+  GstCaps *caps, *filter;
+
+  pad = gst_pad_new ("sink", GST_PAD_SINK);
+  fail_unless (pad != NULL);
+  gst_pad_set_query_function (pad, count_caps_query_func);
+  caps_queries = 0;
+
+  /* not cached by default */
+  gst_caps_unref (gst_pad_query_caps (pad, NULL));
+  gst_caps_unref (gst_pad_query_caps (pad, NULL));
+  fail_unless_equals_int (caps_queries, 2);
+
+  GST_PAD_SET_CACHE_CAPS (pad);
+  caps = gst_pad_query_caps (pad, NULL);
+  gst_caps_unref (gst_pad_query_caps (pad, NULL));
+  fail_unless_equals_int (caps_queries, 3);
+
+  /* the result is the same */
+  fail_unless (gst_caps_is_any (caps));
+  gst_caps_unref (caps);
+
+  /* a different filter is a different entry, an equal one hits it */
+  filter = gst_caps_from_string ("foo/bar");
+  caps = gst_pad_query_caps (pad, filter);
+  fail_unless_equals_int (caps_queries, 4);
+  gst_caps_unref (caps);
+  gst_caps_unref (filter);
+  filter = gst_caps_from_string ("foo/bar");
+  caps = gst_pad_query_caps (pad, filter);
+  fail_unless_equals_int (caps_queries, 4);
+  fail_unless (gst_caps_is_equal (caps, filter));
+  gst_caps_unref (caps);
+  gst_caps_unref (filter);
+
+  /* reconfiguration invalidates the results */
+  gst_pad_mark_reconfigure (pad);
+  gst_caps_unref (gst_pad_query_caps (pad, NULL));
+  fail_unless_equals_int (caps_queries, 5);
+  gst_caps_unref (gst_pad_query_caps (pad, NULL));
+  fail_unless_equals_int (caps_queries, 5);
+
+  GST_PAD_UNSET_CACHE_CAPS (pad);
+  gst_caps_unref (gst_pad_query_caps (pad, NULL));
+  fail_unless_equals_int (caps_queries, 6);
+
+  gst_object_unref (pad);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_pad_caps_query_cache_scope)
+{
+  GstElement *pipe1, *pipe2;
+  GstPad *pad1, *pad2, *loose;
+
+  pipe1 = gst_pipeline_new (NULL);
+  pipe2 = gst_pipeline_new (NULL);
+  pad1 = gst_pad_new ("sink1", GST_PAD_SINK);
+  pad2 = gst_pad_new ("sink2", GST_PAD_SINK);
+  loose = gst_pad_new ("sink", GST_PAD_SINK);
+  fail_unless (gst_element_add_pad (pipe1, pad1));
+  fail_unless (gst_element_add_pad (pipe2, pad2));
+  gst_pad_set_query_function (pad1, count_caps_query_func);
+  GST_PAD_SET_CACHE_CAPS (pad1);
+  caps_queries = 0;
+
+  gst_caps_unref (gst_pad_query_caps (pad1, NULL));
+  gst_caps_unref (gst_pad_query_caps (pad1, NULL));
+  fail_unless_equals_int (caps_queries, 1);
+
+  /* changes in another pipeline don't affect the cache */
+  gst_pad_mark_reconfigure (pad2);
+  gst_caps_unref (gst_pad_query_caps (pad1, NULL));
+  fail_unless_equals_int (caps_queries, 1);
+
+  /* changes in the same pipeline do */
+  gst_pad_mark_reconfigure (pad1);
+  gst_caps_unref (gst_pad_query_caps (pad1, NULL));
+  fail_unless_equals_int (caps_queries, 2);
+
+  /* and changes on pads outside of any bin affect all caches */
+  gst_pad_mark_reconfigure (loose);
+  gst_caps_unref (gst_pad_query_caps (pad1, NULL));
+  fail_unless_equals_int (caps_queries, 3);
+  gst_caps_unref (gst_pad_query_caps (pad1, NULL));
+  fail_unless_equals_int (caps_queries, 3);
+
+  gst_object_unref (loose);
+  gst_object_unref (pipe2);
+  gst_object_unref (pipe1);
+}
+
+GST_END_TEST;
+
 typedef struct
 {
   gulong probe_id;
@@ -2602,6 +3091,126 @@ GST_START_TEST (test_sticky_events)
 
 GST_END_TEST;
 
+static const GstEventType sticky_order[] = {
+  GST_EVENT_STREAM_START, GST_EVENT_CAPS, GST_EVENT_SEGMENT, GST_EVENT_TAG,
+  GST_EVENT_TAG, GST_EVENT_BUFFERSIZE, GST_EVENT_CUSTOM_DOWNSTREAM_STICKY,
+  GST_EVENT_CUSTOM_DOWNSTREAM_STICKY, GST_EVENT_EOS
+};
+
+static GArray *sticky_types;
+
+static gboolean
+collect_sticky_type (GstPad * pad, GstEvent ** event, gpointer user_data)
+{
+  GstEventType type = GST_EVENT_TYPE (*event);
+
+  g_array_append_val (sticky_types, type);
+  return TRUE;
+}
+
+static gboolean
+sticky_order_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstEventType type = GST_EVENT_TYPE (event);
+
+  g_array_append_val (sticky_types, type);
+  gst_event_unref (event);
+  return TRUE;
+}
+
+static void
+check_sticky_types (guint n_types)
+{
+  guint i;
+
+  fail_unless_equals_int (sticky_types->len, n_types);
+  for (i = 0; i < n_types; i++)
+    fail_unless_equals_int (g_array_index (sticky_types, GstEventType, i),
+        sticky_order[i]);
+  g_array_set_size (sticky_types, 0);
+}
+
+static GstEvent *
+new_custom_sticky (const gchar * name)
+{
+  return gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM_STICKY,
+      gst_structure_new_empty (name));
+}
+
+/* sticky events are stored and pushed in the order of their type, events
+ * with the same type but a different name are all kept */
+GST_START_TEST (test_sticky_events_order)
+{
+  GstPad *srcpad, *sinkpad;
+  GstTagList *tags;
+  GstSegment seg;
+  GstEvent *event;
+  GstCaps *caps;
+
+  sticky_types = g_array_new (FALSE, FALSE, sizeof (GstEventType));
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  gst_pad_set_active (srcpad, TRUE);
+
+  /* push them out of order where that is allowed */
+  fail_unless (gst_pad_push_event (srcpad, new_custom_sticky ("b")));
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_stream_start ("test")));
+  caps = gst_caps_new_empty_simple ("foo/bar");
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_caps (caps)));
+  gst_caps_unref (caps);
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_buffer_size (GST_FORMAT_BYTES, 0, 100, FALSE)));
+  gst_segment_init (&seg, GST_FORMAT_TIME);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_segment (&seg)));
+  fail_unless (gst_pad_push_event (srcpad,
+          gst_event_new_tag (gst_tag_list_new_empty ())));
+  tags = gst_tag_list_new_empty ();
+  gst_tag_list_set_scope (tags, GST_TAG_SCOPE_GLOBAL);
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_tag (tags)));
+  fail_unless (gst_pad_push_event (srcpad, new_custom_sticky ("a")));
+  /* replaces the first one */
+  fail_unless (gst_pad_push_event (srcpad, new_custom_sticky ("b")));
+
+  gst_pad_sticky_events_foreach (srcpad, collect_sticky_type, NULL);
+  check_sticky_types (8);
+
+  fail_unless (gst_pad_get_sticky_event (srcpad, GST_EVENT_CAPS, 1) == NULL);
+  event = gst_pad_get_sticky_event (srcpad, GST_EVENT_TAG, 1);
+  fail_unless (event != NULL);
+  gst_event_unref (event);
+  fail_unless (gst_pad_get_sticky_event (srcpad, GST_EVENT_TAG, 2) == NULL);
+  event =
+      gst_pad_get_sticky_event (srcpad, GST_EVENT_CUSTOM_DOWNSTREAM_STICKY, 1);
+  fail_unless (gst_event_has_name (event, "a"));
+  gst_event_unref (event);
+
+  /* linking sends all of them with the next buffer, in order */
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_event_function (sinkpad, sticky_order_event);
+  gst_pad_set_chain_function (sinkpad, test_sticky_chain);
+  gst_pad_set_active (sinkpad, TRUE);
+  fail_unless (gst_pad_link (srcpad, sinkpad) == GST_PAD_LINK_OK);
+  fail_unless_equals_int (sticky_types->len, 0);
+
+  fail_unless (gst_pad_push (srcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  check_sticky_types (8);
+  fail_unless (gst_pad_push (srcpad, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (sticky_types->len, 0);
+
+  /* EOS is always the last one */
+  fail_unless (gst_pad_push_event (srcpad, gst_event_new_eos ()));
+  g_array_set_size (sticky_types, 0);
+  gst_pad_sticky_events_foreach (srcpad, collect_sticky_type, NULL);
+  check_sticky_types (9);
+
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+  g_array_unref (sticky_types);
+}
+
+GST_END_TEST;
+
 static GstFlowReturn next_return;
 
 static GstFlowReturn
@@ -3304,6 +3913,8 @@ gst_pad_suite (void)
   tcase_add_test (tc_chain, test_push_linked);
   tcase_add_test (tc_chain, test_push_linked_flushing);
   tcase_add_test (tc_chain, test_push_buffer_list_compat);
+  tcase_add_test (tc_chain, test_push_batching);
+  tcase_add_test (tc_chain, test_push_batching_flushing_eos);
   tcase_add_test (tc_chain, test_flowreturn);
   tcase_add_test (tc_chain, test_push_negotiation);
   tcase_add_test (tc_chain, test_src_unref_unlink);
@@ -3312,10 +3923,15 @@ gst_pad_suite (void)
   tcase_add_test (tc_chain, test_pad_blocking_with_probe_type_block);
   tcase_add_test (tc_chain, test_pad_blocking_with_probe_type_blocking);
   tcase_add_test (tc_chain, test_pad_blocking_with_probe_type_idle);
+  tcase_add_test (tc_chain, test_pad_probe_idle_count);
+  tcase_add_test (tc_chain, test_pad_probe_add_remove_while_pushing);
   tcase_add_test (tc_chain, test_pad_probe_pull);
   tcase_add_test (tc_chain, test_pad_probe_pull_idle);
   tcase_add_test (tc_chain, test_pad_probe_pull_buffer);
   tcase_add_test (tc_chain, test_pad_probe_remove);
+  tcase_add_test (tc_chain, test_pad_probe_dispatch_types);
+  tcase_add_test (tc_chain, test_pad_caps_query_cache);
+  tcase_add_test (tc_chain, test_pad_caps_query_cache_scope);
   tcase_add_test (tc_chain, test_pad_probe_block_add_remove);
   tcase_add_test (tc_chain, test_pad_probe_block_and_drop_buffer);
   tcase_add_test (tc_chain, test_pad_probe_flush_events);
@@ -3332,6 +3948,7 @@ gst_pad_suite (void)
   tcase_add_test (tc_chain, test_block_async_full_destroy_dispose);
   tcase_add_test (tc_chain, test_block_async_replace_callback_no_flush);
   tcase_add_test (tc_chain, test_sticky_events);
+  tcase_add_test (tc_chain, test_sticky_events_order);
   tcase_add_test (tc_chain, test_last_flow_return_push);
   tcase_add_test (tc_chain, test_last_flow_return_pull);
   tcase_add_test (tc_chain, test_flush_stop_inactive);
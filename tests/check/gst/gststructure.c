@@ -218,6 +218,85 @@ GST_START_TEST (test_from_string)
 
 GST_END_TEST;
 
+/* the common values are built directly, check that they come out the same
+ * as what the deserializers make of them */
+GST_START_TEST (test_from_string_values)
+{
+  GstStructure *structure;
+  const GValue *val;
+  const gchar *end;
+  GString *long_string;
+  gint num, den, v;
+  gdouble d;
+  guint i;
+
+  structure = gst_structure_from_string ("test, a=5, b=-7, c=010, d=0x10, "
+      "e=1.5, f=30/1, g=05/1, h=1/-2, i=(int)010, j=(fraction)25, k=max, "
+      "l=(int)max, m=F32LE, n=video/x-raw, o=NULL, p=true, q=de-1, "
+      "r=\"42\", s=(string)7, t=3/0", NULL);
+  fail_unless (structure != NULL);
+
+  fail_unless (gst_structure_get_int (structure, "a", &v));
+  fail_unless_equals_int (v, 5);
+  fail_unless (gst_structure_get_int (structure, "b", &v));
+  fail_unless_equals_int (v, -7);
+  /* octal and hex integers */
+  fail_unless (gst_structure_get_int (structure, "c", &v));
+  fail_unless_equals_int (v, 8);
+  fail_unless (gst_structure_get_int (structure, "d", &v));
+  fail_unless_equals_int (v, 16);
+  fail_unless (gst_structure_get_double (structure, "e", &d));
+  fail_unless (d == 1.5);
+  fail_unless (gst_structure_get_fraction (structure, "f", &num, &den));
+  fail_unless (num == 30 && den == 1);
+  fail_unless (gst_structure_get_fraction (structure, "g", &num, &den));
+  fail_unless (num == 5 && den == 1);
+  fail_unless (gst_structure_get_fraction (structure, "h", &num, &den));
+  fail_unless (num == -1 && den == 2);
+  fail_unless (gst_structure_get_int (structure, "i", &v));
+  fail_unless_equals_int (v, 8);
+  fail_unless (gst_structure_get_fraction (structure, "j", &num, &den));
+  fail_unless (num == 25 && den == 1);
+  /* named constants */
+  fail_unless (gst_structure_get_int (structure, "k", &v));
+  fail_unless_equals_int (v, G_MAXINT);
+  fail_unless (gst_structure_get_int (structure, "l", &v));
+  fail_unless_equals_int (v, G_MAXINT);
+  fail_unless_equals_string (gst_structure_get_string (structure, "m"),
+      "F32LE");
+  fail_unless_equals_string (gst_structure_get_string (structure, "n"),
+      "video/x-raw");
+  val = gst_structure_get_value (structure, "o");
+  fail_unless (G_VALUE_HOLDS_STRING (val));
+  fail_unless (g_value_get_string (val) == NULL);
+  val = gst_structure_get_value (structure, "p");
+  fail_unless (G_VALUE_HOLDS_BOOLEAN (val));
+  val = gst_structure_get_value (structure, "q");
+  fail_unless (GST_VALUE_HOLDS_FLAG_SET (val));
+  fail_unless (gst_structure_get_int (structure, "r", &v));
+  fail_unless_equals_int (v, 42);
+  fail_unless_equals_string (gst_structure_get_string (structure, "s"), "7");
+  fail_unless_equals_string (gst_structure_get_string (structure, "t"), "3/0");
+  gst_structure_free (structure);
+
+  /* strings too long to be parsed on the stack */
+  long_string = g_string_new ("test");
+  for (i = 0; i < 200; i++)
+    g_string_append_printf (long_string, ", field%u=%u", i, i);
+  g_string_append (long_string, "; rest");
+  structure = gst_structure_from_string (long_string->str, (gchar **) & end);
+  fail_unless (structure != NULL);
+  fail_unless_equals_int (gst_structure_n_fields (structure), 200);
+  fail_unless (gst_structure_get_int (structure, "field199", &v));
+  fail_unless_equals_int (v, 199);
+  fail_unless_equals_string (end, "; rest");
+  gst_structure_free (structure);
+  g_string_free (long_string, TRUE);
+}
+
+GST_END_TEST;
+
+
 
 GST_START_TEST (test_to_string)
 {
@@ -870,6 +949,187 @@ GST_START_TEST (test_flagset)
 
 GST_END_TEST;
 
+static gboolean
+remove_every_third_func (GQuark field_id, GValue * value, gpointer user_data)
+{
+  return g_value_get_int (value) % 3 != 0;
+}
+
+GST_START_TEST (test_many_fields)
+{
+  GstStructure *s, *s2;
+  gchar *names[64], *str, *str2;
+  guint i, pos;
+  gint val;
+
+  /* create the names first so that the quarks are ordered differently from
+   * the fields */
+  for (i = 0; i < 64; i++)
+    names[i] = g_strdup_printf ("field-%02u", i);
+  for (i = 0; i < 64; i++)
+    g_quark_from_string (names[i]);
+
+  s = gst_structure_new_empty ("test");
+  for (i = 0; i < 64; i++) {
+    pos = (i * 37) % 64;
+    gst_structure_set (s, names[pos], G_TYPE_INT, pos, NULL);
+  }
+  fail_unless_equals_int (gst_structure_n_fields (s), 64);
+
+  /* fields stay in the order in which they were added */
+  for (i = 0; i < 64; i++) {
+    pos = (i * 37) % 64;
+    fail_unless_equals_string (gst_structure_nth_field_name (s, i),
+        names[pos]);
+    fail_unless (gst_structure_get_int (s, names[i], &val));
+    fail_unless_equals_int (val, i);
+  }
+  fail_if (gst_structure_has_field (s, "field-64"));
+
+  /* replacing a value doesn't add a field */
+  gst_structure_set (s, names[10], G_TYPE_INT, 10, NULL);
+  fail_unless_equals_int (gst_structure_n_fields (s), 64);
+
+  s2 = gst_structure_copy (s);
+  fail_unless (gst_structure_is_equal (s, s2));
+  str = gst_structure_to_string (s);
+  str2 = gst_structure_to_string (s2);
+  fail_unless_equals_string (str, str2);
+  g_free (str);
+  g_free (str2);
+  gst_structure_free (s2);
+
+  gst_structure_filter_and_map_in_place (s, remove_every_third_func, NULL);
+  fail_unless_equals_int (gst_structure_n_fields (s), 42);
+  for (i = 0; i < 64; i++) {
+    fail_unless (gst_structure_get_int (s, names[i], &val) == (i % 3 != 0));
+    if (i % 3 != 0)
+      fail_unless_equals_int (val, i);
+  }
+
+  /* down to a few fields, and back up */
+  for (i = 0; i < 60; i++)
+    gst_structure_remove_field (s, names[i]);
+  fail_unless_equals_int (gst_structure_n_fields (s), 2);
+  fail_unless (gst_structure_has_field (s, names[61]));
+  fail_unless (gst_structure_has_field (s, names[62]));
+  for (i = 0; i < 60; i++)
+    gst_structure_set (s, names[i], G_TYPE_INT, i, NULL);
+  fail_unless_equals_int (gst_structure_n_fields (s), 62);
+  fail_unless_equals_string (gst_structure_nth_field_name (s, 2), names[0]);
+  for (i = 0; i < 64; i++) {
+    fail_unless (gst_structure_has_field (s, names[i]) ==
+        (i != 60 && i != 63));
+  }
+
+  gst_structure_remove_all_fields (s);
+  fail_unless_equals_int (gst_structure_n_fields (s), 0);
+  fail_if (gst_structure_has_field (s, names[0]));
+  gst_structure_free (s);
+
+  for (i = 0; i < 64; i++)
+    g_free (names[i]);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_binary)
+{
+  GstStructure *s, *s2, *inner;
+  GValue list = G_VALUE_INIT, array = G_VALUE_INIT, v = G_VALUE_INIT;
+  GstCaps *caps;
+  GByteArray *bytes;
+  GstAllocationParams params;
+  GDate *date;
+  gsize consumed, len;
+  guint8 byte;
+
+  inner = gst_structure_new ("inner", "x", G_TYPE_INT, 1, NULL);
+  caps = gst_caps_from_string ("video/x-raw(memory:SystemMemory), width=1");
+  date = g_date_new_dmy (1, G_DATE_JANUARY, 2017);
+
+  s = gst_structure_new ("test",
+      "i", G_TYPE_INT, -5, "u", G_TYPE_UINT, 7,
+      "i64", G_TYPE_INT64, G_GINT64_CONSTANT (-1234567890123),
+      "u64", G_TYPE_UINT64, G_MAXUINT64, "b", G_TYPE_BOOLEAN, TRUE,
+      "d", G_TYPE_DOUBLE, -0.5, "f", G_TYPE_FLOAT, 1.5f,
+      "s", G_TYPE_STRING, "hello world", "null", G_TYPE_STRING, NULL,
+      "fr", GST_TYPE_FRACTION, 30000, 1001,
+      "ir", GST_TYPE_INT_RANGE, -2, 10,
+      "i64r", GST_TYPE_INT64_RANGE, G_MININT64, G_MAXINT64,
+      "dr", GST_TYPE_DOUBLE_RANGE, 0.5, 1.5,
+      "frr", GST_TYPE_FRACTION_RANGE, 1, 2, 3, 1,
+      "bm", GST_TYPE_BITMASK, (guint64) 0xff00,
+      "fs", GST_TYPE_FLAG_SET, 0x3, 0xf,
+      "fmt", GST_TYPE_FORMAT, GST_FORMAT_TIME,
+      "sf", GST_TYPE_SEEK_FLAGS, GST_SEEK_FLAG_FLUSH | GST_SEEK_FLAG_KEY_UNIT,
+      "st", GST_TYPE_STRUCTURE, inner, "c", GST_TYPE_CAPS, caps,
+      "date", G_TYPE_DATE, date, NULL);
+
+  g_value_init (&list, GST_TYPE_LIST);
+  g_value_init (&array, GST_TYPE_ARRAY);
+  g_value_init (&v, G_TYPE_STRING);
+  g_value_set_string (&v, "a");
+  gst_value_array_append_value (&array, &v);
+  g_value_set_string (&v, "b");
+  gst_value_array_append_value (&array, &v);
+  g_value_unset (&v);
+  gst_value_list_append_value (&list, &array);
+  g_value_init (&v, G_TYPE_INT);
+  g_value_set_int (&v, 3);
+  gst_value_list_append_value (&list, &v);
+  g_value_unset (&v);
+  gst_structure_take_value (s, "l", &list);
+  g_value_unset (&array);
+
+  bytes = g_byte_array_new ();
+  /* something in front of it */
+  byte = 0x42;
+  g_byte_array_append (bytes, &byte, 1);
+  fail_unless (gst_structure_to_binary (s, bytes));
+  len = bytes->len - 1;
+  fail_unless (gst_structure_to_binary (inner, bytes));
+
+  s2 = gst_structure_from_binary (bytes->data + 1, bytes->len - 1, &consumed);
+  fail_unless (s2 != NULL);
+  fail_unless_equals_int (consumed, len);
+  fail_unless (gst_structure_is_equal (s, s2));
+  gst_structure_free (s2);
+
+  s2 = gst_structure_from_binary (bytes->data + 1 + len,
+      bytes->len - 1 - len, &consumed);
+  fail_unless (s2 != NULL);
+  fail_unless_equals_int (consumed, bytes->len - 1 - len);
+  fail_unless (gst_structure_is_equal (inner, s2));
+  gst_structure_free (s2);
+
+  /* anything that is cut short is rejected */
+  for (consumed = 0; consumed < len; consumed++)
+    fail_unless (gst_structure_from_binary (bytes->data + 1, consumed,
+            NULL) == NULL);
+
+  /* as are other versions, and structures read as caps */
+  bytes->data[1]++;
+  fail_unless (gst_structure_from_binary (bytes->data + 1, len, NULL) == NULL);
+  bytes->data[1]--;
+  fail_unless (gst_caps_from_binary (bytes->data + 1, len, NULL) == NULL);
+
+  /* values that have no serialization can't be written */
+  g_byte_array_set_size (bytes, 0);
+  gst_allocation_params_init (&params);
+  gst_structure_set (s, "p", GST_TYPE_ALLOCATION_PARAMS, &params, NULL);
+  fail_if (gst_structure_to_binary (s, bytes));
+  fail_unless_equals_int (bytes->len, 0);
+
+  g_byte_array_unref (bytes);
+  gst_structure_free (s);
+  gst_structure_free (inner);
+  gst_caps_unref (caps);
+  g_date_free (date);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_structure_suite (void)
 {
@@ -880,6 +1140,7 @@ gst_structure_suite (void)
   tcase_add_test (tc_chain, test_from_string_int);
   tcase_add_test (tc_chain, test_from_string_uint);
   tcase_add_test (tc_chain, test_from_string);
+  tcase_add_test (tc_chain, test_from_string_values);
   tcase_add_test (tc_chain, test_to_string);
   tcase_add_test (tc_chain, test_to_from_string);
   tcase_add_test (tc_chain, test_to_from_string_tag_event);
@@ -900,6 +1161,8 @@ gst_structure_suite (void)
   tcase_add_test (tc_chain, test_map_in_place);
   tcase_add_test (tc_chain, test_filter_and_map_in_place);
   tcase_add_test (tc_chain, test_flagset);
+  tcase_add_test (tc_chain, test_many_fields);
+  tcase_add_test (tc_chain, test_binary);
   return s;
 }
 
@@ -392,6 +392,59 @@ GST_START_TEST (test_async_order_stress_test)
 
 GST_END_TEST;
 
+typedef struct
+{
+  GstClockID id;
+  GThread *thread;
+  volatile gint result;
+} SyncWaitData;
+
+static gpointer
+sync_wait_thread_func (gpointer data)
+{
+  SyncWaitData *d = data;
+
+  g_atomic_int_set (&d->result, gst_clock_id_wait (d->id, NULL));
+
+  return NULL;
+}
+
+GST_START_TEST (test_unschedule_one_of_many)
+{
+#define WAITER_COUNT 10
+  GstClock *clock;
+  SyncWaitData data[WAITER_COUNT];
+  GstClockTime base;
+  gint i, j;
+
+  clock = gst_system_clock_obtain ();
+  fail_unless (clock != NULL, "Could not create instance of GstSystemClock");
+
+  base = gst_clock_get_time (clock);
+  for (i = 0; i < WAITER_COUNT; i++) {
+    data[i].id = gst_clock_new_single_shot_id (clock, base + 60 * GST_SECOND);
+    data[i].result = -1;
+    data[i].thread = g_thread_new ("wait", sync_wait_thread_func, &data[i]);
+  }
+
+  /* unscheduling one entry only stops the wait of that entry */
+  for (i = 0; i < WAITER_COUNT; i++) {
+    /* give the waiters some time to start waiting */
+    g_usleep (G_USEC_PER_SEC / 100);
+    gst_clock_id_unschedule (data[i].id);
+    g_thread_join (data[i].thread);
+    fail_unless_equals_int (g_atomic_int_get (&data[i].result),
+        GST_CLOCK_UNSCHEDULED);
+    for (j = i + 1; j < WAITER_COUNT; j++)
+      fail_unless_equals_int (g_atomic_int_get (&data[j].result), -1);
+    gst_clock_id_unref (data[i].id);
+  }
+
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
 struct test_async_sync_interaction_data
 {
   GMutex lock;
@@ -830,8 +883,8 @@ GST_START_TEST (test_stress_cleanup_unschedule)
   for (i = 0; i < G_N_ELEMENTS (data); i++) {
     WaitUnscheduleData *d = &data[i];
 
-    /* Don't unschedule waits with positive offsets in order to trigger
-     * gst_system_clock_wait_wakeup() */
+    /* Don't unschedule waits with positive offsets in order to have waits
+     * that keep going while others are unscheduled */
     d->dont_unschedule_positive_offset = TRUE;
     /* Overweight of negative offsets in order to trigger GST_CLOCK_EARLY more
      * frequently */
@@ -916,6 +969,7 @@ gst_systemclock_suite (void)
   tcase_add_test (tc_chain, test_periodic_multi);
   tcase_add_test (tc_chain, test_async_order);
   tcase_add_test (tc_chain, test_async_order_stress_test);
+  tcase_add_test (tc_chain, test_unschedule_one_of_many);
   tcase_add_test (tc_chain, test_async_sync_interaction);
   tcase_add_test (tc_chain, test_diff);
   tcase_add_test (tc_chain, test_mixed);
@@ -3408,6 +3408,68 @@ GST_START_TEST (test_transform_list)
 
 GST_END_TEST;
 
+GST_START_TEST (test_dispatch_both_orders)
+{
+  GValue v1 = G_VALUE_INIT, v2 = G_VALUE_INIT, dest = G_VALUE_INIT;
+  const GstStructure *res;
+  GstStructure *s;
+
+  g_value_init (&v1, G_TYPE_INT);
+  g_value_set_int (&v1, 5);
+  g_value_init (&v2, GST_TYPE_INT_RANGE);
+  gst_value_set_int_range (&v2, 1, 10);
+
+  /* registered for int and int range, found both ways */
+  fail_unless (gst_value_can_intersect (&v1, &v2));
+  fail_unless (gst_value_can_intersect (&v2, &v1));
+  fail_unless (gst_value_intersect (&dest, &v2, &v1));
+  fail_unless_equals_int (g_value_get_int (&dest), 5);
+  g_value_unset (&dest);
+
+  fail_unless (gst_value_can_union (&v1, &v2));
+  fail_unless (gst_value_can_union (&v2, &v1));
+  fail_unless (gst_value_union (&dest, &v1, &v2));
+  fail_unless (G_VALUE_HOLDS (&dest, GST_TYPE_INT_RANGE));
+  g_value_unset (&dest);
+
+  /* subtract functions only go one way, but both are registered */
+  fail_unless (gst_value_can_subtract (&v1, &v2));
+  fail_unless (gst_value_can_subtract (&v2, &v1));
+  fail_if (gst_value_subtract (&dest, &v1, &v2));
+  fail_unless (gst_value_subtract (&dest, &v2, &v1));
+  fail_unless (G_VALUE_HOLDS (&dest, GST_TYPE_LIST));
+  g_value_unset (&dest);
+
+  /* no functions for these */
+  g_value_unset (&v2);
+  g_value_init (&v2, GST_TYPE_DOUBLE_RANGE);
+  gst_value_set_double_range (&v2, 1.0, 10.0);
+  fail_if (gst_value_can_union (&v1, &v2));
+  fail_if (gst_value_intersect (NULL, &v1, &v2));
+  g_value_unset (&v1);
+  g_value_unset (&v2);
+
+  /* structures are not fundamental types */
+  s = gst_structure_new ("s", "a", G_TYPE_INT, 1, NULL);
+  g_value_init (&v1, GST_TYPE_STRUCTURE);
+  gst_value_set_structure (&v1, s);
+  gst_structure_free (s);
+  s = gst_structure_new ("s", "b", G_TYPE_INT, 2, NULL);
+  g_value_init (&v2, GST_TYPE_STRUCTURE);
+  gst_value_set_structure (&v2, s);
+  gst_structure_free (s);
+  fail_unless (gst_value_can_union (&v1, &v2));
+  fail_unless (gst_value_intersect (&dest, &v1, &v2));
+  res = gst_value_get_structure (&dest);
+  fail_unless (gst_structure_has_field (res, "a"));
+  fail_unless (gst_structure_has_field (res, "b"));
+  g_value_unset (&dest);
+  g_value_unset (&v1);
+  g_value_unset (&v2);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_serialize_null_aray)
 {
   gchar *serialized;
@@ -3476,6 +3538,7 @@ gst_value_suite (void)
   tcase_add_test (tc_chain, test_transform_array);
   tcase_add_test (tc_chain, test_transform_list);
   tcase_add_test (tc_chain, test_serialize_null_aray);
+  tcase_add_test (tc_chain, test_dispatch_both_orders);
 
   return s;
 }
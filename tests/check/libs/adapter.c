@@ -1167,6 +1167,62 @@ GST_END_TEST;
 
 /* Fill a buffer with a sequence of 32 bit ints and read them back out
  * using take_buffer, checking that they're still in the right order */
+static GstBuffer *
+create_start_code_buffer (gsize size, gsize pos, const guint8 * code,
+    gsize code_size)
+{
+  GstBuffer *buffer = gst_buffer_new_and_alloc (size);
+
+  gst_buffer_memset (buffer, 0, 0xaa, size);
+  gst_buffer_fill (buffer, pos, code, code_size);
+
+  return buffer;
+}
+
+GST_START_TEST (test_scan_start_code)
+{
+  const guint8 code1[] = { 0x00, 0x00, 0x01, 0xb3 };
+  const guint8 code2[] = { 0x01, 0xe0 };
+  const guint8 code3[] = { 0x00, 0xaa, 0xaa, 0xaa, 0xaa, 0x00, 0x00, 0x01,
+    0x42
+  };
+  const guint8 zero = 0x00;
+  GstAdapter *adapter;
+  GstBuffer *buffer;
+  guint32 value;
+  gssize offset;
+
+  adapter = gst_adapter_new ();
+  buffer = create_start_code_buffer (40, 20, code1, sizeof (code1));
+  gst_buffer_fill (buffer, 39, &zero, 1);
+  gst_adapter_push (adapter, buffer);
+  gst_adapter_push (adapter, create_start_code_buffer (1, 0, &zero, 1));
+  buffer = create_start_code_buffer (40, 0, code2, sizeof (code2));
+  gst_buffer_fill (buffer, 30, code3, sizeof (code3));
+  gst_adapter_push (adapter, buffer);
+
+  /* inside a buffer, across three buffers and after a lone zero byte */
+  offset = gst_adapter_masked_scan_uint32_peek (adapter, 0xffffff00,
+      0x00000100, 0, 81, &value);
+  fail_unless_equals_int (offset, 20);
+  fail_unless_equals_int (value, 0x000001b3);
+  offset = gst_adapter_masked_scan_uint32_peek (adapter, 0xffffff00,
+      0x00000100, 21, 60, &value);
+  fail_unless_equals_int (offset, 39);
+  fail_unless_equals_int (value, 0x000001e0);
+  offset = gst_adapter_masked_scan_uint32_peek (adapter, 0xffffff00,
+      0x00000100, 40, 41, &value);
+  fail_unless_equals_int (offset, 76);
+  fail_unless_equals_int (value, 0x00000142);
+  offset = gst_adapter_masked_scan_uint32 (adapter, 0xffffff00, 0x00000100,
+      77, 4);
+  fail_unless_equals_int (offset, -1);
+
+  g_object_unref (adapter);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_take_list)
 {
   GstAdapter *adapter;
@@ -1445,6 +1501,80 @@ GST_START_TEST (test_take_buffer_fast)
 
 GST_END_TEST;
 
+static GstBuffer *
+create_multi_memory_buffer (guint8 start)
+{
+  GstBuffer *buffer = gst_buffer_new ();
+  guint8 *data;
+  guint i, j;
+
+  for (i = 0; i < 20; i++) {
+    data = g_malloc (5);
+    for (j = 0; j < 5; j++)
+      data[j] = start + i * 5 + j;
+    gst_buffer_append_memory (buffer,
+        gst_memory_new_wrapped (0, data, 5, 0, 5, data, g_free));
+  }
+  return buffer;
+}
+
+GST_START_TEST (test_scan_multi_memory)
+{
+  GstAdapter *adapter;
+  GstBuffer *buffer1, *buffer2;
+  const guint8 *data;
+  guint32 value;
+  gssize offset;
+
+  adapter = gst_adapter_new ();
+  buffer1 = create_multi_memory_buffer (0);
+  buffer2 = create_multi_memory_buffer (100);
+  gst_adapter_push (adapter, gst_buffer_ref (buffer1));
+  gst_adapter_push (adapter, gst_buffer_new ());
+  gst_adapter_push (adapter, gst_buffer_ref (buffer2));
+
+  /* inside a memory, across memories and across buffers */
+  offset = gst_adapter_masked_scan_uint32 (adapter, 0xffffffff, 0x00010203, 0,
+      200);
+  fail_unless_equals_int (offset, 0);
+  offset = gst_adapter_masked_scan_uint32 (adapter, 0xffffffff, 0x03040506, 0,
+      200);
+  fail_unless_equals_int (offset, 3);
+  offset = gst_adapter_masked_scan_uint32_peek (adapter, 0xffffffff,
+      0x62636465, 10, 190, &value);
+  fail_unless_equals_int (offset, 98);
+  fail_unless_equals_int (value, 0x62636465);
+  offset = gst_adapter_masked_scan_uint32 (adapter, 0xffffffff, 0xc4c5c6c7,
+      0x62, 102);
+  fail_unless_equals_int (offset, 196);
+  offset = gst_adapter_masked_scan_uint32 (adapter, 0xffffffff, 0xc4c5c6c8, 0,
+      200);
+  fail_unless_equals_int (offset, -1);
+
+  /* data inside one memory is mapped directly, other data is copied */
+  gst_adapter_flush (adapter, 11);
+  data = gst_adapter_map (adapter, 4);
+  fail_unless (data != NULL);
+  fail_unless_equals_int (data[0], 11);
+  fail_unless_equals_int (data[3], 14);
+  gst_adapter_unmap (adapter);
+  data = gst_adapter_map (adapter, 20);
+  fail_unless (data != NULL);
+  fail_unless_equals_int (data[0], 11);
+  fail_unless_equals_int (data[19], 30);
+  gst_adapter_unmap (adapter);
+
+  /* the memory of the buffers was not merged */
+  fail_unless_equals_int (gst_buffer_n_memory (buffer1), 20);
+  fail_unless_equals_int (gst_buffer_n_memory (buffer2), 20);
+
+  g_object_unref (adapter);
+  gst_buffer_unref (buffer1);
+  gst_buffer_unref (buffer2);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_adapter_suite (void)
 {
@@ -1462,6 +1592,8 @@ gst_adapter_suite (void)
   tcase_add_test (tc_chain, test_take_buf_order);
   tcase_add_test (tc_chain, test_timestamp);
   tcase_add_test (tc_chain, test_scan);
+  tcase_add_test (tc_chain, test_scan_multi_memory);
+  tcase_add_test (tc_chain, test_scan_start_code);
   tcase_add_test (tc_chain, test_take_list);
   tcase_add_test (tc_chain, test_get_list);
   tcase_add_test (tc_chain, test_take_buffer_list);
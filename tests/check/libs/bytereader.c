@@ -607,6 +607,60 @@ GST_START_TEST (test_scan)
 
 GST_END_TEST;
 
+/* the start code scan works on blocks of bytes, check start codes around
+ * the block boundaries and 0 bytes that don't start one */
+GST_START_TEST (test_scan_start_code_blocks)
+{
+  const guint codes[] = { 0, 13, 14, 15, 16, 30, 31, 33, 62, 63, 64, 200 };
+  GstByteReader reader;
+  guint8 data[300];
+  guint32 val;
+  guint i, offset, expected;
+  gint found;
+
+  memset (data, 0xff, sizeof (data));
+  /* almost start codes */
+  for (i = 100; i < 190; i += 5) {
+    data[i] = 0x00;
+    data[i + 1] = (i % 2) ? 0x00 : 0x01;
+    data[i + 2] = 0x02;
+  }
+  for (i = 0; i < G_N_ELEMENTS (codes); i++) {
+    data[codes[i]] = 0x00;
+    data[codes[i] + 1] = 0x00;
+    data[codes[i] + 2] = 0x01;
+    data[codes[i] + 3] = i;
+  }
+  /* a start code in the last 4 bytes */
+  memcpy (data + sizeof (data) - 4, "\0\0\1\xa0", 4);
+
+  gst_byte_reader_init (&reader, data, sizeof (data));
+
+  for (offset = 0; offset < sizeof (data) - 4; offset++) {
+    for (expected = offset; expected + 4 <= sizeof (data); expected++) {
+      if (data[expected] == 0 && data[expected + 1] == 0
+          && data[expected + 2] == 1)
+        break;
+    }
+    fail_unless (expected + 4 <= sizeof (data));
+
+    found = gst_byte_reader_masked_scan_uint32_peek (&reader, 0xffffff00,
+        0x00000100, offset, sizeof (data) - offset, &val);
+    fail_unless_equals_int (found, expected);
+    fail_unless_equals_int (val, 0x00000100 | data[expected + 3]);
+
+    /* the same without the last start code */
+    found = gst_byte_reader_masked_scan_uint32 (&reader, 0xffffff00,
+        0x00000100, offset, sizeof (data) - offset - 1);
+    if (expected == sizeof (data) - 4)
+      fail_unless_equals_int (found, -1);
+    else
+      fail_unless_equals_int (found, expected);
+  }
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_string_funcs)
 {
   GstByteReader reader, backup;
@@ -835,6 +889,7 @@ gst_byte_reader_suite (void)
   tcase_add_test (tc_chain, test_get_float_be);
   tcase_add_test (tc_chain, test_position_tracking);
   tcase_add_test (tc_chain, test_scan);
+  tcase_add_test (tc_chain, test_scan_start_code_blocks);
   tcase_add_test (tc_chain, test_string_funcs);
   tcase_add_test (tc_chain, test_dup_string);
   tcase_add_test (tc_chain, test_sub_reader);